@@ -0,0 +1,181 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+#include "benchmarkrunner.hpp"
+#include "config.h"
+
+using std::chrono::duration;
+using std::chrono::steady_clock;
+using std::function;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace bench {
+
+namespace {
+
+/** Return the percentile p (0..1) of the sorted values. */
+double percentile(const vector<double> &sorted, double p)
+{
+	if (sorted.empty())
+		return 0.;
+	size_t pos = (size_t)std::ceil(p * (double)sorted.size());
+	if (pos > 0)
+		--pos;
+	return sorted[std::min(pos, sorted.size() - 1)];
+}
+
+} // namespace
+
+BenchmarkRunner::BenchmarkRunner(double min_time, unsigned int seed,
+		const string &filter) :
+	min_time_(min_time),
+	seed_(seed),
+	filter_(filter),
+	random_(seed),
+	sink_(0.)
+{
+}
+
+void BenchmarkRunner::run(const string &name, function<void()> setup,
+	benchmark_func_t func)
+{
+	if (!is_selected(name))
+		return;
+
+	fprintf(stderr, "Running %s...\n", name.c_str());
+	reseed();
+
+	// Each benchmark runs at least 3 iterations, the first one is a warm up
+	// run and not included in the results.
+	vector<double> iteration_ns;
+	uint64_t items = 0;
+	double elapsed = 0.;
+	for (size_t i = 0; i < 3 || elapsed < min_time_; ++i) {
+		if (setup)
+			setup();
+
+		steady_clock::time_point start = steady_clock::now();
+		uint64_t iteration_items = func();
+		double ns = duration<double, std::nano>(
+			steady_clock::now() - start).count();
+		if (i == 0)
+			continue;
+
+		iteration_ns.push_back(ns);
+		items += iteration_items;
+		elapsed += ns / 1e9;
+	}
+
+	std::sort(iteration_ns.begin(), iteration_ns.end());
+
+	QJsonObject result;
+	result["name"] = QString::fromStdString(name);
+	result["iterations"] = (double)iteration_ns.size();
+	result["items"] = (double)items;
+	result["items_per_second"] = elapsed > 0. ? (double)items / elapsed : 0.;
+	result["ns_per_item"] = items > 0 ? elapsed * 1e9 / (double)items : 0.;
+	QJsonObject iteration;
+	iteration["min"] = iteration_ns.front();
+	iteration["p50"] = percentile(iteration_ns, 0.5);
+	iteration["p99"] = percentile(iteration_ns, 0.99);
+	iteration["max"] = iteration_ns.back();
+	result["iteration_ns"] = iteration;
+	benchmarks_.append(result);
+}
+
+void BenchmarkRunner::run(const string &name, benchmark_func_t func)
+{
+	run(name, nullptr, func);
+}
+
+void BenchmarkRunner::add_result(const string &name, QJsonObject result)
+{
+	result["name"] = QString::fromStdString(name);
+	load_tests_.append(result);
+}
+
+bool BenchmarkRunner::is_selected(const string &name) const
+{
+	return filter_.empty() || name.find(filter_) != string::npos;
+}
+
+void BenchmarkRunner::reseed()
+{
+	random_.seed(seed_);
+}
+
+vector<double> BenchmarkRunner::synthetic_samples(size_t count,
+	double amplitude)
+{
+	std::normal_distribution<double> noise(0., amplitude / 100.);
+	vector<double> samples;
+	samples.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		samples.push_back(
+			amplitude * std::sin((double)i / 100.) + noise(random_));
+	}
+	return samples;
+}
+
+vector<double> BenchmarkRunner::random_values(size_t count,
+	double min, double max)
+{
+	std::uniform_real_distribution<double> dist(min, max);
+	vector<double> values;
+	values.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+		values.push_back(dist(random_));
+	return values;
+}
+
+void BenchmarkRunner::consume(double value)
+{
+	sink_ = sink_ + value;
+}
+
+QJsonDocument BenchmarkRunner::to_json() const
+{
+	QJsonObject root;
+	root["version"] = QString(SV_VERSION_STRING);
+	root["seed"] = (double)seed_;
+	root["min_time"] = min_time_;
+	root["benchmarks"] = benchmarks_;
+	root["load_tests"] = load_tests_;
+	return QJsonDocument(root);
+}
+
+} // namespace bench
+} // namespace sv
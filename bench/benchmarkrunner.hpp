@@ -0,0 +1,103 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_BENCHMARKRUNNER_HPP
+#define BENCH_BENCHMARKRUNNER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+using std::function;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace bench {
+
+/**
+ * The BenchmarkRunner runs each benchmark function repeatedly for at least
+ * the min. run time and collects the durations of the single iterations.
+ * The random generator is reseeded for every benchmark, so the synthetic
+ * workloads are the same in every run. All results are collected as JSON,
+ * so they can be compared between builds.
+ */
+class BenchmarkRunner
+{
+
+public:
+	/** A benchmark iteration returns the number of processed items. */
+	typedef function<uint64_t()> benchmark_func_t;
+
+	/**
+	 * @param min_time The min. run time of a benchmark in seconds.
+	 * @param seed The seed for the synthetic workloads.
+	 * @param filter Only run benchmarks, whose name contains the filter.
+	 */
+	BenchmarkRunner(double min_time, unsigned int seed, const string &filter);
+
+	/**
+	 * Run a benchmark. The setup function is called before every iteration
+	 * and isn't included in the measured time.
+	 */
+	void run(const string &name, function<void()> setup,
+		benchmark_func_t func);
+	void run(const string &name, benchmark_func_t func);
+
+	/** Add the result of a test, that does its own measuring. */
+	void add_result(const string &name, QJsonObject result);
+
+	bool is_selected(const string &name) const;
+
+	/**
+	 * Reseed the random generator. Must be called before a workload is
+	 * generated, that is outside of run().
+	 */
+	void reseed();
+	/** A (noisy) sine wave with the given amplitude. */
+	vector<double> synthetic_samples(size_t count, double amplitude);
+	/** Uniform distributed random values in [min, max). */
+	vector<double> random_values(size_t count, double min, double max);
+
+	/** Prevent the compiler from optimizing away a result. */
+	void consume(double value);
+
+	QJsonDocument to_json() const;
+
+private:
+	const double min_time_;
+	const unsigned int seed_;
+	const string filter_;
+	std::mt19937 random_;
+	volatile double sink_;
+	QJsonArray benchmarks_;
+	QJsonArray load_tests_;
+
+};
+
+} // namespace bench
+} // namespace sv
+
+#endif // BENCH_BENCHMARKRUNNER_HPP
@@ -0,0 +1,94 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_BENCHMARKS_HPP
+#define BENCH_BENCHMARKS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/data/datautil.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class UserDevice;
+}
+
+namespace bench {
+
+class BenchmarkRunner;
+
+/** The number of samples of the synthetic signals. */
+const size_t bench_sample_count = 100000;
+/** The samplerate of the synthetic signals. */
+const uint64_t bench_samplerate = 1000;
+
+/**
+ * Create a new user channel with an empty signal in the device.
+ */
+shared_ptr<data::AnalogTimeSignal> create_signal(
+	shared_ptr<devices::UserDevice> device, const string &name,
+	data::Quantity quantity, data::Unit unit);
+
+/**
+ * Push the samples to the signal, starting at the timestamp (in s since
+ * epoch). Returns the timestamp after the last sample.
+ */
+double push_samples(shared_ptr<data::AnalogTimeSignal> signal,
+	vector<double> &samples, double timestamp, uint64_t samplerate);
+
+/**
+ * AnalogTimeSignal::push_samples(), get_value_at_timestamp() and
+ * combine_signals().
+ */
+void run_signal_benchmarks(BenchmarkRunner &runner, Session &session);
+
+/** All MathChannel subclasses. */
+void run_math_benchmarks(BenchmarkRunner &runner, Session &session);
+
+/** The CSV export of the SaveDialog. */
+void run_export_benchmarks(BenchmarkRunner &runner, Session &session);
+
+/** Sample iteration of TimeCurveData and XYCurveData. */
+void run_curve_benchmarks(BenchmarkRunner &runner, Session &session);
+
+/**
+ * Acquire data from the sigrok demo driver for the given duration (in
+ * seconds) at each samplerate and report the throughput and the latencies.
+ */
+void run_load_test(BenchmarkRunner &runner, Session &session,
+	double duration, const vector<uint64_t> &samplerates);
+
+} // namespace bench
+} // namespace sv
+
+#endif // BENCH_BENCHMARKS_HPP
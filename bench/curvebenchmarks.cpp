@@ -0,0 +1,100 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <QPointF>
+#include <QRectF>
+
+#include "benchmarks.hpp"
+#include "benchmarkrunner.hpp"
+#include "src/session.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/userdevice.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/timecurvedata.hpp"
+#include "src/ui/widgets/plot/xycurvedata.hpp"
+
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace bench {
+
+namespace {
+
+/**
+ * Iterate over all samples of the curve, like the curve renderer does when
+ * the whole curve is visible.
+ */
+uint64_t iterate_curve(BenchmarkRunner &runner,
+	const ui::widgets::plot::BaseCurveData &curve_data)
+{
+	double sum = 0.;
+	const size_t size = curve_data.size();
+	for (size_t i = 0; i < size; ++i) {
+		QPointF point = curve_data.sample(i);
+		sum += point.x() + point.y();
+	}
+	QRectF rect = curve_data.boundingRect();
+	runner.consume(sum + rect.width());
+	return size;
+}
+
+} // namespace
+
+void run_curve_benchmarks(BenchmarkRunner &runner, Session &session)
+{
+	if (!runner.is_selected("curve/"))
+		return;
+
+	auto device = session.add_user_device();
+	auto x_signal = create_signal(device, "Curve X",
+		data::Quantity::Voltage, data::Unit::Volt);
+	auto y_signal = create_signal(device, "Curve Y",
+		data::Quantity::Current, data::Unit::Ampere);
+	runner.reseed();
+	vector<double> x_samples =
+		runner.synthetic_samples(bench_sample_count, 10.);
+	vector<double> y_samples =
+		runner.synthetic_samples(bench_sample_count, 1.);
+	push_samples(x_signal, x_samples,
+		Session::session_start_timestamp, bench_samplerate);
+	push_samples(y_signal, y_samples,
+		Session::session_start_timestamp, bench_samplerate);
+
+	auto time_curve_data =
+		make_shared<ui::widgets::plot::TimeCurveData>(y_signal);
+	runner.run("curve/TimeCurveData", [&]() {
+		return iterate_curve(runner, *time_curve_data);
+	});
+
+	auto xy_curve_data =
+		make_shared<ui::widgets::plot::XYCurveData>(x_signal, y_signal);
+	runner.run("curve/XYCurveData", [&]() {
+		return iterate_curve(runner, *xy_curve_data);
+	});
+}
+
+} // namespace bench
+} // namespace sv
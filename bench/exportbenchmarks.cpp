@@ -0,0 +1,87 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include "benchmarks.hpp"
+#include "benchmarkrunner.hpp"
+#include "src/session.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/userdevice.hpp"
+#include "src/ui/dialogs/savedialog.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace bench {
+
+void run_export_benchmarks(BenchmarkRunner &runner, Session &session)
+{
+	if (!runner.is_selected("export/"))
+		return;
+
+	// Three signals with the same samplerate, but shifted timestamps, so
+	// the combined export has a line for every single sample.
+	auto device = session.add_user_device();
+	vector<shared_ptr<data::BaseSignal>> signals;
+	runner.reseed();
+	for (size_t i = 0; i < 3; ++i) {
+		auto signal = create_signal(device, "Export " + std::to_string(i + 1),
+			data::Quantity::Voltage, data::Unit::Volt);
+		vector<double> samples =
+			runner.synthetic_samples(bench_sample_count, 10.);
+		push_samples(signal, samples,
+			Session::session_start_timestamp + (double)i * 0.0001,
+			bench_samplerate);
+		signals.push_back(signal);
+	}
+	const uint64_t sample_count = signals.size() * bench_sample_count;
+	const QString file_name = QDir::temp().filePath("smuview-bench.csv");
+
+	runner.run("export/save", [&]() {
+		ui::dialogs::SaveDialog::save(signals, file_name, true, ",");
+		return sample_count;
+	});
+
+	runner.run("export/save_absolute_time", [&]() {
+		ui::dialogs::SaveDialog::save(signals, file_name, false, ",");
+		return sample_count;
+	});
+
+	runner.run("export/save_combined", [&]() {
+		ui::dialogs::SaveDialog::save_combined(signals, file_name, true, ",");
+		return sample_count;
+	});
+
+	QFile::remove(file_name);
+}
+
+} // namespace bench
+} // namespace sv
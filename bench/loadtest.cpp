@@ -0,0 +1,159 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+#include <QEventLoop>
+#include <QJsonObject>
+#include <QObject>
+#include <QTimer>
+
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include "benchmarks.hpp"
+#include "benchmarkrunner.hpp"
+#include "src/devicemanager.hpp"
+#include "src/eventloopmonitor.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/devices/acquisitionmetrics.hpp"
+#include "src/devices/hardwaredevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace bench {
+
+namespace {
+
+/** The number of analog channels of the demo device. */
+const uint64_t demo_analog_channels = 4;
+
+/** Process events for the given time in seconds. */
+void process_events(double seconds)
+{
+	QEventLoop loop;
+	QTimer::singleShot((int)(seconds * 1000), &loop, SLOT(quit()));
+	loop.exec();
+}
+
+QJsonObject to_json(const devices::LatencyStats &stats)
+{
+	QJsonObject json;
+	json["count"] = (double)stats.count;
+	json["mean"] = stats.mean;
+	json["p50"] = stats.p50;
+	json["p99"] = stats.p99;
+	json["max"] = stats.max;
+	return json;
+}
+
+} // namespace
+
+void run_load_test(BenchmarkRunner &runner, Session &session,
+	double duration, const vector<uint64_t> &samplerates)
+{
+	if (duration <= 0. || !runner.is_selected("load/"))
+		return;
+
+	auto devices = session.device_manager().driver_scan("demo", {
+		"analog_channels=" + std::to_string(demo_analog_channels),
+		"logic_channels=0" });
+	if (devices.empty()) {
+		qWarning() << "run_load_test(): No demo device found";
+		return;
+	}
+	shared_ptr<devices::HardwareDevice> device = devices.front();
+	session.add_device(device);
+	auto metrics = device->metrics();
+
+	// There are no displays in the load test, so the latency is measured
+	// until the samples are delivered to the main thread. The signals of a
+	// hardware channel are created by the acquisition thread, so they are
+	// connected directly in there.
+	QObject receiver;
+	auto connect_signal = [&receiver, metrics](
+			shared_ptr<data::BaseSignal> signal) {
+		auto a_signal = dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+		if (!a_signal)
+			return;
+		QObject::connect(a_signal.get(), &data::AnalogTimeSignal::sample_appended,
+			&receiver, [metrics]() { metrics->mark_displayed(); });
+	};
+	for (const auto &channel_pair : device->channel_map()) {
+		auto channel = channel_pair.second;
+		for (const auto &signal : channel->signals())
+			connect_signal(signal);
+		QObject::connect(channel.get(), &channels::BaseChannel::signal_added,
+			&receiver, connect_signal, Qt::DirectConnection);
+	}
+
+	for (const auto samplerate : samplerates) {
+		string name = "load/demo@" + std::to_string(samplerate);
+		fprintf(stderr, "Running %s...\n", name.c_str());
+
+		device->sr_device()->config_set(sigrok::ConfigKey::SAMPLERATE,
+			Glib::Variant<uint64_t>::create(samplerate));
+		// Let the acquisition settle at the new samplerate.
+		process_events(0.5);
+		metrics->reset();
+		session.event_loop_monitor()->reset();
+
+		process_events(duration);
+		devices::AcquisitionStats stats = metrics->stats();
+
+		size_t memory_size = 0;
+		for (const auto &signal : device->signals()) {
+			auto a_signal = dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+			if (a_signal)
+				memory_size += a_signal->memory_size();
+		}
+
+		QJsonObject result;
+		result["samplerate"] = (double)samplerate;
+		result["duration"] = duration;
+		result["packets"] = (double)stats.packet_count;
+		result["samples"] = (double)stats.sample_count;
+		result["packets_per_second"] = (double)stats.packet_count / duration;
+		result["samples_per_second"] = (double)stats.sample_count / duration;
+		result["expected_samples_per_second"] =
+			(double)(samplerate * demo_analog_channels);
+		result["ingest_latency_us"] = to_json(stats.ingest_latency);
+		result["delivery_latency_us"] = to_json(stats.display_latency);
+		result["event_loop_max_lag_ms"] =
+			session.event_loop_monitor()->max_lag();
+		result["memory_bytes"] = (double)memory_size;
+		runner.add_result(name, result);
+	}
+
+	session.remove_device(device);
+}
+
+} // namespace bench
+} // namespace sv
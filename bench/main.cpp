@@ -0,0 +1,165 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <getopt.h>
+
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QString>
+
+#include "benchmarks.hpp"
+#include "benchmarkrunner.hpp"
+#include "config.h"
+#include "src/application.hpp"
+#include "src/devicemanager.hpp"
+#include "src/session.hpp"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+void usage()
+{
+	fprintf(stdout,
+		"Usage:\n"
+		"  %s-bench [OPTIONS]\n"
+		"\n"
+		"Options:\n"
+		"  -h, -?, --help             Show help option\n"
+		"  -o, --output               Write the JSON results to a file instead of stdout\n"
+		"  -t, --min-time             Min. run time of a benchmark in s (default: 1)\n"
+		"  -s, --seed                 Seed of the synthetic workloads (default: 42)\n"
+		"  -f, --filter               Only run benchmarks whose name contains the filter\n"
+		"  -L, --load-time            Duration of the demo load test per samplerate in s\n"
+		"                             (default: 5, 0 disables the load test)\n"
+		"  -r, --samplerate           Samplerate of the demo load test, can be repeated\n"
+		"                             (default: 1000, 10000 and 100000)\n"
+		"\n"
+		"Example:\n"
+		"  %s-bench --filter math/ --output math.json\n",
+		SV_BIN_NAME, SV_BIN_NAME);
+}
+
+int main(int argc, char *argv[])
+{
+	string output_file;
+	double min_time = 1.;
+	unsigned int seed = 42;
+	string filter;
+	double load_time = 5.;
+	vector<uint64_t> samplerates;
+
+	CoreApplication app(argc, argv);
+
+	// Parse arguments
+	while (true) {
+		static const struct option long_options[] = {
+			{ "help", no_argument, nullptr, 'h' },
+			{ "output", required_argument, nullptr, 'o' },
+			{ "min-time", required_argument, nullptr, 't' },
+			{ "seed", required_argument, nullptr, 's' },
+			{ "filter", required_argument, nullptr, 'f' },
+			{ "load-time", required_argument, nullptr, 'L' },
+			{ "samplerate", required_argument, nullptr, 'r' },
+			{ nullptr, 0, nullptr, 0 }
+		};
+
+		const int c = getopt_long(argc, argv,
+			"h?o:t:s:f:L:r:", long_options, nullptr);
+
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case 'h':
+		case '?':
+			usage();
+			return 0;
+
+		case 'o':
+			output_file = optarg;
+			break;
+
+		case 't':
+			min_time = atof(optarg);
+			break;
+
+		case 's':
+			seed = (unsigned int)strtoul(optarg, nullptr, 10);
+			break;
+
+		case 'f':
+			filter = optarg;
+			break;
+
+		case 'L':
+			load_time = atof(optarg);
+			break;
+
+		case 'r':
+			samplerates.push_back(strtoull(optarg, nullptr, 10));
+			break;
+		}
+	}
+	if (samplerates.empty())
+		samplerates = { 1000, 10000, 100000 };
+
+	shared_ptr<sigrok::Context> context = sigrok::Context::create();
+	sv::Session::sr_context = context;
+	sv::Session::session_start_timestamp =
+		QDateTime::currentMSecsSinceEpoch() / (double)1000;
+
+	sv::bench::BenchmarkRunner runner(min_time, seed, filter);
+	{
+		// Don't scan for devices, the load test scans for the demo device.
+		sv::DeviceManager device_manager(context, vector<string>(), false);
+		sv::Session session(device_manager, nullptr);
+
+		sv::bench::run_signal_benchmarks(runner, session);
+		sv::bench::run_math_benchmarks(runner, session);
+		sv::bench::run_export_benchmarks(runner, session);
+		sv::bench::run_curve_benchmarks(runner, session);
+		sv::bench::run_load_test(runner, session, load_time, samplerates);
+	}
+
+	QByteArray json = runner.to_json().toJson(QJsonDocument::Indented);
+	if (output_file.empty()) {
+		fwrite(json.constData(), 1, json.size(), stdout);
+		return 0;
+	}
+
+	QFile file(QString::fromStdString(output_file));
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		fprintf(stderr, "Could not write %s.\n", output_file.c_str());
+		return 1;
+	}
+	file.write(json);
+
+	return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmarks.hpp"
+#include "benchmarkrunner.hpp"
+#include "src/session.hpp"
+#include "src/channels/addscchannel.hpp"
+#include "src/channels/dividechannel.hpp"
+#include "src/channels/energychannel.hpp"
+#include "src/channels/integratechannel.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/channels/movingavgchannel.hpp"
+#include "src/channels/multiplysfchannel.hpp"
+#include "src/channels/multiplysschannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::function;
+using std::make_pair;
+using std::make_shared;
+using std::pair;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace bench {
+
+namespace {
+
+typedef vector<shared_ptr<data::AnalogTimeSignal>> input_signals_t;
+typedef function<shared_ptr<channels::MathChannel>(
+	shared_ptr<devices::UserDevice>, const input_signals_t &)> create_channel_t;
+
+/** The number of samples, that are pushed to the inputs per iteration. */
+const size_t math_chunk_size = 10000;
+
+/**
+ * Push the samples one by one to the input signals, like a slow acquisition
+ * (e.g. a multimeter) does, so the math channel has to process every single
+ * sample. The input signals are continued in every iteration.
+ */
+void run_math_benchmark(BenchmarkRunner &runner, Session &session,
+	const string &name, vector<pair<data::Quantity, data::Unit>> input_types,
+	create_channel_t create_channel)
+{
+	if (!runner.is_selected(name))
+		return;
+
+	auto device = session.add_user_device();
+	input_signals_t inputs;
+	vector<vector<double>> samples;
+	runner.reseed();
+	for (const auto &input_type : input_types) {
+		inputs.push_back(create_signal(device,
+			"Input " + std::to_string(inputs.size() + 1),
+			input_type.first, input_type.second));
+		samples.push_back(runner.synthetic_samples(math_chunk_size, 10.));
+	}
+	device->add_math_channel(create_channel(device, inputs), "Benchmark");
+
+	double timestamp = Session::session_start_timestamp;
+	const double time_stride = 1. / (double)bench_samplerate;
+	runner.run(name, [&]() {
+		for (size_t i = 0; i < math_chunk_size; ++i) {
+			for (size_t j = 0; j < inputs.size(); ++j) {
+				inputs[j]->push_sample(&samples[j][i], timestamp,
+					sizeof(double), 7, -1);
+			}
+			timestamp += time_stride;
+		}
+		return (uint64_t)math_chunk_size;
+	});
+}
+
+} // namespace
+
+void run_math_benchmarks(BenchmarkRunner &runner, Session &session)
+{
+	const auto voltage = make_pair(data::Quantity::Voltage, data::Unit::Volt);
+	const auto current = make_pair(data::Quantity::Current, data::Unit::Ampere);
+	const auto power = make_pair(data::Quantity::Power, data::Unit::Watt);
+
+	run_math_benchmark(runner, session, "math/AddSCChannel", { voltage },
+		[](shared_ptr<devices::UserDevice> device, const input_signals_t &in) {
+			return make_shared<channels::AddSCChannel>(
+				data::Quantity::Voltage, set<data::QuantityFlag>(),
+				data::Unit::Volt, in[0], 1.5, device,
+				set<string> { "Benchmark" }, "AddSC",
+				in[0]->signal_start_timestamp());
+		});
+
+	run_math_benchmark(runner, session, "math/MultiplySFChannel", { voltage },
+		[](shared_ptr<devices::UserDevice> device, const input_signals_t &in) {
+			return make_shared<channels::MultiplySFChannel>(
+				data::Quantity::Voltage, set<data::QuantityFlag>(),
+				data::Unit::Volt, in[0], 2.5, device,
+				set<string> { "Benchmark" }, "MultiplySF",
+				in[0]->signal_start_timestamp());
+		});
+
+	run_math_benchmark(runner, session, "math/MultiplySSChannel",
+		{ voltage, current },
+		[](shared_ptr<devices::UserDevice> device, const input_signals_t &in) {
+			return make_shared<channels::MultiplySSChannel>(
+				data::Quantity::Power, set<data::QuantityFlag>(),
+				data::Unit::Watt, in[0], in[1], device,
+				set<string> { "Benchmark" }, "MultiplySS",
+				in[0]->signal_start_timestamp());
+		});
+
+	run_math_benchmark(runner, session, "math/DivideChannel",
+		{ voltage, current },
+		[](shared_ptr<devices::UserDevice> device, const input_signals_t &in) {
+			return make_shared<channels::DivideChannel>(
+				data::Quantity::Resistance, set<data::QuantityFlag>(),
+				data::Unit::Ohm, in[0], in[1], device,
+				set<string> { "Benchmark" }, "Divide",
+				in[0]->signal_start_timestamp());
+		});
+
+	run_math_benchmark(runner, session, "math/IntegrateChannel", { power },
+		[](shared_ptr<devices::UserDevice> device, const input_signals_t &in) {
+			return make_shared<channels::IntegrateChannel>(
+				data::Quantity::Work, set<data::QuantityFlag>(),
+				data::Unit::WattHour, in[0], device,
+				set<string> { "Benchmark" }, "Integrate",
+				in[0]->signal_start_timestamp());
+		});
+
+	run_math_benchmark(runner, session, "math/MovingAvgChannel", { voltage },
+		[](shared_ptr<devices::UserDevice> device, const input_signals_t &in) {
+			return make_shared<channels::MovingAvgChannel>(
+				data::Quantity::Voltage, set<data::QuantityFlag>(),
+				data::Unit::Volt, in[0], 100, device,
+				set<string> { "Benchmark" }, "MovingAvg",
+				in[0]->signal_start_timestamp());
+		});
+
+	run_math_benchmark(runner, session, "math/EnergyChannel",
+		{ voltage, current },
+		[](shared_ptr<devices::UserDevice> device, const input_signals_t &in) {
+			return make_shared<channels::EnergyChannel>(in[0], in[1], device,
+				set<string> { "Benchmark" }, "Energy",
+				in[0]->signal_start_timestamp());
+		});
+}
+
+} // namespace bench
+} // namespace sv
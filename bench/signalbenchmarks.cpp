@@ -0,0 +1,146 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "benchmarks.hpp"
+#include "benchmarkrunner.hpp"
+#include "src/session.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::make_shared;
+using std::set;
+using std::shared_ptr;
+using std::static_pointer_cast;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace bench {
+
+shared_ptr<data::AnalogTimeSignal> create_signal(
+	shared_ptr<devices::UserDevice> device, const string &name,
+	data::Quantity quantity, data::Unit unit)
+{
+	auto channel = device->add_user_channel(name, "Benchmark");
+	return static_pointer_cast<data::AnalogTimeSignal>(channel->add_signal(
+		quantity, set<data::QuantityFlag>(), unit));
+}
+
+double push_samples(shared_ptr<data::AnalogTimeSignal> signal,
+	vector<double> &samples, double timestamp, uint64_t samplerate)
+{
+	signal->push_samples(samples.data(), samples.size(), timestamp,
+		samplerate, sizeof(double), 7, -1);
+	return timestamp + (double)samples.size() / (double)samplerate;
+}
+
+void run_signal_benchmarks(BenchmarkRunner &runner, Session &session)
+{
+	auto device = session.add_user_device();
+	const double start_timestamp = Session::session_start_timestamp;
+
+	if (runner.is_selected("signal/push_samples")) {
+		// Push the samples in packets, like the demo driver does.
+		const size_t packet_size = 1000;
+		auto signal = create_signal(device, "push_samples",
+			data::Quantity::Voltage, data::Unit::Volt);
+		runner.reseed();
+		vector<double> samples =
+			runner.synthetic_samples(bench_sample_count, 10.);
+		runner.run("signal/push_samples",
+			[signal]() { signal->clear(); },
+			[&]() {
+				double timestamp = start_timestamp;
+				for (size_t pos = 0; pos < samples.size(); pos += packet_size) {
+					signal->push_samples(&samples[pos], packet_size, timestamp,
+						bench_samplerate, sizeof(double), 7, -1);
+					timestamp += (double)packet_size / bench_samplerate;
+				}
+				return (uint64_t)samples.size();
+			});
+	}
+
+	if (runner.is_selected("signal/get_value_at_timestamp")) {
+		auto signal = create_signal(device, "get_value_at_timestamp",
+			data::Quantity::Voltage, data::Unit::Volt);
+		runner.reseed();
+		vector<double> samples =
+			runner.synthetic_samples(bench_sample_count, 10.);
+		double end_timestamp = push_samples(
+			signal, samples, start_timestamp, bench_samplerate);
+		vector<double> timestamps = runner.random_values(
+			bench_sample_count, start_timestamp, end_timestamp);
+		runner.run("signal/get_value_at_timestamp", [&]() {
+			double sum = 0.;
+			double value;
+			for (const double timestamp : timestamps) {
+				if (signal->get_value_at_timestamp(timestamp, value, false))
+					sum += value;
+			}
+			runner.consume(sum);
+			return (uint64_t)timestamps.size();
+		});
+	}
+
+	if (runner.is_selected("signal/combine_signals")) {
+		// Two signals with different samplerates and a time offset, so
+		// that most values must be interpolated.
+		auto signal1 = create_signal(device, "combine_signals_1",
+			data::Quantity::Voltage, data::Unit::Volt);
+		auto signal2 = create_signal(device, "combine_signals_2",
+			data::Quantity::Current, data::Unit::Ampere);
+		runner.reseed();
+		vector<double> samples1 =
+			runner.synthetic_samples(bench_sample_count, 10.);
+		vector<double> samples2 =
+			runner.synthetic_samples(bench_sample_count, 1.);
+		push_samples(signal1, samples1, start_timestamp, bench_samplerate);
+		push_samples(signal2, samples2, start_timestamp + 0.0005,
+			bench_samplerate * 7 / 10);
+
+		shared_ptr<vector<double>> time_vector;
+		shared_ptr<vector<double>> data1_vector;
+		shared_ptr<vector<double>> data2_vector;
+		runner.run("signal/combine_signals",
+			[&]() {
+				time_vector = make_shared<vector<double>>();
+				data1_vector = make_shared<vector<double>>();
+				data2_vector = make_shared<vector<double>>();
+			},
+			[&]() {
+				size_t signal1_pos = 0;
+				size_t signal2_pos = 0;
+				data::AnalogTimeSignal::combine_signals(
+					signal1, signal1_pos, signal2, signal2_pos,
+					time_vector, data1_vector, data2_vector);
+				return (uint64_t)time_vector->size();
+			});
+	}
+}
+
+} // namespace bench
+} // namespace sv
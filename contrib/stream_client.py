@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+##
+## This file is part of the SmuView project.
+##
+## Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+##
+## This program is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## This program is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+"""
+Minimal client for the SmuView stream server (smuview --stream-server).
+
+Usage:
+  stream_client.py <port|socket path> [path ...]
+
+Without a path all signals are subscribed. A path is
+"<device id>/<channel name>/<signal name>", the channel and signal name
+can be omitted.
+"""
+
+import socket
+import struct
+import sys
+
+FRAME_SIGNAL_INFO = 1
+FRAME_SAMPLES = 2
+FRAME_DROPPED = 3
+FRAME_ERROR = 4
+
+
+def connect(address):
+    if address.isdigit():
+        return socket.create_connection(("127.0.0.1", int(address)))
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(address)
+    return sock
+
+
+def read_exactly(sock, size):
+    data = b""
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("Connection closed by SmuView")
+        data += chunk
+    return data
+
+
+def read_string(payload, offset):
+    (length,) = struct.unpack_from("<H", payload, offset)
+    offset += 2
+    return payload[offset:offset + length].decode("utf-8"), offset + length
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+
+    sock = connect(sys.argv[1])
+    for path in sys.argv[2:] or ["*"]:
+        sock.sendall("SUBSCRIBE {}\n".format(path).encode("utf-8"))
+
+    streams = {}
+    while True:
+        length, frame_type = struct.unpack("<IB", read_exactly(sock, 5))
+        payload = read_exactly(sock, length)
+        if frame_type == FRAME_SIGNAL_INFO:
+            (stream_id,) = struct.unpack_from("<I", payload)
+            path, offset = read_string(payload, 4)
+            quantity, offset = read_string(payload, offset)
+            unit, offset = read_string(payload, offset)
+            streams[stream_id] = (path, unit)
+            print("# {}: {} ({}) [{}]".format(stream_id, path, quantity, unit))
+        elif frame_type == FRAME_SAMPLES:
+            stream_id, count = struct.unpack_from("<II", payload)
+            path, unit = streams.get(stream_id, (str(stream_id), ""))
+            for i in range(count):
+                timestamp, value = struct.unpack_from("<dd", payload, 8 + 16 * i)
+                print("{:.6f}\t{}\t{} {}".format(timestamp, path, value, unit))
+        elif frame_type == FRAME_DROPPED:
+            (dropped,) = struct.unpack_from("<Q", payload)
+            print("# {} samples dropped".format(dropped), file=sys.stderr)
+        elif frame_type == FRAME_ERROR:
+            message, _ = read_string(payload, 0)
+            print("# Error: {}".format(message), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        pass
@@ -18,11 +18,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <getopt.h>
 #include <unistd.h>
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
+#include <QCoreApplication>
 #include <QDateTime>
 #include <QDebug>
 #include <QSettings>
@@ -32,6 +36,9 @@
 #include "src/devicemanager.hpp"
 #include "src/session.hpp"
 #include "src/mainwindow.hpp"
+#include "src/tracer.hpp"
+#include "src/devices/hardwaredevice.hpp"
+#include "src/python/smuscriptrunner.hpp"
 
 #ifdef ENABLE_SIGNALS
 #include "signalhandler.hpp"
@@ -46,6 +53,7 @@ Q_IMPORT_PLUGIN(QSvgPlugin)
 using std::exception;
 using std::shared_ptr;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 void usage()
@@ -63,9 +71,14 @@ void usage()
 		"  -d, --driver               Specify the device driver(s) to use\n"
 		"  -D, --dont-scan            Don't auto-scan for devices, use -d spec only\n"
 		"  -s, --script               Specify the SmuScript to load and execute\n"
-		/* Disable cmd line options i, I and c
+		"  -H, --headless             Run without GUI (e.g. for logging with a SmuScript)\n"
+		"  -S, --stream-server        Stream the samples to local clients (TCP port or socket name)\n"
+		"  -C, --scpi-server          Serve SCPI commands to local clients (TCP port or socket name)\n"
+		"  -T, --trace                Trace the hot paths and write a Chrome trace file on exit\n"
+		"  -J, --journal              Journal the session for crash recovery (max. size in MiB)\n"
 		"  -i, --input-file           Load input from file\n"
 		"  -I, --input-format         Input format\n"
+		/* Disable cmd line option c
 		"  -c, --clean                Don't restore previous session on startup\n"
 		*/
 		"\n"
@@ -76,8 +89,74 @@ void usage()
 		"\n"
 		"  %s --driver voltcraft-k204:conn=/dev/ttyUSB0 \\\n"
 		"     --driver uni-t-ut61d:conn=1a86.e008 \\\n"
-		"     --driver uni-t-ut61e-ser:conn=/dev/ttyUSB1\n",
-		SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME);
+		"     --driver uni-t-ut61e-ser:conn=/dev/ttyUSB1\n"
+		"\n"
+		"  %s --headless --driver uni-t-ut61e:conn=1a86.e008 \\\n"
+		"     --script /path/to/logging_script.py\n"
+		"\n"
+		"  %s --headless --driver uni-t-ut61e:conn=1a86.e008 \\\n"
+		"     --stream-server 5025\n",
+		SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME,
+		SV_BIN_NAME);
+}
+
+/**
+ * Run the session without the main window. The application quits when the
+ * script has finished, or on SIGINT/SIGTERM when no script is given.
+ */
+int run_headless(QCoreApplication &app, sv::DeviceManager &device_manager,
+	const string &script_file, const string &stream_address,
+	const string &scpi_address, uint64_t journal_max_size)
+{
+	sv::Session session(device_manager, nullptr);
+	session.set_journal_max_size(journal_max_size);
+	// There is no one to ask, so a crashed session is never recovered here.
+	session.init_journal(false);
+
+	for (const auto &device : device_manager.user_spec_devices())
+		session.add_device(device);
+
+	if (!stream_address.empty() && !session.start_stream_server(
+			QString::fromStdString(stream_address)))
+		return 1;
+	if (!scpi_address.empty() && !session.start_scpi_server(
+			QString::fromStdString(scpi_address)))
+		return 1;
+
+	bool script_failed = false;
+	if (!script_file.empty()) {
+		sv::python::SmuScriptRunner *runner =
+			session.smu_script_runner().get();
+		// The script runs in its own thread, quit from the main loop.
+		QObject::connect(runner, &sv::python::SmuScriptRunner::script_error,
+			&app, [&app, &script_failed, runner]() {
+				script_failed = true;
+				// The script couldn't be started at all.
+				if (!runner->is_running())
+					app.exit(1);
+			},
+			Qt::QueuedConnection);
+		QObject::connect(runner, &sv::python::SmuScriptRunner::script_finished,
+			&app, [&app, &script_failed]() { app.exit(script_failed ? 1 : 0); },
+			Qt::QueuedConnection);
+		runner->run(script_file);
+	}
+	else {
+		qWarning() << "Running headless without a script, stop with Ctrl+C.";
+	}
+
+#ifdef ENABLE_SIGNALS
+	if (SignalHandler::prepare_signals()) {
+		SignalHandler *const handler = new SignalHandler(&app);
+		QObject::connect(handler, SIGNAL(int_received()), &app, SLOT(quit()));
+		QObject::connect(handler, SIGNAL(term_received()), &app, SLOT(quit()));
+	}
+	else {
+		qWarning() << "Could not prepare signal handler.";
+	}
+#endif
+
+	return app.exec();
 }
 
 int main(int argc, char *argv[])
@@ -89,8 +168,22 @@ int main(int argc, char *argv[])
 	bool restore_session = true;
 	bool do_scan = true;
 	string script_file;
-
-	Application app(argc, argv);
+	string stream_address;
+	string scpi_address;
+	string trace_file;
+	uint64_t journal_max_size = 0;
+	bool headless = false;
+
+	// The application type must be known before the arguments are parsed.
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--headless") == 0 || strcmp(argv[i], "-H") == 0)
+			headless = true;
+	}
+	unique_ptr<QCoreApplication> app;
+	if (headless)
+		app.reset(new CoreApplication(argc, argv));
+	else
+		app.reset(new Application(argc, argv));
 
 	// Parse arguments
 	while (true) {
@@ -101,20 +194,25 @@ int main(int argc, char *argv[])
 			{ "driver", required_argument, nullptr, 'd' },
 			{ "dont-scan", no_argument, nullptr, 'D' },
 			{ "script", required_argument, nullptr, 's' },
-			/* Disable cmd line options i, I and c
+			{ "headless", no_argument, nullptr, 'H' },
+			{ "stream-server", required_argument, nullptr, 'S' },
+			{ "scpi-server", required_argument, nullptr, 'C' },
+			{ "trace", required_argument, nullptr, 'T' },
+			{ "journal", required_argument, nullptr, 'J' },
 			{ "input-file", required_argument, nullptr, 'i' },
 			{ "input-format", required_argument, nullptr, 'I' },
+			/* Disable cmd line option c
 			{ "clean", no_argument, nullptr, 'c' },
 			*/
 			{ nullptr, 0, nullptr, 0 }
 		};
 
-		/* Disable cmd line options i, I and c
+		/* Disable cmd line option c
 		const int c = getopt_long(argc, argv,
 			"l:Vhc?d:i:I:", long_options, nullptr);
 		*/
 		const int c = getopt_long(argc, argv,
-			"h?VDl:d:s:", long_options, nullptr);
+			"h?VDHl:d:s:S:C:T:J:i:I:", long_options, nullptr);
 
 		if (c == -1)
 			break;
@@ -155,7 +253,33 @@ int main(int argc, char *argv[])
 			script_file = optarg;
 			break;
 
-		/* Disable cmd line options i, I and c
+		case 'H':
+			// Already handled before the application has been created.
+			break;
+
+		case 'S':
+			stream_address = optarg;
+			break;
+
+		case 'C':
+			scpi_address = optarg;
+			break;
+
+		case 'T':
+			trace_file = optarg;
+			break;
+
+		case 'J':
+		{
+			const long long max_size_mib = atoll(optarg);
+			if (max_size_mib <= 0) {
+				fprintf(stderr, "Invalid journal size: %s\n", optarg);
+				return 1;
+			}
+			journal_max_size = (uint64_t)max_size_mib * 1024 * 1024;
+			break;
+		}
+
 		case 'i':
 			open_file = optarg;
 			break;
@@ -164,6 +288,7 @@ int main(int argc, char *argv[])
 			open_file_format = optarg;
 			break;
 
+		/* Disable cmd line option c
 		case 'c':
 			restore_session = false;
 			break;
@@ -171,7 +296,7 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if (argc - optind > 1) {
+	if (argc - optind > 1 || (argc - optind == 1 && !open_file.empty())) {
 		fprintf(stderr, "Only one file can be opened.\n");
 		return 1;
 	}
@@ -183,6 +308,10 @@ int main(int argc, char *argv[])
 	context = sigrok::Context::create();
 	sv::Session::sr_context = context;
 
+	sv::Tracer::set_thread_name("Main");
+	if (!trace_file.empty())
+		sv::Tracer::start();
+
 	do {
 		try {
 			// Initialize global start timestamp
@@ -193,11 +322,18 @@ int main(int argc, char *argv[])
 			// Create the device manager, initialise the drivers
 			sv::DeviceManager device_manager(context, drivers, do_scan);
 
+			if (headless) {
+				ret = run_headless(*app, device_manager, script_file,
+					stream_address, scpi_address, journal_max_size);
+				break;
+			}
+
 			// TODO: Init session here!
 
 			// Initialise the main window
 			sv::MainWindow w(device_manager);
 			w.show();
+			w.session()->set_journal_max_size(journal_max_size);
 
 			if (restore_session)
 				w.restore_session();
@@ -210,6 +346,13 @@ int main(int argc, char *argv[])
 			if (!script_file.empty())
 				w.run_smu_script(script_file); // TODO: Call in Session not MainWindow
 
+			if (!stream_address.empty())
+				w.session()->start_stream_server(
+					QString::fromStdString(stream_address));
+			if (!scpi_address.empty())
+				w.session()->start_scpi_server(
+					QString::fromStdString(scpi_address));
+
 #ifdef ENABLE_SIGNALS
 			if (SignalHandler::prepare_signals()) {
 				SignalHandler *const handler =
@@ -227,7 +370,7 @@ int main(int argc, char *argv[])
 #endif
 
 			// Run the application
-			ret = app.exec();
+			ret = app->exec();
 		}
 		catch (exception &e) {
 			 qCritical() << "main() failed: " << e.what();
@@ -236,5 +379,10 @@ int main(int argc, char *argv[])
 	}
 	while (false);
 
+	if (!trace_file.empty()) {
+		sv::Tracer::stop();
+		sv::Tracer::write_json(trace_file);
+	}
+
 	return ret;
 }
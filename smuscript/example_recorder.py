@@ -0,0 +1,49 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+import smuview
+import time
+
+# Long term logging of a power supply, e.g. in headless mode:
+#   smuview --headless -s example_recorder.py
+# The samples are written to disk continuously, so nothing is lost when the
+# test is aborted. A new file is started every hour.
+
+# Connect device
+psu_dev = Session.connect_device("scpi-pps:conn=libgpib/hp6632b")[0]
+
+# Give the device the chance to create signals
+time.sleep(1)
+
+recorder = smuview.SignalRecorder("/tmp/psu_log", smuview.RecorderFormat.CSV)
+recorder.add_signal(psu_dev.channels()["V1"].actual_signal())
+recorder.add_signal(psu_dev.channels()["I1"].actual_signal())
+recorder.set_rotation_time(3600)
+recorder.set_sync_interval(5)
+recorder.start()
+
+# Record for 48 hours
+for i in range(48 * 60):
+    time.sleep(60)
+    print("%s: %d samples" % (recorder.file_name(), recorder.recorded_sample_count()))
+
+recorder.stop()
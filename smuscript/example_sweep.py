@@ -0,0 +1,64 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+import smuview
+
+# Same measurement as in example_characterize_psu.py, but using the native
+# sweep engine. Instead of sleeping a fixed time after every step, the engine
+# waits until all signals have settled.
+
+# Connect all devices
+load_dev = Session.connect_device("arachnid-labs-re-load-pro:conn=/dev/ttyUSB2")[0]
+load_conf = load_dev.configurables()["1"]
+psu_dev = Session.connect_device("scpi-pps:conn=libgpib/hp6632b")[0]
+psu_conf = psu_dev.configurables()["1"]
+
+# Init device settings
+load_conf.set_config(smuview.ConfigKey.CurrentLimit, .0)
+psu_conf.set_config(smuview.ConfigKey.VoltageTarget, 10.0)
+psu_conf.set_config(smuview.ConfigKey.CurrentLimit, 2.000)
+psu_conf.set_config(smuview.ConfigKey.Enabled, True)
+
+# Add user device for the results
+user_dev = Session.add_user_device()
+UiProxy.add_device_tab(user_dev)
+
+# Sweep the load current from 0 A to 2 A in 5 mA steps. A step has settled,
+# when all samples within 300 ms are inside a band of 1 mV/1 mA + 0.1 %.
+sweep = smuview.SweepEngine(load_conf, smuview.ConfigKey.CurrentLimit, user_dev)
+sweep.add_signal(psu_dev.channels()["V1"].actual_signal())
+sweep.add_signal(psu_dev.channels()["I1"].actual_signal())
+sweep.add_signal(load_dev.channels()["V"].actual_signal())
+sweep.add_signal(load_dev.channels()["I"].actual_signal())
+sweep.set_range(0.0, 2.0, 0.005)
+sweep.set_settling(0.001, 0.001, 0.3, 5.0)
+sweep.start()
+sweep.wait()
+
+# Show the input voltage over the load current
+results = sweep.result_channels()
+UiProxy.add_plot_view(user_dev.id(), smuview.DockArea.TopDockArea,
+    results[0].actual_signal(), results[1].actual_signal())
+
+# Set values to a save state
+load_conf.set_config(smuview.ConfigKey.CurrentLimit, .0)
+psu_conf.set_config(smuview.ConfigKey.Enabled, False)
@@ -27,13 +27,22 @@ using std::cerr;
 using std::endl;
 using std::exception;
 
+namespace {
+
+void init_application()
+{
+	QCoreApplication::setApplicationVersion(SV_VERSION_STRING);
+	QCoreApplication::setApplicationName("SmuView");
+	QCoreApplication::setOrganizationName("sigrok");
+	QCoreApplication::setOrganizationDomain("sigrok.org");
+}
+
+} // namespace
+
 Application::Application(int &argc, char *argv[]) :
 	QApplication(argc, argv)
 {
-	setApplicationVersion(SV_VERSION_STRING);
-	setApplicationName("SmuView");
-	setOrganizationName("sigrok");
-	setOrganizationDomain("sigrok.org");
+	init_application();
 }
 
 bool Application::notify(QObject *receiver, QEvent *event)
@@ -47,3 +56,21 @@ bool Application::notify(QObject *receiver, QEvent *event)
 		return false;
 	}
 }
+
+CoreApplication::CoreApplication(int &argc, char *argv[]) :
+	QCoreApplication(argc, argv)
+{
+	init_application();
+}
+
+bool CoreApplication::notify(QObject *receiver, QEvent *event)
+{
+	try {
+		return QCoreApplication::notify(receiver, event);
+	}
+	catch (exception &e) {
+		cerr << "Caught exception: " << e.what() << endl;
+		exit(1);
+		return false;
+	}
+}
@@ -22,6 +22,7 @@
 #define SV_APPLICATION_HPP
 
 #include <QApplication>
+#include <QCoreApplication>
 
 class Application : public QApplication
 {
@@ -34,4 +35,19 @@ private:
 
 };
 
+/**
+ * The application for the headless mode, without the Qt widget stack and
+ * without a connection to a display server.
+ */
+class CoreApplication : public QCoreApplication
+{
+
+public:
+	CoreApplication(int &argc, char *argv[]);
+
+private:
+	bool notify(QObject *receiver, QEvent *event);
+
+};
+
 #endif // SV_APPLICATION_HPP
@@ -25,6 +25,7 @@
 #include <QDebug>
 
 #include "addscchannel.hpp"
+#include "src/tracer.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/mathchannel.hpp"
 #include "src/data/analogtimesignal.hpp"
@@ -65,6 +66,8 @@ AddSCChannel::AddSCChannel(
 
 void AddSCChannel::on_sample_appended()
 {
+	SV_TRACE_SCOPE("math", "AddSCChannel");
+
 	size_t signal_sample_count = signal_->sample_count();
 	while (next_signal_pos_ < signal_sample_count) {
 		auto sample = signal_->get_sample(next_signal_pos_, false);
@@ -26,6 +26,7 @@
 #include <QDebug>
 
 #include "dividechannel.hpp"
+#include "src/tracer.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/mathchannel.hpp"
 #include "src/data/analogtimesignal.hpp"
@@ -80,6 +81,8 @@ DivideChannel::DivideChannel(
 
 void DivideChannel::on_sample_appended()
 {
+	SV_TRACE_SCOPE("math", "DivideChannel");
+
 	lock_guard<mutex> lock(sample_append_mutex_);
 
 	shared_ptr<vector<double>> time = make_shared<vector<double>>();
@@ -0,0 +1,136 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <QDebug>
+
+#include "energychannel.hpp"
+#include "src/tracer.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/energyaccumulator.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::make_shared;
+using std::set;
+using std::static_pointer_cast;
+using std::string;
+using std::weak_ptr;
+
+namespace sv {
+namespace channels {
+
+EnergyChannel::EnergyChannel(
+		data::Quantity quantity,
+		shared_ptr<data::EnergyAccumulator> energy_accumulator,
+		shared_ptr<devices::BaseDevice> parent_device,
+		set<string> channel_group_names,
+		string channel_name,
+		double channel_start_timestamp) :
+	MathChannel(quantity, set<data::QuantityFlag>(),
+		quantity == data::Quantity::Work ?
+			data::Unit::WattHour : data::Unit::AmpereHour,
+		parent_device, channel_group_names,
+		channel_name, channel_start_timestamp),
+	energy_accumulator_(energy_accumulator)
+{
+	assert(energy_accumulator_);
+	assert(quantity == data::Quantity::Work ||
+		quantity == data::Quantity::ElectricCharge);
+
+	auto voltage_signal = energy_accumulator_->voltage_signal();
+	auto current_signal = energy_accumulator_->current_signal();
+
+	if (voltage_signal->digits() >= current_signal->digits())
+		digits_ = voltage_signal->digits();
+	else
+		digits_ = current_signal->digits();
+
+	if (voltage_signal->decimal_places() >= current_signal->decimal_places())
+		decimal_places_ = voltage_signal->decimal_places();
+	else
+		decimal_places_ = current_signal->decimal_places();
+}
+
+void EnergyChannel::init_signals()
+{
+	actual_signal_ = static_pointer_cast<data::AnalogTimeSignal>(
+		add_signal(quantity_, quantity_flags_, unit_));
+
+	// The Wh channel has a fixed (primary) signal, but also provides the
+	// min/max/mean power as signals.
+	if (quantity_ == data::Quantity::Work) {
+		bool fixed_signal = fixed_signal_;
+		fixed_signal_ = false;
+		power_min_signal_ = static_pointer_cast<data::AnalogTimeSignal>(
+			add_signal(data::Quantity::Power, { data::QuantityFlag::Min },
+				data::Unit::Watt));
+		power_max_signal_ = static_pointer_cast<data::AnalogTimeSignal>(
+			add_signal(data::Quantity::Power, { data::QuantityFlag::Max },
+				data::Unit::Watt));
+		power_mean_signal_ = static_pointer_cast<data::AnalogTimeSignal>(
+			add_signal(data::Quantity::Power, { data::QuantityFlag::Avg },
+				data::Unit::Watt));
+		fixed_signal_ = fixed_signal;
+	}
+
+	// The samples are pushed in the thread that accumulates them. The
+	// channel is locked for the time of the call, like the accumulator.
+	weak_ptr<BaseChannel> weak_this = shared_from_this();
+	connect(energy_accumulator_.get(),
+		&data::EnergyAccumulator::sample_accumulated, this,
+		[weak_this](double timestamp, double amp_hours, double watt_hours,
+				double power_min, double power_max, double power_mean) {
+			auto channel =
+				static_pointer_cast<EnergyChannel>(weak_this.lock());
+			if (channel)
+				channel->on_sample_accumulated(timestamp, amp_hours,
+					watt_hours, power_min, power_max, power_mean);
+		},
+		Qt::DirectConnection);
+}
+
+shared_ptr<data::EnergyAccumulator> EnergyChannel::energy_accumulator() const
+{
+	return energy_accumulator_;
+}
+
+void EnergyChannel::on_sample_accumulated(double timestamp, double amp_hours,
+	double watt_hours, double power_min, double power_max, double power_mean)
+{
+	SV_TRACE_SCOPE("math", "EnergyChannel");
+
+	if (quantity_ == data::Quantity::ElectricCharge) {
+		push_sample(amp_hours, timestamp);
+		return;
+	}
+
+	push_sample(watt_hours, timestamp);
+	push_sample(power_min_signal_, power_min, timestamp);
+	push_sample(power_max_signal_, power_max, timestamp);
+	push_sample(power_mean_signal_, power_mean, timestamp);
+}
+
+} // namespace channels
+} // namespace sv
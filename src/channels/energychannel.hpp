@@ -0,0 +1,88 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_ENERGYCHANNEL_HPP
+#define CHANNELS_ENERGYCHANNEL_HPP
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include <QObject>
+
+#include "src/channels/mathchannel.hpp"
+#include "src/data/datautil.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+class EnergyAccumulator;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace channels {
+
+/**
+ * The EnergyChannel provides the values of an EnergyAccumulator, that can be
+ * shared between several channels. A Wh channel (quantity Work) has the
+ * energy as primary signal and also provides the min/max/mean power, an Ah
+ * channel (quantity ElectricCharge) provides the charge.
+ */
+class EnergyChannel : public MathChannel
+{
+	Q_OBJECT
+
+public:
+	EnergyChannel(
+		data::Quantity quantity,
+		shared_ptr<data::EnergyAccumulator> energy_accumulator,
+		shared_ptr<devices::BaseDevice> parent_device,
+		set<string> channel_group_names,
+		string channel_name,
+		double channel_start_timestamp);
+
+	void init_signals() override;
+
+	shared_ptr<data::EnergyAccumulator> energy_accumulator() const;
+
+private:
+	shared_ptr<data::EnergyAccumulator> energy_accumulator_;
+	shared_ptr<data::AnalogTimeSignal> power_min_signal_;
+	shared_ptr<data::AnalogTimeSignal> power_max_signal_;
+	shared_ptr<data::AnalogTimeSignal> power_mean_signal_;
+
+private Q_SLOTS:
+	void on_sample_accumulated(double timestamp, double amp_hours,
+		double watt_hours, double power_min, double power_max,
+		double power_mean);
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_ENERGYCHANNEL_HPP
@@ -63,8 +63,6 @@ void HardwareChannel::push_interleaved_samples(const float *data,
 	size_t sample_count, size_t stride, double timestamp, uint64_t samplerate,
 	shared_ptr<sigrok::Analog> sr_analog)
 {
-	//lock_guard<recursive_mutex> lock(mutex_);
-
 	/*
 	 * NOTE: Sometimes the mq is not set (e.g. for the demo driver in
 	 *       sigrok 6.0.0) and mq() just throws an exception, without a
@@ -79,6 +77,30 @@ void HardwareChannel::push_interleaved_samples(const float *data,
 	}
 	set<data::QuantityFlag> quantity_flags =
 		data::datautil::get_quantity_flags(sr_analog->mq_flags());
+	data::Unit unit = data::datautil::get_unit(sr_analog->unit());
+
+	/*
+	 * Number of significant digits after the decimal point if positive, or
+	 * number of non-significant digits before the decimal point if negative
+	 * (refers to the value we actually read on the wire).
+	 */
+	int digits = 7;
+	int decimal_places = -1;
+	if (sr_analog->digits() >= 0)
+		decimal_places = sr_analog->digits();
+	else
+		digits = -1 * sr_analog->digits(); // TODO
+
+	push_interleaved_samples(data, sample_count, stride, timestamp,
+		samplerate, quantity, quantity_flags, unit, digits, decimal_places);
+}
+
+void HardwareChannel::push_interleaved_samples(const float *data,
+	size_t sample_count, size_t stride, double timestamp, uint64_t samplerate,
+	data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
+	data::Unit unit, int digits, int decimal_places)
+{
+	//lock_guard<recursive_mutex> lock(mutex_);
 
 	if (!actual_signal_ || actual_signal_->quantity() != quantity ||
 		actual_signal_->quantity_flags() != quantity_flags) {
@@ -87,9 +109,8 @@ void HardwareChannel::push_interleaved_samples(const float *data,
 		measured_quantity_t mq = make_pair(quantity, quantity_flags);
 		size_t signals_count = signal_map_.count(mq);
 		if (signals_count == 0) {
-			data::Unit unit = data::datautil::get_unit(sr_analog->unit());
 			add_signal(quantity, quantity_flags, unit);
-			qWarning() << "HardwareChannel::push_sample_sr_analog(): " <<
+			qWarning() << "HardwareChannel::push_interleaved_samples(): " <<
 				display_name() << " - No signal found: " <<
 				actual_signal_->display_name();
 		}
@@ -101,18 +122,6 @@ void HardwareChannel::push_interleaved_samples(const float *data,
 		Q_EMIT signal_changed(actual_signal_);
 	}
 
-	/*
-	 * Number of significant digits after the decimal point if positive, or
-	 * number of non-significant digits before the decimal point if negative
-	 * (refers to the value we actually read on the wire).
-	 */
-	int digits = 7;
-	int decimal_places = -1;
-	if (sr_analog->digits() >= 0)
-		decimal_places = sr_analog->digits();
-	else
-		digits = -1 * sr_analog->digits(); // TODO
-
 	// Deinterleave the samples and add them
 	unique_ptr<float[]> deint_data(new float[sample_count]);
 	float *deint_data_ptr = deint_data.get();
@@ -122,9 +131,10 @@ void HardwareChannel::push_interleaved_samples(const float *data,
 		data += stride;
 	}
 
+	// The deinterleaved samples are always floats
 	static_pointer_cast<data::AnalogTimeSignal>(actual_signal_)->push_samples(
 		deint_data.get(), sample_count, timestamp, samplerate,
-		sr_analog->unitsize(), digits, decimal_places);
+		sizeof(float), digits, decimal_places);
 }
 
 } // namespace channels
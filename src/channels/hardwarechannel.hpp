@@ -27,6 +27,7 @@
 #include <QObject>
 
 #include "src/channels/basechannel.hpp"
+#include "src/data/datautil.hpp"
 
 using std::set;
 using std::shared_ptr;
@@ -68,6 +69,16 @@ public:
 		size_t stride, double timestamp, uint64_t samplerate,
 		shared_ptr<sigrok::Analog> sr_analog);
 
+	/**
+	 * Add one or more interleaved samples with timestamps to the channel.
+	 * The meaning of the samples is given explicitly, e.g. for samples
+	 * from a recording.
+	 */
+	void push_interleaved_samples(const float *data, size_t sample_count,
+		size_t stride, double timestamp, uint64_t samplerate,
+		data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
+		data::Unit unit, int digits, int decimal_places);
+
 };
 
 } // namespace channels
@@ -25,6 +25,7 @@
 #include <QDebug>
 
 #include "integratechannel.hpp"
+#include "src/tracer.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/mathchannel.hpp"
 #include "src/data/analogtimesignal.hpp"
@@ -74,6 +75,8 @@ void IntegrateChannel::on_channel_start_timestamp_changed(double timestamp)
 
 void IntegrateChannel::on_sample_appended()
 {
+	SV_TRACE_SCOPE("math", "IntegrateChannel");
+
 	// Integrate
 	size_t int_signal_sample_count = int_signal_->sample_count();
 	while (next_int_signal_pos_ < int_signal_sample_count) {
@@ -93,9 +93,20 @@ data::Unit MathChannel::unit()
 	return unit_;
 }
 
+void MathChannel::init_signals()
+{
+	add_signal(quantity_, quantity_flags_, unit_);
+}
+
 void MathChannel::push_sample(double sample, double timestamp)
 {
 	auto signal = static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
+	push_sample(signal, sample, timestamp);
+}
+
+void MathChannel::push_sample(shared_ptr<data::AnalogTimeSignal> signal,
+	double sample, double timestamp)
+{
 	signal->push_sample(&sample, timestamp,
 		size_of_double_, digits_, decimal_places_);
 }
@@ -38,6 +38,7 @@ using std::vector;
 namespace sv {
 
 namespace data {
+class AnalogTimeSignal;
 class BaseSignal;
 }
 
@@ -79,11 +80,24 @@ public:
 	 */
 	data::Unit unit();
 
+	/**
+	 * Add the signals of the math channel. The default implementation adds
+	 * a single signal with the quantity, quantity flags and unit of the
+	 * channel. Is called by BaseDevice::add_math_channel(), because the
+	 * signals need shared_from_this(), which is not available in the ctor.
+	 */
+	virtual void init_signals();
+
 protected:
 	/**
 	 * Add a single sample with timestamp to the channel/signal
 	 */
 	void push_sample(double sample, double timestamp);
+	/**
+	 * Add a single sample with timestamp to the given signal of the channel
+	 */
+	void push_sample(shared_ptr<data::AnalogTimeSignal> signal,
+		double sample, double timestamp);
 
 	int digits_;
 	int decimal_places_;
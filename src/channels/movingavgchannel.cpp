@@ -25,6 +25,7 @@
 #include <QDebug>
 
 #include "movingavgchannel.hpp"
+#include "src/tracer.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/mathchannel.hpp"
 #include "src/data/analogtimesignal.hpp"
@@ -70,6 +71,8 @@ MovingAvgChannel::MovingAvgChannel(
 
 void MovingAvgChannel::on_sample_appended()
 {
+	SV_TRACE_SCOPE("math", "MovingAvgChannel");
+
 	size_t signal_sample_count = signal_->sample_count();
 	while (next_signal_pos_ < signal_sample_count) {
 		auto sample = signal_->get_sample(next_signal_pos_, false);
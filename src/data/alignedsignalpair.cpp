@@ -0,0 +1,225 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "alignedsignalpair.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::lock_guard;
+using std::make_pair;
+using std::make_shared;
+using std::map;
+using std::mutex;
+using std::pair;
+using std::shared_ptr;
+using std::vector;
+using std::weak_ptr;
+
+namespace sv {
+namespace data {
+
+mutex AlignedSignalPair::registry_mutex_;
+map<pair<AnalogTimeSignal *, AnalogTimeSignal *>, weak_ptr<AlignedSignalPair>>
+	AlignedSignalPair::registry_;
+
+shared_ptr<AlignedSignalPair> AlignedSignalPair::get(
+	shared_ptr<AnalogTimeSignal> signal1, shared_ptr<AnalogTimeSignal> signal2)
+{
+	lock_guard<mutex> lock(registry_mutex_);
+
+	// Remove the views of the pairs, that are no longer used.
+	for (auto it = registry_.begin(); it != registry_.end(); ) {
+		if (it->second.expired())
+			it = registry_.erase(it);
+		else
+			++it;
+	}
+
+	auto key = make_pair(signal1.get(), signal2.get());
+	auto it = registry_.find(key);
+	if (it != registry_.end())
+		return it->second.lock();
+
+	auto signal_pair = make_shared<AlignedSignalPair>(signal1, signal2);
+	registry_.insert(make_pair(key, signal_pair));
+	return signal_pair;
+}
+
+AlignedSignalPair::AlignedSignalPair(shared_ptr<AnalogTimeSignal> signal1,
+		shared_ptr<AnalogTimeSignal> signal2) :
+	signal1_(signal1),
+	signal2_(signal2),
+	signal1_pos_(0),
+	signal2_pos_(0)
+{
+	update();
+}
+
+void AlignedSignalPair::reset()
+{
+	signal1_pos_ = 0;
+	signal2_pos_ = 0;
+	entries_.clear();
+}
+
+void AlignedSignalPair::update()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	// The signals have been cleared.
+	if (signal1_->sample_count() < signal1_pos_ ||
+			signal2_->sample_count() < signal2_pos_)
+		reset();
+
+	// Ignore the first sample(s), like AnalogTimeSignal::combine_signals().
+	if (signal1_pos_ == 0 && signal2_pos_ == 0) {
+		if (signal1_->sample_count() == 0 || signal2_->sample_count() == 0)
+			return;
+
+		double signal1_ts = signal1_->get_sample(0, false).first;
+		double signal2_ts = signal2_->get_sample(0, false).first;
+		if (signal1_ts < signal2_ts) {
+			signal1_pos_ = signal1_->get_index_at_timestamp(signal2_ts, false);
+		}
+		else if (signal1_ts > signal2_ts) {
+			signal2_pos_ = signal2_->get_index_at_timestamp(signal1_ts, false);
+		}
+	}
+
+	while (signal1_pos_ < signal1_->sample_count() &&
+			signal2_pos_ < signal2_->sample_count()) {
+		const double signal1_ts = signal1_->get_sample(signal1_pos_, false).first;
+		const double signal2_ts = signal2_->get_sample(signal2_pos_, false).first;
+
+		Entry entry;
+		if (signal1_ts == signal2_ts) {
+			entry.pos1 = (uint32_t)signal1_pos_;
+			entry.pos2 = (uint32_t)signal2_pos_;
+			entry.source = Source::Both;
+			++signal1_pos_;
+			++signal2_pos_;
+		}
+		else if (signal1_ts < signal2_ts &&
+				signal2_->sample_count() > signal2_pos_ + 1) {
+			// signal2 is interpolated at the timestamp of signal1.
+			const size_t upper_pos =
+				signal2_->get_index_at_timestamp(signal1_ts, false);
+			if (upper_pos == 0)
+				return;
+			entry.pos1 = (uint32_t)signal1_pos_;
+			entry.pos2 = (uint32_t)(upper_pos - 1);
+			entry.source = Source::Signal1;
+			++signal1_pos_;
+		}
+		else if (signal1_ts > signal2_ts &&
+				signal1_->sample_count() > signal1_pos_ + 1) {
+			// signal1 is interpolated at the timestamp of signal2.
+			const size_t upper_pos =
+				signal1_->get_index_at_timestamp(signal2_ts, false);
+			if (upper_pos == 0)
+				return;
+			entry.pos1 = (uint32_t)(upper_pos - 1);
+			entry.pos2 = (uint32_t)signal2_pos_;
+			entry.source = Source::Signal2;
+			++signal2_pos_;
+		}
+		else {
+			return;
+		}
+		entries_.push_back(entry);
+	}
+}
+
+size_t AlignedSignalPair::size() const
+{
+	return entries_.size();
+}
+
+bool AlignedSignalPair::get_sample(size_t pos, double &time,
+	double &value1, double &value2) const
+{
+	if (pos >= entries_.size())
+		return false;
+
+	const Entry &entry = entries_[pos];
+	switch (entry.source) {
+	case Source::Both:
+	{
+		auto sample1 = signal1_->get_sample(entry.pos1, false);
+		time = sample1.first;
+		value1 = sample1.second;
+		value2 = signal2_->get_sample(entry.pos2, false).second;
+		return true;
+	}
+	case Source::Signal1:
+	{
+		auto sample1 = signal1_->get_sample(entry.pos1, false);
+		time = sample1.first;
+		value1 = sample1.second;
+		return interpolate(signal2_, entry.pos2, time, value2);
+	}
+	case Source::Signal2:
+	{
+		auto sample2 = signal2_->get_sample(entry.pos2, false);
+		time = sample2.first;
+		value2 = sample2.second;
+		return interpolate(signal1_, entry.pos1, time, value1);
+	}
+	default:
+		return false;
+	}
+}
+
+bool AlignedSignalPair::interpolate(shared_ptr<AnalogTimeSignal> signal,
+	size_t lower_pos, double time, double &value)
+{
+	if (lower_pos + 1 >= signal->sample_count())
+		return false;
+
+	auto lower = signal->get_sample(lower_pos, false);
+	auto upper = signal->get_sample(lower_pos + 1, false);
+	if (upper.first == lower.first) {
+		value = lower.second;
+		return true;
+	}
+
+	// Same linear interpolation as AnalogTimeSignal::get_value_at_timestamp()
+	const double ts_factor = (time - lower.first) / (upper.first - lower.first);
+	value = lower.second + (upper.second - lower.second) * ts_factor;
+	return true;
+}
+
+shared_ptr<AnalogTimeSignal> AlignedSignalPair::signal1() const
+{
+	return signal1_;
+}
+
+shared_ptr<AnalogTimeSignal> AlignedSignalPair::signal2() const
+{
+	return signal2_;
+}
+
+} // namespace data
+} // namespace sv
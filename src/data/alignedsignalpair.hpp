@@ -0,0 +1,121 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_ALIGNEDSIGNALPAIR_HPP
+#define DATA_ALIGNEDSIGNALPAIR_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using std::map;
+using std::mutex;
+using std::pair;
+using std::shared_ptr;
+using std::vector;
+using std::weak_ptr;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Time aligned view on two AnalogTimeSignals (e.g. for XY plots). The values
+ * are not copied, only the positions of the matching samples in the two
+ * signals are stored. When only one signal has a sample at a timestamp,
+ * the value of the other signal is interpolated on access.
+ *
+ * All consumers of the same signal pair share one instance, see get().
+ */
+class AlignedSignalPair
+{
+
+public:
+	/**
+	 * Return the shared aligned view for the two signals. It is created on
+	 * first use and freed when the last consumer is gone.
+	 */
+	static shared_ptr<AlignedSignalPair> get(
+		shared_ptr<AnalogTimeSignal> signal1,
+		shared_ptr<AnalogTimeSignal> signal2);
+
+	AlignedSignalPair(shared_ptr<AnalogTimeSignal> signal1,
+		shared_ptr<AnalogTimeSignal> signal2);
+
+	/** Align the samples that have been added to the signals. */
+	void update();
+
+	/** Number of aligned samples. */
+	size_t size() const;
+
+	/**
+	 * Get the aligned sample at the given position.
+	 *
+	 * @return false if the position is out of range.
+	 */
+	bool get_sample(size_t pos, double &time,
+		double &value1, double &value2) const;
+
+	shared_ptr<AnalogTimeSignal> signal1() const;
+	shared_ptr<AnalogTimeSignal> signal2() const;
+
+private:
+	/** Which signal has a sample at the timestamp of an aligned sample. */
+	enum class Source : uint8_t {
+		Both,
+		Signal1,
+		Signal2
+	};
+
+	/**
+	 * Position of an aligned sample in both signals. For an interpolated
+	 * signal, it is the position of the sample right before the timestamp.
+	 * 32 bit positions keep the index at 12 bytes per aligned sample.
+	 */
+	struct Entry {
+		uint32_t pos1;
+		uint32_t pos2;
+		Source source;
+	};
+
+	void reset();
+	static bool interpolate(shared_ptr<AnalogTimeSignal> signal,
+		size_t lower_pos, double time, double &value);
+
+	shared_ptr<AnalogTimeSignal> signal1_;
+	shared_ptr<AnalogTimeSignal> signal2_;
+	size_t signal1_pos_;
+	size_t signal2_pos_;
+	vector<Entry> entries_;
+	mutable mutex mutex_;
+
+	static mutex registry_mutex_;
+	static map<pair<AnalogTimeSignal *, AnalogTimeSignal *>,
+		weak_ptr<AlignedSignalPair>> registry_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_ALIGNEDSIGNALPAIR_HPP
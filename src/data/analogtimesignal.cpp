@@ -26,6 +26,7 @@
 #include <QString>
 
 #include "analogtimesignal.hpp"
+#include "src/tracer.hpp"
 #include "src/util.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/basesignal.hpp"
@@ -48,7 +49,8 @@ AnalogTimeSignal::AnalogTimeSignal(
 		double signal_start_timestamp) :
 	AnalogBaseSignal(quantity, quantity_flags, unit, parent_channel),
 	signal_start_timestamp_(signal_start_timestamp),
-	last_timestamp_(0.)
+	last_timestamp_(0.),
+	memory_size_(0)
 {
 	qWarning() << "Init analog time signal " << display_name()
 		<< ", signal_start_timestamp_ = "
@@ -62,7 +64,9 @@ void AnalogTimeSignal::clear()
 	// TODO: mutex
 	time_->clear();
 	data_->clear();
+	min_max_tree_.clear();
 	sample_count_ = 0;
+	update_memory_size();
 
 	Q_EMIT samples_cleared();
 }
@@ -105,19 +109,20 @@ bool AnalogTimeSignal::get_value_at_timestamp(
 {
 	if (time_->size() == 0)
 		return false;
+
+	if (relative_time)
+		timestamp += signal_start_timestamp_;
+
 	if (timestamp < time_->at(0))
 		return false;
 	if (timestamp > time_->back())
 		return false;
 
-	if (relative_time)
-		timestamp += signal_start_timestamp_;
-
 	auto lower = std::lower_bound(time_->begin(), time_->end(), timestamp);
 
 	// Check if timestamp and found timestamp match
 	if (timestamp == *lower) {
-		value = *lower;
+		value = data_->at(lower - time_->begin());
 		return true;
 	}
 
@@ -141,9 +146,39 @@ bool AnalogTimeSignal::get_value_at_timestamp(
 	return true;
 }
 
+size_t AnalogTimeSignal::get_index_at_timestamp(
+	double timestamp, bool relative_time) const
+{
+	if (relative_time)
+		timestamp += signal_start_timestamp_;
+
+	// Only search the samples that are complete (time and data).
+	auto end = time_->begin() + sample_count_;
+	return std::lower_bound(time_->begin(), end, timestamp) - time_->begin();
+}
+
+bool AnalogTimeSignal::get_min_max(double start_timestamp,
+	double end_timestamp, double &min, double &max, bool relative_time) const
+{
+	const size_t first = get_index_at_timestamp(start_timestamp, relative_time);
+	size_t last = get_index_at_timestamp(end_timestamp, relative_time);
+	if (last >= sample_count_ ||
+			get_sample(last, relative_time).first > end_timestamp) {
+		if (last == 0)
+			return false;
+		--last;
+	}
+	if (first > last)
+		return false;
+
+	return min_max_tree_.get_min_max(*data_, first, last, min, max);
+}
+
 void AnalogTimeSignal::push_sample(void *sample, double timestamp,
 	size_t unit_size, int digits, int decimal_places)
 {
+	SV_TRACE_SCOPE("signal", "push_sample");
+
 	double dsample = 0.;
 	if (unit_size == size_of_float_)
 		dsample = (double) *(float *)sample;
@@ -183,7 +218,9 @@ void AnalogTimeSignal::push_sample(void *sample, double timestamp,
 	// TODO: Mutex?
 	time_->push_back(timestamp);
 	data_->push_back(dsample);
+	min_max_tree_.append(dsample);
 	sample_count_++;
+	update_memory_size();
 	Q_EMIT sample_appended();
 
 	bool digits_chngd = false;
@@ -204,6 +241,7 @@ void AnalogTimeSignal::push_samples(void *data,
 	int digits, int decimal_places)
 {
 	//lock_guard<recursive_mutex> lock(mutex_);
+	SV_TRACE_SCOPE("signal", "push_samples");
 
 	double dsample;
 
@@ -248,6 +286,7 @@ void AnalogTimeSignal::push_samples(void *data,
 		// TODO: Limit memory!
 		time_->push_back(timestamp);
 		data_->push_back(dsample);
+		min_max_tree_.append(dsample);
 
 		timestamp += time_stride;
 		++pos;
@@ -256,6 +295,51 @@ void AnalogTimeSignal::push_samples(void *data,
 
 	last_timestamp_ = timestamp - time_stride;
 	last_value_ = dsample;
+	update_memory_size();
+	Q_EMIT sample_appended();
+
+	bool digits_chngd = false;
+	if (digits != digits_) {
+		digits_ = digits;
+		digits_chngd = true;
+	}
+	if (decimal_places != decimal_places_) {
+		decimal_places_ = decimal_places;
+		digits_chngd = true;
+	}
+	if (digits_chngd)
+		Q_EMIT digits_changed(digits_, decimal_places_);
+}
+
+void AnalogTimeSignal::push_samples(const double *timestamps,
+	const double *values, size_t count, int digits, int decimal_places)
+{
+	SV_TRACE_SCOPE("signal", "push_samples");
+
+	if (count == 0)
+		return;
+
+	for (size_t pos = 0; pos < count; ++pos) {
+		const double dsample = values[pos];
+		if (min_value_ > dsample)
+			min_value_ = dsample;
+		// Ignore infinitiy (overflow) as max value.
+		if (max_value_ < dsample &&
+			dsample != std::numeric_limits<double>::infinity()) {
+
+			max_value_ = dsample;
+		}
+		min_max_tree_.append(dsample);
+	}
+
+	// TODO: Mutex?
+	time_->insert(time_->end(), timestamps, timestamps + count);
+	data_->insert(data_->end(), values, values + count);
+	sample_count_ += count;
+
+	last_timestamp_ = timestamps[count - 1];
+	last_value_ = values[count - 1];
+	update_memory_size();
 	Q_EMIT sample_appended();
 
 	bool digits_chngd = false;
@@ -300,6 +384,18 @@ double AnalogTimeSignal::last_timestamp(bool relative_time) const
 	return last_timestamp_;
 }
 
+size_t AnalogTimeSignal::memory_size() const
+{
+	return memory_size_;
+}
+
+void AnalogTimeSignal::update_memory_size()
+{
+	// Only the capacities are read, this is cheap enough for every push.
+	memory_size_ = (time_->capacity() + data_->capacity()) * sizeof(double) +
+		min_max_tree_.memory_size();
+}
+
 void AnalogTimeSignal::on_channel_start_timestamp_changed(double timestamp)
 {
 	signal_start_timestamp_ = timestamp;
@@ -20,6 +20,7 @@
 #ifndef DATA_ANALOGTIMESIGNAL_HPP
 #define DATA_ANALOGTIMESIGNAL_HPP
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <utility>
@@ -29,6 +30,7 @@
 
 #include "src/data/analogbasesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/minmaxtree.hpp"
 
 using std::pair;
 using std::set;
@@ -83,6 +85,25 @@ public:
 	bool get_value_at_timestamp(
 		double timestamp, double &value, bool relative_time) const;
 
+	/**
+	 * Return the position of the first sample with a timestamp >= the given
+	 * timestamp, or the sample count if there is no such sample. The samples
+	 * are ordered by time, so this is a binary search.
+	 *
+	 * @param timestamp The timestamp to search for.
+	 * @param relative_time Use time relative to the session start time.
+	 */
+	size_t get_index_at_timestamp(double timestamp, bool relative_time) const;
+
+	/**
+	 * Return the min and max value of the samples between the two
+	 * timestamps. Non finite values are ignored.
+	 *
+	 * @return false if there are no (finite) samples in the time range.
+	 */
+	bool get_min_max(double start_timestamp, double end_timestamp,
+		double &min, double &max, bool relative_time) const;
+
 	/**
 	 * Push a single sample to the signal.
 	 *
@@ -97,10 +118,24 @@ public:
 	void push_samples(void *data, uint64_t samples, double timestamp,
 		uint64_t samplerate, size_t unit_size, int digits, int decimal_places);
 
+	/**
+	 * Push a block of samples with individual timestamps to the signal. The
+	 * timestamps must be ascending. This is used to append whole chunks of
+	 * imported data at once, so sample_appended() is only emitted once.
+	 */
+	void push_samples(const double *timestamps, const double *values,
+		size_t count, int digits, int decimal_places);
+
 	double signal_start_timestamp() const;
 	double first_timestamp(bool relative_time) const;
 	double last_timestamp(bool relative_time) const;
 
+	/**
+	 * Return the allocated memory of the samples in bytes. The size is
+	 * updated after each push, so it can be read from any thread.
+	 */
+	size_t memory_size() const;
+
 	static void combine_signals(
 		shared_ptr<AnalogTimeSignal> signal1, size_t &signal1_pos,
 		shared_ptr<AnalogTimeSignal> signal2, size_t &signal2_pos,
@@ -109,9 +144,13 @@ public:
 		shared_ptr<vector<double>> data2_vector);
 
 private:
+	void update_memory_size();
+
 	shared_ptr<vector<double>> time_;
+	MinMaxTree min_max_tree_;
 	double signal_start_timestamp_;
 	double last_timestamp_;
+	std::atomic<size_t> memory_size_;
 
 public Q_SLOTS:
 	void on_channel_start_timestamp_changed(double);
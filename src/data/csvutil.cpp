@@ -0,0 +1,446 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QDate>
+#include <QDateTime>
+#include <QDebug>
+#include <QString>
+#include <QTime>
+
+#include "csvutil.hpp"
+#include "src/util.hpp"
+#include "src/data/datautil.hpp"
+
+using std::make_pair;
+using std::map;
+using std::pair;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+namespace csvutil {
+
+namespace {
+
+/** The powers of 10, that can be represented exactly as double. */
+const double exact_powers_of_ten[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+const int max_exact_power_of_ten = 22;
+
+inline bool is_digit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+inline bool is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/** Compare [begin, end) case insensitive with the lower case word. */
+bool equals_word(const char *begin, const char *end, const char *word)
+{
+	for (; begin < end && *word; ++begin, ++word) {
+		char c = *begin;
+		if (c >= 'A' && c <= 'Z')
+			c = c - 'A' + 'a';
+		if (c != *word)
+			return false;
+	}
+	return begin == end && !*word;
+}
+
+/** Parse the fixed size number in [begin, begin+size). */
+bool parse_fixed_int(const char *begin, int size, int &value)
+{
+	value = 0;
+	for (int i = 0; i < size; ++i) {
+		if (!is_digit(begin[i]))
+			return false;
+		value = value * 10 + (begin[i] - '0');
+	}
+	return true;
+}
+
+/**
+ * Parse an absolute timestamp in the format "yyyy.MM.dd hh:mm:ss.zzz" (see
+ * util::format_time_date()).
+ */
+bool parse_date_time(const char *begin, const char *end, double &timestamp,
+	DateTimeCache &cache)
+{
+	if (end - begin != 23 || begin[4] != '.' || begin[7] != '.' ||
+			begin[10] != ' ' || begin[13] != ':' || begin[16] != ':' ||
+			begin[19] != '.')
+		return false;
+
+	int year, month, day, hour, minute, second, msec;
+	if (!parse_fixed_int(begin, 4, year) ||
+			!parse_fixed_int(begin + 5, 2, month) ||
+			!parse_fixed_int(begin + 8, 2, day) ||
+			!parse_fixed_int(begin + 11, 2, hour) ||
+			!parse_fixed_int(begin + 14, 2, minute) ||
+			!parse_fixed_int(begin + 17, 2, second) ||
+			!parse_fixed_int(begin + 20, 3, msec) ||
+			minute > 59 || second > 59)
+		return false;
+
+	int64_t hour_key = (((int64_t)year * 100 + month) * 100 + day) * 100 + hour;
+	if (hour_key != cache.hour_key) {
+		// The timestamps are written in local time.
+		QDateTime date_time(QDate(year, month, day), QTime(hour, 0));
+		if (!date_time.isValid())
+			return false;
+		cache.hour_key = hour_key;
+		cache.hour_msecs = date_time.toMSecsSinceEpoch();
+	}
+
+	timestamp = (cache.hour_msecs + minute * 60000 + second * 1000 + msec) /
+		(double)1000;
+	return true;
+}
+
+/**
+ * Return the first of the channel group names, that are joined with ", ".
+ * An empty channel group is written as "\"\"".
+ */
+string get_first_channel_group_name(const string &channel_group_names)
+{
+	if (channel_group_names == "\"\"")
+		return "";
+	return channel_group_names.substr(0, channel_group_names.find(", "));
+}
+
+} // namespace
+
+string detect_separator(const string &header_line)
+{
+	string separator(",");
+	size_t max_count = 0;
+	for (const auto &sep : { ",", ";", "\t", "|" }) {
+		size_t count = util::split_string(header_line, sep).size();
+		if (count > max_count) {
+			max_count = count;
+			separator = sep;
+		}
+	}
+	return separator;
+}
+
+bool parse_header(const vector<string> &header_lines,
+	const string &separator, CsvHeader &header)
+{
+	if (header_lines.size() < header_line_count)
+		return false;
+
+	header.separator = separator.empty() ?
+		detect_separator(header_lines[3]) : separator;
+	const string &sep = header.separator;
+	vector<string> device_names = util::split_string(header_lines[0], sep);
+	vector<string> chg_names = util::split_string(header_lines[1], sep);
+	vector<string> ch_names = util::split_string(header_lines[2], sep);
+	vector<string> signal_names = util::split_string(header_lines[3], sep);
+	if (ch_names.size() != signal_names.size() ||
+			device_names.size() != signal_names.size())
+		return false;
+
+	// The channel group names are joined with ", ", so they can only be used
+	// if they don't interfere with the separator.
+	if (chg_names.size() != signal_names.size())
+		chg_names = vector<string>(signal_names.size(), "");
+
+	// A combined file has a single time column, otherwise there is a time
+	// column for every value column.
+	header.column_count = signal_names.size();
+	header.combined = signal_names[0] == "Time" && ch_names[0] == "Time";
+	if (!header.combined && signal_names.size() % 2 != 0)
+		return false;
+
+	// Channels with the same name from different devices are prefixed with
+	// the device name, channels with the same name from different channel
+	// groups of one device are prefixed with the channel group name.
+	const size_t step = header.combined ? 1 : 2;
+	map<string, set<string>> channel_devices;
+	map<pair<string, string>, set<string>> channel_groups;
+	for (size_t i = 1; i < ch_names.size(); i += step) {
+		channel_devices[ch_names[i]].insert(device_names[i]);
+		channel_groups[make_pair(device_names[i], ch_names[i])].insert(
+			get_first_channel_group_name(chg_names[i]));
+	}
+
+	header.columns.clear();
+	for (size_t i = 1; i < signal_names.size(); i += step) {
+		CsvColumn column;
+		column.time_column = header.combined ? 0 : i - 1;
+		column.value_column = i;
+		if (!parse_signal_name(
+				signal_names[i], column.unit, column.quantity_flags)) {
+			qWarning() << "csvutil::parse_header(): Unknown signal" <<
+				QString::fromStdString(signal_names[i]) << ", skipped";
+			continue;
+		}
+		column.quantity = get_quantity(column.unit, column.quantity_flags);
+		if (column.quantity == Quantity::Unknown) {
+			qWarning() << "csvutil::parse_header(): No quantity for" <<
+				QString::fromStdString(signal_names[i]) << ", skipped";
+			continue;
+		}
+
+		column.device_name = device_names[i];
+		column.channel_group_name = get_first_channel_group_name(chg_names[i]);
+		column.channel_name = ch_names[i];
+		if (channel_groups[make_pair(device_names[i], ch_names[i])].size() > 1 &&
+				!column.channel_group_name.empty()) {
+			column.channel_name =
+				column.channel_group_name + " " + column.channel_name;
+		}
+		if (channel_devices[ch_names[i]].size() > 1)
+			column.channel_name = device_names[i] + " " + column.channel_name;
+
+		header.columns.push_back(column);
+	}
+
+	return true;
+}
+
+bool parse_signal_name(const string &signal_name,
+	Unit &unit, set<QuantityFlag> &quantity_flags)
+{
+	size_t start = signal_name.rfind('[');
+	size_t end = signal_name.rfind(']');
+	if (start == string::npos || end == string::npos || end < start)
+		return false;
+
+	QString meaning = QString::fromStdString(
+		signal_name.substr(start + 1, end - start - 1));
+	int unit_end = meaning.indexOf(' ');
+	QString unit_str = unit_end < 0 ? meaning : meaning.left(unit_end);
+	QString flags_str = unit_end < 0 ? QString() : meaning.mid(unit_end + 1);
+
+	unit = Unit::Unknown;
+	for (const auto &unit_pair : datautil::get_unit_name_map()) {
+		if (unit_pair.second == unit_str) {
+			unit = unit_pair.first;
+			break;
+		}
+	}
+	if (unit == Unit::Unknown)
+		return false;
+
+	/*
+	 * The flags are separated by spaces, but some flag names contain spaces
+	 * too, so the longest flag name that matches is taken.
+	 */
+	vector<pair<QString, QuantityFlag>> flag_names;
+	for (const auto &flag_pair : datautil::get_quantity_flag_name_map())
+		flag_names.push_back(std::make_pair(flag_pair.second, flag_pair.first));
+	std::sort(flag_names.begin(), flag_names.end(),
+		[](const pair<QString, QuantityFlag> &a,
+				const pair<QString, QuantityFlag> &b) {
+			return a.first.size() > b.first.size();
+		});
+
+	quantity_flags.clear();
+	flags_str = flags_str.trimmed();
+	while (!flags_str.isEmpty()) {
+		bool found = false;
+		for (const auto &flag_pair : flag_names) {
+			if (flags_str == flag_pair.first ||
+					flags_str.startsWith(flag_pair.first + " ")) {
+				quantity_flags.insert(flag_pair.second);
+				flags_str = flags_str.mid(flag_pair.first.size()).trimmed();
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			return false;
+	}
+
+	return true;
+}
+
+Quantity get_quantity(Unit &unit, const set<QuantityFlag> &quantity_flags)
+{
+	// "dB" is ambiguous, the SPL flags are only used by sound level meters.
+	for (const auto &quantity_flag : quantity_flags) {
+		if (quantity_flag >= QuantityFlag::SplFreqWeightA &&
+				quantity_flag <= QuantityFlag::SplPctOverAlarm) {
+			unit = Unit::DecibelSpl;
+			return Quantity::SoundPressureLevel;
+		}
+	}
+
+	for (const auto &quantity_pair : datautil::get_quantity_name_map()) {
+		if (datautil::get_units_from_quantity(
+				quantity_pair.first).count(unit) > 0)
+			return quantity_pair.first;
+	}
+	return Quantity::Unknown;
+}
+
+bool parse_double(const char *begin, const char *end, double &value)
+{
+	while (begin < end && is_space(*begin))
+		++begin;
+	while (end > begin && is_space(*(end - 1)))
+		--end;
+	if (begin == end)
+		return false;
+
+	bool negative = false;
+	if (*begin == '-' || *begin == '+') {
+		negative = *begin == '-';
+		++begin;
+	}
+
+	if (equals_word(begin, end, "inf")) {
+		value = negative ?
+			-std::numeric_limits<double>::infinity() :
+			std::numeric_limits<double>::infinity();
+		return true;
+	}
+	if (equals_word(begin, end, "nan")) {
+		value = std::numeric_limits<double>::quiet_NaN();
+		return true;
+	}
+
+	// Up to 19 significant digits fit into the mantissa.
+	uint64_t mantissa = 0;
+	int significant_digits = 0;
+	int exponent = 0;
+	bool has_digits = false;
+	const char *pos = begin;
+	for (; pos < end && is_digit(*pos); ++pos) {
+		has_digits = true;
+		if (significant_digits < 19) {
+			mantissa = mantissa * 10 + (*pos - '0');
+			if (mantissa > 0)
+				++significant_digits;
+		}
+		else {
+			++exponent;
+		}
+	}
+	if (pos < end && *pos == '.') {
+		for (++pos; pos < end && is_digit(*pos); ++pos) {
+			has_digits = true;
+			if (significant_digits < 19) {
+				mantissa = mantissa * 10 + (*pos - '0');
+				if (mantissa > 0)
+					++significant_digits;
+				--exponent;
+			}
+		}
+	}
+	if (!has_digits)
+		return false;
+
+	if (pos < end && (*pos == 'e' || *pos == 'E')) {
+		++pos;
+		bool negative_exponent = false;
+		if (pos < end && (*pos == '-' || *pos == '+')) {
+			negative_exponent = *pos == '-';
+			++pos;
+		}
+		if (pos == end || !is_digit(*pos))
+			return false;
+		int exp_value = 0;
+		for (; pos < end && is_digit(*pos); ++pos) {
+			if (exp_value < 10000)
+				exp_value = exp_value * 10 + (*pos - '0');
+		}
+		exponent += negative_exponent ? -exp_value : exp_value;
+	}
+	if (pos != end)
+		return false;
+
+	if (mantissa == 0) {
+		value = negative ? -0. : 0.;
+		return true;
+	}
+
+	// Scaling by an exact power of 10 gives a correctly rounded result for
+	// all mantissas up to 2^53, which covers all values written by SmuView.
+	value = (double)mantissa;
+	if (exponent < 0) {
+		if (-exponent <= max_exact_power_of_ten)
+			value /= exact_powers_of_ten[-exponent];
+		else
+			value /= std::pow(10., -exponent);
+	}
+	else if (exponent > 0) {
+		if (exponent <= max_exact_power_of_ten)
+			value *= exact_powers_of_ten[exponent];
+		else
+			value *= std::pow(10., exponent);
+	}
+	if (negative)
+		value = -value;
+
+	return true;
+}
+
+bool parse_timestamp(const char *begin, const char *end, double &timestamp,
+	DateTimeCache &cache)
+{
+	while (begin < end && is_space(*begin))
+		++begin;
+	while (end > begin && is_space(*(end - 1)))
+		--end;
+	if (begin == end)
+		return false;
+
+	if (parse_double(begin, end, timestamp))
+		return true;
+	return parse_date_time(begin, end, timestamp, cache);
+}
+
+int get_decimal_places(const char *begin, const char *end)
+{
+	while (end > begin && is_space(*(end - 1)))
+		--end;
+	const char *point = std::find(begin, end, '.');
+	if (point == end)
+		return 0;
+	for (const char *pos = point + 1; pos < end; ++pos) {
+		if (*pos == 'e' || *pos == 'E')
+			return 0;
+	}
+	return (int)(end - point - 1);
+}
+
+} // namespace csvutil
+} // namespace data
+} // namespace sv
@@ -0,0 +1,131 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CSVUTIL_HPP
+#define DATA_CSVUTIL_HPP
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "src/data/datautil.hpp"
+
+using std::set;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+namespace csvutil {
+
+/** A value column of a SmuView CSV file. */
+struct CsvColumn
+{
+	/** The time column of the value, 0 for a combined file. */
+	size_t time_column;
+	size_t value_column;
+	string device_name;
+	/**
+	 * The channel name. Channels with the same name from different devices
+	 * are prefixed with the device name, channels with the same name from
+	 * different channel groups of one device with the channel group name.
+	 */
+	string channel_name;
+	string channel_group_name;
+	Quantity quantity;
+	set<QuantityFlag> quantity_flags;
+	Unit unit;
+};
+
+/** The header of a SmuView CSV file, as written by SaveDialog. */
+struct CsvHeader
+{
+	string separator;
+	/** The number of columns in every line. */
+	size_t column_count;
+	/** A combined file has a single time column for all value columns. */
+	bool combined;
+	/** All value columns with a known quantity. */
+	vector<CsvColumn> columns;
+};
+
+/**
+ * Caches the epoch time of the last parsed hour, so parsing absolute
+ * timestamps only needs one (slow) QDateTime conversion per hour.
+ */
+struct DateTimeCache
+{
+	DateTimeCache() : hour_key(-1), hour_msecs(0) {}
+
+	int64_t hour_key;
+	int64_t hour_msecs;
+};
+
+/** The number of lines of the SmuView CSV header. */
+const size_t header_line_count = 4;
+
+/** Detect the separator of a CSV file from a header line. */
+string detect_separator(const string &header_line);
+
+/**
+ * Parse the header lines (device, channel groups, channel, signal) of a
+ * SmuView CSV file. If separator is empty, it is detected from the header.
+ * Signals with an unknown unit or quantity are skipped.
+ *
+ * @return false if the lines are not a SmuView CSV header.
+ */
+bool parse_header(const vector<string> &header_lines,
+	const string &separator, CsvHeader &header);
+
+/**
+ * Parse the signal name "<channel> [<unit> <flags>]" (see
+ * BaseSignal::BaseSignal()) into the unit and the quantity flags.
+ */
+bool parse_signal_name(const string &signal_name,
+	Unit &unit, set<QuantityFlag> &quantity_flags);
+
+/**
+ * Derive the quantity from the unit and the quantity flags. The quantity
+ * isn't stored in the CSV file.
+ */
+Quantity get_quantity(Unit &unit, const set<QuantityFlag> &quantity_flags);
+
+/**
+ * Parse a decimal number in [begin, end). This is a lot faster than
+ * QString::toDouble() and std::strtod(), and it doesn't depend on the locale.
+ * Surrounding spaces are ignored, "inf" and "nan" are accepted.
+ */
+bool parse_double(const char *begin, const char *end, double &value);
+
+/**
+ * Parse a timestamp in [begin, end), that was written by SaveDialog as
+ * relative time in s or as absolute date/time (see util::format_time_date()).
+ */
+bool parse_timestamp(const char *begin, const char *end, double &timestamp,
+	DateTimeCache &cache);
+
+/** Return the number of decimal places of the number in [begin, end). */
+int get_decimal_places(const char *begin, const char *end);
+
+} // namespace csvutil
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CSVUTIL_HPP
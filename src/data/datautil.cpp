@@ -19,11 +19,13 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include "datautil.hpp"
 
 using std::map;
 using std::set;
+using std::vector;
 
 namespace sv {
 namespace data {
@@ -71,6 +73,13 @@ uint32_t get_sr_quantity_id(Quantity quantity)
 	return 0;
 }
 
+const sigrok::Quantity *get_sr_quantity(Quantity quantity)
+{
+	if (quantity_sr_quantity_map.count(quantity) > 0)
+		return quantity_sr_quantity_map[quantity];
+	return nullptr;
+}
+
 
 QuantityFlag get_quantity_flag(const sigrok::QuantityFlag *sr_quantity_flag)
 {
@@ -127,6 +136,18 @@ uint64_t get_sr_quantity_flags_id(set<QuantityFlag> quantity_flags)
 	return sr_qfs_id;
 }
 
+vector<const sigrok::QuantityFlag *> get_sr_quantity_flags(
+	set<QuantityFlag> quantity_flags)
+{
+	vector<const sigrok::QuantityFlag *> sr_quantity_flags;
+	for (const auto &quantity_flag : quantity_flags) {
+		if (quantity_flag_sr_quantity_flag_map.count(quantity_flag) > 0)
+			sr_quantity_flags.push_back(
+				quantity_flag_sr_quantity_flag_map[quantity_flag]);
+	}
+	return sr_quantity_flags;
+}
+
 
 Unit get_unit(const sigrok::Unit *sr_unit)
 {
@@ -135,6 +156,13 @@ Unit get_unit(const sigrok::Unit *sr_unit)
 	return Unit::Unknown;
 }
 
+const sigrok::Unit *get_sr_unit(Unit unit)
+{
+	if (unit_sr_unit_map.count(unit) > 0)
+		return unit_sr_unit_map[unit];
+	return nullptr;
+}
+
 
 DataType get_data_type(const sigrok::DataType *sr_data_type)
 {
@@ -290,6 +318,26 @@ set<data::Unit> get_units_from_quantity(data::Quantity quantity)
 	return units;
 }
 
+data::Quantity get_quantity_from_unit(data::Unit unit)
+{
+	switch (unit) {
+	case data::Unit::Volt:
+		return data::Quantity::Voltage;
+	case data::Unit::Ampere:
+		return data::Quantity::Current;
+	case data::Unit::Watt:
+		return data::Quantity::Power;
+	case data::Unit::Ohm:
+		return data::Quantity::Resistance;
+	case data::Unit::Hertz:
+		return data::Quantity::Frequency;
+	case data::Unit::Second:
+		return data::Quantity::Time;
+	default:
+		return data::Quantity::Unknown;
+	}
+}
+
 } // namespace datautil
 } // namespace data
 } // namespace sv
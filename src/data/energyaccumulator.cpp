@@ -0,0 +1,179 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QObject>
+
+#include "energyaccumulator.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::vector;
+using std::weak_ptr;
+
+namespace sv {
+namespace data {
+
+EnergyAccumulator::EnergyAccumulator(
+		shared_ptr<AnalogTimeSignal> voltage_signal,
+		shared_ptr<AnalogTimeSignal> current_signal) :
+	QObject(),
+	voltage_signal_(voltage_signal),
+	current_signal_(current_signal),
+	voltage_pos_(0),
+	current_pos_(0)
+{
+	assert(voltage_signal_);
+	assert(current_signal_);
+
+	reset();
+}
+
+EnergyAccumulator::~EnergyAccumulator()
+{
+	disconnect(voltage_connection_);
+	disconnect(current_connection_);
+}
+
+void EnergyAccumulator::init()
+{
+	// Accumulate directly in the thread that appends the samples. The
+	// accumulator is locked for the time of the call, so it can't be
+	// destroyed by its owner (e.g. a closed view) while it is accumulating.
+	weak_ptr<EnergyAccumulator> weak_this = shared_from_this();
+	auto on_sample_appended = [weak_this]() {
+		if (auto accumulator = weak_this.lock())
+			accumulator->on_sample_appended();
+	};
+	voltage_connection_ = connect(voltage_signal_.get(),
+		&AnalogTimeSignal::sample_appended, this, on_sample_appended,
+		Qt::DirectConnection);
+	current_connection_ = connect(current_signal_.get(),
+		&AnalogTimeSignal::sample_appended, this, on_sample_appended,
+		Qt::DirectConnection);
+}
+
+shared_ptr<AnalogTimeSignal> EnergyAccumulator::voltage_signal() const
+{
+	return voltage_signal_;
+}
+
+shared_ptr<AnalogTimeSignal> EnergyAccumulator::current_signal() const
+{
+	return current_signal_;
+}
+
+void EnergyAccumulator::reset()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	voltage_pos_ = voltage_signal_->sample_count();
+	current_pos_ = current_signal_->sample_count();
+	has_last_ = false;
+	last_time_ = 0.;
+	last_current_ = 0.;
+	last_power_ = 0.;
+	values_.amp_hours = 0.;
+	values_.watt_hours = 0.;
+	values_.power_min = std::numeric_limits<double>::max();
+	values_.power_max = std::numeric_limits<double>::lowest();
+	values_.power_mean = 0.;
+	values_.elapsed_time = 0.;
+	values_.sample_count = 0;
+}
+
+EnergyValues EnergyAccumulator::values() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return values_;
+}
+
+void EnergyAccumulator::accumulate(double time, double voltage,
+	double current)
+{
+	if (!std::isfinite(voltage) || !std::isfinite(current)) {
+		// Don't integrate over gaps (e.g. overflows).
+		has_last_ = false;
+		return;
+	}
+
+	const double power = voltage * current;
+	if (has_last_ && time > last_time_) {
+		// Trapezoidal rule
+		const double dt_hours = (time - last_time_) / 3600.;
+		values_.amp_hours += (last_current_ + current) / 2. * dt_hours;
+		values_.watt_hours += (last_power_ + power) / 2. * dt_hours;
+		values_.elapsed_time += time - last_time_;
+	}
+	if (power < values_.power_min)
+		values_.power_min = power;
+	if (power > values_.power_max)
+		values_.power_max = power;
+	if (values_.elapsed_time > 0.)
+		values_.power_mean = values_.watt_hours * 3600. / values_.elapsed_time;
+	else
+		values_.power_mean = power;
+	++values_.sample_count;
+
+	has_last_ = true;
+	last_time_ = time;
+	last_current_ = current;
+	last_power_ = power;
+}
+
+void EnergyAccumulator::on_sample_appended()
+{
+	auto time = make_shared<vector<double>>();
+	auto voltage_data = make_shared<vector<double>>();
+	auto current_data = make_shared<vector<double>>();
+	vector<EnergyValues> new_values;
+
+	{
+		lock_guard<mutex> lock(mutex_);
+
+		AnalogTimeSignal::combine_signals(
+			voltage_signal_, voltage_pos_,
+			current_signal_, current_pos_,
+			time, voltage_data, current_data);
+
+		new_values.reserve(time->size());
+		for (size_t i = 0; i < time->size(); ++i) {
+			accumulate(time->at(i), voltage_data->at(i), current_data->at(i));
+			new_values.push_back(values_);
+		}
+	}
+
+	// Emit without holding the lock, so receivers can call values().
+	for (size_t i = 0; i < new_values.size(); ++i) {
+		const EnergyValues &v = new_values[i];
+		Q_EMIT sample_accumulated(time->at(i), v.amp_hours, v.watt_hours,
+			v.power_min, v.power_max, v.power_mean);
+	}
+}
+
+} // namespace data
+} // namespace sv
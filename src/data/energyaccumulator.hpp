@@ -0,0 +1,123 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_ENERGYACCUMULATOR_HPP
+#define DATA_ENERGYACCUMULATOR_HPP
+
+#include <memory>
+#include <mutex>
+
+#include <QObject>
+
+using std::mutex;
+using std::shared_ptr;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * Accumulated values of an EnergyAccumulator.
+ */
+struct EnergyValues
+{
+	double amp_hours;
+	double watt_hours;
+	double power_min;
+	double power_max;
+	/** Time weighted mean of the power. */
+	double power_mean;
+	/** Accumulated time in seconds. */
+	double elapsed_time;
+	size_t sample_count;
+};
+
+/**
+ * The EnergyAccumulator integrates the charge (Ah) and the energy (Wh) of a
+ * voltage and a current signal over the true sample timestamps. The samples
+ * of both signals are time aligned and integrated with the trapezoidal
+ * rule, so the result doesn't depend on when the values are read.
+ *
+ * The samples are processed in the thread that appends them to the signals
+ * (the acquisition thread for hardware devices), without GUI involvement.
+ * While the samples are processed, that thread holds a reference to the
+ * accumulator, so the owner can release it at any time.
+ */
+class EnergyAccumulator :
+	public QObject,
+	public std::enable_shared_from_this<EnergyAccumulator>
+{
+	Q_OBJECT
+
+public:
+	EnergyAccumulator(shared_ptr<AnalogTimeSignal> voltage_signal,
+		shared_ptr<AnalogTimeSignal> current_signal);
+	~EnergyAccumulator();
+
+	/**
+	 * Start to accumulate the appended samples.
+	 * Must be called after instantiation and not from the ctor.
+	 */
+	void init();
+
+	shared_ptr<AnalogTimeSignal> voltage_signal() const;
+	shared_ptr<AnalogTimeSignal> current_signal() const;
+
+	/**
+	 * Reset all accumulated values. Only samples that are appended after the
+	 * reset are accumulated.
+	 */
+	void reset();
+	/** Get a consistent copy of all accumulated values. */
+	EnergyValues values() const;
+
+private:
+	void accumulate(double time, double voltage, double current);
+	void on_sample_appended();
+
+	shared_ptr<AnalogTimeSignal> voltage_signal_;
+	shared_ptr<AnalogTimeSignal> current_signal_;
+	size_t voltage_pos_;
+	size_t current_pos_;
+
+	bool has_last_;
+	double last_time_;
+	double last_current_;
+	double last_power_;
+	EnergyValues values_;
+	mutable mutex mutex_;
+	QMetaObject::Connection voltage_connection_;
+	QMetaObject::Connection current_connection_;
+
+Q_SIGNALS:
+	/**
+	 * Is emitted for every accumulated (time aligned) voltage/current pair,
+	 * in the thread that has appended the sample.
+	 */
+	void sample_accumulated(double timestamp, double amp_hours,
+		double watt_hours, double power_min, double power_max,
+		double power_mean);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_ENERGYACCUMULATOR_HPP
@@ -0,0 +1,162 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "minmaxtree.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t MinMaxTree::chunk_size;
+
+MinMaxTree::MinMax::MinMax() :
+	min(std::numeric_limits<double>::max()),
+	max(std::numeric_limits<double>::lowest())
+{
+}
+
+void MinMaxTree::MinMax::add(double value)
+{
+	if (!std::isfinite(value))
+		return;
+	if (value < min)
+		min = value;
+	if (value > max)
+		max = value;
+}
+
+void MinMaxTree::MinMax::add(const MinMax &other)
+{
+	if (other.min < min)
+		min = other.min;
+	if (other.max > max)
+		max = other.max;
+}
+
+bool MinMaxTree::MinMax::is_valid() const
+{
+	return min <= max;
+}
+
+MinMaxTree::MinMaxTree() :
+	count_(0)
+{
+}
+
+void MinMaxTree::append(double value)
+{
+	size_t pos = count_ / chunk_size;
+	++count_;
+
+	if (levels_.empty())
+		levels_.push_back(vector<MinMax>());
+	if (levels_[0].size() <= pos)
+		levels_[0].push_back(MinMax());
+	levels_[0][pos].add(value);
+
+	// Update the path from the leaf to the root. The parent nodes are
+	// recalculated from their children, so a new root level also contains
+	// the values of the old root.
+	for (size_t level = 1; levels_[level - 1].size() > 1; ++level) {
+		pos /= 2;
+		if (levels_.size() <= level)
+			levels_.push_back(vector<MinMax>());
+		const vector<MinMax> &children = levels_[level - 1];
+		vector<MinMax> &nodes = levels_[level];
+		if (nodes.size() <= pos)
+			nodes.push_back(MinMax());
+		MinMax node = children[2 * pos];
+		if (2 * pos + 1 < children.size())
+			node.add(children[2 * pos + 1]);
+		nodes[pos] = node;
+	}
+}
+
+void MinMaxTree::clear()
+{
+	count_ = 0;
+	levels_.clear();
+}
+
+size_t MinMaxTree::memory_size() const
+{
+	size_t size = levels_.capacity() * sizeof(vector<MinMax>);
+	for (const auto &level : levels_)
+		size += level.capacity() * sizeof(MinMax);
+	return size;
+}
+
+bool MinMaxTree::get_min_max(const vector<double> &values,
+	size_t first, size_t last, double &min, double &max) const
+{
+	if (last >= count_)
+		last = count_ - 1;
+	if (count_ == 0 || first > last || last >= values.size())
+		return false;
+
+	MinMax result;
+	size_t first_chunk = first / chunk_size;
+	const size_t last_chunk = last / chunk_size;
+
+	if (first_chunk == last_chunk) {
+		for (size_t i = first; i <= last; ++i)
+			result.add(values[i]);
+	}
+	else {
+		// Partial chunks at the boundaries
+		size_t lo = first_chunk;
+		if (first % chunk_size != 0) {
+			for (size_t i = first; i < (first_chunk + 1) * chunk_size; ++i)
+				result.add(values[i]);
+			++lo;
+		}
+		size_t hi = last_chunk + 1;
+		if ((last + 1) % chunk_size != 0 && last + 1 != count_) {
+			for (size_t i = last_chunk * chunk_size; i <= last; ++i)
+				result.add(values[i]);
+			--hi;
+		}
+
+		// Full chunks [lo, hi) bottom up through the tree.
+		for (size_t level = 0; lo < hi && level < levels_.size(); ++level) {
+			const vector<MinMax> &nodes = levels_[level];
+			if (lo & 1)
+				result.add(nodes[lo++]);
+			if (hi & 1)
+				result.add(nodes[--hi]);
+			lo >>= 1;
+			hi >>= 1;
+		}
+	}
+
+	if (!result.is_valid())
+		return false;
+	min = result.min;
+	max = result.max;
+	return true;
+}
+
+} // namespace data
+} // namespace sv
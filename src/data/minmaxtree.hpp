@@ -0,0 +1,83 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_MINMAXTREE_HPP
+#define DATA_MINMAXTREE_HPP
+
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+namespace sv {
+namespace data {
+
+/**
+ * Range min/max queries over an append only sequence of values. The values
+ * are summarized in chunks, the chunk summaries are the leafs of a segment
+ * tree, so a query costs O(chunk_size + log n) and the tree only needs a
+ * fraction of the memory of the values. Non finite values are ignored.
+ *
+ * The values itself are not stored in the tree, they must be passed to
+ * get_min_max() for the partial chunks at the range boundaries.
+ */
+class MinMaxTree
+{
+
+public:
+	MinMaxTree();
+
+	void append(double value);
+	void clear();
+
+	/**
+	 * Get the min and max value of the values first to last (inclusive).
+	 *
+	 * @return false if there is no finite value in the range.
+	 */
+	bool get_min_max(const vector<double> &values, size_t first, size_t last,
+		double &min, double &max) const;
+
+	/** Allocated memory of the tree in bytes. */
+	size_t memory_size() const;
+
+	/** Number of values per chunk. */
+	static const size_t chunk_size = 64;
+
+private:
+	struct MinMax {
+		double min;
+		double max;
+
+		MinMax();
+		void add(double value);
+		void add(const MinMax &other);
+		bool is_valid() const;
+	};
+
+	size_t count_;
+	/** levels_[0] are the chunk summaries, the last level is the root. */
+	vector<vector<MinMax>> levels_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_MINMAXTREE_HPP
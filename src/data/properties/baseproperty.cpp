@@ -17,15 +17,28 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 
 #include <QDebug>
 
 #include "baseproperty.hpp"
+#include "src/devices/commandqueue.hpp"
 #include "src/devices/configurable.hpp"
 #include "src/devices/deviceutil.hpp"
 
+using std::chrono::duration;
+using std::chrono::steady_clock;
+using std::function;
+using std::lock_guard;
+using std::make_pair;
 using std::string;
+using std::weak_ptr;
 
 namespace sv {
 namespace data {
@@ -34,7 +47,9 @@ namespace properties {
 BaseProperty::BaseProperty(shared_ptr<devices::Configurable> configurable,
 		devices::ConfigKey config_key) :
 	configurable_(configurable),
-	config_key_(config_key)
+	config_key_(config_key),
+	has_cached_value_(false),
+	poll_interval_(0.)
 {
 	data_type_ = devices::deviceutil::get_data_type_for_config_key(config_key_);
 	//quantity_ = data::Quantity::Unknown; // TODO
@@ -44,6 +59,14 @@ BaseProperty::BaseProperty(shared_ptr<devices::Configurable> configurable,
 	is_listable_ = configurable_->has_list_config(config_key_);
 }
 
+BaseProperty::~BaseProperty()
+{
+	if (poll_interval_ > 0.) {
+		configurable_->command_queue()->set_periodic(
+			make_pair(this, -1), 0., nullptr);
+	}
+}
+
 shared_ptr<devices::Configurable> BaseProperty::configurable() const
 {
 	return configurable_;
@@ -96,6 +119,86 @@ QString BaseProperty::display_name() const
 	return devices::deviceutil::format_config_key(config_key_);
 }
 
+QVariant BaseProperty::value() const
+{
+	{
+		lock_guard<mutex> lock(cache_mutex_);
+		if (has_cached_value_)
+			return cached_value_;
+	}
+
+	QVariant qvar = read_value();
+	set_cached_value(qvar);
+	return qvar;
+}
+
+double BaseProperty::cache_age() const
+{
+	lock_guard<mutex> lock(cache_mutex_);
+	if (!has_cached_value_)
+		return -1.;
+	return duration<double>(steady_clock::now() - cache_time_).count();
+}
+
+void BaseProperty::set_poll_interval(double interval)
+{
+	if (!is_getable_)
+		return;
+
+	poll_interval_ = interval;
+	configurable_->command_queue()->set_periodic(
+		make_pair(this, -1), interval, create_refresh_command());
+}
+
+double BaseProperty::poll_interval() const
+{
+	return poll_interval_;
+}
+
+void BaseProperty::refresh()
+{
+	if (!is_getable_)
+		return;
+
+	// Same key as the polling, so a refresh is coalesced with a pending poll.
+	configurable_->command_queue()->push(
+		make_pair(this, -1), create_refresh_command());
+}
+
+void BaseProperty::update_value(const QVariant qvar)
+{
+	set_cached_value(qvar);
+	Q_EMIT value_changed(qvar);
+}
+
+void BaseProperty::set_cached_value(const QVariant qvar) const
+{
+	lock_guard<mutex> lock(cache_mutex_);
+	cached_value_ = qvar;
+	cache_time_ = steady_clock::now();
+	has_cached_value_ = true;
+}
+
+function<bool()> BaseProperty::create_refresh_command()
+{
+	// The command may still be queued, when the property is gone.
+	weak_ptr<BaseProperty> weak_property = shared_from_this();
+	return [weak_property]() {
+		auto property = weak_property.lock();
+		if (!property)
+			return false;
+		try {
+			property->update_value(property->read_value());
+		}
+		catch (std::exception &e) {
+			qWarning() << "BaseProperty::refresh(): Failed to read " <<
+				property->display_name() << ": " << e.what();
+			return false;
+		}
+		return true;
+	};
+}
+
 } // namespace properties
 } // namespace data
 } // namespace sv
@@ -20,7 +20,11 @@
 #ifndef DATA_PROPERTIES_BASEPROPERTY_HPP
 #define DATA_PROPERTIES_BASEPROPERTY_HPP
 
+#include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include <glib.h>
@@ -32,6 +36,8 @@
 #include "src/data/datautil.hpp"
 #include "src/devices/deviceutil.hpp"
 
+using std::mutex;
+using std::shared_future;
 using std::shared_ptr;
 using std::string;
 
@@ -44,13 +50,16 @@ class Configurable;
 namespace data {
 namespace properties {
 
-class BaseProperty : public QObject
+class BaseProperty :
+	public QObject,
+	public std::enable_shared_from_this<BaseProperty>
 {
 	Q_OBJECT
 
 public:
 	BaseProperty(shared_ptr<devices::Configurable> configurable,
 		devices::ConfigKey config_key);
+	~BaseProperty();
 
 	shared_ptr<devices::Configurable> configurable() const;
 	devices::ConfigKey config_key() const;
@@ -62,11 +71,35 @@ public:
 	bool is_listable() const;
 	string name() const;
 	QString display_name() const;
-	virtual QVariant value() const = 0;
+	/**
+	 * Return the cached value. The value is only read from the device, when
+	 * there is no cached value yet.
+	 */
+	QVariant value() const;
 	virtual QString to_string(const QVariant qvar) const = 0;
 	virtual QString to_string() const = 0;
 
+	/**
+	 * Age of the cached value in seconds, or -1 if there is no cached value.
+	 */
+	double cache_age() const;
+	/**
+	 * Set the interval in seconds in which the value is read from the device
+	 * in the background. An interval <= 0 disables polling.
+	 */
+	void set_poll_interval(double interval);
+	double poll_interval() const;
+
 protected:
+	/**
+	 * Read the actual value from the device.
+	 */
+	virtual QVariant read_value() const = 0;
+	/**
+	 * Update the cached value and emit value_changed().
+	 */
+	void update_value(const QVariant qvar);
+
 	shared_ptr<devices::Configurable> configurable_;
 	devices::ConfigKey config_key_;
 	data::DataType data_type_;
@@ -76,19 +109,35 @@ protected:
 	bool is_setable_;
 	bool is_listable_;
 
+private:
+	void set_cached_value(const QVariant qvar) const;
+	std::function<bool()> create_refresh_command();
+
+	mutable mutex cache_mutex_;
+	mutable QVariant cached_value_;
+	mutable std::chrono::steady_clock::time_point cache_time_;
+	mutable bool has_cached_value_;
+	double poll_interval_;
+
 public Q_SLOTS:
 	/**
 	 * Load the list of available values for this property.
 	 */
 	virtual bool list_config() = 0;
 	/**
-	 * Value has changes within SmuView and should be send to the device
+	 * Value has changes within SmuView and should be send to the device.
+	 * The future returns false, if the value couldn't be set.
 	 */
-	virtual void change_value(const QVariant) = 0;
+	virtual shared_future<bool> change_value(const QVariant) = 0;
 	/**
 	 * Devices has sended a changed value via a meta package
 	 */
 	virtual void on_value_changed(Glib::VariantBase) = 0;
+	/**
+	 * Queue a read of the value from the device. The cache is updated in the
+	 * background.
+	 */
+	void refresh();
 
 Q_SIGNALS:
 	void value_changed(const QVariant);
@@ -34,14 +34,14 @@ BoolProperty::BoolProperty(shared_ptr<devices::Configurable> configurable,
 {
 }
 
-QVariant BoolProperty::value() const
+bool BoolProperty::bool_value() const
 {
-	return QVariant(bool_value());
+	return value().toBool();
 }
 
-bool BoolProperty::bool_value() const
+QVariant BoolProperty::read_value() const
 {
-	return configurable_->get_config<bool>(config_key_);
+	return QVariant(configurable_->get_config<bool>(config_key_));
 }
 
 QString BoolProperty::to_string(bool value) const
@@ -65,15 +65,16 @@ bool BoolProperty::list_config()
 	return false;
 }
 
-void BoolProperty::change_value(const QVariant qvar)
+shared_future<bool> BoolProperty::change_value(const QVariant qvar)
 {
-	configurable_->set_config(config_key_, qvar.toBool());
-	Q_EMIT value_changed(qvar);
+	auto future = configurable_->set_config_async(config_key_, qvar.toBool());
+	update_value(qvar);
+	return future;
 }
 
 void BoolProperty::on_value_changed(Glib::VariantBase g_var)
 {
-	Q_EMIT value_changed(QVariant(g_variant_get_boolean(g_var.gobj())));
+	update_value(QVariant(g_variant_get_boolean(g_var.gobj())));
 }
 
 } // namespace properties
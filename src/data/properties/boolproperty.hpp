@@ -51,15 +51,17 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
 	bool bool_value() const;
 	QString to_string(bool value) const;
 	QString to_string(const QVariant qvar) const override;
 	QString to_string() const override;
 
+protected:
+	QVariant read_value() const override;
+
 public Q_SLOTS:
 	bool list_config() override;
-	void change_value(const QVariant) override;
+	shared_future<bool> change_value(const QVariant) override;
 	void on_value_changed(Glib::VariantBase) override;
 
 };
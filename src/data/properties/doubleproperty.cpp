@@ -47,14 +47,14 @@ DoubleProperty::DoubleProperty(shared_ptr<devices::Configurable> configurable,
 	}
 }
 
-QVariant DoubleProperty::value() const
+double DoubleProperty::double_value() const
 {
-	return QVariant(double_value());
+	return value().toDouble();
 }
 
-double DoubleProperty::double_value() const
+QVariant DoubleProperty::read_value() const
 {
-	return configurable_->get_config<double>(config_key_);
+	return QVariant(configurable_->get_config<double>(config_key_));
 }
 
 QString DoubleProperty::to_string(double value) const
@@ -120,15 +120,16 @@ bool DoubleProperty::list_config()
 	return true;
 }
 
-void DoubleProperty::change_value(const QVariant qvar)
+shared_future<bool> DoubleProperty::change_value(const QVariant qvar)
 {
-	configurable_->set_config(config_key_, qvar.toDouble());
-	Q_EMIT value_changed(qvar);
+	auto future = configurable_->set_config_async(config_key_, qvar.toDouble());
+	update_value(qvar);
+	return future;
 }
 
 void DoubleProperty::on_value_changed(Glib::VariantBase g_var)
 {
-	Q_EMIT value_changed(QVariant(g_variant_get_double(g_var.gobj())));
+	update_value(QVariant(g_variant_get_double(g_var.gobj())));
 }
 
 } // namespace properties
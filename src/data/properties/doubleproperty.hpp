@@ -52,7 +52,6 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
 	double double_value() const;
 	QString to_string(double value) const;
 	QString to_string(const QVariant qvar) const override;
@@ -63,6 +62,9 @@ public:
 	uint digits() const;
 	uint decimal_places() const;
 
+protected:
+	QVariant read_value() const override;
+
 private:
 	double min_;
 	double max_;
@@ -72,7 +74,7 @@ private:
 
 public Q_SLOTS:
 	bool list_config() override;
-	void change_value(const QVariant) override;
+	shared_future<bool> change_value(const QVariant) override;
 	void on_value_changed(Glib::VariantBase) override;
 
 };
@@ -46,12 +46,12 @@ DoubleRangeProperty::DoubleRangeProperty(
 		list_config();
 }
 
-QVariant DoubleRangeProperty::value() const
+double_range_t DoubleRangeProperty::double_range_value() const
 {
-	return QVariant().fromValue(double_range_value());
+	return value().value<double_range_t>();
 }
 
-double_range_t DoubleRangeProperty::double_range_value() const
+QVariant DoubleRangeProperty::read_value() const
 {
 	Glib::VariantContainerBase gvar =
 		configurable_->get_container_config(config_key_);
@@ -59,7 +59,7 @@ double_range_t DoubleRangeProperty::double_range_value() const
 	size_t child_cnt = gvar.get_n_children();
 	if (child_cnt != 2)
 		throw std::runtime_error(QString(
-			"DoubleRangeProperty::double_range_value(): ").append(
+			"DoubleRangeProperty::read_value(): ").append(
 			"container should have 2 child, but has %1").arg(child_cnt).
 			toStdString());
 
@@ -71,7 +71,7 @@ double_range_t DoubleRangeProperty::double_range_value() const
 	double high =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<double>>(gvar).get();
 
-	return make_pair(low, high);
+	return QVariant().fromValue<double_range_t>(make_pair(low, high));
 }
 
 QString DoubleRangeProperty::to_string(data::double_range_t value) const
@@ -129,7 +129,7 @@ bool DoubleRangeProperty::list_config()
  *
  *       set_config(config_key_, std::tuple<double, double>);
  */
-void DoubleRangeProperty::change_value(const QVariant qvar)
+shared_future<bool> DoubleRangeProperty::change_value(const QVariant qvar)
 {
 	data::double_range_t range = qvar.value<data::double_range_t>();
 
@@ -140,8 +140,10 @@ void DoubleRangeProperty::change_value(const QVariant qvar)
 	gcontainer.push_back(gvar_low);
 	gcontainer.push_back(gvar_high);
 
-	configurable_->set_container_config(config_key_, gcontainer);
-	Q_EMIT value_changed(qvar);
+	auto future = configurable_->set_container_config_async(
+		config_key_, gcontainer);
+	update_value(qvar);
+	return future;
 }
 
 void DoubleRangeProperty::on_value_changed(Glib::VariantBase g_var)
@@ -154,7 +156,7 @@ void DoubleRangeProperty::on_value_changed(Glib::VariantBase g_var)
 	double high =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<double>>(g_var).get();
 
-	Q_EMIT value_changed(QVariant().fromValue(make_pair(low, high)));
+	update_value(QVariant().fromValue(make_pair(low, high)));
 }
 
 } // namespace properties
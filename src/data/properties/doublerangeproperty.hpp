@@ -52,19 +52,21 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
 	data::double_range_t double_range_value() const;
 	QString to_string(data::double_range_t value) const;
 	QString to_string(const QVariant qvar) const override;
 	QString to_string() const override;
 	vector<data::double_range_t> list_values() const;
 
+protected:
+	QVariant read_value() const override;
+
 private:
 	vector<data::double_range_t> values_list_;
 
 public Q_SLOTS:
 	bool list_config() override;
-	void change_value(const QVariant) override;
+	shared_future<bool> change_value(const QVariant) override;
 	void on_value_changed(Glib::VariantBase) override;
 
 };
@@ -41,14 +41,14 @@ Int32Property::Int32Property(shared_ptr<devices::Configurable> configurable,
 		list_config();
 }
 
-QVariant Int32Property::value() const
+int32_t Int32Property::int32_value() const
 {
-	return QVariant(int32_value());
+	return value().toInt();
 }
 
-int32_t Int32Property::int32_value() const
+QVariant Int32Property::read_value() const
 {
-	return configurable_->get_config<int32_t>(config_key_);
+	return QVariant(configurable_->get_config<int32_t>(config_key_));
 }
 
 QString Int32Property::to_string(int32_t value) const
@@ -104,15 +104,16 @@ bool Int32Property::list_config()
 	return true;
 }
 
-void Int32Property::change_value(const QVariant qvar)
+shared_future<bool> Int32Property::change_value(const QVariant qvar)
 {
-	configurable_->set_config(config_key_, qvar.toInt());
-	Q_EMIT value_changed(qvar);
+	auto future = configurable_->set_config_async(config_key_, qvar.toInt());
+	update_value(qvar);
+	return future;
 }
 
 void Int32Property::on_value_changed(Glib::VariantBase g_var)
 {
-	Q_EMIT value_changed(QVariant(g_variant_get_int32(g_var.gobj())));
+	update_value(QVariant(g_variant_get_int32(g_var.gobj())));
 }
 
 } // namespace datatypes
@@ -51,7 +51,6 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
 	int32_t int32_value() const;
 	int32_t min() const;
 	int32_t max() const;
@@ -60,6 +59,9 @@ public:
 	QString to_string(const QVariant qvar) const override;
 	QString to_string() const override;
 
+protected:
+	QVariant read_value() const override;
+
 private:
 	int32_t min_;
 	int32_t max_;
@@ -67,7 +69,7 @@ private:
 
 public Q_SLOTS:
 	bool list_config() override;
-	void change_value(const QVariant) override;
+	shared_future<bool> change_value(const QVariant) override;
 	void on_value_changed(Glib::VariantBase) override;
 
 };
@@ -51,9 +51,9 @@ MeasuredQuantityProperty::MeasuredQuantityProperty(
 		list_config();
 }
 
-QVariant MeasuredQuantityProperty::value() const
+data::measured_quantity_t MeasuredQuantityProperty::measured_quantity_value() const
 {
-	return QVariant().fromValue(measured_quantity_value());
+	return value().value<data::measured_quantity_t>();
 }
 
 /**
@@ -62,8 +62,7 @@ QVariant MeasuredQuantityProperty::value() const
  *
  *       return get_config<std::tuple<uint32_t, uint64_t>>(sigrok::ConfigKey);
  */
-data::measured_quantity_t
-MeasuredQuantityProperty::measured_quantity_value() const
+QVariant MeasuredQuantityProperty::read_value() const
 {
 	Glib::VariantContainerBase gvar =
 		configurable_->get_container_config(config_key_);
@@ -71,7 +70,7 @@ MeasuredQuantityProperty::measured_quantity_value() const
 	size_t child_cnt = gvar.get_n_children();
 	if (child_cnt != 2)
 		throw std::runtime_error(QString(
-			"MeasuredQuantityProperty::measured_quantity_value(): ").append(
+			"MeasuredQuantityProperty::read_value(): ").append(
 			"container (mq) should have 2 child, but has %1").arg(child_cnt).
 			toStdString());
 
@@ -87,7 +86,8 @@ MeasuredQuantityProperty::measured_quantity_value() const
 	set<data::QuantityFlag> quantity_flags =
 		data::datautil::get_quantity_flags(sr_qflags);
 
-	return make_pair(quantity, quantity_flags);
+	return QVariant().fromValue<data::measured_quantity_t>(
+		make_pair(quantity, quantity_flags));
 }
 
 QString MeasuredQuantityProperty::to_string(data::measured_quantity_t value) const
@@ -142,7 +142,7 @@ bool MeasuredQuantityProperty::list_config()
  *
  *       set_config(config_key_, std::tuple<uint32_t, uint64_t>);
  */
-void MeasuredQuantityProperty::change_value(const QVariant qvar)
+shared_future<bool> MeasuredQuantityProperty::change_value(const QVariant qvar)
 {
 	data::measured_quantity_t mq = qvar.value<data::measured_quantity_t>();
 
@@ -155,13 +155,18 @@ void MeasuredQuantityProperty::change_value(const QVariant qvar)
 	gcontainer.push_back(gvar_q);
 	gcontainer.push_back(gvar_qfs);
 
-	configurable_->set_container_config(config_key_, gcontainer);
-	Q_EMIT value_changed(qvar);
+	auto future = configurable_->set_container_config_async(
+		config_key_, gcontainer);
+	update_value(qvar);
+	return future;
 }
 
 void MeasuredQuantityProperty::on_value_changed(Glib::VariantBase g_var)
 {
-	Q_EMIT value_changed(QVariant(g_variant_get_string(g_var.gobj(), NULL)));
+	(void)g_var;
+	// The meta package contains the raw sigrok mq container, read the value
+	// from the device to get a proper measured_quantity_t for the cache.
+	refresh();
 }
 
 } // namespace properties
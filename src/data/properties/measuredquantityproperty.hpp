@@ -52,19 +52,21 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
 	data::measured_quantity_t measured_quantity_value() const;
 	vector<data::measured_quantity_t> list_values() const;
 	QString to_string(data::measured_quantity_t value) const;
 	QString to_string(const QVariant qvar) const override;
 	QString to_string() const override;
 
+protected:
+	QVariant read_value() const override;
+
 private:
 	vector<data::measured_quantity_t> measured_quantity_list_;
 
 public Q_SLOTS:
 	bool list_config() override;
-	void change_value(const QVariant) override;
+	shared_future<bool> change_value(const QVariant) override;
 	void on_value_changed(Glib::VariantBase) override;
 
 };
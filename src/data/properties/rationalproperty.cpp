@@ -50,9 +50,9 @@ RationalProperty::RationalProperty(
 		list_config();
 }
 
-QVariant RationalProperty::value() const
+data::rational_t RationalProperty::rational_value() const
 {
-	return QVariant().fromValue(rational_value());
+	return value().value<data::rational_t>();
 }
 
 /**
@@ -61,7 +61,7 @@ QVariant RationalProperty::value() const
  *
  *       return get_config<std::tuple<uint32_t, uint64_t>>(sigrok::ConfigKey);
  */
-data::rational_t RationalProperty::rational_value() const
+QVariant RationalProperty::read_value() const
 {
 	Glib::VariantContainerBase gvar =
 		configurable_->get_container_config(config_key_);
@@ -69,7 +69,7 @@ data::rational_t RationalProperty::rational_value() const
 	size_t child_cnt = gvar.get_n_children();
 	if (child_cnt != 2)
 		throw std::runtime_error(QString(
-			"RationalProperty::rational_value(): ").append(
+			"RationalProperty::read_value(): ").append(
 			"container should have 2 child, but has %1").arg(child_cnt).
 			toStdString());
 
@@ -81,7 +81,7 @@ data::rational_t RationalProperty::rational_value() const
 	uint64_t q =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<uint64_t>>(gvar).get();
 
-	return make_pair(p, q);
+	return QVariant().fromValue<data::rational_t>(make_pair(p, q));
 }
 
 QString RationalProperty::to_string(data::rational_t value) const
@@ -140,7 +140,7 @@ bool RationalProperty::list_config()
  *
  *       set_config(config_key_, std::tuple<uint32_t, uint64_t>);
  */
-void RationalProperty::change_value(const QVariant qvar)
+shared_future<bool> RationalProperty::change_value(const QVariant qvar)
 {
 	data::rational_t rational = qvar.value<data::rational_t>();
 
@@ -151,8 +151,10 @@ void RationalProperty::change_value(const QVariant qvar)
 	gcontainer.push_back(gvar_p);
 	gcontainer.push_back(gvar_q);
 
-	configurable_->set_container_config(config_key_, gcontainer);
-	Q_EMIT value_changed(qvar);
+	auto future = configurable_->set_container_config_async(
+		config_key_, gcontainer);
+	update_value(qvar);
+	return future;
 }
 
 void RationalProperty::on_value_changed(Glib::VariantBase g_var)
@@ -165,7 +167,7 @@ void RationalProperty::on_value_changed(Glib::VariantBase g_var)
 	uint64_t q =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<uint64_t>>(g_var).get();
 
-	Q_EMIT value_changed(QVariant().fromValue(make_pair(p, q)));
+	update_value(QVariant().fromValue(make_pair(p, q)));
 }
 
 } // namespace datatypes
@@ -45,15 +45,15 @@ StringProperty::StringProperty(shared_ptr<devices::Configurable> configurable,
 	}
 }
 
-QVariant StringProperty::value() const
+QString StringProperty::string_value() const
 {
-	return QVariant(string_value());
+	return value().toString();
 }
 
-QString StringProperty::string_value() const
+QVariant StringProperty::read_value() const
 {
-	return QString::fromStdString(
-		configurable_->get_config<string>(config_key_));
+	return QVariant(QString::fromStdString(
+		configurable_->get_config<string>(config_key_)));
 }
 
 QString StringProperty::to_string(const QVariant qvar) const
@@ -90,18 +90,19 @@ bool StringProperty::list_config()
 	return true;
 }
 
-void StringProperty::change_value(const QVariant qvar)
+shared_future<bool> StringProperty::change_value(const QVariant qvar)
 {
 	// We have to use Glib::ustring here, to get a variant type of 's'.
 	// std::string will create a variant type of 'ay'
-	configurable_->set_config<Glib::ustring>(
+	auto future = configurable_->set_config_async<Glib::ustring>(
 		config_key_, Glib::ustring(qvar.toString().toStdString()));
-	Q_EMIT value_changed(qvar);
+	update_value(qvar);
+	return future;
 }
 
 void StringProperty::on_value_changed(Glib::VariantBase g_var)
 {
-	Q_EMIT value_changed(QVariant(g_variant_get_string(g_var.gobj(), NULL)));
+	update_value(QVariant(g_variant_get_string(g_var.gobj(), NULL)));
 }
 
 } // namespace datatypes
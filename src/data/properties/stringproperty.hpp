@@ -54,18 +54,20 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
 	QString string_value() const;
 	QStringList list_values() const;
 	QString to_string(const QVariant qvar) const override;
 	QString to_string() const override;
 
+protected:
+	QVariant read_value() const override;
+
 private:
 	QStringList string_list_;
 
 public Q_SLOTS:
 	bool list_config() override;
-	void change_value(const QVariant) override;
+	shared_future<bool> change_value(const QVariant) override;
 	void on_value_changed(Glib::VariantBase) override;
 
 };
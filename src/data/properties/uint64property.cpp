@@ -48,14 +48,14 @@ UInt64Property::UInt64Property(shared_ptr<devices::Configurable> configurable,
 		list_config();
 }
 
-QVariant UInt64Property::value() const
+uint64_t UInt64Property::uint64_value() const
 {
-	return QVariant((qulonglong)uint64_value());
+	return (uint64_t)value().toULongLong();
 }
 
-uint64_t UInt64Property::uint64_value() const
+QVariant UInt64Property::read_value() const
 {
-	return configurable_->get_config<uint64_t>(config_key_);
+	return QVariant((qulonglong)configurable_->get_config<uint64_t>(config_key_));
 }
 
 QString UInt64Property::to_string(uint64_t value) const
@@ -162,7 +162,7 @@ bool UInt64Property::list_config()
 	return true;
 }
 
-void UInt64Property::change_value(const QVariant qvar)
+shared_future<bool> UInt64Property::change_value(const QVariant qvar)
 {
 	/*
 	 * TODO: This is a dirty hack to limit the sample rate of the (demo) device
@@ -176,13 +176,15 @@ void UInt64Property::change_value(const QVariant qvar)
 			new_qvar.setValue((qulonglong)20000);
 	}
 
-	configurable_->set_config(config_key_, (uint64_t)new_qvar.toULongLong());
-	Q_EMIT value_changed(new_qvar);
+	auto future = configurable_->set_config_async(
+		config_key_, (uint64_t)new_qvar.toULongLong());
+	update_value(new_qvar);
+	return future;
 }
 
 void UInt64Property::on_value_changed(Glib::VariantBase g_var)
 {
-	Q_EMIT value_changed(QVariant(
+	update_value(QVariant(
 		(qulonglong)g_variant_get_uint64(g_var.gobj())));
 }
 
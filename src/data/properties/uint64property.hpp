@@ -51,7 +51,6 @@ public:
 		devices::ConfigKey config_key);
 
 public:
-	QVariant value() const override;
 	uint64_t uint64_value() const;
 	QString to_string(uint64_t value) const;
 	QString to_string(const QVariant qvar) const override;
@@ -61,6 +60,9 @@ public:
 	uint64_t step() const;
 	vector<uint64_t> list_values() const;
 
+protected:
+	QVariant read_value() const override;
+
 private:
 	uint64_t min_;
 	uint64_t max_;
@@ -69,7 +71,7 @@ private:
 
 public Q_SLOTS:
 	bool list_config() override;
-	void change_value(const QVariant) override;
+	shared_future<bool> change_value(const QVariant) override;
 	void on_value_changed(Glib::VariantBase) override;
 
 };
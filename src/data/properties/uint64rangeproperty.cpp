@@ -49,9 +49,9 @@ UInt64RangeProperty::UInt64RangeProperty(
 		list_config();
 }
 
-QVariant UInt64RangeProperty::value() const
+data::uint64_range_t UInt64RangeProperty::uint64_range_value() const
 {
-	return QVariant().fromValue(uint64_range_value());
+	return value().value<data::uint64_range_t>();
 }
 
 /**
@@ -60,7 +60,7 @@ QVariant UInt64RangeProperty::value() const
  *
  *       return get_config<std::tuple<uint64_t, uint64_t>>(sigrok::ConfigKey);
  */
-data::uint64_range_t UInt64RangeProperty::uint64_range_value() const
+QVariant UInt64RangeProperty::read_value() const
 {
 	Glib::VariantContainerBase gvar =
 		configurable_->get_container_config(config_key_);
@@ -68,7 +68,7 @@ data::uint64_range_t UInt64RangeProperty::uint64_range_value() const
 	size_t child_cnt = gvar.get_n_children();
 	if (child_cnt != 2)
 		throw std::runtime_error(QString(
-			"UInt64RangeProperty::uint64_range_value(): ").append(
+			"UInt64RangeProperty::read_value(): ").append(
 			"container should have 2 child, but has %1").arg(child_cnt).
 			toStdString());
 
@@ -80,7 +80,7 @@ data::uint64_range_t UInt64RangeProperty::uint64_range_value() const
 	uint64_t high =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<uint64_t>>(gvar).get();
 
-	return make_pair(low, high);
+	return QVariant().fromValue<data::uint64_range_t>(make_pair(low, high));
 }
 
 QString UInt64RangeProperty::to_string(data::uint64_range_t value) const
@@ -136,7 +136,7 @@ bool UInt64RangeProperty::list_config()
  *
  *       set_config(config_key_, std::tuple<uint32_t, uint64_t>);
  */
-void UInt64RangeProperty::change_value(const QVariant qvar)
+shared_future<bool> UInt64RangeProperty::change_value(const QVariant qvar)
 {
 	data::uint64_range_t range = qvar.value<data::uint64_range_t>();
 
@@ -147,8 +147,10 @@ void UInt64RangeProperty::change_value(const QVariant qvar)
 	gcontainer.push_back(gvar_low);
 	gcontainer.push_back(gvar_high);
 
-	configurable_->set_container_config(config_key_, gcontainer);
-	Q_EMIT value_changed(qvar);
+	auto future = configurable_->set_container_config_async(
+		config_key_, gcontainer);
+	update_value(qvar);
+	return future;
 }
 
 void UInt64RangeProperty::on_value_changed(Glib::VariantBase g_var)
@@ -161,7 +163,7 @@ void UInt64RangeProperty::on_value_changed(Glib::VariantBase g_var)
 	uint64_t high =
 		Glib::VariantBase::cast_dynamic<Glib::Variant<uint64_t>>(g_var).get();
 
-	Q_EMIT value_changed(QVariant().fromValue(make_pair(low, high)));
+	update_value(QVariant().fromValue(make_pair(low, high)));
 }
 
 } // namespace properties
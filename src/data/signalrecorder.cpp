@@ -0,0 +1,415 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QString>
+
+#include "signalrecorder.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::chrono::duration;
+using std::chrono::steady_clock;
+using std::lock_guard;
+using std::unique_lock;
+using std::weak_ptr;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** Wake up the writer thread early, when this many samples are pending. */
+const size_t max_pending_records = 65536;
+/** The writer thread collects the samples for this time, before writing. */
+const std::chrono::milliseconds write_interval(100);
+
+const char binary_magic[] = "SVREC001";
+
+} // namespace
+
+SignalRecorder::SignalRecorder(const string &base_file_name,
+		RecorderFormat format) :
+	QObject(),
+	base_file_name_(base_file_name),
+	format_(format),
+	rotation_size_(0),
+	rotation_time_(0.),
+	sync_interval_(1.),
+	is_running_(false),
+	stop_(false),
+	file_(nullptr),
+	file_number_(0),
+	file_size_(0),
+	header_signal_count_(0),
+	unsynced_(false),
+	recorded_sample_count_(0),
+	dropped_sample_count_(0)
+{
+}
+
+SignalRecorder::~SignalRecorder()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		for (const auto &connection : signal_connections_)
+			disconnect(connection);
+	}
+	stop();
+}
+
+void SignalRecorder::add_signal(shared_ptr<AnalogTimeSignal> signal)
+{
+	assert(signal);
+
+	lock_guard<mutex> lock(mutex_);
+	size_t signal_index = signals_.size();
+	signals_.push_back(signal);
+	signal_pos_.push_back(signal->sample_count());
+
+	// Copy the new samples in the thread that has appended them. The
+	// recorder is locked for the time of the call, so it can't be destroyed
+	// by its owner while it is copying.
+	weak_ptr<SignalRecorder> weak_this = shared_from_this();
+	signal_connections_.push_back(connect(signal.get(),
+		&AnalogTimeSignal::sample_appended, this,
+		[weak_this, signal_index]() {
+			if (auto recorder = weak_this.lock())
+				recorder->on_sample_appended(signal_index);
+		},
+		Qt::DirectConnection));
+}
+
+vector<shared_ptr<AnalogTimeSignal>> SignalRecorder::signals() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return signals_;
+}
+
+void SignalRecorder::set_rotation_size(uint64_t rotation_size)
+{
+	lock_guard<mutex> lock(mutex_);
+	rotation_size_ = rotation_size;
+}
+
+void SignalRecorder::set_rotation_time(double rotation_time)
+{
+	lock_guard<mutex> lock(mutex_);
+	rotation_time_ = rotation_time;
+}
+
+void SignalRecorder::set_sync_interval(double sync_interval)
+{
+	lock_guard<mutex> lock(mutex_);
+	sync_interval_ = sync_interval;
+}
+
+bool SignalRecorder::start()
+{
+	if (is_running_)
+		return false;
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (signals_.empty())
+			return false;
+		pending_records_.clear();
+		for (size_t i = 0; i < signals_.size(); ++i)
+			signal_pos_[i] = signals_[i]->sample_count();
+		stop_ = false;
+	}
+
+	if (!open_file())
+		return false;
+
+	is_running_ = true;
+	writer_thread_ = std::thread(&SignalRecorder::writer_thread_proc, this);
+
+	return true;
+}
+
+void SignalRecorder::stop()
+{
+	if (!is_running_)
+		return;
+
+	is_running_ = false;
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_all();
+
+	if (writer_thread_.joinable())
+		writer_thread_.join();
+}
+
+bool SignalRecorder::is_running() const
+{
+	return is_running_;
+}
+
+string SignalRecorder::file_name() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return file_name_;
+}
+
+uint64_t SignalRecorder::recorded_sample_count() const
+{
+	return recorded_sample_count_;
+}
+
+uint64_t SignalRecorder::dropped_sample_count() const
+{
+	return dropped_sample_count_;
+}
+
+void SignalRecorder::on_sample_appended(size_t signal_index)
+{
+	if (!is_running_)
+		return;
+
+	lock_guard<mutex> lock(mutex_);
+	const auto &signal = signals_[signal_index];
+	const size_t sample_count = signal->sample_count();
+	for (size_t pos = signal_pos_[signal_index]; pos < sample_count; ++pos) {
+		analog_time_sample_t sample = signal->get_sample(pos, false);
+		Record record;
+		record.signal_index = (uint32_t)signal_index;
+		record.timestamp = sample.first;
+		record.value = sample.second;
+		pending_records_.push_back(record);
+	}
+	signal_pos_[signal_index] = sample_count;
+
+	if (pending_records_.size() >= max_pending_records)
+		cv_.notify_one();
+}
+
+void SignalRecorder::writer_thread_proc()
+{
+	unique_lock<mutex> lock(mutex_);
+	while (true) {
+		// Collect the samples for a while, to write them in batches.
+		cv_.wait_for(lock, write_interval, [this] {
+			return stop_ || pending_records_.size() >= max_pending_records; });
+
+		vector<Record> records;
+		records.swap(pending_records_);
+		const bool stop = stop_;
+		const double sync_interval = sync_interval_;
+		lock.unlock();
+
+		write_records(records);
+		if (stop || duration<double>(
+				steady_clock::now() - last_sync_time_).count() >= sync_interval)
+			sync_file();
+		if (stop)
+			break;
+
+		lock.lock();
+	}
+
+	close_file();
+}
+
+bool SignalRecorder::open_file()
+{
+	// Never overwrite the files of a previous recording.
+	const QString extension = format_ == RecorderFormat::CSV ? "csv" : "svrec";
+	QString file_name;
+	do {
+		++file_number_;
+		file_name = QString("%1_%2.%3").
+			arg(QString::fromStdString(base_file_name_)).
+			arg(file_number_, 4, 10, QChar('0')).
+			arg(extension);
+	} while (QFileInfo::exists(file_name));
+
+	file_ = fopen(file_name.toLocal8Bit().constData(),
+		format_ == RecorderFormat::CSV ? "w" : "wb");
+	if (!file_) {
+		qWarning() << "SignalRecorder: Could not open file" << file_name;
+		Q_EMIT write_error(tr("Could not open file %1").arg(file_name));
+		return false;
+	}
+
+	{
+		lock_guard<mutex> lock(mutex_);
+		file_name_ = file_name.toStdString();
+	}
+	file_size_ = 0;
+	file_open_time_ = steady_clock::now();
+	last_sync_time_ = file_open_time_;
+	unsynced_ = false;
+
+	write_header();
+	Q_EMIT file_opened(file_name);
+
+	return true;
+}
+
+void SignalRecorder::close_file()
+{
+	if (!file_)
+		return;
+
+	sync_file();
+	fclose(file_);
+	file_ = nullptr;
+}
+
+void SignalRecorder::write_header()
+{
+	vector<shared_ptr<AnalogTimeSignal>> signals;
+	{
+		lock_guard<mutex> lock(mutex_);
+		signals = signals_;
+	}
+	header_signal_count_ = signals.size();
+
+	if (format_ == RecorderFormat::CSV) {
+		int size = fprintf(file_, "; SmuView signal recorder\n");
+		for (size_t i = 0; i < signals.size(); ++i) {
+			size += fprintf(file_, "; Signal %u: %s [%s]\n", (unsigned int)i,
+				signals[i]->display_name().toUtf8().constData(),
+				signals[i]->unit_name().toUtf8().constData());
+		}
+		size += fprintf(file_, "Time [s],Signal,Value\n");
+		file_size_ += size;
+	}
+	else {
+		auto write_string = [this](const QString &str) {
+			const QByteArray bytes = str.toUtf8();
+			const uint32_t length = (uint32_t)bytes.size();
+			fwrite(&length, sizeof(length), 1, file_);
+			fwrite(bytes.constData(), 1, length, file_);
+			file_size_ += sizeof(length) + length;
+		};
+
+		fwrite(binary_magic, 1, sizeof(binary_magic) - 1, file_);
+		const uint32_t signal_count = (uint32_t)signals.size();
+		fwrite(&signal_count, sizeof(signal_count), 1, file_);
+		file_size_ += sizeof(binary_magic) - 1 + sizeof(signal_count);
+		for (const auto &signal : signals) {
+			write_string(signal->display_name());
+			write_string(signal->unit_name());
+		}
+	}
+	unsynced_ = true;
+}
+
+void SignalRecorder::write_records(const vector<Record> &records)
+{
+	if (records.empty())
+		return;
+
+	uint64_t rotation_size;
+	double rotation_time;
+	{
+		lock_guard<mutex> lock(mutex_);
+		rotation_size = rotation_size_;
+		rotation_time = rotation_time_;
+	}
+
+	if (file_ && rotation_time > 0. && duration<double>(
+			steady_clock::now() - file_open_time_).count() >= rotation_time)
+		close_file();
+
+	for (size_t i = 0; i < records.size(); ++i) {
+		if (file_ && rotation_size > 0 && file_size_ >= rotation_size)
+			close_file();
+		// A signal has been added while running.
+		if (file_ && records[i].signal_index >= header_signal_count_)
+			close_file();
+		if (!file_ && !open_file()) {
+			dropped_sample_count_ += records.size() - i;
+			return;
+		}
+
+		const Record &record = records[i];
+		bool ok;
+		if (format_ == RecorderFormat::CSV) {
+			const int size = fprintf(file_, "%.6f,%u,%.12g\n", record.timestamp,
+				record.signal_index, record.value);
+			ok = size > 0;
+			if (ok)
+				file_size_ += size;
+		}
+		else {
+			ok = fwrite(&record.signal_index,
+					sizeof(record.signal_index), 1, file_) == 1 &&
+				fwrite(&record.timestamp, sizeof(record.timestamp), 1, file_) == 1 &&
+				fwrite(&record.value, sizeof(record.value), 1, file_) == 1;
+			if (ok) {
+				file_size_ += sizeof(record.signal_index) +
+					sizeof(record.timestamp) + sizeof(record.value);
+			}
+		}
+
+		if (!ok) {
+			qWarning() << "SignalRecorder: Could not write to file" <<
+				QString::fromStdString(file_name());
+			Q_EMIT write_error(tr("Could not write to file %1").
+				arg(QString::fromStdString(file_name())));
+			dropped_sample_count_ += records.size() - i;
+			// Continue with a new file with the next batch.
+			fclose(file_);
+			file_ = nullptr;
+			return;
+		}
+		++recorded_sample_count_;
+		unsynced_ = true;
+	}
+}
+
+void SignalRecorder::sync_file()
+{
+	if (!file_ || !unsynced_)
+		return;
+
+	fflush(file_);
+#ifdef _WIN32
+	_commit(_fileno(file_));
+#else
+	fsync(fileno(file_));
+#endif
+	unsynced_ = false;
+	last_sync_time_ = steady_clock::now();
+}
+
+} // namespace data
+} // namespace sv
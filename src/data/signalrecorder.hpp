@@ -0,0 +1,168 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SIGNALRECORDER_HPP
+#define DATA_SIGNALRECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QMetaObject>
+#include <QObject>
+#include <QString>
+
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+enum class RecorderFormat {
+	/**
+	 * One line per sample: "timestamp,signal index,value". The signals are
+	 * listed in the comment lines of the file header.
+	 */
+	CSV,
+	/**
+	 * Header: "SVREC001", uint32 signal count and for each signal the
+	 * uint32 length prefixed UTF-8 name and unit. Records: uint32 signal
+	 * index, double timestamp, double value (host byte order).
+	 */
+	Binary,
+};
+
+/**
+ * The SignalRecorder appends the samples of the added signals to disk, as
+ * they arrive. The new samples are only copied in the thread that appends
+ * them to the signal; formatting, writing and syncing happen in the writer
+ * thread. Files are rotated by size and/or time, every file is self
+ * contained (with header).
+ *
+ * The recorder must be owned by a shared_ptr.
+ */
+class SignalRecorder :
+	public QObject,
+	public std::enable_shared_from_this<SignalRecorder>
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * The files are named <base_file_name>_<number>.<csv|svrec>.
+	 */
+	SignalRecorder(const string &base_file_name, RecorderFormat format);
+	~SignalRecorder();
+
+	/**
+	 * Add a signal. When the recorder is running, a new file is started with
+	 * the next sample of the new signal, so the header lists all signals.
+	 */
+	void add_signal(shared_ptr<AnalogTimeSignal> signal);
+	vector<shared_ptr<AnalogTimeSignal>> signals() const;
+
+	/** Rotate when the file size exceeds the size in bytes. 0 = never. */
+	void set_rotation_size(uint64_t rotation_size);
+	/** Rotate when the file is older than the time in seconds. 0 = never. */
+	void set_rotation_time(double rotation_time);
+	/** Flush and sync the file to disk at most every interval seconds. */
+	void set_sync_interval(double sync_interval);
+
+	/**
+	 * Start recording. Only samples that are appended after the start are
+	 * recorded.
+	 */
+	bool start();
+	/** Stop recording, write all pending samples and close the file. */
+	void stop();
+	bool is_running() const;
+
+	string file_name() const;
+	uint64_t recorded_sample_count() const;
+	/** Number of samples that couldn't be written. */
+	uint64_t dropped_sample_count() const;
+
+private:
+	struct Record {
+		uint32_t signal_index;
+		double timestamp;
+		double value;
+	};
+
+	void on_sample_appended(size_t signal_index);
+	void writer_thread_proc();
+	bool open_file();
+	void close_file();
+	void write_header();
+	void write_records(const vector<Record> &records);
+	void sync_file();
+
+	string base_file_name_;
+	RecorderFormat format_;
+	vector<shared_ptr<AnalogTimeSignal>> signals_;
+	vector<size_t> signal_pos_;
+	vector<QMetaObject::Connection> signal_connections_;
+	uint64_t rotation_size_;
+	double rotation_time_;
+	double sync_interval_;
+
+	mutable mutex mutex_;
+	std::condition_variable cv_;
+	vector<Record> pending_records_;
+	std::atomic<bool> is_running_;
+	bool stop_;
+	std::thread writer_thread_;
+
+	// Only used by the writer thread (and start()/stop())
+	FILE *file_;
+	string file_name_;
+	unsigned int file_number_;
+	uint64_t file_size_;
+	/** Number of signals in the header of the actual file. */
+	size_t header_signal_count_;
+	std::chrono::steady_clock::time_point file_open_time_;
+	std::chrono::steady_clock::time_point last_sync_time_;
+	bool unsynced_;
+
+	std::atomic<uint64_t> recorded_sample_count_;
+	std::atomic<uint64_t> dropped_sample_count_;
+
+Q_SIGNALS:
+	/** Is emitted from the writer thread when a new file was opened. */
+	void file_opened(const QString &file_name);
+	/** Is emitted from the writer thread when writing has failed. */
+	void write_error(const QString &message);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SIGNALRECORDER_HPP
@@ -18,18 +18,26 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 
 #include <glib.h>
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
 #include <QApplication>
+#include <QCoreApplication>
 #include <QDebug>
 #include <QObject>
 #include <QProgressDialog>
@@ -43,14 +51,24 @@
 #include "src/devices/sourcesinkdevice.hpp"
 
 using std::bind;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::steady_clock;
+using std::condition_variable;
 using std::list;
+using std::lock_guard;
+using std::make_pair;
+using std::make_shared;
 using std::map;
 using std::multimap;
+using std::mutex;
 using std::pair;
 using std::placeholders::_1;
 using std::placeholders::_2;
+using std::set;
 using std::shared_ptr;
 using std::string;
+using std::unique_lock;
 using std::unique_ptr;
 using std::vector;
 
@@ -58,17 +76,108 @@ using Glib::VariantBase;
 
 namespace sv {
 
-DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
-		vector<string> drivers, bool do_scan) :
-	context_(context)
+/**
+ * The drivers with a running scan. Two concurrent scans of the same driver
+ * must not overlap, so a driver with an abandoned scan isn't scanned again
+ * until the abandoned scan has returned.
+ */
+struct ScanningDrivers
 {
-	unique_ptr<QProgressDialog> progress(new QProgressDialog("",
-		QObject::tr("Cancel"), 0, context->drivers().size() + 1));
-	progress->setWindowModality(Qt::WindowModal);
-	progress->setMinimumDuration(1);  // To show the dialog immediately
+	mutex mtx;
+	set<sigrok::Driver *> drivers;
+};
 
-	int entry_num = 1;
+namespace {
 
+/** How long to wait for abandoned scans when the DeviceManager is destroyed. */
+const auto abandoned_scan_join_timeout = std::chrono::seconds(2);
+
+bool begin_driver_scan(ScanningDrivers &scanning_drivers,
+	shared_ptr<sigrok::Driver> sr_driver)
+{
+	lock_guard<mutex> lock(scanning_drivers.mtx);
+	if (!scanning_drivers.drivers.insert(sr_driver.get()).second) {
+		qWarning() << "Driver" << QString::fromStdString(sr_driver->name()) <<
+			"is still scanning";
+		return false;
+	}
+	return true;
+}
+
+void end_driver_scan(ScanningDrivers &scanning_drivers,
+	shared_ptr<sigrok::Driver> sr_driver)
+{
+	lock_guard<mutex> lock(scanning_drivers.mtx);
+	scanning_drivers.drivers.erase(sr_driver.get());
+}
+
+struct DriverScan
+{
+	driver_scan_request_t request;
+	vector<shared_ptr<sigrok::HardwareDevice>> sr_devices;
+	bool started;
+	bool finished;
+	steady_clock::time_point start_time;
+};
+
+} // namespace
+
+/**
+ * The state of a parallel driver scan, shared between the calling thread and
+ * the worker threads. Abandoned workers may outlive the call.
+ */
+struct DriverScanState
+{
+	mutex mtx;
+	condition_variable cv;
+	vector<DriverScan> scans;
+	size_t next_scan;
+	size_t running_workers;
+	bool canceled;
+	shared_ptr<ScanningDrivers> scanning_drivers;
+};
+
+namespace {
+
+void driver_scan_thread_proc(shared_ptr<DriverScanState> state)
+{
+	unique_lock<mutex> lock(state->mtx);
+	while (!state->canceled && state->next_scan < state->scans.size()) {
+		size_t i = state->next_scan++;
+		state->scans[i].started = true;
+		state->scans[i].start_time = steady_clock::now();
+		driver_scan_request_t request = state->scans[i].request;
+		lock.unlock();
+
+		vector<shared_ptr<sigrok::HardwareDevice>> sr_devices;
+		try {
+			sr_devices = request.first->scan(request.second);
+		}
+		catch (const std::exception &e) {
+			qWarning() << "Scan with driver" <<
+				QString::fromStdString(request.first->name()) <<
+				"failed:" << e.what();
+		}
+		end_driver_scan(*state->scanning_drivers, request.first);
+
+		lock.lock();
+		state->scans[i].sr_devices = sr_devices;
+		state->scans[i].finished = true;
+		state->cv.notify_all();
+	}
+	--state->running_workers;
+	state->cv.notify_all();
+}
+
+} // namespace
+
+DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
+		vector<string> drivers, bool do_scan) :
+	context_(context),
+	scan_timeout_(15.),
+	scan_thread_count_(8),
+	scanning_drivers_(make_shared<ScanningDrivers>())
+{
 	/*
 	 * Check the presence of optional user specs for device scans.
 	 * Determine the driver names and options (in generic format) when
@@ -90,6 +199,7 @@ DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
 	 * Scan for devices. No specific options apply here, this is
 	 * best effort auto detection.
 	 */
+	vector<driver_scan_request_t> requests;
 	for (const auto &entry : context->drivers()) {
 		if (!do_scan)
 			break;
@@ -97,18 +207,11 @@ DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
 		// Skip drivers we won't scan anyway
 		if (!devices::deviceutil::is_supported_driver(entry.second))
 			continue;
-
-		progress->setLabelText(QObject::tr("Scanning for %1...")
-			.arg(QString::fromStdString(entry.first)));
-
 		if (user_drvs_name_opts.count(entry.first) > 0)
 			continue;
-		driver_scan(entry.second, map<const sigrok::ConfigKey *, VariantBase>());
 
-		progress->setValue(entry_num++);
-		QApplication::processEvents();
-		if (progress->wasCanceled())
-			break;
+		requests.push_back(driver_scan_request_t(entry.second,
+			map<const sigrok::ConfigKey *, VariantBase>()));
 	}
 
 	/*
@@ -119,22 +222,81 @@ DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
 	 * prefer one out of multiple found devices, and have this
 	 * device pre-selected for new sessions upon user's request.
 	 */
+	vector<shared_ptr<sigrok::Driver>> user_spec_drivers;
+	for (auto it = user_drvs_name_opts.begin(), end = user_drvs_name_opts.end();
+		it != end;
+		it = user_drvs_name_opts.upper_bound(it->first)) {
+
+		driver_scan_request_t request =
+			driver_scan_request(it->first, it->second);
+		if (!request.first)
+			continue;
+		requests.push_back(request);
+		user_spec_drivers.push_back(request.first);
+	}
+
+	/*
+	 * All drivers are scanned concurrently, so the startup time is bound by
+	 * the slowest driver and not by the sum of all drivers.
+	 */
+	unique_ptr<QProgressDialog> progress;
+	// No progress dialog in headless mode (without a QApplication).
+	if (qobject_cast<QApplication *>(QCoreApplication::instance())) {
+		progress.reset(new QProgressDialog(
+			QObject::tr("Scanning for devices..."),
+			QObject::tr("Cancel"), 0, (int)requests.size()));
+		progress->setWindowModality(Qt::WindowModal);
+		progress->setMinimumDuration(1);  // To show the dialog immediately
+	}
+
+	size_t found_count = 0;
+	auto found_devices = parallel_driver_scan(requests,
+		[&](size_t finished, size_t total, shared_ptr<sigrok::Driver> driver,
+				list<shared_ptr<devices::HardwareDevice>> devices) {
+			if (!progress)
+				return true;
+			if (driver) {
+				found_count += devices.size();
+				progress->setLabelText(QObject::tr(
+					"Scanning for devices (%1 of %2 drivers done, "
+					"%3 devices found)...").
+					arg(finished).arg(total).arg(found_count));
+				progress->setValue((int)finished);
+			}
+			QApplication::processEvents();
+			return !progress->wasCanceled();
+		});
+
 	user_spec_devices_.clear();
- 	if (!drivers.empty() && !user_drvs_name_opts.empty()) {
-		for( auto it = user_drvs_name_opts.begin(), end = user_drvs_name_opts.end();
-			it != end;
- 			it = user_drvs_name_opts.upper_bound(it->first)) {
-
-			auto user_drv_name = it->first;
-			auto user_drv_opts = it->second;
-
-			list< shared_ptr<devices::HardwareDevice> > found =
-				driver_scan(user_drv_name, user_drv_opts);
-			if (!found.empty())
-				user_spec_devices_.push_back(found.front());
+	for (const auto &driver : user_spec_drivers) {
+		const auto &found = found_devices[driver];
+		if (!found.empty())
+			user_spec_devices_.push_back(found.front());
+	}
+	if (progress)
+		progress->setValue((int)requests.size());
+}
+
+DeviceManager::~DeviceManager()
+{
+	// Wait for abandoned scans, they are still using the sigrok context. A
+	// scan that hangs forever must not block the exit, so its workers are
+	// detached after the timeout.
+	const auto deadline = steady_clock::now() + abandoned_scan_join_timeout;
+	for (auto &abandoned_scan : abandoned_scans_) {
+		auto state = abandoned_scan.first;
+		unique_lock<mutex> lock(state->mtx);
+		const bool finished = state->cv.wait_until(lock, deadline,
+			[state]() { return state->running_workers == 0; });
+		lock.unlock();
+
+		for (auto &thread : abandoned_scan.second) {
+			if (finished)
+				thread.join();
+			else
+				thread.detach();
 		}
 	}
-	progress->setValue(entry_num++);
 }
 
 const shared_ptr<sigrok::Context>& DeviceManager::context() const
@@ -212,8 +374,7 @@ DeviceManager::driver_scan_options(vector<string> user_spec,
 	return result;
 }
 
-list<shared_ptr<devices::HardwareDevice>>
-DeviceManager::driver_scan(
+driver_scan_request_t DeviceManager::driver_scan_request(
 	string driver_name, vector<string> driver_opts)
 {
 	shared_ptr<sigrok::Driver> scan_drv;
@@ -235,13 +396,23 @@ DeviceManager::driver_scan(
 		scan_opts = driver_scan_options(driver_opts, drv_opts);
 	}
 
+	return driver_scan_request_t(scan_drv, scan_opts);
+}
+
+list<shared_ptr<devices::HardwareDevice>>
+DeviceManager::driver_scan(
+	string driver_name, vector<string> driver_opts)
+{
+	driver_scan_request_t request =
+		driver_scan_request(driver_name, driver_opts);
+
 	/*
 	 * Run another scan for the specified driver, passing
 	 * user provided scan options this time.
 	 */
 	list<shared_ptr<devices::HardwareDevice>> found;
-	if (scan_drv)
-		found = driver_scan(scan_drv, scan_opts);
+	if (request.first)
+		found = driver_scan(request.first, request.second);
 
 	return found;
 }
@@ -257,15 +428,185 @@ DeviceManager::driver_scan(
 
 	if (!devices::deviceutil::is_supported_driver(sr_driver))
 		return driver_devices;
+	if (!begin_driver_scan(*scanning_drivers_, sr_driver))
+		return driver_devices;
+
+	// Do the scan
+	vector<shared_ptr<sigrok::HardwareDevice>> sr_devices;
+	try {
+		sr_devices = sr_driver->scan(drvopts);
+	}
+	catch (...) {
+		end_driver_scan(*scanning_drivers_, sr_driver);
+		throw;
+	}
+	end_driver_scan(*scanning_drivers_, sr_driver);
+
+	return add_scanned_devices(sr_driver, sr_devices);
+}
+
+map<shared_ptr<sigrok::Driver>, list<shared_ptr<devices::HardwareDevice>>>
+DeviceManager::parallel_driver_scan(vector<driver_scan_request_t> requests,
+	driver_scan_callback_t callback)
+{
+	map<shared_ptr<sigrok::Driver>, list<shared_ptr<devices::HardwareDevice>>>
+		found_devices;
+
+	auto state = make_shared<DriverScanState>();
+	state->next_scan = 0;
+	state->running_workers = 0;
+	state->canceled = false;
+	state->scanning_drivers = scanning_drivers_;
+	for (const auto &request : requests) {
+		if (!request.first ||
+				!devices::deviceutil::is_supported_driver(request.first))
+			continue;
+		// Don't overlap with a running (abandoned) scan of the same driver.
+		if (!begin_driver_scan(*scanning_drivers_, request.first))
+			continue;
+		DriverScan scan;
+		scan.request = request;
+		scan.started = false;
+		scan.finished = false;
+		state->scans.push_back(scan);
+	}
+	const size_t scan_count = state->scans.size();
+	if (scan_count == 0)
+		return found_devices;
+
+	vector<std::thread> threads;
+	const size_t thread_count = std::max((size_t)1,
+		std::min((size_t)scan_thread_count_, scan_count));
+	state->running_workers = thread_count;
+	for (size_t i = 0; i < thread_count; ++i)
+		threads.push_back(std::thread(driver_scan_thread_proc, state));
+
+	const auto timeout = duration_cast<steady_clock::duration>(
+		duration<double>(scan_timeout_));
+	vector<bool> handled(scan_count, false);
+	size_t handled_count = 0;
+	size_t reported_count = 0;
+	bool all_finished = true;
+
+	unique_lock<mutex> lock(state->mtx);
+	while (handled_count < scan_count && !state->canceled) {
+		state->cv.wait_for(lock, std::chrono::milliseconds(50));
+
+		// Collect the finished and the timed out scans.
+		vector<pair<shared_ptr<sigrok::Driver>,
+			vector<shared_ptr<sigrok::HardwareDevice>>>> finished_scans;
+		const steady_clock::time_point now = steady_clock::now();
+		for (size_t i = 0; i < scan_count; ++i) {
+			const DriverScan &scan = state->scans[i];
+			if (handled[i] || !scan.started)
+				continue;
+			if (scan.finished) {
+				finished_scans.push_back(
+					make_pair(scan.request.first, scan.sr_devices));
+			}
+			else if (scan_timeout_ > 0. && now - scan.start_time > timeout) {
+				qWarning() << "Scan with driver" <<
+					QString::fromStdString(scan.request.first->name()) <<
+					"timed out";
+				finished_scans.push_back(make_pair(scan.request.first,
+					vector<shared_ptr<sigrok::HardwareDevice>>()));
+				all_finished = false;
+				// The abandoned worker is blocked, so start a new worker for
+				// the queued scans.
+				if (state->next_scan < scan_count) {
+					++state->running_workers;
+					threads.push_back(
+						std::thread(driver_scan_thread_proc, state));
+				}
+			}
+			else {
+				continue;
+			}
+			handled[i] = true;
+			++handled_count;
+		}
+		lock.unlock();
+
+		// Add the devices and report them in the calling thread.
+		bool proceed = true;
+		for (const auto &finished_scan : finished_scans) {
+			auto devices = add_scanned_devices(
+				finished_scan.first, finished_scan.second);
+			found_devices[finished_scan.first] = devices;
+			++reported_count;
+			if (callback)
+				proceed = callback(reported_count, scan_count,
+					finished_scan.first, devices) && proceed;
+		}
+		if (callback && finished_scans.empty())
+			proceed = callback(reported_count, scan_count, nullptr,
+				list<shared_ptr<devices::HardwareDevice>>());
+
+		lock.lock();
+		if (!proceed) {
+			state->canceled = true;
+			for (size_t i = 0; i < scan_count; ++i) {
+				if (state->scans[i].started && !state->scans[i].finished)
+					all_finished = false;
+			}
+		}
+	}
+	// The queued scans of a canceled scan will never start.
+	for (size_t i = state->next_scan; i < scan_count; ++i)
+		end_driver_scan(*scanning_drivers_, state->scans[i].request.first);
+	state->next_scan = scan_count;
+	lock.unlock();
+
+	if (all_finished) {
+		for (auto &thread : threads)
+			thread.join();
+	}
+	else {
+		// Don't block on abandoned scans, join them in the destructor.
+		abandoned_scans_.push_back(make_pair(state, std::move(threads)));
+	}
+
+	return found_devices;
+}
+
+void DeviceManager::set_scan_timeout(double scan_timeout)
+{
+	scan_timeout_ = scan_timeout;
+}
+
+double DeviceManager::scan_timeout() const
+{
+	return scan_timeout_;
+}
+
+void DeviceManager::set_scan_thread_count(unsigned int scan_thread_count)
+{
+	scan_thread_count_ = scan_thread_count;
+}
+
+unsigned int DeviceManager::scan_thread_count() const
+{
+	return scan_thread_count_;
+}
+
+bool DeviceManager::is_driver_scanning(
+	shared_ptr<sigrok::Driver> sr_driver) const
+{
+	lock_guard<mutex> lock(scanning_drivers_->mtx);
+	return scanning_drivers_->drivers.count(sr_driver.get()) > 0;
+}
+
+list<shared_ptr<devices::HardwareDevice>> DeviceManager::add_scanned_devices(
+	shared_ptr<sigrok::Driver> sr_driver,
+	vector<shared_ptr<sigrok::HardwareDevice>> sr_devices)
+{
+	list< shared_ptr<devices::HardwareDevice> > driver_devices;
 
 	// Remove any device instances from this driver from the device
 	// list. They will not be valid after the scan.
 	devices_.remove_if([&](shared_ptr<devices::HardwareDevice> device) {
 		return device->sr_hardware_device()->driver() == sr_driver; });
 
-	// Do the scan
-	auto sr_devices = sr_driver->scan(drvopts);
-
 	// Add the scanned devices to the main list, set display names and sort.
 	for (const auto &sr_device : sr_devices) {
 		if (devices::deviceutil::is_source_sink_driver(sr_driver)) {
@@ -21,15 +21,20 @@
 #ifndef DEVICEMANAGER_HPP
 #define DEVICEMANAGER_HPP
 
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+using std::function;
 using std::list;
 using std::map;
+using std::pair;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -43,6 +48,7 @@ namespace sigrok {
 class ConfigKey;
 class Context;
 class Driver;
+class HardwareDevice;
 }
 
 namespace sv {
@@ -53,6 +59,24 @@ class HardwareDevice;
 }
 
 class Session;
+struct DriverScanState;
+struct ScanningDrivers;
+
+/**
+ * A driver scan request: The driver and the scan options.
+ */
+typedef pair<shared_ptr<sigrok::Driver>,
+	map<const sigrok::ConfigKey *, Glib::VariantBase>> driver_scan_request_t;
+
+/**
+ * Is called by DeviceManager::parallel_driver_scan() in the calling thread
+ * with the number of finished scans, the number of all scans, the driver and
+ * the devices found by the driver. While waiting for the scans, it is also
+ * called periodically with a nullptr driver (e.g. to process GUI events).
+ * Return false to cancel the remaining scans.
+ */
+typedef function<bool(size_t, size_t, shared_ptr<sigrok::Driver>,
+	list<shared_ptr<devices::HardwareDevice>>)> driver_scan_callback_t;
 
 class DeviceManager
 {
@@ -61,7 +85,7 @@ public:
 	DeviceManager(shared_ptr<sigrok::Context> context,
 		vector<std::string> drivers, bool do_scan);
 
-	~DeviceManager() = default;
+	~DeviceManager();
 
 	const shared_ptr<sigrok::Context> &context() const;
 
@@ -77,6 +101,27 @@ public:
 		shared_ptr<sigrok::Driver> sr_driver,
 		map<const sigrok::ConfigKey *, Glib::VariantBase> drvopts);
 
+	/**
+	 * Scan with multiple drivers concurrently in a pool of worker threads.
+	 * The found devices are added in the calling thread as soon as a driver
+	 * has finished. A scan that takes longer than the scan timeout is
+	 * abandoned and its devices are discarded; a new worker takes over the
+	 * remaining scans. Drivers that are still scanning (e.g. an abandoned
+	 * scan) are not scanned again.
+	 */
+	map<shared_ptr<sigrok::Driver>, list<shared_ptr<devices::HardwareDevice>>>
+	parallel_driver_scan(vector<driver_scan_request_t> requests,
+		driver_scan_callback_t callback);
+
+	/** Set the timeout of a single driver scan in seconds. 0 = no timeout. */
+	void set_scan_timeout(double scan_timeout);
+	double scan_timeout() const;
+	/** Set the max. number of concurrent driver scans. */
+	void set_scan_thread_count(unsigned int scan_thread_count);
+	unsigned int scan_thread_count() const;
+	/** Return true, if a scan of the driver is running (or abandoned). */
+	bool is_driver_scanning(shared_ptr<sigrok::Driver> sr_driver) const;
+
 	const map<string, string> get_device_info(
 		const shared_ptr<devices::BaseDevice> device);
 
@@ -91,10 +136,31 @@ private:
 	driver_scan_options(vector<string> user_spec,
 		set<const sigrok::ConfigKey *> driver_opts);
 
+	/**
+	 * Convert the driver name and the generic driver options into a scan
+	 * request. The driver of the request is nullptr for unknown drivers.
+	 */
+	driver_scan_request_t driver_scan_request(
+		string driver_name, vector<string> driver_opts);
+
+	/**
+	 * Replace the devices of the driver with the scanned devices.
+	 */
+	list<shared_ptr<devices::HardwareDevice>> add_scanned_devices(
+		shared_ptr<sigrok::Driver> sr_driver,
+		vector<shared_ptr<sigrok::HardwareDevice>> sr_devices);
+
 protected:
 	shared_ptr<sigrok::Context> context_;
 	list<shared_ptr<devices::HardwareDevice>> devices_;
 	list<shared_ptr<devices::HardwareDevice>> user_spec_devices_;
+	double scan_timeout_;
+	unsigned int scan_thread_count_;
+	/** The drivers with a running scan, shared with the worker threads. */
+	shared_ptr<ScanningDrivers> scanning_drivers_;
+	/** Parallel scans with abandoned (timed out) workers. */
+	list<pair<shared_ptr<DriverScanState>, vector<std::thread>>>
+		abandoned_scans_;
 
 };
 
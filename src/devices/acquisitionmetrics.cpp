@@ -0,0 +1,199 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "acquisitionmetrics.hpp"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+using std::lock_guard;
+using std::memory_order_relaxed;
+
+namespace sv {
+namespace devices {
+
+const size_t LatencyHistogram::bucket_count;
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+void LatencyHistogram::add(steady_clock::duration latency)
+{
+	int64_t us = duration_cast<microseconds>(latency).count();
+	uint64_t value = us > 0 ? (uint64_t)us : 0;
+
+	size_t bucket = 0;
+	for (uint64_t v = value; v > 1 && bucket < bucket_count - 1; v >>= 1)
+		++bucket;
+
+	buckets_[bucket].fetch_add(1, memory_order_relaxed);
+	count_.fetch_add(1, memory_order_relaxed);
+	sum_.fetch_add(value, memory_order_relaxed);
+	uint64_t max = max_.load(memory_order_relaxed);
+	while (value > max &&
+		!max_.compare_exchange_weak(max, value, memory_order_relaxed)) {
+	}
+}
+
+void LatencyHistogram::reset()
+{
+	for (auto &bucket : buckets_)
+		bucket.store(0, memory_order_relaxed);
+	count_.store(0, memory_order_relaxed);
+	sum_.store(0, memory_order_relaxed);
+	max_.store(0, memory_order_relaxed);
+}
+
+LatencyStats LatencyHistogram::stats() const
+{
+	// The buckets are read one by one, so they may not add up exactly to the
+	// count, while new values are added. That's good enough for statistics.
+	std::array<uint64_t, bucket_count> buckets;
+	uint64_t total = 0;
+	for (size_t i = 0; i < bucket_count; ++i) {
+		buckets[i] = buckets_[i].load(memory_order_relaxed);
+		total += buckets[i];
+	}
+
+	LatencyStats stats;
+	stats.count = count_.load(memory_order_relaxed);
+	stats.max = (double)max_.load(memory_order_relaxed);
+	stats.mean = stats.count > 0 ?
+		sum_.load(memory_order_relaxed) / (double)stats.count : 0.;
+
+	// The percentiles are the upper bound of the bucket, that contains them.
+	auto percentile = [&](double p) {
+		uint64_t rank = (uint64_t)(p * total);
+		uint64_t sum = 0;
+		for (size_t i = 0; i < bucket_count; ++i) {
+			sum += buckets[i];
+			if (sum > rank)
+				return std::min((double)((uint64_t)2 << i), stats.max);
+		}
+		return stats.max;
+	};
+	stats.p50 = total > 0 ? percentile(0.5) : 0.;
+	stats.p99 = total > 0 ? percentile(0.99) : 0.;
+
+	return stats;
+}
+
+AcquisitionMetrics::AcquisitionMetrics() :
+	packet_count_(0),
+	sample_count_(0),
+	pending_arrival_(0),
+	rate_time_(steady_clock::now()),
+	rate_packet_count_(0),
+	rate_sample_count_(0),
+	packet_rate_(0.),
+	sample_rate_(0.)
+{
+}
+
+void AcquisitionMetrics::add_packet(metrics_time_point_t arrival_time,
+	bool has_samples)
+{
+	packet_count_.fetch_add(1, memory_order_relaxed);
+	if (!has_samples)
+		return;
+
+	// Only the oldest packet, that isn't on screen yet, is tracked.
+	int64_t expected = 0;
+	pending_arrival_.compare_exchange_strong(
+		expected, to_ticks(arrival_time), memory_order_relaxed);
+}
+
+void AcquisitionMetrics::add_samples(uint64_t samples)
+{
+	sample_count_.fetch_add(samples, memory_order_relaxed);
+}
+
+void AcquisitionMetrics::add_ingest_latency(steady_clock::duration latency)
+{
+	ingest_latency_.add(latency);
+}
+
+void AcquisitionMetrics::mark_displayed()
+{
+	int64_t arrival = pending_arrival_.exchange(0, memory_order_relaxed);
+	if (arrival == 0)
+		return;
+	display_latency_.add(steady_clock::duration(
+		to_ticks(steady_clock::now()) - arrival));
+}
+
+void AcquisitionMetrics::reset()
+{
+	packet_count_.store(0, memory_order_relaxed);
+	sample_count_.store(0, memory_order_relaxed);
+	pending_arrival_.store(0, memory_order_relaxed);
+	ingest_latency_.reset();
+	display_latency_.reset();
+
+	lock_guard<mutex> lock(rate_mutex_);
+	rate_time_ = steady_clock::now();
+	rate_packet_count_ = 0;
+	rate_sample_count_ = 0;
+	packet_rate_ = 0.;
+	sample_rate_ = 0.;
+}
+
+AcquisitionStats AcquisitionMetrics::stats()
+{
+	AcquisitionStats stats;
+	stats.packet_count = packet_count_.load(memory_order_relaxed);
+	stats.sample_count = sample_count_.load(memory_order_relaxed);
+	stats.ingest_latency = ingest_latency_.stats();
+	stats.display_latency = display_latency_.stats();
+
+	// The rates are recalculated at most once per second, so they don't
+	// jitter when the stats are polled often.
+	lock_guard<mutex> lock(rate_mutex_);
+	steady_clock::time_point now = steady_clock::now();
+	double elapsed = duration<double>(now - rate_time_).count();
+	if (elapsed >= 1.) {
+		packet_rate_ = (stats.packet_count - rate_packet_count_) / elapsed;
+		sample_rate_ = (stats.sample_count - rate_sample_count_) / elapsed;
+		rate_time_ = now;
+		rate_packet_count_ = stats.packet_count;
+		rate_sample_count_ = stats.sample_count;
+	}
+	stats.packet_rate = packet_rate_;
+	stats.sample_rate = sample_rate_;
+
+	return stats;
+}
+
+int64_t AcquisitionMetrics::to_ticks(metrics_time_point_t time_point)
+{
+	// The steady clock never returns the epoch, 0 can mark "no packet".
+	return std::max<int64_t>(time_point.time_since_epoch().count(), 1);
+}
+
+} // namespace devices
+} // namespace sv
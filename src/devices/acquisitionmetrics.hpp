@@ -0,0 +1,138 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_ACQUISITIONMETRICS_HPP
+#define DEVICES_ACQUISITIONMETRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+using std::mutex;
+
+namespace sv {
+namespace devices {
+
+typedef std::chrono::steady_clock::time_point metrics_time_point_t;
+
+/**
+ * Statistics of a latency histogram. All values are in µs, the percentiles
+ * are estimated from the histogram buckets.
+ */
+struct LatencyStats
+{
+	uint64_t count;
+	double mean;
+	double max;
+	double p50;
+	double p99;
+};
+
+/**
+ * A lock free latency histogram with logarithmic (power of 2) buckets in µs.
+ * Adding a value only costs a few relaxed atomic increments, so it can be
+ * used on the acquisition hot path.
+ */
+class LatencyHistogram
+{
+
+public:
+	LatencyHistogram();
+
+	void add(std::chrono::steady_clock::duration latency);
+	void reset();
+	LatencyStats stats() const;
+
+	/** Bucket i counts the latencies in [2^i, 2^(i+1)) µs. */
+	static const size_t bucket_count = 24;
+
+private:
+	std::array<std::atomic<uint64_t>, bucket_count> buckets_;
+	std::atomic<uint64_t> count_;
+	std::atomic<uint64_t> sum_;
+	std::atomic<uint64_t> max_;
+
+};
+
+/** A snapshot of the acquisition metrics of a device. */
+struct AcquisitionStats
+{
+	uint64_t packet_count;
+	uint64_t sample_count;
+	/** Packets per second, averaged over the last second. */
+	double packet_rate;
+	/** Samples per second, averaged over the last second. */
+	double sample_rate;
+	/** Time spent in the data feed per analog packet. */
+	LatencyStats ingest_latency;
+	/** Time from the packet arrival until the packet is on screen. */
+	LatencyStats display_latency;
+};
+
+/**
+ * The AcquisitionMetrics collect counters and latency histograms of the
+ * acquisition pipeline of a device. The counters are updated from the
+ * acquisition thread with relaxed atomics and can be read from any thread.
+ */
+class AcquisitionMetrics
+{
+
+public:
+	AcquisitionMetrics();
+
+	/** Count a received packet. Called from the acquisition thread. */
+	void add_packet(metrics_time_point_t arrival_time, bool has_samples);
+	/** Count received samples. Called from the acquisition thread. */
+	void add_samples(uint64_t samples);
+	/** Record the time that was needed to process a packet. */
+	void add_ingest_latency(std::chrono::steady_clock::duration latency);
+	/**
+	 * Record the display latency of the oldest packet, that wasn't on screen
+	 * yet. Called from the GUI thread after the displays have been updated.
+	 */
+	void mark_displayed();
+	void reset();
+
+	AcquisitionStats stats();
+
+private:
+	static int64_t to_ticks(metrics_time_point_t time_point);
+
+	std::atomic<uint64_t> packet_count_;
+	std::atomic<uint64_t> sample_count_;
+	/** Arrival time of the oldest undisplayed packet, 0 if there is none. */
+	std::atomic<int64_t> pending_arrival_;
+	LatencyHistogram ingest_latency_;
+	LatencyHistogram display_latency_;
+
+	mutex rate_mutex_;
+	metrics_time_point_t rate_time_;
+	uint64_t rate_packet_count_;
+	uint64_t rate_sample_count_;
+	double packet_rate_;
+	double sample_rate_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_ACQUISITIONMETRICS_HPP
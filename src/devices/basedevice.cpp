@@ -19,6 +19,7 @@
  */
 
 #include <cassert>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -33,13 +34,17 @@
 
 #include "basedevice.hpp"
 #include "src/session.hpp"
+#include "src/tracer.hpp"
 #include "src/util.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/hardwarechannel.hpp"
 #include "src/channels/mathchannel.hpp"
 #include "src/channels/userchannel.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/devices/acquisitionmetrics.hpp"
+#include "src/devices/commandqueue.hpp"
 #include "src/devices/configurable.hpp"
+#include "src/devices/limitengine.hpp"
 
 #define USER_CHANNEL_START_INDEX 1000
 #define CONFIGURABLE_START_INDEX 5000
@@ -80,6 +85,10 @@ BaseDevice::BaseDevice(const shared_ptr<sigrok::Context> sr_context,
 	 *       CSV, XY-Plots) can be displayed with relative timestamps.
 	 */
 	aquisition_start_timestamp_ = sv::Session::session_start_timestamp;
+
+	limit_engine_ = make_shared<LimitEngine>();
+	command_queue_ = make_shared<CommandQueue>();
+	metrics_ = make_shared<AcquisitionMetrics>();
 }
 
 BaseDevice::~BaseDevice()
@@ -284,6 +293,21 @@ vector<shared_ptr<data::BaseSignal>> BaseDevice::signals() const
 	return signals;
 }
 
+shared_ptr<LimitEngine> BaseDevice::limit_engine() const
+{
+	return limit_engine_;
+}
+
+shared_ptr<CommandQueue> BaseDevice::command_queue() const
+{
+	return command_queue_;
+}
+
+shared_ptr<AcquisitionMetrics> BaseDevice::metrics() const
+{
+	return metrics_;
+}
+
 unsigned int BaseDevice::next_channel_index()
 {
 	return next_channel_index_++;
@@ -348,10 +372,7 @@ void BaseDevice::add_math_channel(
 	 * TODO: Remove shared_from_this() / (channel pointer in signal), so that
 	 *       "add_signal()" can be called from MathChannel ctor.
 	 */
-	math_channel->add_signal(
-		math_channel->quantity(),
-		math_channel->quantity_flags(),
-		math_channel->unit());
+	math_channel->init_signals();
 }
 
 shared_ptr<channels::UserChannel> BaseDevice::add_user_channel(
@@ -394,6 +415,11 @@ void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 	if (sr_device != sr_device_)
 		return;
 
+	const metrics_time_point_t arrival_time = std::chrono::steady_clock::now();
+	metrics_->add_packet(arrival_time,
+		sr_packet->type()->id() == SR_DF_ANALOG &&
+		aquisition_state_ == AquisitionState::Running);
+
 	switch (sr_packet->type()->id()) {
 	case SR_DF_HEADER:
 		//qWarning() << "data_feed_in(): SR_DF_HEADER";
@@ -430,11 +456,14 @@ void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 			return;
 
 		try {
+			SV_TRACE_SCOPE("acquisition", "feed_in_analog");
 			feed_in_analog(
 				dynamic_pointer_cast<sigrok::Analog>(sr_packet->payload()));
 		} catch (bad_alloc &) {
 			//out_of_memory_ = true;
 		}
+		metrics_->add_ingest_latency(
+			std::chrono::steady_clock::now() - arrival_time);
 		break;
 
 	case SR_DF_FRAME_BEGIN:
@@ -464,6 +493,8 @@ void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 
 void BaseDevice::aquisition_thread_proc()
 {
+	Tracer::set_thread_name("Acquisition " + name());
+
 	try {
 		sr_session_->start();
 	}
@@ -66,7 +66,10 @@ class BaseSignal;
 
 namespace devices {
 
+class AcquisitionMetrics;
+class CommandQueue;
 class Configurable;
+class LimitEngine;
 
 enum class AquisitionState {
 	Stopped,
@@ -202,6 +205,22 @@ public:
 	 */
 	vector<shared_ptr<data::BaseSignal>> signals() const;
 
+	/**
+	 * Returns the limit engine of this device.
+	 */
+	shared_ptr<LimitEngine> limit_engine() const;
+
+	/**
+	 * Returns the command queue, that serializes all config accesses to
+	 * this device.
+	 */
+	shared_ptr<CommandQueue> command_queue() const;
+
+	/**
+	 * Returns the metrics (packet/sample rates, latencies) of the data
+	 * acquisition of this device.
+	 */
+	shared_ptr<AcquisitionMetrics> metrics() const;
 
 protected:
 	/**
@@ -253,6 +272,10 @@ protected:
 
 	bool frame_began_;
 
+	shared_ptr<LimitEngine> limit_engine_;
+	shared_ptr<CommandQueue> command_queue_;
+	shared_ptr<AcquisitionMetrics> metrics_;
+
 private:
 	void aquisition_thread_proc();
 
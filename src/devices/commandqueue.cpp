@@ -0,0 +1,234 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <QDebug>
+
+#include "commandqueue.hpp"
+#include "src/tracer.hpp"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::steady_clock;
+using std::function;
+using std::lock_guard;
+using std::make_shared;
+using std::promise;
+using std::shared_future;
+using std::unique_lock;
+
+namespace sv {
+namespace devices {
+
+CommandQueue::CommandQueue() :
+	stop_(false),
+	coalesced_count_(0)
+{
+	worker_thread_ = std::thread(&CommandQueue::worker_thread_proc, this);
+}
+
+CommandQueue::~CommandQueue()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_all();
+	if (worker_thread_.joinable())
+		worker_thread_.join();
+}
+
+shared_future<bool> CommandQueue::push(command_key_t key,
+	function<bool()> command)
+{
+	Command cmd;
+	cmd.has_key = true;
+	cmd.key = key;
+	cmd.proc = command;
+	return push(cmd);
+}
+
+shared_future<bool> CommandQueue::push(function<bool()> command)
+{
+	Command cmd;
+	cmd.has_key = false;
+	cmd.proc = command;
+	return push(cmd);
+}
+
+shared_future<bool> CommandQueue::push_front(command_key_t key,
+	function<bool()> command)
+{
+	Command cmd;
+	cmd.has_key = true;
+	cmd.key = key;
+	cmd.proc = command;
+	return push(cmd, true);
+}
+
+shared_future<bool> CommandQueue::push(Command command, bool to_front)
+{
+	shared_future<bool> future;
+	{
+		lock_guard<mutex> lock(mutex_);
+		future = push_locked(command, to_front);
+	}
+	cv_.notify_one();
+
+	return future;
+}
+
+shared_future<bool> CommandQueue::push_locked(Command command,
+	bool to_front)
+{
+	if (command.has_key) {
+		// Drop a pending command with the same key, but keep its promise,
+		// so that the waiters for the old command get the result of the
+		// new one. The new command goes to the end of the queue to
+		// preserve the order to commands with other keys.
+		for (auto it = commands_.begin(); it != commands_.end(); ++it) {
+			if (it->has_key && it->key == command.key) {
+				command.promise = it->promise;
+				command.future = it->future;
+				commands_.erase(it);
+				++coalesced_count_;
+				break;
+			}
+		}
+	}
+	if (!command.promise) {
+		command.promise = make_shared<promise<bool>>();
+		command.future = command.promise->get_future().share();
+	}
+	if (to_front)
+		commands_.push_front(command);
+	else
+		commands_.push_back(command);
+
+	return command.future;
+}
+
+void CommandQueue::set_periodic(command_key_t key, double interval,
+	function<bool()> command)
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (interval <= 0. || !command) {
+			periodic_commands_.erase(key);
+			return;
+		}
+
+		PeriodicCommand periodic;
+		periodic.interval = duration_cast<steady_clock::duration>(
+			duration<double>(interval));
+		periodic.due_time = steady_clock::now() + periodic.interval;
+		periodic.proc = command;
+		periodic_commands_[key] = periodic;
+	}
+	cv_.notify_one();
+}
+
+void CommandQueue::queue_periodic_commands()
+{
+	steady_clock::time_point now = steady_clock::now();
+	for (auto &periodic_pair : periodic_commands_) {
+		PeriodicCommand &periodic = periodic_pair.second;
+		if (periodic.due_time > now)
+			continue;
+
+		Command command;
+		command.has_key = true;
+		command.key = periodic_pair.first;
+		command.proc = periodic.proc;
+		push_locked(command);
+
+		// Don't try to catch up missed polls.
+		periodic.due_time += periodic.interval;
+		if (periodic.due_time <= now)
+			periodic.due_time = now + periodic.interval;
+	}
+}
+
+void CommandQueue::flush()
+{
+	execute<bool>([]() { return true; });
+}
+
+size_t CommandQueue::size() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return commands_.size();
+}
+
+size_t CommandQueue::coalesced_count() const
+{
+	return coalesced_count_;
+}
+
+void CommandQueue::worker_thread_proc()
+{
+	Tracer::set_thread_name("Command queue");
+
+	unique_lock<mutex> lock(mutex_);
+	while (true) {
+		if (!stop_)
+			queue_periodic_commands();
+
+		if (commands_.empty()) {
+			if (stop_)
+				break;
+			if (periodic_commands_.empty()) {
+				cv_.wait(lock);
+			}
+			else {
+				steady_clock::time_point due_time =
+					periodic_commands_.begin()->second.due_time;
+				for (const auto &periodic_pair : periodic_commands_)
+					due_time = std::min(due_time, periodic_pair.second.due_time);
+				cv_.wait_until(lock, due_time);
+			}
+			continue;
+		}
+
+		Command command = commands_.front();
+		commands_.pop_front();
+		lock.unlock();
+
+		try {
+			command.promise->set_value(command.proc());
+		}
+		catch (...) {
+			qWarning() << "CommandQueue::worker_thread_proc(): Command failed";
+			command.promise->set_exception(std::current_exception());
+		}
+
+		lock.lock();
+	}
+}
+
+} // namespace devices
+} // namespace sv
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_COMMANDQUEUE_HPP
+#define DEVICES_COMMANDQUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+using std::deque;
+using std::function;
+using std::map;
+using std::mutex;
+using std::pair;
+using std::shared_future;
+using std::shared_ptr;
+
+namespace sv {
+namespace devices {
+
+/**
+ * Key for coalescing commands: The owner (e.g. a Configurable) and an id
+ * (e.g. the ConfigKey) of the command.
+ */
+typedef pair<const void *, int> command_key_t;
+
+/**
+ * The CommandQueue serializes all accesses to a (sigrok) device in a worker
+ * thread. Pending commands with the same key are coalesced, only the last
+ * written value goes to the device (last writer wins).
+ */
+class CommandQueue
+{
+public:
+	CommandQueue();
+	~CommandQueue();
+
+	/**
+	 * Queue a command, that replaces a pending command with the same key.
+	 * The returned future is shared with the replaced command and becomes
+	 * ready when the last command for this key has been executed.
+	 */
+	shared_future<bool> push(command_key_t key, function<bool()> command);
+
+	/**
+	 * Queue a command that is never coalesced.
+	 */
+	shared_future<bool> push(function<bool()> command);
+
+	/**
+	 * Queue a command in front of all pending commands, e.g. for a
+	 * protective action. A pending command with the same key is dropped
+	 * and its future is shared with this command.
+	 */
+	shared_future<bool> push_front(command_key_t key,
+		function<bool()> command);
+
+	/**
+	 * Queue the command every interval seconds with the given key, so it is
+	 * coalesced with other commands for this key. An interval <= 0 removes
+	 * the periodic command.
+	 */
+	void set_periodic(command_key_t key, double interval,
+		function<bool()> command);
+
+	/**
+	 * Queue a command and block until it has been executed. All commands
+	 * queued before are executed first. Exceptions are passed to the caller.
+	 * When called from within a command, it is executed directly.
+	 */
+	template<typename T> T execute(function<T()> command)
+	{
+		if (std::this_thread::get_id() == worker_thread_.get_id())
+			return command();
+
+		auto task = std::make_shared<std::packaged_task<T()>>(command);
+		std::future<T> future = task->get_future();
+		push([task]() { (*task)(); return true; });
+		return future.get();
+	}
+
+	/**
+	 * Block until all queued commands have been executed.
+	 */
+	void flush();
+
+	/** Number of pending commands. */
+	size_t size() const;
+	/** Number of commands that have been dropped in favour of a newer one. */
+	size_t coalesced_count() const;
+
+private:
+	struct Command {
+		bool has_key;
+		command_key_t key;
+		function<bool()> proc;
+		shared_ptr<std::promise<bool>> promise;
+		shared_future<bool> future;
+	};
+
+	struct PeriodicCommand {
+		std::chrono::steady_clock::duration interval;
+		std::chrono::steady_clock::time_point due_time;
+		function<bool()> proc;
+	};
+
+	shared_future<bool> push(Command command, bool to_front = false);
+	/** Queue a command. The mutex must be locked by the caller. */
+	shared_future<bool> push_locked(Command command, bool to_front = false);
+	/** Queue all due periodic commands. The mutex must be locked. */
+	void queue_periodic_commands();
+	void worker_thread_proc();
+
+	mutable mutex mutex_;
+	std::condition_variable cv_;
+	deque<Command> commands_;
+	map<command_key_t, PeriodicCommand> periodic_commands_;
+	bool stop_;
+	std::atomic<size_t> coalesced_count_;
+	std::thread worker_thread_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_COMMANDQUEUE_HPP
@@ -18,6 +18,8 @@
  */
 
 #include <cassert>
+#include <functional>
+#include <future>
 #include <tuple>
 #include <type_traits>
 #include <map>
@@ -33,6 +35,8 @@
 #include <QString>
 
 #include "configurable.hpp"
+#include "src/tracer.hpp"
+#include "src/devices/commandqueue.hpp"
 #include "src/data/datautil.hpp"
 #include "src/data/properties/baseproperty.hpp"
 #include "src/data/properties/boolproperty.hpp"
@@ -47,8 +51,10 @@
 
 using std::dynamic_pointer_cast;
 using std::forward;
+using std::function;
 using std::make_pair;
 using std::make_shared;
+using std::shared_future;
 using std::string;
 using sv::devices::ConfigKey;
 
@@ -58,12 +64,15 @@ namespace devices {
 Configurable::Configurable(
 		const shared_ptr<sigrok::Configurable> sr_configurable,
 		unsigned int configurable_index,
-		const string device_name, const DeviceType device_type):
+		const string device_name, const DeviceType device_type,
+		shared_ptr<CommandQueue> command_queue):
 	sr_configurable_(sr_configurable),
 	configurable_index_(configurable_index),
 	device_name_(device_name),
-	device_type_(device_type)
+	device_type_(device_type),
+	command_queue_(command_queue)
 {
+	assert(command_queue_);
 }
 
 /*
@@ -186,8 +195,12 @@ template<typename T> T Configurable::get_config(devices::ConfigKey config_key) c
 	/*
 	try {
 	*/
-		return Glib::VariantBase::cast_dynamic<Glib::Variant<T>>(
-			sr_configurable_->config_get(sr_key)).get();
+		auto sr_configurable = sr_configurable_;
+		return command_queue_->execute<T>([sr_configurable, sr_key]() {
+			SV_TRACE_SCOPE("config", "config_get");
+			return Glib::VariantBase::cast_dynamic<Glib::Variant<T>>(
+				sr_configurable->config_get(sr_key)).get();
+		});
 	/*
 	}
 	catch (sigrok::Error &error) {
@@ -219,7 +232,12 @@ Glib::VariantContainerBase Configurable::get_container_config(
 	/*
 	try {
 	*/
-	Glib::VariantBase gvar = sr_configurable_->config_get(sr_key);
+	auto sr_configurable = sr_configurable_;
+	Glib::VariantBase gvar = command_queue_->execute<Glib::VariantBase>(
+		[sr_configurable, sr_key]() {
+			SV_TRACE_SCOPE("config", "config_get");
+			return sr_configurable->config_get(sr_key);
+		});
 	if (gvar.is_container()) {
 		Glib::VariantContainerBase gcontainer =
 			Glib::VariantBase::cast_dynamic<Glib::VariantContainerBase>(gvar);
@@ -254,52 +272,125 @@ template void Configurable::set_config(devices::ConfigKey, const Glib::ustring);
 template<typename T> void Configurable::set_config(
 	devices::ConfigKey config_key, const T value)
 {
-	assert(sr_configurable_);
+	set_config_async(config_key, value).wait();
+}
 
-	const sigrok::ConfigKey *sr_key =
-		devices::deviceutil::get_sr_config_key(config_key);
+template shared_future<bool> Configurable::set_config_async(
+	devices::ConfigKey, const bool);
+template shared_future<bool> Configurable::set_config_async(
+	devices::ConfigKey, const int32_t);
+template shared_future<bool> Configurable::set_config_async(
+	devices::ConfigKey, const uint64_t);
+template shared_future<bool> Configurable::set_config_async(
+	devices::ConfigKey, const double);
+template shared_future<bool> Configurable::set_config_async(
+	devices::ConfigKey, const std::string);
+template shared_future<bool> Configurable::set_config_async(
+	devices::ConfigKey, const Glib::ustring);
+template<typename T> shared_future<bool> Configurable::set_config_async(
+	devices::ConfigKey config_key, const T value)
+{
+	return command_queue_->push(make_pair(this, (int)config_key),
+		create_set_config_command(config_key, value));
+}
+
+template void Configurable::set_config_priority(
+	devices::ConfigKey, const bool);
+template void Configurable::set_config_priority(
+	devices::ConfigKey, const int32_t);
+template void Configurable::set_config_priority(
+	devices::ConfigKey, const uint64_t);
+template void Configurable::set_config_priority(
+	devices::ConfigKey, const double);
+template void Configurable::set_config_priority(
+	devices::ConfigKey, const std::string);
+template void Configurable::set_config_priority(
+	devices::ConfigKey, const Glib::ustring);
+template<typename T> void Configurable::set_config_priority(
+	devices::ConfigKey config_key, const T value)
+{
+	command_queue_->push_front(make_pair(this, (int)config_key),
+		create_set_config_command(config_key, value)).wait();
+}
 
-	if (!sr_configurable_->config_check(sr_key, sigrok::Capability::SET)) {
+template<typename T> function<bool()> Configurable::create_set_config_command(
+	devices::ConfigKey config_key, const T value) const
+{
+	assert(sr_configurable_);
+
+	if (!has_set_config(config_key)) {
 		qWarning() << "Configurable::set_config(): No setable  config key  " <<
 			devices::deviceutil::format_config_key(config_key);
 		assert(false);
 	}
 
-	try {
-		sr_configurable_->config_set(sr_key, Glib::Variant<T>::create(value));
-	}
-	catch (sigrok::Error &error) {
-		qWarning() << "Configurable::set_config(): Failed to set config key " <<
-			devices::deviceutil::format_config_key(config_key) << ". " <<
-			error.what();
-	}
+	const sigrok::ConfigKey *sr_key =
+		devices::deviceutil::get_sr_config_key(config_key);
+	auto sr_configurable = sr_configurable_;
+	return [sr_configurable, sr_key, config_key, value]() {
+		SV_TRACE_SCOPE("config", "config_set");
+		try {
+			sr_configurable->config_set(
+				sr_key, Glib::Variant<T>::create(value));
+		}
+		catch (sigrok::Error &error) {
+			qWarning() <<
+				"Configurable::set_config(): Failed to set config key " <<
+				devices::deviceutil::format_config_key(config_key) <<
+				". " << error.what();
+			return false;
+		}
+		return true;
+	};
 }
 
 void Configurable::set_container_config(
 	devices::ConfigKey config_key, vector<Glib::VariantBase> childs)
 {
-	assert(sr_configurable_);
+	set_container_config_async(config_key, childs).wait();
+}
 
-	const sigrok::ConfigKey *sr_key =
-		devices::deviceutil::get_sr_config_key(config_key);
+shared_future<bool> Configurable::set_container_config_async(
+	devices::ConfigKey config_key, vector<Glib::VariantBase> childs)
+{
+	assert(sr_configurable_);
 
-	if (!sr_configurable_->config_check(sr_key, sigrok::Capability::SET)) {
+	if (!has_set_config(config_key)) {
 		qWarning() <<
 			"Configurable::set_container_config(): No setable config key  " <<
 			devices::deviceutil::format_config_key(config_key);
 		assert(false);
 	}
 
-	try {
-		sr_configurable_->config_set(
-			sr_key, Glib::VariantContainerBase::create_tuple(childs));
-	}
-	catch (sigrok::Error &error) {
-		qWarning() <<
-			"Configurable::set_container_config(): Failed to set config key " <<
-			devices::deviceutil::format_config_key(config_key) << ". " <<
-			error.what();
-	}
+	const sigrok::ConfigKey *sr_key =
+		devices::deviceutil::get_sr_config_key(config_key);
+	auto sr_configurable = sr_configurable_;
+	return command_queue_->push(make_pair(this, (int)config_key),
+		[sr_configurable, sr_key, config_key, childs]() {
+			SV_TRACE_SCOPE("config", "config_set");
+			try {
+				sr_configurable->config_set(
+					sr_key, Glib::VariantContainerBase::create_tuple(childs));
+			}
+			catch (sigrok::Error &error) {
+				qWarning() <<
+					"Configurable::set_container_config(): Failed to set config key " <<
+					devices::deviceutil::format_config_key(config_key) <<
+					". " << error.what();
+				return false;
+			}
+			return true;
+		});
+}
+
+void Configurable::wait_for_commands()
+{
+	command_queue_->flush();
+}
+
+shared_ptr<CommandQueue> Configurable::command_queue() const
+{
+	return command_queue_;
 }
 
 bool Configurable::has_list_config(devices::ConfigKey key) const
@@ -325,7 +416,12 @@ bool Configurable::list_config(devices::ConfigKey key,
 	}
 
 	try {
-		gvariant = sr_configurable_->config_list(sr_key);
+		auto sr_configurable = sr_configurable_;
+		gvariant = command_queue_->execute<Glib::VariantContainerBase>(
+			[sr_configurable, sr_key]() {
+				SV_TRACE_SCOPE("config", "config_list");
+				return sr_configurable->config_list(sr_key);
+			});
 	}
 	catch (sigrok::Error &error) {
 		qWarning() << "Configurable::list_config(): Failed to list key " <<
@@ -20,6 +20,8 @@
 #ifndef DEVICES_CONFIGURABLE_HPP
 #define DEVICES_CONFIGURABLE_HPP
 
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <set>
@@ -37,10 +39,12 @@
 #include "src/devices/deviceutil.hpp"
 
 using std::forward;
+using std::function;
 using std::make_shared;
 using std::map;
 using std::pair;
 using std::set;
+using std::shared_future;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -63,6 +67,8 @@ class BaseProperty;
 
 namespace devices {
 
+class CommandQueue;
+
 class Configurable :
 	public QObject,
 	public std::enable_shared_from_this<Configurable>
@@ -72,7 +78,8 @@ class Configurable :
 private:
 	Configurable(const shared_ptr<sigrok::Configurable> sr_configurable,
 		unsigned int configurable_index,
-		const string device_name, const DeviceType device_type);
+		const string device_name, const DeviceType device_type,
+		shared_ptr<CommandQueue> command_queue);
 
 public:
 	template<typename ...Arg>
@@ -106,13 +113,40 @@ public:
 	Glib::VariantContainerBase get_container_config(devices::ConfigKey) const;
 
 	bool has_set_config(devices::ConfigKey) const;
+	/**
+	 * Set the config key and block until the value was sent to the device.
+	 */
 	template<typename T> void set_config(devices::ConfigKey, const T);
+	/**
+	 * Queue the config key to be set by the command queue of the device and
+	 * return immediately. A pending value for the same config key is
+	 * replaced. The future returns false, if setting the value has failed.
+	 */
+	template<typename T> shared_future<bool> set_config_async(
+		devices::ConfigKey, const T);
+	/**
+	 * Set the config key in front of all pending commands of the device and
+	 * block until the value was sent, e.g. for protective actions. A
+	 * pending value for the same config key is dropped.
+	 */
+	template<typename T> void set_config_priority(devices::ConfigKey, const T);
 	/**
 	 * Special handling for Conatiner Variants (especially std::tuple).
 	 * Tuple types are only supported with version >= 2.52 of glibmm, but we
 	 * need to use version 2.42, because of mxe.
 	 */
 	void set_container_config(devices::ConfigKey, vector<Glib::VariantBase>);
+	shared_future<bool> set_container_config_async(
+		devices::ConfigKey, vector<Glib::VariantBase>);
+
+	/**
+	 * Block until all queued commands of the device have been executed.
+	 */
+	void wait_for_commands();
+	/**
+	 * The command queue of the device, that serializes the config accesses.
+	 */
+	shared_ptr<CommandQueue> command_queue() const;
 
 	bool has_list_config(devices::ConfigKey) const;
 	bool list_config(devices::ConfigKey, Glib::VariantContainerBase &);
@@ -149,10 +183,15 @@ public:
 	void feed_in_meta(shared_ptr<sigrok::Meta>);
 
 private:
+	/** Create the command queue command, that sets the config key. */
+	template<typename T> function<bool()> create_set_config_command(
+		devices::ConfigKey, const T) const;
+
 	const shared_ptr<sigrok::Configurable> sr_configurable_;
 	unsigned int configurable_index_;
 	const string device_name_;
 	const DeviceType device_type_;
+	shared_ptr<CommandQueue> command_queue_;
 
 	set<devices::ConfigKey> getable_configs_;
 	set<devices::ConfigKey> setable_configs_;
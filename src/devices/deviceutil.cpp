@@ -17,10 +17,15 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
+
+#include <QFileInfo>
+#include <QString>
 
 #include "deviceutil.hpp"
 #include "src/data/datautil.hpp"
@@ -28,6 +33,7 @@
 using std::map;
 using std::set;
 using std::shared_ptr;
+using std::string;
 
 namespace sv {
 namespace devices {
@@ -82,6 +88,30 @@ bool is_measurement_driver(shared_ptr<sigrok::Driver> sr_driver)
 		| keys.count(sigrok::ConfigKey::DEMO_DEV);
 }
 
+shared_ptr<sigrok::InputFormat> find_input_format(
+	shared_ptr<sigrok::Context> sr_context,
+	const string &file_name, const string &format_name)
+{
+	assert(sr_context);
+
+	const auto input_formats = sr_context->input_formats();
+	if (!format_name.empty()) {
+		if (input_formats.count(format_name) > 0)
+			return input_formats.at(format_name);
+		return nullptr;
+	}
+
+	const QFileInfo file_info(QString::fromStdString(file_name));
+	const string suffix = file_info.suffix().toLower().toStdString();
+	for (const auto &format_pair : input_formats) {
+		const auto extensions = format_pair.second->extensions();
+		if (std::find(extensions.begin(), extensions.end(), suffix) !=
+				extensions.end())
+			return format_pair.second;
+	}
+	return nullptr;
+}
+
 DeviceType get_device_type(const sigrok::ConfigKey *sr_config_key)
 {
 	if (sr_config_key_device_type_map.count(sr_config_key) > 0)
@@ -23,6 +23,7 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
@@ -35,6 +36,7 @@
 using std::map;
 using std::set;
 using std::shared_ptr;
+using std::string;
 using std::vector;
 
 namespace sigrok {
@@ -78,6 +80,8 @@ enum class DeviceType
 	Powermeter,
 	/** User device */
 	UserDevice,
+	/** Replay of a recorded session */
+	ReplayDevice,
 	/** Unknown device. */
 	Unknown,
 };
@@ -283,6 +287,7 @@ device_type_name_map_t device_type_name_map = {
 	{ DeviceType::SignalGenerator, QString("Signal Generator") },
 	{ DeviceType::Powermeter, QString("Power Meter") },
 	{ DeviceType::UserDevice, QString("Virtual User Device") },
+	{ DeviceType::ReplayDevice, QString("Replay Device") },
 	{ DeviceType::Unknown, QString("Unknown") },
 };
 
@@ -713,6 +718,20 @@ bool is_source_sink_driver(shared_ptr<sigrok::Driver> sr_driver);
  */
  bool is_measurement_driver(shared_ptr<sigrok::Driver> sr_driver);
 
+/**
+ * Find the libsigrok input format for a file.
+ *
+ * @param sr_context The sigrok Context.
+ * @param file_name The file to read.
+ * @param format_name The name of the input format. If empty, the input
+ *        format is selected by the file extension.
+ *
+ * @return The input format or nullptr, if no input format was found.
+ */
+shared_ptr<sigrok::InputFormat> find_input_format(
+	shared_ptr<sigrok::Context> sr_context,
+	const string &file_name, const string &format_name);
+
 /**
  * Return the corresponding DeviceType for a sigrok ConfigKey
  *
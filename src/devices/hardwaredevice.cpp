@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <set>
 #include <string>
 #include <thread>
@@ -39,10 +40,13 @@
 #include "src/session.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/hardwarechannel.hpp"
+#include "src/data/basesignal.hpp"
 #include "src/data/properties/uint64property.hpp"
+#include "src/devices/acquisitionmetrics.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
 #include "src/devices/deviceutil.hpp"
+#include "src/devices/limitengine.hpp"
 
 using std::bad_alloc;
 using std::dynamic_pointer_cast;
@@ -188,7 +192,7 @@ void HardwareDevice::init_configurables()
 
 		auto cg_c = Configurable::create(
 			sr_cg, next_configurable_index_++,
-			short_name().toStdString(), device_type_);
+			short_name().toStdString(), device_type_, command_queue_);
 		configurable_map_.insert(make_pair(sr_cg_pair.first, cg_c));
 	}
 
@@ -208,7 +212,7 @@ void HardwareDevice::init_configurables()
 	// Init Configurable from Device
 	auto d_c = Configurable::create(
 		sr_device_, next_configurable_index_++,
-		short_name().toStdString(), device_type_);
+		short_name().toStdString(), device_type_, command_queue_);
 	configurable_map_.insert(make_pair("", d_c));
 
 	// Sample rate for interleaved samples
@@ -289,6 +293,10 @@ void HardwareDevice::feed_in_analog(shared_ptr<sigrok::Analog> sr_analog)
 	if (num_samples == 0)
 		return;
 
+	// Ingest time for the limit engine latency measurement
+	limit_time_point_t ingest_time = std::chrono::steady_clock::now();
+	bool check_limits = limit_engine_->has_rules();
+
 	lock_guard<recursive_mutex> lock(data_mutex_);
 
 	uint64_t samplerate = 0;
@@ -297,6 +305,8 @@ void HardwareDevice::feed_in_analog(shared_ptr<sigrok::Analog> sr_analog)
 
 	const vector<shared_ptr<sigrok::Channel>> sr_channels = sr_analog->channels();
 
+	metrics_->add_samples(num_samples * sr_channels.size());
+
 	unique_ptr<float[]> data(new float[num_samples * sr_channels.size()]);
 	sr_analog->get_data_as_float(data.get());
 	float *channel_data = data.get();
@@ -322,9 +332,21 @@ void HardwareDevice::feed_in_analog(shared_ptr<sigrok::Analog> sr_analog)
 		else
 			timestamp = QDateTime::currentMSecsSinceEpoch() / (double)1000;
 
+		// Remember the position of the first new sample for the limit engine
+		shared_ptr<data::BaseSignal> signal = channel->actual_signal();
+		size_t first_pos = signal ? signal->sample_count() : 0;
+
 		//channel->push_sample_sr_analog(channel_data++, timestamp, sr_analog);
 		channel->push_interleaved_samples(channel_data++, num_samples,
 			sr_channels.size(), timestamp, samplerate, sr_analog);
+
+		// Evaluate the limits directly on the acquisition thread
+		if (check_limits) {
+			if (channel->actual_signal() != signal)
+				first_pos = 0;
+			limit_engine_->evaluate(
+				channel->actual_signal(), first_pos, ingest_time);
+		}
 	}
 }
 
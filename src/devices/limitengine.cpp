@@ -0,0 +1,273 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <QDebug>
+#include <QString>
+
+#include "limitengine.hpp"
+#include "src/util.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/deviceutil.hpp"
+
+using std::chrono::duration;
+using std::chrono::steady_clock;
+using std::lock_guard;
+using std::make_pair;
+using std::micro;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+
+namespace sv {
+namespace devices {
+
+LimitEngine::LimitEngine() :
+	next_rule_id_(0),
+	has_rules_(false),
+	stop_(false),
+	trigger_count_(0),
+	last_latency_(0.),
+	max_latency_(0.)
+{
+}
+
+LimitEngine::~LimitEngine()
+{
+	{
+		lock_guard<mutex> lock(events_mutex_);
+		stop_ = true;
+	}
+	events_cv_.notify_all();
+	if (action_thread_.joinable())
+		action_thread_.join();
+}
+
+unsigned int LimitEngine::add_rule(shared_ptr<data::AnalogTimeSignal> signal,
+	LimitCondition condition, LimitDirection direction, double limit,
+	double window, LimitAction action,
+	shared_ptr<Configurable> configurable, string name)
+{
+	lock_guard<mutex> lock(rules_mutex_);
+
+	LimitRule rule;
+	rule.id = next_rule_id_++;
+	rule.name = name.empty() ? "Rule " + std::to_string(rule.id) : name;
+	rule.signal = signal;
+	rule.condition = condition;
+	rule.direction = direction;
+	rule.limit = limit;
+	rule.window = window;
+	rule.action = action;
+	rule.configurable = configurable;
+	rule.violated = false;
+	rule.window_sum = 0.;
+	rule.trigger_count = 0;
+
+	rules_.insert(make_pair(rule.id, rule));
+	has_rules_ = true;
+
+	// Most devices never get a rule, so the action thread is only started
+	// with the first one.
+	if (!action_thread_.joinable())
+		action_thread_ = std::thread(&LimitEngine::action_thread_proc, this);
+
+	return rule.id;
+}
+
+void LimitEngine::remove_rule(unsigned int id)
+{
+	lock_guard<mutex> lock(rules_mutex_);
+	rules_.erase(id);
+	has_rules_ = !rules_.empty();
+}
+
+void LimitEngine::clear_rules()
+{
+	lock_guard<mutex> lock(rules_mutex_);
+	rules_.clear();
+	has_rules_ = false;
+}
+
+bool LimitEngine::has_rules() const
+{
+	return has_rules_;
+}
+
+void LimitEngine::evaluate(shared_ptr<data::BaseSignal> signal,
+	size_t first_pos, limit_time_point_t ingest_time)
+{
+	if (!has_rules_ || !signal)
+		return;
+
+	lock_guard<mutex> lock(rules_mutex_);
+
+	for (auto &rule_pair : rules_) {
+		LimitRule &rule = rule_pair.second;
+		if (rule.signal.get() != signal.get())
+			continue;
+
+		size_t sample_count = rule.signal->sample_count();
+		for (size_t pos = first_pos; pos < sample_count; ++pos) {
+			auto sample = rule.signal->get_sample(pos, false);
+			double rule_value;
+			bool violated = check_rule(rule, sample.first, sample.second,
+				rule_value);
+
+			// Edge triggered, only fire once per violation.
+			if (violated && !rule.violated) {
+				++rule.trigger_count;
+
+				LimitEvent event;
+				event.rule_id = rule.id;
+				event.name = rule.name;
+				event.action = rule.action;
+				event.configurable = rule.configurable;
+				event.value = rule_value;
+				event.timestamp = sample.first;
+				event.ingest_time = ingest_time;
+				event.detect_time = steady_clock::now();
+				{
+					lock_guard<mutex> events_lock(events_mutex_);
+					events_.push_back(event);
+				}
+				events_cv_.notify_one();
+			}
+			rule.violated = violated;
+		}
+	}
+}
+
+bool LimitEngine::check_rule(LimitRule &rule, double timestamp, double value,
+	double &rule_value)
+{
+	switch (rule.condition) {
+	case LimitCondition::Threshold:
+		rule_value = value;
+		break;
+	case LimitCondition::RateOfChange:
+		rule.window_samples.push_back(make_pair(timestamp, value));
+		while (rule.window_samples.size() > 2 &&
+				timestamp - rule.window_samples.front().first > rule.window)
+			rule.window_samples.pop_front();
+		if (rule.window_samples.size() < 2)
+			return false;
+		if (timestamp <= rule.window_samples.front().first)
+			return rule.violated;
+		rule_value = (value - rule.window_samples.front().second) /
+			(timestamp - rule.window_samples.front().first);
+		break;
+	case LimitCondition::WindowAverage:
+		rule.window_samples.push_back(make_pair(timestamp, value));
+		rule.window_sum += value;
+		while (rule.window_samples.size() > 1 &&
+				timestamp - rule.window_samples.front().first > rule.window) {
+			rule.window_sum -= rule.window_samples.front().second;
+			rule.window_samples.pop_front();
+		}
+		rule_value = rule.window_sum / rule.window_samples.size();
+		break;
+	default:
+		return false;
+	}
+
+	if (rule.direction == LimitDirection::Above)
+		return rule_value > rule.limit;
+	return rule_value < rule.limit;
+}
+
+void LimitEngine::action_thread_proc()
+{
+	while (true) {
+		LimitEvent event;
+		{
+			unique_lock<mutex> lock(events_mutex_);
+			events_cv_.wait(lock, [this] { return stop_ || !events_.empty(); });
+			// The queued events are executed before the thread exits, a
+			// protective action (e.g. disable an output) must not be lost.
+			if (events_.empty())
+				return;
+			event = events_.front();
+			events_.pop_front();
+		}
+		execute_event(event);
+	}
+}
+
+void LimitEngine::execute_event(const LimitEvent &event)
+{
+	if (event.action == LimitAction::DisableOutput && event.configurable) {
+		if (event.configurable->has_set_config(ConfigKey::Enabled)) {
+			// Don't wait for the pending commands of the device.
+			event.configurable->set_config_priority<bool>(
+				ConfigKey::Enabled, false);
+		}
+		else {
+			qWarning() << "LimitEngine::execute_event(): " <<
+				event.configurable->display_name() <<
+				" has no setable config key Enabled";
+		}
+	}
+
+	limit_time_point_t done_time = steady_clock::now();
+	double detect_latency = duration<double, micro>(
+		event.detect_time - event.ingest_time).count();
+	double action_latency = duration<double, micro>(
+		done_time - event.ingest_time).count();
+
+	++trigger_count_;
+	last_latency_ = action_latency;
+	if (action_latency > max_latency_)
+		max_latency_ = action_latency;
+
+	qWarning().nospace() << "LIMIT " << QString::fromStdString(event.name) <<
+		" triggered at " << util::format_time_date(event.timestamp) <<
+		": value = " << event.value <<
+		", detect latency = " << detect_latency << " µs" <<
+		", action latency = " << action_latency << " µs";
+
+	Q_EMIT limit_triggered(event.rule_id, QString::fromStdString(event.name),
+		event.value, event.timestamp, detect_latency, action_latency);
+}
+
+size_t LimitEngine::trigger_count() const
+{
+	return trigger_count_;
+}
+
+double LimitEngine::last_latency() const
+{
+	return last_latency_;
+}
+
+double LimitEngine::max_latency() const
+{
+	return max_latency_;
+}
+
+} // namespace devices
+} // namespace sv
@@ -0,0 +1,201 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_LIMITENGINE_HPP
+#define DEVICES_LIMITENGINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <QObject>
+#include <QString>
+
+using std::deque;
+using std::map;
+using std::mutex;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+class BaseSignal;
+}
+
+namespace devices {
+
+class Configurable;
+
+enum class LimitCondition {
+	/** The sample value crosses the limit. */
+	Threshold,
+	/** The slope (units per second) over the window crosses the limit. */
+	RateOfChange,
+	/** The mean value over the window crosses the limit. */
+	WindowAverage
+};
+
+enum class LimitDirection {
+	Above,
+	Below
+};
+
+enum class LimitAction {
+	/** Only write a marker to the log. */
+	LogMarker,
+	/** Disable the output (ConfigKey::Enabled) of a configurable. */
+	DisableOutput
+};
+
+typedef std::chrono::steady_clock::time_point limit_time_point_t;
+
+/**
+ * A single limit rule. The rule is edge triggered: The action is only
+ * executed once, when the condition changes from "ok" to "violated".
+ */
+struct LimitRule
+{
+	unsigned int id;
+	string name;
+	shared_ptr<data::AnalogTimeSignal> signal;
+	LimitCondition condition;
+	LimitDirection direction;
+	double limit;
+	/** Window length in seconds for RateOfChange and WindowAverage. */
+	double window;
+	LimitAction action;
+	shared_ptr<Configurable> configurable;
+
+	// Runtime state, only touched by the acquisition thread
+	bool violated;
+	deque<pair<double, double>> window_samples;
+	double window_sum;
+	size_t trigger_count;
+};
+
+/**
+ * The LimitEngine evaluates its rules directly on the acquisition thread
+ * (see HardwareDevice::feed_in_analog()). Only the actions are deferred to a
+ * worker thread, so that a slow device can't stall the acquisition.
+ */
+class LimitEngine : public QObject
+{
+	Q_OBJECT
+
+public:
+	LimitEngine();
+	~LimitEngine();
+
+	/**
+	 * Add a new rule and return its id.
+	 */
+	unsigned int add_rule(shared_ptr<data::AnalogTimeSignal> signal,
+		LimitCondition condition, LimitDirection direction, double limit,
+		double window, LimitAction action,
+		shared_ptr<Configurable> configurable, string name);
+
+	/**
+	 * Remove the rule with the given id.
+	 */
+	void remove_rule(unsigned int id);
+
+	/**
+	 * Remove all rules.
+	 */
+	void clear_rules();
+
+	/**
+	 * Returns true if there is at least one rule. Lock free, so that the
+	 * acquisition thread can skip the evaluation.
+	 */
+	bool has_rules() const;
+
+	/**
+	 * Evaluate all rules for the given signal, starting with the sample at
+	 * position first_pos. ingest_time is the time, when the packet was
+	 * received by the device and is used for the latency measurement.
+	 */
+	void evaluate(shared_ptr<data::BaseSignal> signal, size_t first_pos,
+		limit_time_point_t ingest_time);
+
+	/** Number of triggered rules since the creation of the engine. */
+	size_t trigger_count() const;
+	/** Latency from packet ingest to the completed action of the last trigger in µs. */
+	double last_latency() const;
+	/** Max. latency from packet ingest to the completed action in µs. */
+	double max_latency() const;
+
+private:
+	struct LimitEvent
+	{
+		unsigned int rule_id;
+		string name;
+		LimitAction action;
+		shared_ptr<Configurable> configurable;
+		double value;
+		double timestamp;
+		limit_time_point_t ingest_time;
+		limit_time_point_t detect_time;
+	};
+
+	bool check_rule(LimitRule &rule, double timestamp, double value,
+		double &rule_value);
+	void action_thread_proc();
+	void execute_event(const LimitEvent &event);
+
+	map<unsigned int, LimitRule> rules_;
+	unsigned int next_rule_id_;
+	std::atomic<bool> has_rules_;
+	mutable mutex rules_mutex_;
+
+	deque<LimitEvent> events_;
+	mutex events_mutex_;
+	std::condition_variable events_cv_;
+	bool stop_;
+	/** Started with the first rule, guarded by rules_mutex_. */
+	std::thread action_thread_;
+
+	std::atomic<size_t> trigger_count_;
+	std::atomic<double> last_latency_;
+	std::atomic<double> max_latency_;
+
+Q_SIGNALS:
+	/**
+	 * Emitted (from the action thread) after the action has been executed.
+	 * The latencies are in µs, measured from the packet ingest.
+	 */
+	void limit_triggered(unsigned int rule_id, QString name, double value,
+		double timestamp, double detect_latency, double action_latency);
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_LIMITENGINE_HPP
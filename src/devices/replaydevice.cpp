@@ -0,0 +1,426 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QString>
+
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include "replaydevice.hpp"
+#include "src/session.hpp"
+#include "src/tracer.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/hardwarechannel.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/acquisitionmetrics.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/devices/deviceutil.hpp"
+#include "src/devices/limitengine.hpp"
+#include "src/devices/replayrecording.hpp"
+
+using std::lock_guard;
+using std::static_pointer_cast;
+using std::unique_lock;
+
+namespace sv {
+namespace devices {
+
+ReplayDevice::ReplayDevice(
+		const shared_ptr<sigrok::Context> &sr_context,
+		shared_ptr<ReplayRecording> recording) :
+	BaseDevice(sr_context, nullptr),
+	recording_(recording),
+	replay_stop_(false),
+	speed_(1),
+	loop_(false),
+	finished_(false),
+	replay_pos_(0),
+	position_(0),
+	pass_start_timestamp_(0),
+	last_timestamp_(0),
+	base_position_(0),
+	current_packet_(nullptr),
+	current_timestamp_(0)
+{
+	sr_device_ = sr_context_->create_user_device(
+		"SmuView", "Replay", recording_->name().toStdString());
+	device_type_ = DeviceType::ReplayDevice;
+	aquisition_state_ = AquisitionState::Stopped;
+}
+
+ReplayDevice::~ReplayDevice()
+{
+	stop_replay();
+}
+
+string ReplayDevice::id() const
+{
+	return "replaydevice:" + std::to_string(device_index_);
+}
+
+QString ReplayDevice::full_name() const
+{
+	return QString("Replay %1").arg(recording_->name());
+}
+
+QString ReplayDevice::short_name() const
+{
+	return full_name();
+}
+
+QString ReplayDevice::display_name(
+	const DeviceManager &device_manager) const
+{
+	(void)device_manager;
+	return full_name();
+}
+
+void ReplayDevice::open()
+{
+	if (device_open_)
+		close();
+
+	try {
+		sr_device_->open();
+	}
+	catch (const sigrok::Error &e) {
+		// The sigrok UserDevice has no driver and throws SR_ERR_ARG, thats ok.
+	}
+
+	sr_session_->add_device(sr_device_);
+
+	this->init_configurables();
+	this->init_channels();
+
+	{
+		lock_guard<mutex> lock(replay_mutex_);
+		replay_stop_ = false;
+		aquisition_state_ = AquisitionState::Running;
+		start_pass();
+	}
+	replay_thread_ = std::thread(&ReplayDevice::replay_thread_proc, this);
+
+	device_open_ = true;
+}
+
+void ReplayDevice::close()
+{
+	qWarning() << "ReplayDevice::close(): Trying to close device " << full_name();
+
+	if (!device_open_)
+		return;
+
+	stop_replay();
+	aquisition_state_ = AquisitionState::Stopped;
+
+	try {
+		sr_device_->close();
+	}
+	catch (...) {}
+
+	if (sr_session_)
+		sr_session_->remove_devices();
+
+	device_open_ = false;
+
+	qWarning() << "ReplayDevice::close(): Device closed " << full_name();
+}
+
+void ReplayDevice::start_aquisition()
+{
+	lock_guard<mutex> lock(replay_mutex_);
+	BaseDevice::start_aquisition();
+	rebase_timing();
+	replay_cond_.notify_all();
+}
+
+void ReplayDevice::pause_aquisition()
+{
+	lock_guard<mutex> lock(replay_mutex_);
+	BaseDevice::pause_aquisition();
+	replay_cond_.notify_all();
+}
+
+shared_ptr<ReplayRecording> ReplayDevice::recording() const
+{
+	return recording_;
+}
+
+void ReplayDevice::set_speed(double speed)
+{
+	lock_guard<mutex> lock(replay_mutex_);
+	speed_ = std::max(speed, 0.);
+	rebase_timing();
+	replay_cond_.notify_all();
+}
+
+double ReplayDevice::speed() const
+{
+	lock_guard<mutex> lock(replay_mutex_);
+	return speed_;
+}
+
+void ReplayDevice::set_loop(bool loop)
+{
+	lock_guard<mutex> lock(replay_mutex_);
+	loop_ = loop;
+	if (loop_ && finished_)
+		start_pass();
+	replay_cond_.notify_all();
+}
+
+bool ReplayDevice::loop() const
+{
+	lock_guard<mutex> lock(replay_mutex_);
+	return loop_;
+}
+
+void ReplayDevice::restart()
+{
+	lock_guard<mutex> lock(replay_mutex_);
+	start_pass();
+	replay_cond_.notify_all();
+}
+
+double ReplayDevice::position() const
+{
+	lock_guard<mutex> lock(replay_mutex_);
+	return position_;
+}
+
+bool ReplayDevice::is_finished() const
+{
+	lock_guard<mutex> lock(replay_mutex_);
+	return finished_;
+}
+
+void ReplayDevice::init_configurables()
+{
+}
+
+void ReplayDevice::init_channels()
+{
+	// The sigrok channels can't be removed, so they are only created once.
+	if (!sr_channels_.empty())
+		return;
+
+	auto sr_user_device = static_pointer_cast<sigrok::UserDevice>(sr_device_);
+	const auto &replay_channels = recording_->channels();
+	for (size_t i = 0; i < replay_channels.size(); ++i) {
+		auto sr_channel = sr_user_device->add_channel(
+			i, sigrok::ChannelType::ANALOG, replay_channels[i].name);
+		sr_channels_.push_back(sr_channel);
+		add_sr_channel(sr_channel, replay_channels[i].channel_group_name);
+	}
+}
+
+void ReplayDevice::feed_in_header()
+{
+}
+
+void ReplayDevice::feed_in_trigger()
+{
+}
+
+void ReplayDevice::feed_in_meta(shared_ptr<sigrok::Meta> sr_meta)
+{
+	(void)sr_meta;
+}
+
+void ReplayDevice::feed_in_frame_begin()
+{
+}
+
+void ReplayDevice::feed_in_frame_end()
+{
+}
+
+void ReplayDevice::feed_in_logic(shared_ptr<sigrok::Logic> sr_logic)
+{
+	(void)sr_logic;
+}
+
+void ReplayDevice::feed_in_analog(shared_ptr<sigrok::Analog> sr_analog)
+{
+	// Only the packets from the replay thread are handled.
+	if (!current_packet_)
+		return;
+
+	size_t num_samples = sr_analog->num_samples();
+	if (num_samples == 0)
+		return;
+
+	// Ingest time for the limit engine latency measurement
+	limit_time_point_t ingest_time = std::chrono::steady_clock::now();
+	bool check_limits = limit_engine_->has_rules();
+
+	lock_guard<recursive_mutex> lock(data_mutex_);
+
+	metrics_->add_samples(num_samples);
+
+	/*
+	 * NOTE: libsigrokcxx can't resolve the channels of a packet that was
+	 *       created by the context (the packet has no device), so the
+	 *       channel and the meaning are taken from the replay packet.
+	 */
+	auto channel = static_pointer_cast<channels::HardwareChannel>(
+		sr_channel_map_[sr_channels_[current_packet_->channel_index]]);
+
+	// Remember the position of the first new sample for the limit engine
+	shared_ptr<data::BaseSignal> signal = channel->actual_signal();
+	size_t first_pos = signal ? signal->sample_count() : 0;
+
+	channel->push_interleaved_samples(current_packet_->samples.data(),
+		num_samples, 1, current_timestamp_, current_packet_->samplerate,
+		current_packet_->quantity, current_packet_->quantity_flags,
+		current_packet_->unit, current_packet_->digits,
+		current_packet_->decimal_places);
+
+	// Evaluate the limits directly on the replay thread
+	if (check_limits) {
+		if (channel->actual_signal() != signal)
+			first_pos = 0;
+		limit_engine_->evaluate(
+			channel->actual_signal(), first_pos, ingest_time);
+	}
+}
+
+void ReplayDevice::replay_thread_proc()
+{
+	Tracer::set_thread_name(
+		"Replay " + recording_->name().toStdString());
+
+	qWarning() << "ReplayDevice: Start replay of " << full_name() << ", " <<
+		recording_->sample_count() << " samples, " <<
+		recording_->duration() << " s";
+
+	const vector<ReplayPacket> &packets = recording_->packets();
+	unique_lock<mutex> lock(replay_mutex_);
+	while (!replay_stop_) {
+		if (aquisition_state_ != AquisitionState::Running ||
+				replay_pos_ >= packets.size()) {
+			replay_cond_.wait(lock);
+			continue;
+		}
+
+		const ReplayPacket &packet = packets[replay_pos_];
+		if (speed_ > 0) {
+			auto due_time = base_time_ +
+				std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(
+						(packet.timestamp - base_position_) / speed_));
+			if (std::chrono::steady_clock::now() < due_time) {
+				// Speed changes, pause, restart and close wake up the player.
+				replay_cond_.wait_until(lock, due_time);
+				continue;
+			}
+		}
+
+		++replay_pos_;
+		position_ = packet.timestamp;
+		double timestamp = pass_start_timestamp_ + packet.timestamp;
+		double end_timestamp = timestamp;
+		if (packet.samplerate > 0 && packet.samples.size() > 1) {
+			end_timestamp +=
+				(packet.samples.size() - 1) / (double)packet.samplerate;
+		}
+		last_timestamp_ = std::max(last_timestamp_, end_timestamp);
+
+		lock.unlock();
+		feed_in_replay_packet(packet, timestamp);
+		lock.lock();
+
+		if (replay_pos_ < packets.size())
+			continue;
+		if (loop_) {
+			start_pass();
+			continue;
+		}
+
+		finished_ = true;
+		lock.unlock();
+		qWarning() << "ReplayDevice: Replay of " << full_name() << " finished";
+		Q_EMIT replay_finished();
+		lock.lock();
+	}
+}
+
+void ReplayDevice::stop_replay()
+{
+	{
+		lock_guard<mutex> lock(replay_mutex_);
+		replay_stop_ = true;
+		replay_cond_.notify_all();
+	}
+	if (replay_thread_.joinable())
+		replay_thread_.join();
+}
+
+void ReplayDevice::feed_in_replay_packet(
+	const ReplayPacket &packet, double timestamp)
+{
+	auto sr_packet = sr_context_->create_analog_packet(
+		{ sr_channels_[packet.channel_index] },
+		packet.samples.data(), packet.samples.size(),
+		data::datautil::get_sr_quantity(packet.quantity),
+		data::datautil::get_sr_unit(packet.unit),
+		data::datautil::get_sr_quantity_flags(packet.quantity_flags));
+
+	current_packet_ = &packet;
+	current_timestamp_ = timestamp;
+	data_feed_in(sr_device_, sr_packet);
+	current_packet_ = nullptr;
+}
+
+void ReplayDevice::start_pass()
+{
+	/*
+	 * The samples of a new pass get new timestamps. They start now, but
+	 * never before the samples of the last pass, because at a higher speed
+	 * the timestamps of the last pass can be in the future.
+	 */
+	double now = QDateTime::currentMSecsSinceEpoch() / (double)1000;
+	pass_start_timestamp_ = std::max(now, last_timestamp_ + 0.001);
+	replay_pos_ = 0;
+	position_ = 0;
+	finished_ = false;
+	rebase_timing();
+}
+
+void ReplayDevice::rebase_timing()
+{
+	const auto &packets = recording_->packets();
+	base_time_ = std::chrono::steady_clock::now();
+	if (replay_pos_ < packets.size())
+		base_position_ = packets[replay_pos_].timestamp;
+	else
+		base_position_ = recording_->duration();
+}
+
+} // namespace devices
+} // namespace sv
@@ -0,0 +1,198 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_REPLAYDEVICE_HPP
+#define DEVICES_REPLAYDEVICE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "src/devices/basedevice.hpp"
+
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sigrok {
+class Channel;
+class Context;
+}
+
+namespace sv {
+namespace devices {
+
+struct ReplayPacket;
+class ReplayRecording;
+
+/**
+ * A ReplayDevice plays back a recorded session. The packets of the recording
+ * are injected into the same data feed as the packets of a hardware device,
+ * so plots, math channels, limits and exporters can be tested with
+ * reproducible data and without any lab instruments.
+ *
+ * The playback runs in its own thread with the recorded timing (speed 1),
+ * faster or slower by a factor, or as fast as possible (speed 0).
+ */
+class ReplayDevice : public BaseDevice
+{
+	Q_OBJECT
+
+public:
+	ReplayDevice(const shared_ptr<sigrok::Context> &sr_context,
+		shared_ptr<ReplayRecording> recording);
+	~ReplayDevice();
+
+	/**
+	 * Builds the full name. It only contains all the fields.
+	 */
+	QString full_name() const override;
+
+	/**
+	 * Builds the short name.
+	 */
+	QString short_name() const override;
+
+	/**
+	 * Get the unique Id of the device
+	 */
+	string id() const override;
+
+	/**
+	 * Builds the display name. It only contains fields as required.
+	 * @param device_manager a reference to the device manager is needed
+	 * so that other similarly titled devices can be detected.
+	 */
+	QString display_name(const DeviceManager &device_manager) const override;
+
+	void open() override;
+	void close() override;
+
+	/**
+	 * Resume the playback.
+	 */
+	void start_aquisition() override;
+
+	/**
+	 * Pause the playback.
+	 */
+	void pause_aquisition() override;
+
+	shared_ptr<ReplayRecording> recording() const;
+
+	/**
+	 * Set the playback speed as factor of the recorded timing. A speed of 0
+	 * plays back the recording as fast as possible.
+	 */
+	void set_speed(double speed);
+	double speed() const;
+
+	/**
+	 * Start the playback from the beginning, when the end of the recording
+	 * is reached.
+	 */
+	void set_loop(bool loop);
+	bool loop() const;
+
+	/**
+	 * Start the playback from the beginning of the recording.
+	 */
+	void restart();
+
+	/**
+	 * The position of the playback in s, relative to the recording start.
+	 */
+	double position() const;
+
+	/**
+	 * Returns true, if the whole recording was played back.
+	 */
+	bool is_finished() const;
+
+protected:
+	/**
+	 * Init all configurables for this replay device. Not used in here!
+	 */
+	void init_configurables() override;
+	/**
+	 * Init all channels of the recording.
+	 */
+	void init_channels() override;
+
+	void feed_in_header() override;
+	void feed_in_trigger() override;
+	void feed_in_meta(shared_ptr<sigrok::Meta> sr_meta) override;
+	void feed_in_frame_begin() override;
+	void feed_in_frame_end() override;
+	void feed_in_logic(shared_ptr<sigrok::Logic> sr_logic) override;
+	void feed_in_analog(shared_ptr<sigrok::Analog> sr_analog) override;
+
+private:
+	void replay_thread_proc();
+	void stop_replay();
+	/** Send a packet of the recording through the data feed. */
+	void feed_in_replay_packet(const ReplayPacket &packet, double timestamp);
+	/** Start a new pass over the recording. replay_mutex_ must be locked. */
+	void start_pass();
+	/** Restart the timing at the actual position. replay_mutex_ must be locked. */
+	void rebase_timing();
+
+	shared_ptr<ReplayRecording> recording_;
+	/** The sigrok channels by the channel index of the recording. */
+	vector<shared_ptr<sigrok::Channel>> sr_channels_;
+
+	std::thread replay_thread_;
+	mutable mutex replay_mutex_;
+	std::condition_variable replay_cond_;
+	bool replay_stop_;
+	double speed_;
+	bool loop_;
+	bool finished_;
+	/** Index of the next packet to play back. */
+	size_t replay_pos_;
+	double position_;
+	/** Timestamp of the recording start in the actual pass. */
+	double pass_start_timestamp_;
+	/** Timestamp of the last sample that was played back. */
+	double last_timestamp_;
+	/** The recording position, that is played back at base_time_. */
+	double base_position_;
+	std::chrono::steady_clock::time_point base_time_;
+
+	/** The packet that is actually fed in, and its timestamp. */
+	const ReplayPacket *current_packet_;
+	double current_timestamp_;
+
+Q_SIGNALS:
+	void replay_finished();
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_REPLAYDEVICE_HPP
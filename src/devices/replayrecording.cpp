@@ -0,0 +1,435 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QString>
+
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include "replayrecording.hpp"
+#include "src/util.hpp"
+#include "src/data/csvutil.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/deviceutil.hpp"
+
+using std::dynamic_pointer_cast;
+using std::ifstream;
+using std::map;
+using std::pair;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+namespace {
+
+/** Size of the chunks that are sent to a libsigrok input module. */
+const size_t input_chunk_size = 4 * 1024 * 1024;
+
+/** A value column of a SmuView CSV file with its samples. */
+struct CsvColumnSamples
+{
+	data::csvutil::CsvColumn column;
+	size_t channel_index;
+	int decimal_places;
+	vector<pair<double, float>> samples;
+};
+
+string trim_line(string line)
+{
+	if (!line.empty() && line.back() == '\r')
+		line.pop_back();
+	return line;
+}
+
+} // namespace
+
+ReplayRecording::ReplayRecording(const QString &name) :
+	name_(name),
+	duration_(0),
+	sample_count_(0)
+{
+}
+
+shared_ptr<ReplayRecording> ReplayRecording::load(
+	const shared_ptr<sigrok::Context> &sr_context,
+	const QString &file_name, const string &format_name)
+{
+	if (format_name.empty() &&
+			QFileInfo(file_name).suffix().toLower() == "csv")
+		return load_csv(file_name, "");
+	return load_sigrok(sr_context, file_name, format_name);
+}
+
+shared_ptr<ReplayRecording> ReplayRecording::load_csv(
+	const QString &file_name, const string &separator)
+{
+	ifstream input_file(file_name.toStdString());
+	if (!input_file)
+		throw QString("Could not open %1").arg(file_name);
+
+	// Header: device, channel groups, channel, signal
+	vector<string> header_lines;
+	string line;
+	while (header_lines.size() < data::csvutil::header_line_count &&
+			std::getline(input_file, line))
+		header_lines.push_back(trim_line(line));
+	data::csvutil::CsvHeader header;
+	if (!data::csvutil::parse_header(header_lines, separator, header))
+		throw QString("%1 is not a SmuView CSV file").arg(file_name);
+
+	auto recording = shared_ptr<ReplayRecording>(
+		new ReplayRecording(QFileInfo(file_name).completeBaseName()));
+
+	vector<CsvColumnSamples> columns;
+	for (const auto &header_column : header.columns) {
+		if (!data::datautil::is_valid_sr_quantity(header_column.quantity) ||
+				!data::datautil::get_sr_unit(header_column.unit)) {
+			qWarning() << "ReplayRecording::load_csv(): No quantity for" <<
+				QString::fromStdString(header_column.channel_name) <<
+				", skipped";
+			continue;
+		}
+
+		CsvColumnSamples column;
+		column.column = header_column;
+		column.decimal_places = 0;
+		column.channel_index = recording->get_channel_index(
+			header_column.device_name, header_column.channel_name,
+			header_column.channel_group_name);
+		columns.push_back(column);
+	}
+	if (columns.empty())
+		throw QString("%1 contains no signals").arg(file_name);
+
+	// Data
+	size_t line_number = data::csvutil::header_line_count;
+	size_t invalid_lines = 0;
+	data::csvutil::DateTimeCache date_time_cache;
+	while (std::getline(input_file, line)) {
+		++line_number;
+		vector<string> values =
+			util::split_string(trim_line(line), header.separator);
+		if (values.size() != header.column_count) {
+			if (!line.empty())
+				++invalid_lines;
+			continue;
+		}
+
+		for (auto &column : columns) {
+			const string &value_str = values[column.column.value_column];
+			if (value_str.empty())
+				continue;
+
+			const string &time_str = values[column.column.time_column];
+			double timestamp;
+			if (!data::csvutil::parse_timestamp(time_str.data(),
+					time_str.data() + time_str.size(), timestamp,
+					date_time_cache)) {
+				++invalid_lines;
+				continue;
+			}
+			const char *value_end = value_str.data() + value_str.size();
+			double value;
+			if (!data::csvutil::parse_double(
+					value_str.data(), value_end, value)) {
+				++invalid_lines;
+				continue;
+			}
+
+			column.decimal_places = std::max(column.decimal_places,
+				data::csvutil::get_decimal_places(value_str.data(), value_end));
+			column.samples.push_back(std::make_pair(timestamp, (float)value));
+		}
+	}
+	if (invalid_lines > 0) {
+		qWarning() << "ReplayRecording::load_csv():" << invalid_lines <<
+			"invalid values in" << line_number << "lines skipped";
+	}
+
+	// Every CSV sample becomes a packet of its own, the samples don't have a
+	// fixed samplerate.
+	for (const auto &column : columns) {
+		for (const auto &sample : column.samples) {
+			ReplayPacket packet;
+			packet.channel_index = column.channel_index;
+			packet.timestamp = sample.first;
+			packet.samplerate = 0;
+			packet.quantity = column.column.quantity;
+			packet.quantity_flags = column.column.quantity_flags;
+			packet.unit = column.column.unit;
+			packet.digits = 7;
+			packet.decimal_places = column.decimal_places;
+			packet.samples.push_back(sample.second);
+			recording->packets_.push_back(std::move(packet));
+		}
+	}
+
+	recording->finish();
+	return recording;
+}
+
+shared_ptr<ReplayRecording> ReplayRecording::load_sigrok(
+	const shared_ptr<sigrok::Context> &sr_context,
+	const QString &file_name, const string &format_name)
+{
+	auto input_format = deviceutil::find_input_format(
+		sr_context, file_name.toStdString(), format_name);
+	if (!input_format) {
+		throw QString("No input format found for %1").arg(
+			format_name.empty() ? file_name : QString::fromStdString(format_name));
+	}
+
+	ifstream input_file(file_name.toStdString(), std::ios::binary);
+	if (!input_file)
+		throw QString("Could not open %1").arg(file_name);
+
+	auto recording = shared_ptr<ReplayRecording>(
+		new ReplayRecording(QFileInfo(file_name).completeBaseName()));
+
+	uint64_t samplerate = 0;
+	bool samplerate_warned = false;
+	bool quantity_warned = false;
+	map<size_t, uint64_t> sample_positions;
+
+	// The input module sends the packets synchronously from Input::send().
+	auto sr_session = sr_context->create_session();
+	sr_session->add_datafeed_callback([&]
+		(shared_ptr<sigrok::Device> sr_device, shared_ptr<sigrok::Packet> sr_packet) {
+			(void)sr_device;
+
+			if (sr_packet->type()->id() == SR_DF_META) {
+				auto sr_meta =
+					dynamic_pointer_cast<sigrok::Meta>(sr_packet->payload());
+				for (const auto &entry : sr_meta->config()) {
+					if (entry.first != sigrok::ConfigKey::SAMPLERATE)
+						continue;
+					samplerate = Glib::VariantBase::cast_dynamic
+						<Glib::Variant<guint64>>(entry.second).get();
+				}
+				return;
+			}
+			if (sr_packet->type()->id() != SR_DF_ANALOG)
+				return;
+
+			auto sr_analog =
+				dynamic_pointer_cast<sigrok::Analog>(sr_packet->payload());
+			size_t num_samples = sr_analog->num_samples();
+			if (num_samples == 0)
+				return;
+
+			data::Quantity quantity;
+			try {
+				quantity = data::datautil::get_quantity(sr_analog->mq());
+			}
+			catch (sigrok::Error &e) {
+				quantity = data::Quantity::Unknown;
+			}
+			data::Unit unit = data::datautil::get_unit(sr_analog->unit());
+			if (!data::datautil::is_valid_sr_quantity(quantity) ||
+					!data::datautil::get_sr_unit(unit)) {
+				if (!quantity_warned) {
+					qWarning() << "ReplayRecording::load_sigrok(): Samples " <<
+						"without a known quantity or unit skipped";
+					quantity_warned = true;
+				}
+				return;
+			}
+
+			if (samplerate == 0) {
+				if (!samplerate_warned) {
+					qWarning() << "ReplayRecording::load_sigrok(): No " <<
+						"samplerate in" << file_name << ", using 1 Hz";
+					samplerate_warned = true;
+				}
+				samplerate = 1;
+			}
+
+			// See HardwareChannel::push_interleaved_samples()
+			int digits = 7;
+			int decimal_places = -1;
+			if (sr_analog->digits() >= 0)
+				decimal_places = sr_analog->digits();
+			else
+				digits = -1 * sr_analog->digits();
+
+			const auto sr_channels = sr_analog->channels();
+			unique_ptr<float[]> data(new float[num_samples * sr_channels.size()]);
+			sr_analog->get_data_as_float(data.get());
+
+			for (size_t i = 0; i < sr_channels.size(); ++i) {
+				ReplayPacket packet;
+				packet.channel_index = recording->get_channel_index(
+					"", sr_channels[i]->name(), "");
+				uint64_t &position = sample_positions[packet.channel_index];
+				packet.timestamp = position / (double)samplerate;
+				packet.samplerate = samplerate;
+				packet.quantity = quantity;
+				packet.quantity_flags =
+					data::datautil::get_quantity_flags(sr_analog->mq_flags());
+				packet.unit = unit;
+				packet.digits = digits;
+				packet.decimal_places = decimal_places;
+				packet.samples.reserve(num_samples);
+				for (size_t j = 0; j < num_samples; ++j)
+					packet.samples.push_back(data[j * sr_channels.size() + i]);
+				position += num_samples;
+				recording->packets_.push_back(std::move(packet));
+			}
+		});
+
+	try {
+		auto input = input_format->create_input();
+		unique_ptr<char[]> buffer(new char[input_chunk_size]);
+
+		/*
+		 * The input module creates the device after it has seen enough data.
+		 * Packets can only be sent when the device is in a session, so the
+		 * input is reset and the file is read again from the start.
+		 */
+		shared_ptr<sigrok::Device> sr_device;
+		while (!sr_device) {
+			input_file.read(buffer.get(), input_chunk_size);
+			size_t size = input_file.gcount();
+			if (size == 0)
+				break;
+			input->send(buffer.get(), size);
+			try {
+				sr_device = input->device();
+			}
+			catch (sigrok::Error &e) {
+				// Device not ready yet
+			}
+		}
+		if (!sr_device)
+			throw QString("%1 contains no device").arg(file_name);
+
+		sr_session->add_device(sr_device);
+		input->reset();
+		input_file.clear();
+		input_file.seekg(0);
+
+		while (true) {
+			input_file.read(buffer.get(), input_chunk_size);
+			size_t size = input_file.gcount();
+			if (size == 0)
+				break;
+			input->send(buffer.get(), size);
+		}
+		input->end();
+	}
+	catch (sigrok::Error &e) {
+		throw QString("Could not read %1: %2").arg(file_name, e.what());
+	}
+
+	sr_session->remove_datafeed_callbacks();
+	sr_session->remove_devices();
+
+	if (recording->packets_.empty())
+		throw QString("%1 contains no analog data").arg(file_name);
+
+	recording->finish();
+	return recording;
+}
+
+QString ReplayRecording::name() const
+{
+	return name_;
+}
+
+const vector<ReplayChannel> &ReplayRecording::channels() const
+{
+	return channels_;
+}
+
+const vector<ReplayPacket> &ReplayRecording::packets() const
+{
+	return packets_;
+}
+
+double ReplayRecording::duration() const
+{
+	return duration_;
+}
+
+size_t ReplayRecording::sample_count() const
+{
+	return sample_count_;
+}
+
+size_t ReplayRecording::get_channel_index(const string &device_name,
+	const string &name, const string &channel_group_name)
+{
+	for (size_t i = 0; i < channels_.size(); ++i) {
+		if (channels_[i].device_name == device_name &&
+				channels_[i].channel_group_name == channel_group_name &&
+				channels_[i].name == name)
+			return i;
+	}
+
+	ReplayChannel channel;
+	channel.device_name = device_name;
+	channel.name = name;
+	channel.channel_group_name = channel_group_name;
+	channels_.push_back(channel);
+	return channels_.size() - 1;
+}
+
+void ReplayRecording::finish()
+{
+	if (packets_.empty())
+		return;
+
+	std::stable_sort(packets_.begin(), packets_.end(),
+		[](const ReplayPacket &a, const ReplayPacket &b) {
+			return a.timestamp < b.timestamp;
+		});
+
+	double start_timestamp = packets_.front().timestamp;
+	duration_ = 0;
+	sample_count_ = 0;
+	for (auto &packet : packets_) {
+		packet.timestamp -= start_timestamp;
+		double end_timestamp = packet.timestamp;
+		if (packet.samplerate > 0 && packet.samples.size() > 1) {
+			end_timestamp +=
+				(packet.samples.size() - 1) / (double)packet.samplerate;
+		}
+		duration_ = std::max(duration_, end_timestamp);
+		sample_count_ += packet.samples.size();
+	}
+}
+
+} // namespace devices
+} // namespace sv
@@ -0,0 +1,148 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_REPLAYRECORDING_HPP
+#define DEVICES_REPLAYRECORDING_HPP
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+#include "src/data/datautil.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sigrok {
+class Context;
+}
+
+namespace sv {
+namespace devices {
+
+/** A channel of a recording. */
+struct ReplayChannel
+{
+	/** The device the channel was recorded from, empty if unknown. */
+	string device_name;
+	string name;
+	string channel_group_name;
+};
+
+/**
+ * A packet of a recording. It holds one or more consecutive samples of a
+ * single channel with the meaning they were recorded with.
+ */
+struct ReplayPacket
+{
+	/** Index into ReplayRecording::channels(). */
+	size_t channel_index;
+	/** Timestamp of the first sample in s, relative to the recording start. */
+	double timestamp;
+	/** Samplerate of the samples, 0 if the packet has only one sample. */
+	uint64_t samplerate;
+	data::Quantity quantity;
+	set<data::QuantityFlag> quantity_flags;
+	data::Unit unit;
+	int digits;
+	int decimal_places;
+	vector<float> samples;
+};
+
+/**
+ * A ReplayRecording holds all packets of a recorded session in memory,
+ * sorted by their timestamps, so they can be played back by a ReplayDevice.
+ *
+ * A recording can be loaded from a CSV file, that was saved by SmuView, or
+ * from any file format for which libsigrok has an input module.
+ */
+class ReplayRecording
+{
+
+public:
+	/**
+	 * Load a recording from a file. If format_name is empty, files with the
+	 * extension ".csv" are read as SmuView CSV (see load_csv()), all other
+	 * files are read by the libsigrok input module matching the file
+	 * extension. Throws a QString on error.
+	 */
+	static shared_ptr<ReplayRecording> load(
+		const shared_ptr<sigrok::Context> &sr_context,
+		const QString &file_name, const string &format_name);
+
+	/**
+	 * Load a CSV file that was saved by SmuView (with separate or combined
+	 * time stamps). The quantity of a signal isn't stored in the CSV file,
+	 * it is derived from the unit. If separator is empty, it is detected
+	 * from the header. Throws a QString on error.
+	 */
+	static shared_ptr<ReplayRecording> load_csv(
+		const QString &file_name, const string &separator);
+
+	/**
+	 * Load a file with the libsigrok input module format_name, or with the
+	 * input module matching the file extension if format_name is empty.
+	 * Only analog data is read. Throws a QString on error.
+	 */
+	static shared_ptr<ReplayRecording> load_sigrok(
+		const shared_ptr<sigrok::Context> &sr_context,
+		const QString &file_name, const string &format_name);
+
+	/** The name of the recording, this is the base name of the file. */
+	QString name() const;
+	const vector<ReplayChannel> &channels() const;
+	/** All packets of the recording, sorted by their timestamp. */
+	const vector<ReplayPacket> &packets() const;
+	/** Timestamp of the last sample, relative to the recording start. */
+	double duration() const;
+	size_t sample_count() const;
+
+private:
+	explicit ReplayRecording(const QString &name);
+
+	/**
+	 * Return the index of the channel, that is identified by device, channel
+	 * group and channel name. A new channel is added if it is unknown.
+	 */
+	size_t get_channel_index(const string &device_name, const string &name,
+		const string &channel_group_name);
+	/**
+	 * Sort the packets by their timestamp and make the timestamps relative
+	 * to the first packet.
+	 */
+	void finish();
+
+	QString name_;
+	vector<ReplayChannel> channels_;
+	vector<ReplayPacket> packets_;
+	double duration_;
+	size_t sample_count_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_REPLAYRECORDING_HPP
@@ -0,0 +1,209 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QVariant>
+
+#include "sequencer.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/configurable.hpp"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::steady_clock;
+using std::lock_guard;
+using std::milli;
+using std::shared_ptr;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+Sequencer::Sequencer(shared_ptr<data::properties::DoubleProperty> property) :
+	property_(property),
+	repeat_count_(0),
+	catch_up_policy_(SequencerCatchUp::Skip),
+	is_running_(false),
+	stop_(false),
+	max_timing_error_(0.)
+{
+	assert(property_);
+}
+
+Sequencer::~Sequencer()
+{
+	stop();
+	wait();
+}
+
+void Sequencer::set_sequence(const vector<double> &values,
+	const vector<double> &delays)
+{
+	lock_guard<mutex> lock(mutex_);
+	if (is_running_)
+		return;
+
+	values_.clear();
+	delays_.clear();
+	size_t size = std::min(values.size(), delays.size());
+	for (size_t i = 0; i < size; ++i) {
+		if (delays[i] <= 0.)
+			continue;
+		values_.push_back(values[i]);
+		delays_.push_back(delays[i]);
+	}
+}
+
+void Sequencer::set_repeat_count(unsigned int repeat_count)
+{
+	lock_guard<mutex> lock(mutex_);
+	if (is_running_)
+		return;
+	repeat_count_ = repeat_count;
+}
+
+void Sequencer::set_catch_up_policy(SequencerCatchUp catch_up_policy)
+{
+	lock_guard<mutex> lock(mutex_);
+	if (is_running_)
+		return;
+	catch_up_policy_ = catch_up_policy;
+}
+
+void Sequencer::start()
+{
+	if (is_running_)
+		return;
+	if (sequencer_thread_.joinable())
+		sequencer_thread_.join();
+	if (values_.empty())
+		return;
+
+	stop_ = false;
+	is_running_ = true;
+	max_timing_error_ = 0.;
+	sequencer_thread_ = std::thread(&Sequencer::sequencer_thread_proc, this);
+}
+
+void Sequencer::stop()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cv_.notify_all();
+}
+
+void Sequencer::wait()
+{
+	if (sequencer_thread_.joinable() &&
+			sequencer_thread_.get_id() != std::this_thread::get_id())
+		sequencer_thread_.join();
+}
+
+bool Sequencer::is_running() const
+{
+	return is_running_;
+}
+
+double Sequencer::max_timing_error() const
+{
+	return max_timing_error_;
+}
+
+void Sequencer::sequencer_thread_proc()
+{
+	// The values can't change while running, no need to copy them.
+	const size_t size = values_.size();
+	size_t step = 0;
+	unsigned int cycle = 0;
+
+	const steady_clock::time_point start_time = steady_clock::now();
+	const double start_timestamp =
+		QDateTime::currentMSecsSinceEpoch() / (double)1000;
+	// The planned time of a step is always derived from the start time and
+	// the summed up delays, so rounding errors and late steps don't add up.
+	double planned_offset = 0.;
+
+	auto advance = [&]() {
+		planned_offset += delays_[step];
+		if (++step >= size) {
+			step = 0;
+			++cycle;
+		}
+		return repeat_count_ == 0 || cycle < repeat_count_;
+	};
+	auto to_time_point = [&](double offset) {
+		return start_time + duration_cast<steady_clock::duration>(
+			duration<double>(offset));
+	};
+
+	bool running = true;
+	while (running && !stop_) {
+		steady_clock::time_point planned_time = to_time_point(planned_offset);
+		{
+			unique_lock<mutex> lock(mutex_);
+			if (stop_cv_.wait_until(lock, planned_time,
+					[this] { return stop_.load(); }))
+				break;
+		}
+
+		if (catch_up_policy_ == SequencerCatchUp::Skip) {
+			// Jump to the step that should be active now.
+			steady_clock::time_point now = steady_clock::now();
+			while (running &&
+					to_time_point(planned_offset + delays_[step]) <= now)
+				running = advance();
+			if (!running)
+				break;
+		}
+
+		double value = values_[step];
+		double planned_timestamp = start_timestamp + planned_offset;
+		property_->change_value(QVariant(value));
+		// The value is set asynchronously, wait until it is on the wire.
+		property_->configurable()->wait_for_commands();
+
+		double timing_error = duration<double, milli>(
+			steady_clock::now() - to_time_point(planned_offset)).count();
+		double actual_timestamp = planned_timestamp + timing_error / 1000.;
+		if (timing_error > max_timing_error_)
+			max_timing_error_ = timing_error;
+		Q_EMIT step_executed((unsigned int)step, value, planned_timestamp,
+			actual_timestamp, timing_error);
+
+		running = advance();
+	}
+
+	is_running_ = false;
+	Q_EMIT sequence_finished();
+}
+
+} // namespace devices
+} // namespace sv
@@ -0,0 +1,123 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_SEQUENCER_HPP
+#define DEVICES_SEQUENCER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+
+using std::mutex;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+namespace properties {
+class DoubleProperty;
+}
+}
+
+namespace devices {
+
+/**
+ * How the sequencer handles steps whose scheduled time has already passed
+ * (e.g. because setting the previous value took longer than its delay).
+ */
+enum class SequencerCatchUp {
+	/** Drop the missed steps and continue with the step that is due now. */
+	Skip,
+	/** Execute the missed steps back to back until the schedule is reached. */
+	Burst,
+};
+
+/**
+ * The Sequencer plays a sequence of (value, delay) steps into a
+ * DoubleProperty in a dedicated thread. All steps are scheduled on an
+ * absolute steady clock time line, so the timing doesn't drift, even when
+ * setting a value is slow or the sequence is repeated many times.
+ */
+class Sequencer : public QObject
+{
+	Q_OBJECT
+
+public:
+	Sequencer(shared_ptr<data::properties::DoubleProperty> property);
+	~Sequencer();
+
+	/**
+	 * Set the sequence. Each value is held for the delay (in seconds) with
+	 * the same index. Steps with a delay <= 0 are ignored.
+	 */
+	void set_sequence(const vector<double> &values,
+		const vector<double> &delays);
+	/**
+	 * Set the number of cycles to play. 0 repeats the sequence infinitely.
+	 */
+	void set_repeat_count(unsigned int repeat_count);
+	void set_catch_up_policy(SequencerCatchUp catch_up_policy);
+
+	void start();
+	void stop();
+	void wait();
+	bool is_running() const;
+
+	/** Max. deviation from the planned step time of the last run in ms. */
+	double max_timing_error() const;
+
+private:
+	void sequencer_thread_proc();
+
+	shared_ptr<data::properties::DoubleProperty> property_;
+	vector<double> values_;
+	vector<double> delays_;
+	unsigned int repeat_count_;
+	SequencerCatchUp catch_up_policy_;
+
+	mutable mutex mutex_;
+	std::condition_variable stop_cv_;
+	std::atomic<bool> is_running_;
+	std::atomic<bool> stop_;
+	std::atomic<double> max_timing_error_;
+	std::thread sequencer_thread_;
+
+Q_SIGNALS:
+	/**
+	 * Is emitted after each step. The timestamps are in seconds since epoch,
+	 * the actual timestamp is taken after the value has been set, the
+	 * timing error (actual - planned) is in ms.
+	 */
+	void step_executed(unsigned int step, double value,
+		double planned_timestamp, double actual_timestamp,
+		double timing_error);
+	void sequence_finished();
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_SEQUENCER_HPP
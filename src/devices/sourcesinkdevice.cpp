@@ -30,12 +30,14 @@
 #include "src/data/properties/baseproperty.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/dividechannel.hpp"
+#include "src/channels/energychannel.hpp"
 #include "src/channels/hardwarechannel.hpp"
 #include "src/channels/integratechannel.hpp"
 #include "src/channels/mathchannel.hpp"
 #include "src/channels/multiplysschannel.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/energyaccumulator.hpp"
 #include "src/devices/configurable.hpp"
 
 using std::static_pointer_cast;
@@ -225,6 +227,33 @@ void SourceSinkDevice::init_channels()
 			BaseDevice::add_math_channel(resistance_channel, chg_name);
 		}
 
+		// Create Wh (with min/max/mean power) and Ah channels, that share
+		// one energy accumulator.
+		if (voltage_signal && current_signal && (!wh_signal || !ah_signal)) {
+			auto energy_accumulator = make_shared<data::EnergyAccumulator>(
+				voltage_signal, current_signal);
+			if (!wh_signal) {
+				shared_ptr<channels::EnergyChannel> wh_channel =
+					make_shared<channels::EnergyChannel>(
+						data::Quantity::Work, energy_accumulator,
+						shared_from_this(),
+						chg_names, "Wh" + ch_suffix,
+						aquisition_start_timestamp_);
+				BaseDevice::add_math_channel(wh_channel, chg_name);
+			}
+			if (!ah_signal) {
+				shared_ptr<channels::EnergyChannel> ah_channel =
+					make_shared<channels::EnergyChannel>(
+						data::Quantity::ElectricCharge, energy_accumulator,
+						shared_from_this(),
+						chg_names, "Ah" + ch_suffix,
+						aquisition_start_timestamp_);
+				BaseDevice::add_math_channel(ah_channel, chg_name);
+			}
+			energy_accumulator->init();
+			continue;
+		}
+
 		// Create Wh channel
 		if (power_signal && !wh_signal) {
 			shared_ptr<channels::IntegrateChannel> wh_channel =
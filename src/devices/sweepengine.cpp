@@ -0,0 +1,419 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QVariant>
+
+#include "sweepengine.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/devices/configurable.hpp"
+
+using std::lock_guard;
+using std::make_pair;
+using std::make_shared;
+using std::pair;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+namespace {
+
+/** Poll interval while waiting for the signals to settle. */
+const int settle_poll_interval_ms = 10;
+
+double now_timestamp()
+{
+	return QDateTime::currentMSecsSinceEpoch() / (double)1000;
+}
+
+/**
+ * Get the (linear interpolated) value at the timestamp. Timestamps outside
+ * of the samples get the first/last value.
+ */
+double get_value_at_timestamp(const deque<pair<double, double>> &samples,
+	double timestamp)
+{
+	auto upper = std::lower_bound(samples.begin(), samples.end(),
+		make_pair(timestamp, std::numeric_limits<double>::lowest()));
+	if (upper == samples.begin())
+		return upper->second;
+	if (upper == samples.end())
+		return samples.back().second;
+	if (upper->first == timestamp)
+		return upper->second;
+
+	auto lower = upper - 1;
+	double ts_factor =
+		(timestamp - lower->first) / (upper->first - lower->first);
+	return lower->second + (upper->second - lower->second) * ts_factor;
+}
+
+} // namespace
+
+SweepEngine::SweepEngine(
+		shared_ptr<data::properties::DoubleProperty> property,
+		shared_ptr<BaseDevice> result_device) :
+	property_(property),
+	result_device_(result_device),
+	abs_tolerance_(0.),
+	rel_tolerance_(0.001),
+	window_(0.5),
+	timeout_(10.),
+	is_running_(false),
+	stop_(false)
+{
+	assert(property_);
+	assert(result_device_);
+}
+
+SweepEngine::~SweepEngine()
+{
+	stop();
+	wait();
+}
+
+shared_ptr<data::properties::DoubleProperty> SweepEngine::property() const
+{
+	return property_;
+}
+
+void SweepEngine::add_signal(shared_ptr<data::AnalogTimeSignal> signal)
+{
+	lock_guard<mutex> lock(mutex_);
+	if (is_running_ || !signal)
+		return;
+	if (std::find(signals_.begin(), signals_.end(), signal) != signals_.end())
+		return;
+	signals_.push_back(signal);
+}
+
+vector<shared_ptr<data::AnalogTimeSignal>> SweepEngine::signals() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return signals_;
+}
+
+void SweepEngine::set_range(double start, double stop, double step)
+{
+	vector<double> setpoints;
+	if (step == 0.) {
+		setpoints.push_back(start);
+	}
+	else {
+		step = start <= stop ? std::fabs(step) : -std::fabs(step);
+		// Use the step count, to not accumulate rounding errors.
+		size_t count = (size_t)std::floor((stop - start) / step + 1e-9) + 1;
+		for (size_t i = 0; i < count; ++i)
+			setpoints.push_back(start + i * step);
+	}
+	set_setpoints(setpoints);
+}
+
+void SweepEngine::set_setpoints(const vector<double> &setpoints)
+{
+	lock_guard<mutex> lock(mutex_);
+	if (is_running_)
+		return;
+	setpoints_ = setpoints;
+}
+
+vector<double> SweepEngine::setpoints() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return setpoints_;
+}
+
+void SweepEngine::set_settling(double abs_tolerance, double rel_tolerance,
+	double window, double timeout)
+{
+	lock_guard<mutex> lock(mutex_);
+	if (is_running_)
+		return;
+	abs_tolerance_ = std::fabs(abs_tolerance);
+	rel_tolerance_ = std::fabs(rel_tolerance);
+	window_ = std::max(0., window);
+	timeout_ = std::max(0., timeout);
+}
+
+void SweepEngine::start()
+{
+	if (is_running_)
+		return;
+	if (sweep_thread_.joinable())
+		sweep_thread_.join();
+
+	init_result_channels();
+
+	stop_ = false;
+	is_running_ = true;
+	sweep_thread_ = std::thread(&SweepEngine::sweep_thread_proc, this);
+}
+
+void SweepEngine::stop()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	stop_cv_.notify_all();
+}
+
+void SweepEngine::wait()
+{
+	if (sweep_thread_.joinable() &&
+			sweep_thread_.get_id() != std::this_thread::get_id())
+		sweep_thread_.join();
+}
+
+bool SweepEngine::is_running() const
+{
+	return is_running_;
+}
+
+vector<shared_ptr<channels::UserChannel>> SweepEngine::result_channels() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return result_channels_;
+}
+
+void SweepEngine::init_result_channels()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	// Reuse the channels of a previous run, if the signals haven't changed.
+	// The swept property is fixed for the engine.
+	if (!result_channels_.empty() && result_signals_ == signals_)
+		return;
+
+	result_signals_ = signals_;
+	result_channels_.clear();
+	result_channels_.push_back(result_device_->add_user_channel(
+		"Sweep " + property_->name(), "Sweep"));
+	for (const auto &signal : signals_) {
+		result_channels_.push_back(result_device_->add_user_channel(
+			"Sweep " + signal->name(), "Sweep"));
+	}
+}
+
+void SweepEngine::sweep_thread_proc()
+{
+	vector<double> setpoints = this->setpoints();
+
+	qWarning() << "SweepEngine::sweep_thread_proc(): Start sweep of " <<
+		property_->display_name() << " with " << setpoints.size() << " steps";
+	Q_EMIT sweep_started();
+
+	connect_signals();
+	for (size_t step = 0; step < setpoints.size(); ++step) {
+		if (stop_)
+			break;
+
+		double setpoint = setpoints[step];
+		property_->change_value(QVariant(setpoint));
+		property_->configurable()->wait_for_commands();
+		double set_timestamp = now_timestamp();
+		clear_signal_buffers();
+
+		bool settled = wait_for_settling(set_timestamp);
+		if (stop_)
+			break;
+		if (!settled) {
+			qWarning() << "SweepEngine::sweep_thread_proc(): Step " << step <<
+				" (" << setpoint << ") did not settle within " << timeout_ <<
+				" s";
+		}
+
+		capture_tuple(setpoint);
+		Q_EMIT step_finished(step, setpoint, settled);
+	}
+	disconnect_signals();
+
+	is_running_ = false;
+	qWarning() << "SweepEngine::sweep_thread_proc(): Sweep finished";
+	Q_EMIT sweep_finished();
+}
+
+void SweepEngine::connect_signals()
+{
+	for (const auto &signal : signals_) {
+		auto buffer = make_shared<SignalBuffer>();
+		buffer->pos = signal->sample_count();
+		signal_buffers_.push_back(buffer);
+
+		// Copy directly in the thread that appends the samples. The lambda
+		// doesn't use the engine, only the (shared) buffer.
+		data::AnalogTimeSignal *sig = signal.get();
+		signal_connections_.push_back(connect(sig,
+			&data::AnalogTimeSignal::sample_appended, this,
+			[buffer, sig]() {
+				lock_guard<mutex> lock(buffer->mtx);
+				const size_t sample_count = sig->sample_count();
+				if (buffer->pos > sample_count)
+					buffer->pos = 0; // The signal has been cleared.
+				for (; buffer->pos < sample_count; ++buffer->pos) {
+					buffer->samples.push_back(
+						sig->get_sample(buffer->pos, false));
+				}
+			},
+			Qt::DirectConnection));
+	}
+}
+
+void SweepEngine::disconnect_signals()
+{
+	for (const auto &connection : signal_connections_)
+		disconnect(connection);
+	signal_connections_.clear();
+	signal_buffers_.clear();
+}
+
+void SweepEngine::clear_signal_buffers()
+{
+	for (const auto &buffer : signal_buffers_) {
+		lock_guard<mutex> lock(buffer->mtx);
+		if (buffer->samples.size() > 1) {
+			buffer->samples.erase(
+				buffer->samples.begin(), buffer->samples.end() - 1);
+		}
+	}
+}
+
+bool SweepEngine::wait_for_settling(double set_timestamp)
+{
+	auto deadline = std::chrono::steady_clock::now() +
+		std::chrono::milliseconds((int64_t)(timeout_ * 1000));
+
+	while (true) {
+		bool settled = true;
+		for (const auto &buffer : signal_buffers_) {
+			if (!is_settled(buffer, set_timestamp)) {
+				settled = false;
+				break;
+			}
+		}
+		if (settled)
+			return true;
+
+		unique_lock<mutex> lock(mutex_);
+		if (stop_cv_.wait_for(lock,
+				std::chrono::milliseconds(settle_poll_interval_ms),
+				[this] { return stop_.load(); }))
+			return false;
+		if (std::chrono::steady_clock::now() >= deadline)
+			return false;
+	}
+}
+
+bool SweepEngine::is_settled(shared_ptr<SignalBuffer> buffer,
+	double set_timestamp) const
+{
+	lock_guard<mutex> lock(buffer->mtx);
+	const auto &samples = buffer->samples;
+	if (samples.empty())
+		return false;
+
+	// The settling window must be completely after the setpoint change.
+	double last_ts = samples.back().first;
+	if (window_ <= 0.)
+		return last_ts > set_timestamp;
+	double window_start = last_ts - window_;
+	if (window_start < set_timestamp)
+		return false;
+
+	double min = std::numeric_limits<double>::max();
+	double max = std::numeric_limits<double>::lowest();
+	double sum = 0.;
+	size_t n = 0;
+	for (auto it = samples.rbegin(); it != samples.rend(); ++it) {
+		const auto &sample = *it;
+		if (sample.first < window_start)
+			break;
+		min = std::min(min, sample.second);
+		max = std::max(max, sample.second);
+		sum += sample.second;
+		++n;
+	}
+	// Need at least two samples inside the window to detect a drift.
+	if (n < 2)
+		return false;
+
+	double tolerance = abs_tolerance_ + rel_tolerance_ * std::fabs(sum / n);
+	return (max - min) <= tolerance;
+}
+
+bool SweepEngine::capture_tuple(double setpoint)
+{
+	// Use the youngest common timestamp of all signals, so that the values
+	// of the tuple are (interpolated) at the same point in time.
+	double timestamp = std::numeric_limits<double>::max();
+	for (const auto &buffer : signal_buffers_) {
+		lock_guard<mutex> lock(buffer->mtx);
+		if (buffer->samples.empty())
+			return false;
+		timestamp = std::min(timestamp, buffer->samples.back().first);
+	}
+	if (signal_buffers_.empty())
+		timestamp = now_timestamp();
+
+	vector<double> values;
+	for (const auto &buffer : signal_buffers_) {
+		lock_guard<mutex> lock(buffer->mtx);
+		values.push_back(get_value_at_timestamp(buffer->samples, timestamp));
+	}
+
+	auto channels = result_channels();
+	channels[0]->push_sample(setpoint, timestamp,
+		data::datautil::get_quantity_from_unit(property_->unit()),
+		set<data::QuantityFlag>(),
+		property_->unit(), property_->digits(), property_->decimal_places());
+	for (size_t i = 0; i < signals_.size(); ++i) {
+		const auto &signal = signals_[i];
+		channels[i+1]->push_sample(values[i], timestamp,
+			signal->quantity(), signal->quantity_flags(), signal->unit(),
+			signal->digits(), signal->decimal_places());
+	}
+
+	return true;
+}
+
+} // namespace devices
+} // namespace sv
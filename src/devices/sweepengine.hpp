@@ -0,0 +1,177 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_SWEEPENGINE_HPP
+#define DEVICES_SWEEPENGINE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QMetaObject>
+#include <QObject>
+
+using std::deque;
+using std::mutex;
+using std::pair;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+namespace data {
+class AnalogTimeSignal;
+namespace properties {
+class DoubleProperty;
+}
+}
+
+namespace devices {
+
+class BaseDevice;
+
+/**
+ * The SweepEngine steps a DoubleProperty through a list of setpoints. After
+ * each step it waits until all selected signals have settled (all samples
+ * within the settling window are inside the tolerance band) and captures
+ * one synchronized measurement tuple, that is pushed into user channels of
+ * the result device.
+ */
+class SweepEngine : public QObject
+{
+	Q_OBJECT
+
+public:
+	SweepEngine(shared_ptr<data::properties::DoubleProperty> property,
+		shared_ptr<BaseDevice> result_device);
+	~SweepEngine();
+
+	shared_ptr<data::properties::DoubleProperty> property() const;
+
+	/**
+	 * Add a signal that must settle and is captured after each step.
+	 */
+	void add_signal(shared_ptr<data::AnalogTimeSignal> signal);
+	vector<shared_ptr<data::AnalogTimeSignal>> signals() const;
+
+	/**
+	 * Set the setpoints from start to stop (inclusive) with the given step.
+	 */
+	void set_range(double start, double stop, double step);
+	void set_setpoints(const vector<double> &setpoints);
+	vector<double> setpoints() const;
+
+	/**
+	 * Set the settling criteria.
+	 *
+	 * @param abs_tolerance The absolute tolerance band (peak to peak).
+	 * @param rel_tolerance The tolerance band relative to the mean value.
+	 * @param window The settling window in seconds.
+	 * @param timeout Max. time in seconds to wait for settling. The tuple is
+	 *        captured anyway after the timeout.
+	 */
+	void set_settling(double abs_tolerance, double rel_tolerance,
+		double window, double timeout);
+
+	/**
+	 * Start the sweep in a separate thread.
+	 */
+	void start();
+	/**
+	 * Stop a running sweep after the actual step.
+	 */
+	void stop();
+	/**
+	 * Block until the sweep has finished.
+	 */
+	void wait();
+	bool is_running() const;
+
+	/**
+	 * Returns the result channels. The first channel holds the setpoints,
+	 * the other channels the captured values in the order of signals().
+	 */
+	vector<shared_ptr<channels::UserChannel>> result_channels() const;
+
+private:
+	/**
+	 * The new samples of a signal are copied into the buffer in the thread,
+	 * that appends them, so the sweep thread never reads the growing signal.
+	 * The buffer is shared with the sample_appended lambda.
+	 */
+	struct SignalBuffer {
+		mutex mtx;
+		/** Position of the next sample to copy from the signal. */
+		size_t pos;
+		/** Samples since the last setpoint change, plus the one before. */
+		deque<pair<double, double>> samples;
+	};
+
+	void init_result_channels();
+	void sweep_thread_proc();
+	void connect_signals();
+	void disconnect_signals();
+	/** Drop all buffered samples, except the last one. */
+	void clear_signal_buffers();
+	bool wait_for_settling(double set_timestamp);
+	bool is_settled(shared_ptr<SignalBuffer> buffer,
+		double set_timestamp) const;
+	bool capture_tuple(double setpoint);
+
+	shared_ptr<data::properties::DoubleProperty> property_;
+	shared_ptr<BaseDevice> result_device_;
+	vector<shared_ptr<data::AnalogTimeSignal>> signals_;
+	vector<shared_ptr<channels::UserChannel>> result_channels_;
+	/** The signals, the result channels have been created for. */
+	vector<shared_ptr<data::AnalogTimeSignal>> result_signals_;
+	vector<double> setpoints_;
+	double abs_tolerance_;
+	double rel_tolerance_;
+	double window_;
+	double timeout_;
+
+	mutable mutex mutex_;
+	std::condition_variable stop_cv_;
+	std::atomic<bool> is_running_;
+	std::atomic<bool> stop_;
+	std::thread sweep_thread_;
+
+	// Only used by the sweep thread
+	vector<shared_ptr<SignalBuffer>> signal_buffers_;
+	vector<QMetaObject::Connection> signal_connections_;
+
+Q_SIGNALS:
+	void sweep_started();
+	void step_finished(unsigned int step, double setpoint, bool settled);
+	void sweep_finished();
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_SWEEPENGINE_HPP
@@ -0,0 +1,77 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QObject>
+#include <QTimer>
+
+#include "eventloopmonitor.hpp"
+
+namespace sv {
+
+EventLoopMonitor::EventLoopMonitor(int interval, QObject *parent) :
+	QObject(parent),
+	probe_time_(0),
+	probe_pending_(false),
+	lag_(0.),
+	max_lag_(0.)
+{
+	clock_.start();
+	connect(&timer_, SIGNAL(timeout()), this, SLOT(on_timer()));
+	timer_.start(interval);
+}
+
+double EventLoopMonitor::lag() const
+{
+	return lag_;
+}
+
+double EventLoopMonitor::max_lag() const
+{
+	return max_lag_;
+}
+
+void EventLoopMonitor::reset()
+{
+	lag_ = 0.;
+	max_lag_ = 0.;
+}
+
+void EventLoopMonitor::on_timer()
+{
+	// Don't flood a busy event loop with probes.
+	if (probe_pending_)
+		return;
+
+	probe_pending_ = true;
+	probe_time_ = clock_.nsecsElapsed();
+	QMetaObject::invokeMethod(this, "on_probe", Qt::QueuedConnection);
+}
+
+void EventLoopMonitor::on_probe()
+{
+	probe_pending_ = false;
+	double lag = (clock_.nsecsElapsed() - probe_time_) / 1000000.;
+	lag_ = lag;
+	if (lag > max_lag_)
+		max_lag_ = lag;
+}
+
+} // namespace sv
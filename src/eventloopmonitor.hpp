@@ -0,0 +1,68 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTLOOPMONITOR_HPP
+#define EVENTLOOPMONITOR_HPP
+
+#include <atomic>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+namespace sv {
+
+/**
+ * The EventLoopMonitor measures the load of the event loop of the thread it
+ * lives in. Qt doesn't expose the number of pending events, so a probe event
+ * is posted periodically and the time until it is delivered is measured.
+ * A queued event is delivered after all events that were posted before, so
+ * the lag grows with the depth of the event queue.
+ */
+class EventLoopMonitor : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** Post a probe every interval ms. */
+	EventLoopMonitor(int interval = 100, QObject *parent = nullptr);
+
+	/** The lag of the last probe in ms. */
+	double lag() const;
+	/** The max. lag since the last reset in ms. */
+	double max_lag() const;
+	void reset();
+
+private:
+	QTimer timer_;
+	QElapsedTimer clock_;
+	qint64 probe_time_;
+	bool probe_pending_;
+	std::atomic<double> lag_;
+	std::atomic<double> max_lag_;
+
+private Q_SLOTS:
+	void on_timer();
+	void on_probe();
+
+};
+
+} // namespace sv
+
+#endif // EVENTLOOPMONITOR_HPP
@@ -0,0 +1,698 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QString>
+
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include "fileimporter.hpp"
+#include "src/session.hpp"
+#include "src/tracer.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/csvutil.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/deviceutil.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::lock_guard;
+using std::make_pair;
+using std::make_shared;
+using std::make_tuple;
+using std::pair;
+using std::tuple;
+using std::unique_lock;
+using std::unique_ptr;
+
+namespace sv {
+
+namespace {
+
+/** Size of the chunks in which a CSV file is parsed. */
+const qint64 csv_chunk_size = 8 * 1024 * 1024;
+
+/** Size of the chunks that are sent to a libsigrok input module. */
+const qint64 sr_input_chunk_size = 4 * 1024 * 1024;
+
+/** The digits of CSV values, they are not stored in the file. */
+const int csv_digits = 7;
+
+typedef pair<const char *, const char *> field_t;
+
+/** Split the line [begin, end) into its fields. */
+void split_fields(const char *begin, const char *end, const string &separator,
+	vector<field_t> &fields)
+{
+	fields.clear();
+	const char *field = begin;
+	while (true) {
+		const char *field_end;
+		if (separator.size() == 1) {
+			field_end = (const char *)memchr(field, separator[0], end - field);
+			if (!field_end)
+				field_end = end;
+		}
+		else {
+			field_end = std::search(field, end,
+				separator.begin(), separator.end());
+		}
+
+		fields.push_back(make_pair(field, field_end));
+		if (field_end == end)
+			break;
+		field = field_end + separator.size();
+	}
+}
+
+} // namespace
+
+/** The parsed values of a CSV chunk, by value column. */
+struct FileImporter::CsvChunk
+{
+	struct Column
+	{
+		vector<double> timestamps;
+		vector<double> values;
+		int decimal_places;
+	};
+
+	vector<Column> columns;
+	qint64 size;
+	size_t invalid_values;
+};
+
+FileImporter::FileImporter(const shared_ptr<sigrok::Context> &sr_context,
+		const QString &file_name, const string &format_name) :
+	sr_context_(sr_context),
+	file_name_(file_name),
+	format_name_(format_name),
+	file_(file_name),
+	data_(nullptr),
+	size_(0),
+	data_start_(0),
+	time_offset_(0),
+	csv_chunk_count_(0),
+	csv_next_chunk_(0),
+	csv_next_commit_(0),
+	csv_invalid_values_(0),
+	sr_samplerate_(0),
+	sr_samplerate_warned_(false),
+	sr_quantity_warned_(false),
+	running_(false),
+	cancel_(false),
+	bytes_done_(0),
+	sample_count_(0)
+{
+}
+
+FileImporter::~FileImporter()
+{
+	cancel();
+	wait();
+
+	if (sr_session_) {
+		sr_session_->remove_datafeed_callbacks();
+		sr_session_->remove_devices();
+	}
+	if (data_)
+		file_.unmap(data_);
+}
+
+shared_ptr<devices::UserDevice> FileImporter::open()
+{
+	if (device_)
+		return device_;
+
+	if (!file_.open(QIODevice::ReadOnly))
+		throw QString("Could not open %1").arg(file_name_);
+	size_ = file_.size();
+	if (size_ == 0)
+		throw QString("%1 is empty").arg(file_name_);
+	// The file isn't read into memory, the pages are loaded on demand.
+	data_ = file_.map(0, size_);
+	if (!data_)
+		throw QString("Could not map %1").arg(file_name_);
+
+	device_ = make_shared<devices::UserDevice>(sr_context_,
+		"Import", QFileInfo(file_name_).fileName().toStdString(), "");
+
+	try {
+		if (format_name_.empty() &&
+				QFileInfo(file_name_).suffix().toLower() == "csv")
+			open_csv();
+		else
+			open_sigrok();
+	}
+	catch (const QString &e) {
+		device_.reset();
+		throw;
+	}
+
+	return device_;
+}
+
+void FileImporter::start()
+{
+	if (!device_ || import_thread_.joinable())
+		return;
+
+	cancel_ = false;
+	running_ = true;
+	bytes_done_ = 0;
+	import_thread_ = std::thread(&FileImporter::import_thread_proc, this);
+}
+
+void FileImporter::cancel()
+{
+	cancel_ = true;
+
+	// Wake up the CSV workers, that wait for their turn to commit.
+	lock_guard<mutex> lock(csv_commit_mutex_);
+	csv_commit_cond_.notify_all();
+}
+
+void FileImporter::wait()
+{
+	if (import_thread_.joinable())
+		import_thread_.join();
+}
+
+bool FileImporter::is_running() const
+{
+	return running_;
+}
+
+QString FileImporter::file_name() const
+{
+	return file_name_;
+}
+
+shared_ptr<devices::UserDevice> FileImporter::device() const
+{
+	return device_;
+}
+
+uint64_t FileImporter::sample_count() const
+{
+	return sample_count_;
+}
+
+QString FileImporter::error() const
+{
+	lock_guard<mutex> lock(error_mutex_);
+	return error_;
+}
+
+void FileImporter::open_csv()
+{
+	const char *data = (const char *)data_;
+
+	// Header: device, channel groups, channel, signal
+	vector<string> header_lines;
+	qint64 pos = 0;
+	while (header_lines.size() < data::csvutil::header_line_count &&
+			pos < size_) {
+		const char *line = data + pos;
+		const char *line_end = (const char *)memchr(line, '\n', size_ - pos);
+		if (!line_end)
+			line_end = data + size_;
+		pos = line_end - data + 1;
+		if (line_end > line && *(line_end - 1) == '\r')
+			--line_end;
+		header_lines.push_back(string(line, line_end));
+	}
+	if (!data::csvutil::parse_header(header_lines, "", csv_header_))
+		throw QString("%1 is not a SmuView CSV file").arg(file_name_);
+	if (csv_header_.columns.empty())
+		throw QString("%1 contains no signals").arg(file_name_);
+	data_start_ = std::min(pos, size_);
+	csv_chunk_count_ =
+		(size_t)((size_ - data_start_ + csv_chunk_size - 1) / csv_chunk_size);
+
+	/*
+	 * Relative timestamps are shifted to the session start. The channels of
+	 * a file with absolute timestamps start with the first timestamp, so the
+	 * relative time starts at 0, too.
+	 */
+	time_offset_ = Session::session_start_timestamp;
+	bool absolute_time = false;
+	double first_timestamp = 0;
+	const char *line = data + data_start_;
+	const char *line_end = (const char *)memchr(
+		line, '\n', size_ - data_start_);
+	if (!line_end)
+		line_end = data + size_;
+	vector<field_t> fields;
+	split_fields(line, line_end, csv_header_.separator, fields);
+	data::csvutil::DateTimeCache date_time_cache;
+	if (!data::csvutil::parse_double(
+			fields[0].first, fields[0].second, first_timestamp) &&
+			data::csvutil::parse_timestamp(fields[0].first, fields[0].second,
+				first_timestamp, date_time_cache)) {
+		absolute_time = true;
+		time_offset_ = 0;
+	}
+
+	// The channels are identified by device, channel group and channel name.
+	map<tuple<string, string, string>, shared_ptr<channels::UserChannel>>
+		channels;
+	for (const auto &column : csv_header_.columns) {
+		auto &channel = channels[make_tuple(column.device_name,
+			column.channel_group_name, column.channel_name)];
+		if (!channel) {
+			channel = device_->add_user_channel(
+				column.channel_name, column.channel_group_name);
+			if (absolute_time)
+				channel->on_aquisition_start_timestamp_changed(first_timestamp);
+		}
+
+		CsvSignal csv_signal;
+		csv_signal.signal = dynamic_pointer_cast<data::AnalogTimeSignal>(
+			channel->add_signal(
+				column.quantity, column.quantity_flags, column.unit));
+		csv_signal.decimal_places = 0;
+		csv_signals_.push_back(csv_signal);
+	}
+}
+
+void FileImporter::open_sigrok()
+{
+	auto input_format = devices::deviceutil::find_input_format(
+		sr_context_, file_name_.toStdString(), format_name_);
+	if (!input_format) {
+		throw QString("No input format found for %1").arg(format_name_.empty() ?
+			file_name_ : QString::fromStdString(format_name_));
+	}
+
+	try {
+		sr_input_ = input_format->create_input();
+
+		/*
+		 * The input module creates the device after it has seen enough data.
+		 * Packets can only be sent when the device is in a session, so the
+		 * input is reset and the import thread sends the file again from
+		 * the start.
+		 */
+		shared_ptr<sigrok::Device> sr_device;
+		for (qint64 pos = 0; !sr_device && pos < size_;
+				pos += sr_input_chunk_size) {
+			sr_input_->send(data_ + pos,
+				(size_t)std::min(sr_input_chunk_size, size_ - pos));
+			try {
+				sr_device = sr_input_->device();
+			}
+			catch (sigrok::Error &e) {
+				// Device not ready yet
+			}
+		}
+		if (!sr_device)
+			throw QString("%1 contains no device").arg(file_name_);
+
+		sr_session_ = sr_context_->create_session();
+		sr_session_->add_device(sr_device);
+		sr_input_->reset();
+
+		for (const auto &sr_channel : sr_device->channels()) {
+			if (sr_channel->type() != sigrok::ChannelType::ANALOG)
+				continue;
+			sr_channels_[sr_channel->name()] =
+				device_->add_user_channel(sr_channel->name(), "");
+		}
+	}
+	catch (sigrok::Error &e) {
+		throw QString("Could not read %1: %2").arg(file_name_, e.what());
+	}
+	if (sr_channels_.empty())
+		throw QString("%1 contains no analog channels").arg(file_name_);
+
+	time_offset_ = Session::session_start_timestamp;
+}
+
+void FileImporter::import_thread_proc()
+{
+	Tracer::set_thread_name(
+		"Import " + QFileInfo(file_name_).fileName().toStdString());
+
+	auto start_time = std::chrono::steady_clock::now();
+	try {
+		if (sr_input_)
+			import_sigrok();
+		else
+			import_csv();
+	}
+	catch (sigrok::Error &e) {
+		set_error(QString("Could not read %1: %2").arg(file_name_, e.what()));
+	}
+	catch (const std::bad_alloc &e) {
+		set_error(QString("Not enough memory to import %1").arg(file_name_));
+	}
+	std::chrono::duration<double> duration =
+		std::chrono::steady_clock::now() - start_time;
+
+	qWarning() << "FileImporter: Imported" << sample_count_ <<
+		"samples from" << file_name_ << "in" << duration.count() << "s" <<
+		(cancel_ ? "(canceled)" : "");
+
+	running_ = false;
+	Q_EMIT import_finished();
+}
+
+void FileImporter::import_csv()
+{
+	csv_next_chunk_ = 0;
+	csv_next_commit_ = 0;
+	csv_invalid_values_ = 0;
+
+	size_t thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+	thread_count = std::min(thread_count, csv_chunk_count_);
+	vector<std::thread> workers;
+	for (size_t i = 0; i < thread_count; ++i)
+		workers.push_back(std::thread(&FileImporter::csv_worker_proc, this));
+	for (auto &worker : workers)
+		worker.join();
+
+	if (csv_invalid_values_ > 0) {
+		qWarning() << "FileImporter::import_csv():" << csv_invalid_values_ <<
+			"invalid values in" << file_name_ << "skipped";
+	}
+}
+
+void FileImporter::csv_worker_proc()
+{
+	Tracer::set_thread_name("Import worker");
+
+	const char *data = (const char *)data_;
+	data::csvutil::DateTimeCache date_time_cache;
+	CsvChunk chunk;
+	chunk.columns.resize(csv_header_.columns.size());
+
+	try {
+		while (!cancel_) {
+			const size_t index = csv_next_chunk_++;
+			if (index >= csv_chunk_count_)
+				break;
+
+			// A chunk starts with the first line that starts in the chunk.
+			const qint64 begin =
+				csv_line_start(data_start_ + index * csv_chunk_size);
+			const qint64 end =
+				csv_line_start(data_start_ + (index + 1) * csv_chunk_size);
+			for (auto &column : chunk.columns) {
+				column.timestamps.clear();
+				column.values.clear();
+				column.decimal_places = 0;
+			}
+			chunk.size = end - begin;
+			chunk.invalid_values = 0;
+			{
+				SV_TRACE_SCOPE("import", "parse_csv_chunk");
+				parse_csv_chunk(
+					data + begin, data + end, chunk, date_time_cache);
+			}
+
+			// The chunks are committed in file order.
+			unique_lock<mutex> lock(csv_commit_mutex_);
+			csv_commit_cond_.wait(lock, [this, index]() {
+				return cancel_ || csv_next_commit_ == index;
+			});
+			if (cancel_)
+				break;
+			commit_csv_chunk(chunk);
+			++csv_next_commit_;
+			csv_commit_cond_.notify_all();
+		}
+	}
+	catch (const std::bad_alloc &e) {
+		set_error(QString("Not enough memory to import %1").arg(file_name_));
+		cancel();
+	}
+}
+
+qint64 FileImporter::csv_line_start(qint64 pos) const
+{
+	if (pos <= data_start_)
+		return data_start_;
+	if (pos >= size_)
+		return size_;
+
+	const char *data = (const char *)data_;
+	const char *line_end =
+		(const char *)memchr(data + pos - 1, '\n', size_ - pos + 1);
+	if (!line_end)
+		return size_;
+	return line_end - data + 1;
+}
+
+void FileImporter::parse_csv_chunk(const char *begin, const char *end,
+	CsvChunk &chunk, data::csvutil::DateTimeCache &date_time_cache) const
+{
+	const auto &columns = csv_header_.columns;
+	vector<field_t> fields;
+	fields.reserve(csv_header_.column_count);
+
+	const char *line = begin;
+	while (line < end) {
+		const char *line_end = (const char *)memchr(line, '\n', end - line);
+		if (!line_end)
+			line_end = end;
+		const char *next_line = line_end < end ? line_end + 1 : end;
+		if (line_end > line && *(line_end - 1) == '\r')
+			--line_end;
+		if (line_end == line) {
+			line = next_line;
+			continue;
+		}
+
+		split_fields(line, line_end, csv_header_.separator, fields);
+		if (fields.size() != csv_header_.column_count) {
+			++chunk.invalid_values;
+			line = next_line;
+			continue;
+		}
+
+		double combined_timestamp = 0;
+		bool combined_timestamp_ok = csv_header_.combined &&
+			data::csvutil::parse_timestamp(fields[0].first, fields[0].second,
+				combined_timestamp, date_time_cache);
+
+		for (size_t i = 0; i < columns.size(); ++i) {
+			// Signals in a file with separate timestamps can be shorter.
+			const field_t &value_field = fields[columns[i].value_column];
+			if (value_field.first == value_field.second)
+				continue;
+
+			double timestamp = combined_timestamp;
+			if (csv_header_.combined) {
+				if (!combined_timestamp_ok) {
+					++chunk.invalid_values;
+					continue;
+				}
+			}
+			else {
+				const field_t &time_field = fields[columns[i].time_column];
+				if (!data::csvutil::parse_timestamp(time_field.first,
+						time_field.second, timestamp, date_time_cache)) {
+					++chunk.invalid_values;
+					continue;
+				}
+			}
+			double value;
+			if (!data::csvutil::parse_double(
+					value_field.first, value_field.second, value)) {
+				++chunk.invalid_values;
+				continue;
+			}
+
+			auto &column = chunk.columns[i];
+			column.timestamps.push_back(time_offset_ + timestamp);
+			column.values.push_back(value);
+			column.decimal_places = std::max(column.decimal_places,
+				data::csvutil::get_decimal_places(
+					value_field.first, value_field.second));
+		}
+
+		line = next_line;
+	}
+}
+
+void FileImporter::commit_csv_chunk(CsvChunk &chunk)
+{
+	SV_TRACE_SCOPE("import", "commit_csv_chunk");
+
+	for (size_t i = 0; i < csv_signals_.size(); ++i) {
+		auto &column = chunk.columns[i];
+		auto &csv_signal = csv_signals_[i];
+		csv_signal.decimal_places =
+			std::max(csv_signal.decimal_places, column.decimal_places);
+		csv_signal.signal->push_samples(column.timestamps.data(),
+			column.values.data(), column.timestamps.size(),
+			csv_digits, csv_signal.decimal_places);
+		sample_count_ += column.timestamps.size();
+	}
+	csv_invalid_values_ += chunk.invalid_values;
+	add_progress(chunk.size);
+}
+
+void FileImporter::import_sigrok()
+{
+	// The input module sends the packets synchronously from Input::send().
+	sr_session_->add_datafeed_callback([this]
+		(shared_ptr<sigrok::Device> sr_device, shared_ptr<sigrok::Packet> sr_packet) {
+			(void)sr_device;
+			sigrok_data_feed_in(sr_packet);
+		});
+
+	for (qint64 pos = 0; pos < size_ && !cancel_; pos += sr_input_chunk_size) {
+		const qint64 size = std::min(sr_input_chunk_size, size_ - pos);
+		sr_input_->send(data_ + pos, (size_t)size);
+		add_progress(size);
+	}
+	if (!cancel_)
+		sr_input_->end();
+}
+
+void FileImporter::sigrok_data_feed_in(shared_ptr<sigrok::Packet> sr_packet)
+{
+	if (sr_packet->type()->id() == SR_DF_META) {
+		auto sr_meta = dynamic_pointer_cast<sigrok::Meta>(sr_packet->payload());
+		for (const auto &entry : sr_meta->config()) {
+			if (entry.first != sigrok::ConfigKey::SAMPLERATE)
+				continue;
+			sr_samplerate_ = Glib::VariantBase::cast_dynamic
+				<Glib::Variant<guint64>>(entry.second).get();
+		}
+		return;
+	}
+	if (sr_packet->type()->id() != SR_DF_ANALOG)
+		return;
+
+	auto sr_analog = dynamic_pointer_cast<sigrok::Analog>(sr_packet->payload());
+	size_t num_samples = sr_analog->num_samples();
+	if (num_samples == 0)
+		return;
+
+	data::Quantity quantity;
+	try {
+		quantity = data::datautil::get_quantity(sr_analog->mq());
+	}
+	catch (sigrok::Error &e) {
+		quantity = data::Quantity::Unknown;
+	}
+	if (quantity == data::Quantity::Unknown) {
+		if (!sr_quantity_warned_) {
+			qWarning() << "FileImporter::sigrok_data_feed_in(): Samples " <<
+				"without a known quantity skipped";
+			sr_quantity_warned_ = true;
+		}
+		return;
+	}
+	set<data::QuantityFlag> quantity_flags =
+		data::datautil::get_quantity_flags(sr_analog->mq_flags());
+	data::Unit unit = data::datautil::get_unit(sr_analog->unit());
+
+	if (sr_samplerate_ == 0) {
+		if (!sr_samplerate_warned_) {
+			qWarning() << "FileImporter::sigrok_data_feed_in(): No " <<
+				"samplerate in" << file_name_ << ", using 1 Hz";
+			sr_samplerate_warned_ = true;
+		}
+		sr_samplerate_ = 1;
+	}
+
+	// See HardwareChannel::push_interleaved_samples()
+	int digits = 7;
+	int decimal_places = -1;
+	if (sr_analog->digits() >= 0)
+		decimal_places = sr_analog->digits();
+	else
+		digits = -1 * sr_analog->digits();
+
+	const auto sr_channels = sr_analog->channels();
+	unique_ptr<float[]> data(new float[num_samples * sr_channels.size()]);
+	sr_analog->get_data_as_float(data.get());
+
+	vector<float> channel_data(num_samples);
+	for (size_t i = 0; i < sr_channels.size(); ++i) {
+		const string &name = sr_channels[i]->name();
+		const auto channel_it = sr_channels_.find(name);
+		if (channel_it == sr_channels_.end())
+			continue;
+
+		auto &signal = sr_signals_[name];
+		if (!signal || signal->quantity() != quantity ||
+				signal->quantity_flags() != quantity_flags ||
+				signal->unit() != unit) {
+			// Reuse a signal with the same meaning (see
+			// UserChannel::push_sample()).
+			auto signal_map = channel_it->second->signal_map();
+			auto mq = make_pair(quantity, quantity_flags);
+			if (signal_map.count(mq) > 0) {
+				signal = dynamic_pointer_cast<data::AnalogTimeSignal>(
+					signal_map[mq][0]);
+			}
+			else {
+				signal = dynamic_pointer_cast<data::AnalogTimeSignal>(
+					channel_it->second->add_signal(
+						quantity, quantity_flags, unit));
+				// The signal is used by the GUI, not by the import thread.
+				signal->moveToThread(device_->thread());
+			}
+		}
+
+		for (size_t j = 0; j < num_samples; ++j)
+			channel_data[j] = data[j * sr_channels.size() + i];
+		uint64_t &position = sr_sample_positions_[name];
+		signal->push_samples(channel_data.data(), num_samples,
+			time_offset_ + position / (double)sr_samplerate_, sr_samplerate_,
+			sizeof(float), digits, decimal_places);
+		position += num_samples;
+		sample_count_ += num_samples;
+	}
+}
+
+void FileImporter::add_progress(qint64 bytes)
+{
+	bytes_done_ += bytes;
+	Q_EMIT progress_changed(bytes_done_, size_ - data_start_);
+}
+
+void FileImporter::set_error(const QString &error)
+{
+	lock_guard<mutex> lock(error_mutex_);
+	if (error_.isEmpty())
+		error_ = error;
+}
+
+} // namespace sv
@@ -0,0 +1,194 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILEIMPORTER_HPP
+#define FILEIMPORTER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+
+#include "src/data/csvutil.hpp"
+
+using std::map;
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sigrok {
+class Context;
+class Input;
+class Packet;
+class Session;
+}
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class UserDevice;
+}
+
+/**
+ * The FileImporter imports a large data file into a virtual user device.
+ *
+ * SmuView CSV files are memory mapped and parsed in chunks by multiple
+ * threads. The parsed chunks are appended in file order directly to the
+ * signals of the device, so the memory usage doesn't depend on the file
+ * size. All other files are read by a libsigrok input module.
+ *
+ * open() creates the device with its channels (in the GUI thread), start()
+ * imports the samples in the background.
+ */
+class FileImporter : public QObject
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * If format_name is empty, files with the extension ".csv" are read as
+	 * SmuView CSV files, all other files are read by the libsigrok input
+	 * module matching the file extension.
+	 */
+	FileImporter(const shared_ptr<sigrok::Context> &sr_context,
+		const QString &file_name, const string &format_name);
+	~FileImporter();
+
+	/**
+	 * Open the file and create the device. Throws a QString on error.
+	 */
+	shared_ptr<devices::UserDevice> open();
+
+	/**
+	 * Start the import in the background. import_finished() is emitted
+	 * when the import is done.
+	 */
+	void start();
+
+	/**
+	 * Cancel the import. The samples imported so far are kept.
+	 */
+	void cancel();
+
+	/**
+	 * Wait until the import is done.
+	 */
+	void wait();
+
+	bool is_running() const;
+	QString file_name() const;
+	shared_ptr<devices::UserDevice> device() const;
+	/** The number of imported samples of all signals. */
+	uint64_t sample_count() const;
+	/** The error message of a failed import, or an empty string. */
+	QString error() const;
+
+private:
+	struct CsvChunk;
+
+	/** A signal of a CSV value column. */
+	struct CsvSignal
+	{
+		shared_ptr<data::AnalogTimeSignal> signal;
+		int decimal_places;
+	};
+
+	void open_csv();
+	void open_sigrok();
+	void import_thread_proc();
+	void import_csv();
+	void import_sigrok();
+	void csv_worker_proc();
+	/** Return the start of the first line at or after pos. */
+	qint64 csv_line_start(qint64 pos) const;
+	void parse_csv_chunk(const char *begin, const char *end,
+		CsvChunk &chunk, data::csvutil::DateTimeCache &date_time_cache) const;
+	void commit_csv_chunk(CsvChunk &chunk);
+	void sigrok_data_feed_in(shared_ptr<sigrok::Packet> sr_packet);
+	void add_progress(qint64 bytes);
+	void set_error(const QString &error);
+
+	const shared_ptr<sigrok::Context> sr_context_;
+	const QString file_name_;
+	const string format_name_;
+	shared_ptr<devices::UserDevice> device_;
+
+	QFile file_;
+	uchar *data_;
+	qint64 size_;
+	/** The start of the data in the file, behind the header. */
+	qint64 data_start_;
+	/** Added to the (relative) timestamps of the file. */
+	double time_offset_;
+
+	/** CSV import */
+	data::csvutil::CsvHeader csv_header_;
+	vector<CsvSignal> csv_signals_;
+	size_t csv_chunk_count_;
+	std::atomic<size_t> csv_next_chunk_;
+	mutex csv_commit_mutex_;
+	std::condition_variable csv_commit_cond_;
+	size_t csv_next_commit_;
+	std::atomic<uint64_t> csv_invalid_values_;
+
+	/** libsigrok import */
+	shared_ptr<sigrok::Input> sr_input_;
+	shared_ptr<sigrok::Session> sr_session_;
+	map<string, shared_ptr<channels::UserChannel>> sr_channels_;
+	map<string, shared_ptr<data::AnalogTimeSignal>> sr_signals_;
+	map<string, uint64_t> sr_sample_positions_;
+	uint64_t sr_samplerate_;
+	bool sr_samplerate_warned_;
+	bool sr_quantity_warned_;
+
+	std::thread import_thread_;
+	std::atomic<bool> running_;
+	std::atomic<bool> cancel_;
+	std::atomic<qint64> bytes_done_;
+	std::atomic<uint64_t> sample_count_;
+	mutable mutex error_mutex_;
+	QString error_;
+
+Q_SIGNALS:
+	void progress_changed(qint64 bytes_done, qint64 bytes_total);
+	void import_finished();
+
+};
+
+} // namespace sv
+
+#endif // FILEIMPORTER_HPP
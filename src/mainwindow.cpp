@@ -25,16 +25,19 @@
 #include <QApplication>
 #include <QDebug>
 #include <QDockWidget>
+#include <QFileInfo>
 #include <QFontDatabase>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QSizePolicy>
 #include <QVBoxLayout>
 
 #include "mainwindow.hpp"
 #include "config.h"
 #include "src/devicemanager.hpp"
+#include "src/fileimporter.hpp"
 #include "src/session.hpp"
 #include "src/util.hpp"
 #include "src/data/basesignal.hpp"
@@ -55,6 +58,7 @@
 #include "src/ui/tabs/tabhelper.hpp"
 #include "src/ui/tabs/welcometab.hpp"
 #include "src/ui/views/devicesview.hpp"
+#include "src/ui/views/diagnosticsview.hpp"
 #include "src/ui/views/smuscripttreeview.hpp"
 
 using std::make_pair;
@@ -106,28 +110,60 @@ void MainWindow::init_session()
 
 void MainWindow::init_default_session()
 {
-	if (device_manager_.user_spec_devices().empty()) {
-		// Display the WelcomeTab if no DeviceTabs will be opened, because
-		// without a tab in the QTabWidget the main window looks so empty...
+	bool has_recovered_devices = init_journal();
+
+	// Display the WelcomeTab if no DeviceTabs will be opened, because
+	// without a tab in the QTabWidget the main window looks so empty...
+	if (!add_user_spec_devices() && !has_recovered_devices)
 		add_welcome_tab();
-		return;
-	}
+}
+
+void MainWindow::init_session_with_file(
+	string open_file_name, string open_file_format)
+{
+	bool has_devices = init_journal();
+	if (add_user_spec_devices())
+		has_devices = true;
+	if (import_file(open_file_name, open_file_format))
+		has_devices = true;
 
+	if (!has_devices)
+		add_welcome_tab();
+}
+
+bool MainWindow::add_user_spec_devices()
+{
 	for (const auto &device : device_manager_.user_spec_devices()) {
 		// NOTE: add_device() must be called, before the device tab
 		//       tries to access the device (device is not opend yet).
 		session_->add_device(device);
 		add_device_tab(device);
 	}
+
+	return !device_manager_.user_spec_devices().empty();
 }
 
-void MainWindow::init_session_with_file(
-	string open_file_name, string open_file_format)
+bool MainWindow::init_journal()
 {
-	(void)open_file_name;
-	(void)open_file_format;
-	// TODO
-	//session_->load_init_file(open_file_name, open_file_format);
+	bool recover = false;
+	if (session_->has_recoverable_journal()) {
+		recover = QMessageBox::question(this, tr("Recover session"),
+			tr("SmuView was not closed properly. Do you want to recover the "
+				"devices and data of the last session?"),
+			QMessageBox::Yes | QMessageBox::No,
+			QMessageBox::Yes) == QMessageBox::Yes;
+	}
+
+	auto recovered_devices = session_->init_journal(recover);
+	for (const auto &device : recovered_devices)
+		add_device_tab(device);
+
+	return !recovered_devices.empty();
+}
+
+shared_ptr<Session> MainWindow::session() const
+{
+	return session_;
 }
 
 void MainWindow::save_session()
@@ -182,6 +218,55 @@ void MainWindow::add_smuscript_tab(string file_name)
 	add_tab(new ui::tabs::SmuScriptTab(*session_, file_name));
 }
 
+bool MainWindow::import_file(const string &file_name, const string &format)
+{
+	shared_ptr<FileImporter> importer;
+	try {
+		importer = session_->import_file(file_name, format);
+	}
+	catch (const QString &e) {
+		QMessageBox::warning(this, tr("Import file"), e);
+		return false;
+	}
+	add_device_tab(importer->device());
+
+	// The progress is shown in 0.1 % steps.
+	const int progress_steps = 1000;
+	QProgressDialog *progress_dialog = new QProgressDialog(
+		tr("Importing %1...").arg(QFileInfo(importer->file_name()).fileName()),
+		tr("Cancel"), 0, progress_steps, this);
+	progress_dialog->setWindowTitle(tr("Import file"));
+	progress_dialog->setMinimumDuration(500);
+
+	FileImporter *importer_ptr = importer.get();
+	connect(importer_ptr, &FileImporter::progress_changed, progress_dialog,
+		[progress_dialog](qint64 bytes_done, qint64 bytes_total) {
+			if (bytes_total > 0)
+				progress_dialog->setValue(
+					(int)(bytes_done * progress_steps / bytes_total));
+		});
+	connect(progress_dialog, &QProgressDialog::canceled,
+		importer_ptr, &FileImporter::cancel);
+	connect(importer_ptr, &FileImporter::import_finished,
+		this, [this, importer_ptr, progress_dialog]() {
+			progress_dialog->deleteLater();
+			if (!importer_ptr->error().isEmpty())
+				QMessageBox::warning(this, tr("Import file"),
+					importer_ptr->error());
+			file_importers_.remove_if(
+				[importer_ptr](const shared_ptr<FileImporter> &importer) {
+					return importer.get() == importer_ptr;
+				});
+		});
+
+	// Start the import after all signals are connected, a small file can
+	// be imported before the connections are made.
+	file_importers_.push_back(importer);
+	importer->start();
+
+	return true;
+}
+
 void MainWindow::remove_tab(string tab_id)
 {
 	remove_tab(tab_widget_->indexOf(tab_window_map_[tab_id]));
@@ -284,6 +369,18 @@ void MainWindow::setup_ui()
 	script_dock->setWidget(smu_script_tree_view_);
 	this->tabifyDockWidget(dev_dock, script_dock);
 
+	// Diagnostics Dock
+	diagnostics_view_ = new ui::views::DiagnosticsView(*session_);
+
+	QDockWidget* diagnostics_dock =
+		new QDockWidget(diagnostics_view_->title());
+	diagnostics_dock->setAllowedAreas(Qt::AllDockWidgetAreas);
+	diagnostics_dock->setContextMenuPolicy(Qt::PreventContextMenu);
+	diagnostics_dock->setFeatures(QDockWidget::DockWidgetMovable |
+		QDockWidget::DockWidgetFloatable);
+	diagnostics_dock->setWidget(diagnostics_view_);
+	this->tabifyDockWidget(script_dock, diagnostics_dock);
+
 	// Select device tree dock tab
 	dev_dock->show();
 	dev_dock->raise();
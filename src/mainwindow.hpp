@@ -20,12 +20,14 @@
 #ifndef MAINWINDOW_HPP
 #define MAINWINDOW_HPP
 
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
 
 #include <QMainWindow>
 
+using std::list;
 using std::map;
 using std::shared_ptr;
 using std::string;
@@ -33,6 +35,7 @@ using std::string;
 namespace sv {
 
 class DeviceManager;
+class FileImporter;
 class Session;
 
 namespace devices {
@@ -46,6 +49,7 @@ class BaseTab;
 }
 namespace views {
 class DevicesView;
+class DiagnosticsView;
 class SmuScriptTreeView;
 }
 }
@@ -65,11 +69,18 @@ public:
 	void init_session_with_file(string open_file_name, string open_file_format);
 	void save_session();
 	void restore_session();
+	shared_ptr<Session> session() const;
 
 	// TODO: Move to Session, when Session init is in main.cpp
 	void run_smu_script(string script_file);
 
 	void add_smuscript_tab(string file_name);
+	/**
+	 * Import a data file into a new device and show the progress of the
+	 * import. See Session::import_file(). Return false, if the file couldn't
+	 * be opened.
+	 */
+	bool import_file(const string &file_name, const string &format);
 	void remove_tab(string tab_id);
 	void change_tab_icon(string tab_id, QIcon icon);
 	void change_tab_title(string tab_id, QString title);
@@ -78,6 +89,16 @@ public:
 private:
 	void setup_ui();
 	void connect_signals();
+	/**
+	 * Start the session journal and offer to recover a crashed session.
+	 * Return true, if devices have been recovered.
+	 */
+	bool init_journal();
+	/**
+	 * Add the devices from the command line to the session.
+	 * Return true, if there was at least one device.
+	 */
+	bool add_user_spec_devices();
 	void add_tab(ui::tabs::BaseTab *tab_window);
 	void add_welcome_tab();
 	void remove_tab(int tab_index);
@@ -88,9 +109,12 @@ private:
 	QWidget *central_widget_;
 	ui::views::DevicesView *devices_view_;
 	ui::views::SmuScriptTreeView *smu_script_tree_view_;
+	ui::views::DiagnosticsView *diagnostics_view_;
 	QTabWidget *tab_widget_;
 	/** tab_window_map_ is used to get the index of the tab in the QTabWidget */
 	map<string, ui::tabs::BaseTab *> tab_window_map_;
+	/** The running file imports. */
+	list<shared_ptr<FileImporter>> file_importers_;
 
 private Q_SLOTS:
 	void error_handler(const std::string &sender, const std::string &msg);
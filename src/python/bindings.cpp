@@ -17,15 +17,23 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
 #include <set>
 #include <string>
+#include <QMetaObject>
+#include <QString>
+#include <QThread>
 #include <pybind11/embed.h>
 #include <pybind11/stl.h>
 
 #include "bindings.hpp"
 #include "config.h"
+#include "src/eventloopmonitor.hpp"
 #include "src/session.hpp"
+#include "src/tracer.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/channels/hardwarechannel.hpp"
 #include "src/channels/userchannel.hpp"
@@ -34,19 +42,43 @@
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/signalrecorder.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/acquisitionmetrics.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
 #include "src/devices/deviceutil.hpp"
 #include "src/devices/hardwaredevice.hpp"
+#include "src/devices/limitengine.hpp"
+#include "src/devices/replaydevice.hpp"
+#include "src/devices/replayrecording.hpp"
+#include "src/devices/sweepengine.hpp"
 #include "src/devices/userdevice.hpp"
 #include "src/python/pystreambuf.hpp"
 #include "src/python/uiproxy.hpp"
 
+using std::dynamic_pointer_cast;
+using std::make_shared;
 using std::set;
 
 using namespace pybind11::literals; // for the ""_a
 namespace py = pybind11;
 
+/*
+ * Run func in the thread of the session and wait until it has finished.
+ * QObjects like the servers must be created, used and deleted in the thread
+ * with the event loop, while the scripts run in their own thread.
+ */
+static void run_in_session_thread(sv::Session &session,
+	const std::function<void()> &func)
+{
+	if (QThread::currentThread() == session.thread()) {
+		func();
+		return;
+	}
+	QMetaObject::invokeMethod(&session, func, Qt::BlockingQueuedConnection);
+}
+
 /*
  * NOTE: The documentation for the smuview module is optimized for pdoc3!
  */
@@ -127,10 +159,185 @@ void init_Session(py::module &m)
 		"-------\n"
 		"UserDevice\n"
 		"    The created user device object.");
+	py_session.def("add_replay_device",
+		[](sv::Session &session, const std::string &file_name, const std::string &format) {
+			try {
+				return session.add_replay_device(file_name, format);
+			}
+			catch (const QString &e) {
+				throw py::value_error(e.toStdString());
+			}
+		},
+		py::arg("file_name"), py::arg("format") = "",
+		"Load a recorded session and create a replay device, that plays back the recorded samples.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"file_name : str\n"
+		"    A CSV file saved by SmuView or a file for a libsigrok input format.\n"
+		"format : str\n"
+		"    The name of the libsigrok input format. If empty, the format is detected from the file extension.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ReplayDevice\n"
+		"    The created replay device object.");
+	py_session.def("start_stream_server",
+		[](sv::Session &session, const std::string &address) {
+			const QString server_address = QString::fromStdString(address);
+			bool ret = false;
+			run_in_session_thread(session, [&]() {
+				ret = session.start_stream_server(server_address);
+			});
+			return ret;
+		},
+		py::arg("address"), py::call_guard<py::gil_scoped_release>(),
+		"Start the stream server, that publishes the samples of all signals to local clients.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"address : str\n"
+		"    A TCP port (only the loopback interface is used) or the name of a local socket.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    True if the server is listening.");
+	py_session.def("stop_stream_server",
+		[](sv::Session &session) {
+			run_in_session_thread(session, [&]() {
+				session.stop_stream_server();
+			});
+		},
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop the stream server and disconnect all clients.");
+	py_session.def("start_scpi_server",
+		[](sv::Session &session, const std::string &address) {
+			const QString server_address = QString::fromStdString(address);
+			bool ret = false;
+			run_in_session_thread(session, [&]() {
+				ret = session.start_scpi_server(server_address);
+			});
+			return ret;
+		},
+		py::arg("address"), py::call_guard<py::gil_scoped_release>(),
+		"Start the SCPI server, that gives local clients access to the devices of the session.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"address : str\n"
+		"    A TCP port (only the loopback interface is used) or the name of a local socket.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    True if the server is listening.");
+	py_session.def("stop_scpi_server",
+		[](sv::Session &session) {
+			run_in_session_thread(session, [&]() {
+				session.stop_scpi_server();
+			});
+		},
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop the SCPI server and disconnect all clients.");
+	py_session.def("event_loop_lag",
+		[](sv::Session &session) {
+			auto monitor = session.event_loop_monitor();
+			py::dict lag;
+			lag["lag"] = monitor->lag();
+			lag["max_lag"] = monitor->max_lag();
+			return lag;
+		},
+		"Return the lag of the GUI event loop. The lag is the time until a posted event is delivered and grows with the depth of the event queue.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Dict[str, float]\n"
+		"    A Dict with the last (`lag`) and the max. lag (`max_lag`) in ms.");
+	py_session.def("start_trace",
+		[](sv::Session &, size_t buffer_size) {
+			sv::Tracer::start(buffer_size);
+		},
+		py::arg("buffer_size") = sv::Tracer::default_buffer_size,
+		"Clear all recorded trace events and start tracing the hot paths (acquisition, signals, math channels, plots, config accesses).\n\n"
+		"Parameters\n"
+		"----------\n"
+		"buffer_size : int\n"
+		"    The number of events, that are kept per thread.");
+	py_session.def("stop_trace",
+		[](sv::Session &) {
+			sv::Tracer::stop();
+		},
+		"Stop tracing. The recorded events are kept until tracing is started again.");
+	py_session.def("save_trace",
+		[](sv::Session &, const std::string &file_name) {
+			return sv::Tracer::write_json(file_name);
+		},
+		py::arg("file_name"),
+		"Write the recorded trace events to a file in the Chrome trace event format, that can be opened in chrome://tracing or https://ui.perfetto.dev.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"file_name : str\n"
+		"    The file name incl. path.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    True if the file has been written.");
 }
 
 void init_Device(py::module &m)
 {
+	py::class_<sv::devices::LimitEngine, std::shared_ptr<sv::devices::LimitEngine>> py_limit_engine(m, "LimitEngine");
+	py_limit_engine.doc() = "The limit engine of a device. The rules are evaluated on every incoming sample in the acquisition thread, the actions are executed asynchronously.";
+	py_limit_engine.def("add_rule", &sv::devices::LimitEngine::add_rule,
+		py::arg("signal"), py::arg("condition"), py::arg("direction"),
+		py::arg("limit"), py::arg("window") = 0.,
+		py::arg("action") = sv::devices::LimitAction::LogMarker,
+		py::arg("configurable") = nullptr, py::arg("name") = "",
+		"Add a new limit rule.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal to watch.\n"
+		"condition : LimitCondition\n"
+		"    The condition type of the rule.\n"
+		"direction : LimitDirection\n"
+		"    Trigger when the value is above or below the limit.\n"
+		"limit : float\n"
+		"    The limit. For `LimitCondition.RateOfChange` the unit is [signal unit]/s.\n"
+		"window : float\n"
+		"    The window length in seconds for `LimitCondition.RateOfChange` and `LimitCondition.WindowAverage`.\n"
+		"action : LimitAction\n"
+		"    The action to execute, when the rule is triggered.\n"
+		"configurable : Configurable\n"
+		"    The configurable to disable for `LimitAction.DisableOutput`.\n"
+		"name : str\n"
+		"    The name of the rule, used for the log marker.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The id of the new rule.");
+	py_limit_engine.def("remove_rule", &sv::devices::LimitEngine::remove_rule,
+		py::arg("id"),
+		"Remove a limit rule.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"id : int\n"
+		"    The id of the rule.");
+	py_limit_engine.def("clear_rules", &sv::devices::LimitEngine::clear_rules,
+		"Remove all limit rules.");
+	py_limit_engine.def("trigger_count", &sv::devices::LimitEngine::trigger_count,
+		"Return the number of triggered rules.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of triggered rules.");
+	py_limit_engine.def("last_latency", &sv::devices::LimitEngine::last_latency,
+		"Return the latency from the packet ingest to the executed action of the last triggered rule.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The latency in µs.");
+	py_limit_engine.def("max_latency", &sv::devices::LimitEngine::max_latency,
+		"Return the maximum latency from the packet ingest to the executed action.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The latency in µs.");
+
 	py::class_<sv::devices::BaseDevice, std::shared_ptr<sv::devices::BaseDevice>> py_base_device(m, "BaseDevice");
 	py_base_device.doc() = "The base class for all device types.";
 	py_base_device.def("name", &sv::devices::BaseDevice::name,
@@ -170,12 +377,181 @@ void init_Device(py::module &m)
 		"-------\n"
 		"UserChannel\n"
 		"    The new user channel object.");
+	py_base_device.def("limit_engine", &sv::devices::BaseDevice::limit_engine,
+		"Return the limit engine of the device.\n\n"
+		"Returns\n"
+		"-------\n"
+		"LimitEngine\n"
+		"    The limit engine object.");
+	py_base_device.def("metrics",
+		[](sv::devices::BaseDevice &device, bool reset) {
+			sv::devices::AcquisitionStats stats = device.metrics()->stats();
+			if (reset)
+				device.metrics()->reset();
+
+			auto latency_dict = [](const sv::devices::LatencyStats &latency) {
+				py::dict dict;
+				dict["count"] = latency.count;
+				dict["mean"] = latency.mean;
+				dict["max"] = latency.max;
+				dict["p50"] = latency.p50;
+				dict["p99"] = latency.p99;
+				return dict;
+			};
+			py::dict metrics;
+			metrics["packet_count"] = stats.packet_count;
+			metrics["sample_count"] = stats.sample_count;
+			metrics["packet_rate"] = stats.packet_rate;
+			metrics["sample_rate"] = stats.sample_rate;
+			metrics["ingest_latency"] = latency_dict(stats.ingest_latency);
+			metrics["display_latency"] = latency_dict(stats.display_latency);
+			return metrics;
+		},
+		py::arg("reset") = false,
+		"Return the acquisition metrics of the device.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"reset : bool\n"
+		"    When true, the metrics are reset after they have been read.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Dict[str, Any]\n"
+		"    A Dict with the packet and sample counts (`packet_count`, `sample_count`), the rates per second averaged over the last second "
+		"(`packet_rate`, `sample_rate`) and the statistics of the `ingest_latency` (time to process a packet) and the `display_latency` "
+		"(time from the packet arrival until it is on screen). The latency statistics are Dicts with the keys `count`, `mean`, `max`, "
+		"`p50` and `p99` (median and 99th percentile, estimated from a histogram), all in µs.");
 
 	py::class_<sv::devices::HardwareDevice, std::shared_ptr<sv::devices::HardwareDevice>> py_hardware_device(m, "HardwareDevice", py_base_device);
 	py_hardware_device.doc() = "An actual hardware device.";
 
 	py::class_<sv::devices::UserDevice, std::shared_ptr<sv::devices::UserDevice>> py_user_device(m, "UserDevice", py_base_device);
 	py_user_device.doc() = "An user generated (virtual) device for storing custom data and showing a custom tab.";
+
+	py::class_<sv::devices::ReplayDevice, std::shared_ptr<sv::devices::ReplayDevice>> py_replay_device(m, "ReplayDevice", py_base_device);
+	py_replay_device.doc() = "A virtual device, that plays back a recorded session.";
+	py_replay_device.def("set_speed", &sv::devices::ReplayDevice::set_speed,
+		py::arg("speed"),
+		"Set the playback speed.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"speed : float\n"
+		"    The speed as factor of the recorded timing, 0 plays back as fast as possible.");
+	py_replay_device.def("speed", &sv::devices::ReplayDevice::speed,
+		"Return the playback speed.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The speed as factor of the recorded timing, 0 for as fast as possible.");
+	py_replay_device.def("set_loop", &sv::devices::ReplayDevice::set_loop,
+		py::arg("loop"),
+		"Restart the playback at the end of the recording.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"loop : bool\n"
+		"    True to loop the playback.");
+	py_replay_device.def("restart", &sv::devices::ReplayDevice::restart,
+		"Restart the playback from the beginning of the recording.");
+	py_replay_device.def("position", &sv::devices::ReplayDevice::position,
+		"Return the position of the playback.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The position in seconds, relative to the start of the recording.");
+	py_replay_device.def("duration",
+		[](sv::devices::ReplayDevice &device) {
+			return device.recording()->duration();
+		},
+		"Return the duration of the recording.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The duration in seconds.");
+	py_replay_device.def("is_finished", &sv::devices::ReplayDevice::is_finished,
+		"Return if the whole recording was played back.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    True if the playback has finished.");
+
+	py::class_<sv::devices::SweepEngine, std::shared_ptr<sv::devices::SweepEngine>> py_sweep_engine(m, "SweepEngine");
+	py_sweep_engine.doc() = "A sweep engine, that steps a config key through a list of setpoints. After each step it waits until all signals have settled and captures one measurement tuple into user channels of the result device.";
+	py_sweep_engine.def(py::init([](std::shared_ptr<sv::devices::Configurable> configurable,
+			sv::devices::ConfigKey config_key,
+			std::shared_ptr<sv::devices::BaseDevice> result_device) {
+			auto property = dynamic_pointer_cast<sv::data::properties::DoubleProperty>(
+				configurable->get_property(config_key));
+			if (!property)
+				throw py::value_error("The config key is not a double property!");
+			return make_shared<sv::devices::SweepEngine>(property, result_device);
+		}),
+		py::arg("configurable"), py::arg("config_key"), py::arg("result_device"),
+		"Create a new sweep engine.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"configurable : Configurable\n"
+		"    The configurable to sweep.\n"
+		"config_key : ConfigKey\n"
+		"    The config key to sweep. Must be of type float.\n"
+		"result_device : BaseDevice\n"
+		"    The device where the result channels are created.");
+	py_sweep_engine.def("add_signal", &sv::devices::SweepEngine::add_signal,
+		py::arg("signal"),
+		"Add a signal that must settle and is captured after each step.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal object.");
+	py_sweep_engine.def("set_range", &sv::devices::SweepEngine::set_range,
+		py::arg("start"), py::arg("stop"), py::arg("step"),
+		"Set the setpoints from start to stop (inclusive).\n\n"
+		"Parameters\n"
+		"----------\n"
+		"start : float\n"
+		"    The first setpoint.\n"
+		"stop : float\n"
+		"    The last setpoint.\n"
+		"step : float\n"
+		"    The step size.");
+	py_sweep_engine.def("set_setpoints", &sv::devices::SweepEngine::set_setpoints,
+		py::arg("setpoints"),
+		"Set a list of setpoints.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"setpoints : List[float]\n"
+		"    The setpoints.");
+	py_sweep_engine.def("set_settling", &sv::devices::SweepEngine::set_settling,
+		py::arg("abs_tolerance"), py::arg("rel_tolerance"), py::arg("window"),
+		py::arg("timeout"),
+		"Set the settling criteria. A signal has settled, when all samples within the window are inside the tolerance band.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"abs_tolerance : float\n"
+		"    The absolute tolerance band (peak to peak).\n"
+		"rel_tolerance : float\n"
+		"    The tolerance band relative to the mean value.\n"
+		"window : float\n"
+		"    The settling window in seconds.\n"
+		"timeout : float\n"
+		"    The max. time in seconds to wait for settling.");
+	py_sweep_engine.def("start", &sv::devices::SweepEngine::start,
+		"Start the sweep in the background.");
+	py_sweep_engine.def("stop", &sv::devices::SweepEngine::stop,
+		"Stop the sweep after the actual step.");
+	py_sweep_engine.def("wait", &sv::devices::SweepEngine::wait,
+		py::call_guard<py::gil_scoped_release>(),
+		"Wait until the sweep has finished.");
+	py_sweep_engine.def("is_running", &sv::devices::SweepEngine::is_running,
+		"Return if the sweep is running.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    True if the sweep is running.");
+	py_sweep_engine.def("result_channels", &sv::devices::SweepEngine::result_channels,
+		"Return the result channels. The first channel holds the setpoints, the other channels the captured values in the order the signals were added.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[UserChannel]\n"
+		"    The result channels.");
 }
 
 void init_Channel(py::module &m)
@@ -311,6 +687,12 @@ void init_Signal(py::module &m)
 		"    The total number of digits.\n"
 		"decimal_places : int\n"
 		"    The number of decimal places.");
+	py_analog_time_signal.def("memory_size", &sv::data::AnalogTimeSignal::memory_size,
+		"Return the allocated memory of the samples.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The memory in bytes.");
 
 	py::class_<sv::data::AnalogSampleSignal, std::shared_ptr<sv::data::AnalogSampleSignal>> py_analog_sample_signal(m, "AnalogSampleSignal", py_base_signal);
 	py_analog_sample_signal.doc() = "A signal with key-value pairs.";
@@ -341,6 +723,79 @@ void init_Signal(py::module &m)
 		"    The total number of digits.\n"
 		"decimal_places : int\n"
 		"    The number of decimal places.");
+
+	py::class_<sv::data::SignalRecorder, std::shared_ptr<sv::data::SignalRecorder>> py_signal_recorder(m, "SignalRecorder");
+	py_signal_recorder.doc() = "A recorder, that continuously appends the samples of signals to files. The files are written in a background thread, synced to disk in batches and rotated by size and/or time.";
+	py_signal_recorder.def(py::init<const std::string &, sv::data::RecorderFormat>(),
+		py::arg("base_file_name"), py::arg("format") = sv::data::RecorderFormat::CSV,
+		"Create a new signal recorder.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"base_file_name : str\n"
+		"    The base file name incl. path. The files are named <base_file_name>_<number>.<csv|svrec>.\n"
+		"format : RecorderFormat\n"
+		"    The file format.");
+	py_signal_recorder.def("add_signal", &sv::data::SignalRecorder::add_signal,
+		py::arg("signal"),
+		"Add a signal to record. When the recorder is running, a new file is started.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal object.");
+	py_signal_recorder.def("set_rotation_size", &sv::data::SignalRecorder::set_rotation_size,
+		py::arg("rotation_size"),
+		"Start a new file, when the file size exceeds the given size.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"rotation_size : int\n"
+		"    The max. file size in bytes. 0 disables the rotation by size.");
+	py_signal_recorder.def("set_rotation_time", &sv::data::SignalRecorder::set_rotation_time,
+		py::arg("rotation_time"),
+		"Start a new file, when the file is older than the given time.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"rotation_time : float\n"
+		"    The max. file age in seconds. 0 disables the rotation by time.");
+	py_signal_recorder.def("set_sync_interval", &sv::data::SignalRecorder::set_sync_interval,
+		py::arg("sync_interval"),
+		"Set the interval for syncing the file to disk.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"sync_interval : float\n"
+		"    The interval in seconds.");
+	py_signal_recorder.def("start", &sv::data::SignalRecorder::start,
+		"Start recording.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    True if the recording has been started.");
+	py_signal_recorder.def("stop", &sv::data::SignalRecorder::stop,
+		py::call_guard<py::gil_scoped_release>(),
+		"Stop recording, write all pending samples and close the file.");
+	py_signal_recorder.def("is_running", &sv::data::SignalRecorder::is_running,
+		"Return if the recorder is running.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    True if the recorder is running.");
+	py_signal_recorder.def("file_name", &sv::data::SignalRecorder::file_name,
+		"Return the name of the actual file.\n\n"
+		"Returns\n"
+		"-------\n"
+		"str\n"
+		"    The file name.");
+	py_signal_recorder.def("recorded_sample_count", &sv::data::SignalRecorder::recorded_sample_count,
+		"Return the number of written samples.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of samples.");
+	py_signal_recorder.def("dropped_sample_count", &sv::data::SignalRecorder::dropped_sample_count,
+		"Return the number of samples, that couldn't be written.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of samples.");
 }
 
 void init_Configurable(py::module &m)
@@ -350,6 +805,31 @@ void init_Configurable(py::module &m)
 	 *  - list
 	 */
 
+	py::class_<std::shared_future<bool>> py_config_future(m, "ConfigFuture");
+	py_config_future.doc() = "The future of an asynchronous config key set operation.";
+	py_config_future.def("wait",
+		[](const std::shared_future<bool> &future) { future.wait(); },
+		py::call_guard<py::gil_scoped_release>(),
+		"Block until the value has been sent to the device.");
+	py_config_future.def("done",
+		[](const std::shared_future<bool> &future) {
+			return future.wait_for(std::chrono::seconds(0)) ==
+				std::future_status::ready;
+		},
+		"Return `True` if the value has been sent to the device.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the operation has finished.");
+	py_config_future.def("result",
+		[](const std::shared_future<bool> &future) { return future.get(); },
+		py::call_guard<py::gil_scoped_release>(),
+		"Block until the value has been sent to the device and return the result.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the value has been set successfully.");
+
 	py::class_<sv::devices::Configurable, std::shared_ptr<sv::devices::Configurable>> py_configurable(m, "Configurable");
 	py_configurable.doc() = "A configurable for controlling a device with config keys.";
 	py_configurable.def("name", &sv::devices::Configurable::name,
@@ -458,6 +938,109 @@ void init_Configurable(py::module &m)
 		"-------\n"
 		"str\n"
 		"    The string value of the config key.");
+	py_configurable.def("set_config_async", &sv::devices::Configurable::set_config_async<bool>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue a boolean value to be set to the given config key and return immediately. "
+		"A pending value for the same config key is replaced by the new value.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : bool\n"
+		"    The bool value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ConfigFuture\n"
+		"    The future for the set operation.");
+	py_configurable.def("set_config_async", &sv::devices::Configurable::set_config_async<int32_t>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue an integer value to be set to the given config key and return immediately. "
+		"A pending value for the same config key is replaced by the new value.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : int\n"
+		"    The int value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ConfigFuture\n"
+		"    The future for the set operation.");
+	py_configurable.def("set_config_async", &sv::devices::Configurable::set_config_async<uint64_t>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue an unsigned integer value to be set to the given config key and return immediately. "
+		"A pending value for the same config key is replaced by the new value.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : int\n"
+		"    The (unsigned) int value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ConfigFuture\n"
+		"    The future for the set operation.");
+	py_configurable.def("set_config_async", &sv::devices::Configurable::set_config_async<double>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue a double value to be set to the given config key and return immediately. "
+		"A pending value for the same config key is replaced by the new value.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : float\n"
+		"    The float value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ConfigFuture\n"
+		"    The future for the set operation.");
+	py_configurable.def("set_config_async", &sv::devices::Configurable::set_config_async<std::string>,
+		py::arg("config_key"), py::arg("value"),
+		"Queue a string value to be set to the given config key and return immediately. "
+		"A pending value for the same config key is replaced by the new value.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to set.\n"
+		"value : str\n"
+		"    The string value to set.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ConfigFuture\n"
+		"    The future for the set operation.");
+	py_configurable.def("set_poll_interval",
+		[](sv::devices::Configurable &c, sv::devices::ConfigKey config_key, double interval) {
+			auto property = c.get_property(config_key);
+			if (!property)
+				throw py::value_error("Config key not available");
+			property->set_poll_interval(interval);
+		},
+		py::arg("config_key"), py::arg("interval"),
+		"Poll the value of the given config key in the background, so the views "
+		"show changes that are made at the device itself.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` to poll.\n"
+		"interval : float\n"
+		"    The poll interval in seconds. 0 disables polling.");
+	py_configurable.def("get_cache_age",
+		[](sv::devices::Configurable &c, sv::devices::ConfigKey config_key) {
+			auto property = c.get_property(config_key);
+			if (!property)
+				throw py::value_error("Config key not available");
+			return property->cache_age();
+		},
+		py::arg("config_key"),
+		"Return the age of the cached value of the given config key.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey`.\n\n"
+		"Returns\n"
+		"-------\n"
+		"float\n"
+		"    The age in seconds or -1 if the value hasn't been read yet.");
 }
 
 void init_UI(py::module &m)
@@ -1074,6 +1657,36 @@ void init_Enums(py::module &m)
 	py_unit.value("Unknown", sv::data::Unit::Unknown,
 		"Unknown");
 
+	py::enum_<sv::devices::LimitCondition> py_limit_condition(m, "LimitCondition",
+		"Enum of all limit rule conditions.");
+	py_limit_condition.value("Threshold", sv::devices::LimitCondition::Threshold,
+		"The sample value crosses the limit.");
+	py_limit_condition.value("RateOfChange", sv::devices::LimitCondition::RateOfChange,
+		"The slope over the window crosses the limit.");
+	py_limit_condition.value("WindowAverage", sv::devices::LimitCondition::WindowAverage,
+		"The mean value over the window crosses the limit.");
+
+	py::enum_<sv::devices::LimitDirection> py_limit_direction(m, "LimitDirection",
+		"Enum of the limit rule directions.");
+	py_limit_direction.value("Above", sv::devices::LimitDirection::Above,
+		"Trigger when the value is above the limit.");
+	py_limit_direction.value("Below", sv::devices::LimitDirection::Below,
+		"Trigger when the value is below the limit.");
+
+	py::enum_<sv::devices::LimitAction> py_limit_action(m, "LimitAction",
+		"Enum of all limit rule actions.");
+	py_limit_action.value("LogMarker", sv::devices::LimitAction::LogMarker,
+		"Only write a marker to the log.");
+	py_limit_action.value("DisableOutput", sv::devices::LimitAction::DisableOutput,
+		"Disable the output of a configurable.");
+
+	py::enum_<sv::data::RecorderFormat> py_recorder_format(m, "RecorderFormat",
+		"Enum of the file formats of the signal recorder.");
+	py_recorder_format.value("CSV", sv::data::RecorderFormat::CSV,
+		"One line per sample with timestamp, signal index and value.");
+	py_recorder_format.value("Binary", sv::data::RecorderFormat::Binary,
+		"Compact binary records with signal index, timestamp and value.");
+
 	// Qt enumerations
 	py::enum_<Qt::DockWidgetArea> py_dock_area(m, "DockArea",
 		"Enum of all possible docking locations for a view.");
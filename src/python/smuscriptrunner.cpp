@@ -30,6 +30,7 @@
 
 #include "smuscriptrunner.hpp"
 #include "src/session.hpp"
+#include "src/tracer.hpp"
 #include "src/python/bindings.hpp"
 #include "src/python/pystreambuf.hpp"
 #include "src/python/pystreamredirect.hpp"
@@ -114,7 +115,9 @@ void SmuScriptRunner::script_thread_proc()
 		"Session"_a=py::cast(session_, py::return_value_policy::reference),
 		"UiProxy"_a=py::cast(ui_proxy, py::return_value_policy::reference));
 
+	Tracer::set_thread_name("SmuScript");
 	try {
+		SV_TRACE_SCOPE("script", "eval_file");
 		py::eval_file(script_file_name_, py::globals(), locals);
 	}
 	catch (py::error_already_set &ex) {
@@ -46,6 +46,12 @@ UiProxy::UiProxy(Session &session, shared_ptr<UiHelper> ui_helper) :
 	session_(session),
 	ui_helper_(ui_helper)
 {
+	// In headless mode there is no main window and all UI calls are no-ops.
+	if (!session_.main_window()) {
+		qWarning() << "UiProxy: Running headless, UI calls are ignored.";
+		return;
+	}
+
 	connect(this, &UiProxy::add_device_tab,
 		session_.main_window(), &MainWindow::add_device_tab);
 
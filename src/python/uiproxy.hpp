@@ -53,6 +53,8 @@ class UiHelper;
  * methods that will manipulate Qt widgets directly won't work.
  * So we are using UiProxy which is communicating with the Qt main loop via
  * signals and slots.
+ * In headless mode (no main window) the signals are not connected, so all
+ * UI calls are no-ops.
  */
 class UiProxy : public QObject
 {
@@ -0,0 +1,141 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QAbstractSocket>
+#include <QDebug>
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QString>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "baseserver.hpp"
+#include "src/session.hpp"
+
+namespace sv {
+namespace server {
+
+BaseServer::BaseServer(Session &session) :
+	session_(session),
+	tcp_server_(nullptr),
+	local_server_(nullptr)
+{
+}
+
+BaseServer::~BaseServer()
+{
+	BaseServer::close();
+}
+
+bool BaseServer::listen_tcp(quint16 port)
+{
+	close();
+
+	tcp_server_ = new QTcpServer(this);
+	connect(tcp_server_, SIGNAL(newConnection()),
+		this, SLOT(on_tcp_connection()));
+	// Only local clients, there is no authentication.
+	if (!tcp_server_->listen(QHostAddress::LocalHost, port)) {
+		qWarning() << "BaseServer: Could not listen on port" << port <<
+			tcp_server_->errorString();
+		delete tcp_server_;
+		tcp_server_ = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool BaseServer::listen_local(const QString &name)
+{
+	close();
+
+	local_server_ = new QLocalServer(this);
+	local_server_->setSocketOptions(QLocalServer::UserAccessOption);
+	connect(local_server_, SIGNAL(newConnection()),
+		this, SLOT(on_local_connection()));
+	// Remove the socket file of a crashed instance.
+	QLocalServer::removeServer(name);
+	if (!local_server_->listen(name)) {
+		qWarning() << "BaseServer: Could not listen on" << name <<
+			local_server_->errorString();
+		delete local_server_;
+		local_server_ = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool BaseServer::listen(const QString &address)
+{
+	bool is_port;
+	const quint16 port = address.toUShort(&is_port);
+	if (is_port)
+		return listen_tcp(port);
+	return listen_local(address);
+}
+
+void BaseServer::close()
+{
+	if (tcp_server_) {
+		tcp_server_->close();
+		delete tcp_server_;
+		tcp_server_ = nullptr;
+	}
+	if (local_server_) {
+		local_server_->close();
+		delete local_server_;
+		local_server_ = nullptr;
+	}
+}
+
+bool BaseServer::is_listening() const
+{
+	return (tcp_server_ && tcp_server_->isListening()) ||
+		(local_server_ && local_server_->isListening());
+}
+
+QString BaseServer::address() const
+{
+	if (tcp_server_)
+		return QString::number(tcp_server_->serverPort());
+	if (local_server_)
+		return local_server_->fullServerName();
+	return QString();
+}
+
+void BaseServer::on_tcp_connection()
+{
+	while (tcp_server_->hasPendingConnections()) {
+		QTcpSocket *socket = tcp_server_->nextPendingConnection();
+		socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+		add_client(socket);
+	}
+}
+
+void BaseServer::on_local_connection()
+{
+	while (local_server_->hasPendingConnections())
+		add_client(local_server_->nextPendingConnection());
+}
+
+} // namespace server
+} // namespace sv
@@ -0,0 +1,85 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_BASESERVER_HPP
+#define SERVER_BASESERVER_HPP
+
+#include <QObject>
+#include <QString>
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+
+namespace sv {
+
+class Session;
+
+namespace server {
+
+/**
+ * Base class for the servers, that serve local clients over a TCP socket
+ * (loopback only) or a local (Unix) socket.
+ */
+class BaseServer : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit BaseServer(Session &session);
+	virtual ~BaseServer();
+
+	/** Listen on the loopback interface. Port 0 picks a free port. */
+	bool listen_tcp(quint16 port);
+	/** Listen on a local socket (Unix domain socket or named pipe). */
+	bool listen_local(const QString &name);
+	/**
+	 * Listen on a TCP port, if the address is a number, otherwise on a local
+	 * socket with this name.
+	 */
+	bool listen(const QString &address);
+	/** Stop listening. Derived classes also disconnect their clients. */
+	virtual void close();
+	bool is_listening() const;
+	/** The TCP port or the full path of the local socket. */
+	QString address() const;
+
+protected:
+	/**
+	 * Take over a new client connection. The socket is a QTcpSocket or a
+	 * QLocalSocket; both emit disconnected().
+	 */
+	virtual void add_client(QIODevice *socket) = 0;
+
+	Session &session_;
+
+private:
+	QTcpServer *tcp_server_;
+	QLocalServer *local_server_;
+
+private Q_SLOTS:
+	void on_tcp_connection();
+	void on_local_connection();
+
+};
+
+} // namespace server
+} // namespace sv
+
+#endif // SERVER_BASESERVER_HPP
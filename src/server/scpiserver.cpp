@@ -0,0 +1,655 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QByteArray>
+#include <QDebug>
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVariant>
+
+#include "scpiserver.hpp"
+#include "config.h"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/properties/baseproperty.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/deviceutil.hpp"
+
+using std::dynamic_pointer_cast;
+using std::make_pair;
+using std::shared_future;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace server {
+
+namespace {
+
+const qint64 max_line_length = 64 * 1024;
+const size_t max_error_count = 32;
+
+/** The SCPI representation of NaN (and infinity). */
+const char scpi_nan[] = "9.91E+37";
+
+bool is_ready(const shared_future<bool> &future)
+{
+	return future.wait_for(std::chrono::seconds(0)) ==
+		std::future_status::ready;
+}
+
+/** Return true, if token is the short or the long form of the mnemonic. */
+bool mnemonic_matches(const QString &token, const QString &mnemonic)
+{
+	QString short_form;
+	for (const auto &c : mnemonic) {
+		if (!c.isLower())
+			short_form.append(c);
+	}
+	return token.compare(short_form, Qt::CaseInsensitive) == 0 ||
+		token.compare(mnemonic, Qt::CaseInsensitive) == 0;
+}
+
+}
+
+ScpiServer::ScpiServer(Session &session) :
+	BaseServer(session),
+	wait_timer_(new QTimer(this))
+{
+	wait_timer_->setInterval(5);
+	connect(wait_timer_, SIGNAL(timeout()), this, SLOT(on_wait_timer()));
+}
+
+ScpiServer::~ScpiServer()
+{
+	close();
+}
+
+void ScpiServer::close()
+{
+	vector<QIODevice *> sockets;
+	for (const auto &client_pair : clients_)
+		sockets.push_back(client_pair.first);
+	for (const auto &socket : sockets)
+		remove_client(socket);
+
+	BaseServer::close();
+}
+
+size_t ScpiServer::client_count() const
+{
+	return clients_.size();
+}
+
+void ScpiServer::add_client(QIODevice *socket)
+{
+	clients_.insert(make_pair(socket, Client()));
+
+	connect(socket, SIGNAL(readyRead()), this, SLOT(on_client_ready_read()));
+	connect(socket, SIGNAL(disconnected()),
+		this, SLOT(on_client_disconnected()));
+}
+
+void ScpiServer::remove_client(QIODevice *socket)
+{
+	if (clients_.erase(socket) == 0)
+		return;
+
+	disconnect(socket, nullptr, this, nullptr);
+	socket->close();
+	socket->deleteLater();
+}
+
+void ScpiServer::on_client_ready_read()
+{
+	QIODevice *socket = qobject_cast<QIODevice *>(sender());
+	auto it = clients_.find(socket);
+	if (it == clients_.end())
+		return;
+	Client &client = it->second;
+
+	// Queue all complete lines, so they are executed in one batch.
+	while (socket->canReadLine()) {
+		const QString line =
+			QString::fromUtf8(socket->readLine(max_line_length + 1));
+		for (const auto &command : split_unquoted(line, ';')) {
+			const QString trimmed_command = command.trimmed();
+			if (!trimmed_command.isEmpty())
+				client.commands.push_back(trimmed_command);
+		}
+		client.commands.push_back(QString());
+	}
+	if (socket->bytesAvailable() > max_line_length) {
+		qWarning() << "ScpiServer: Line too long, disconnecting client";
+		remove_client(socket);
+		return;
+	}
+
+	if (!process_client(socket, client))
+		wait_timer_->start();
+}
+
+void ScpiServer::on_client_disconnected()
+{
+	remove_client(qobject_cast<QIODevice *>(sender()));
+}
+
+void ScpiServer::on_wait_timer()
+{
+	bool waiting = false;
+	for (auto &client_pair : clients_) {
+		if (!client_pair.second.commands.empty() &&
+				!process_client(client_pair.first, client_pair.second))
+			waiting = true;
+	}
+	if (!waiting)
+		wait_timer_->stop();
+}
+
+bool ScpiServer::process_client(QIODevice *socket, Client &client)
+{
+	QByteArray output;
+	bool finished = true;
+	while (!client.commands.empty()) {
+		const QString command = client.commands.front();
+		if (command.isEmpty()) {
+			// End of line
+			if (!client.responses.isEmpty()) {
+				output.append(client.responses.join(";").toUtf8());
+				output.append('\n');
+				client.responses.clear();
+			}
+			client.commands.pop_front();
+			continue;
+		}
+
+		const QString header = command.section(' ', 0, 0);
+		if (header_matches(header, "*OPC?") || header_matches(header, "*WAI")) {
+			check_pending_sets(client);
+			if (!client.pending_sets.empty()) {
+				finished = false;
+				break;
+			}
+		}
+
+		execute(client, command);
+		client.commands.pop_front();
+	}
+
+	if (!output.isEmpty())
+		socket->write(output);
+	return finished;
+}
+
+void ScpiServer::execute(Client &client, const QString &command)
+{
+	const QString header = command.section(' ', 0, 0);
+	QStringList params;
+	for (const auto &param :
+			split_unquoted(command.section(' ', 1).trimmed(), ',')) {
+		if (!param.trimmed().isEmpty())
+			params.append(param.trimmed());
+	}
+
+	if (header_matches(header, "*IDN?")) {
+		client.responses.append(
+			QString("SmuView,SCPI Server,0,%1").arg(SV_VERSION_STRING));
+	}
+	else if (header_matches(header, "*OPC?")) {
+		client.responses.append("1");
+	}
+	else if (header_matches(header, "*WAI")) {
+		// Nothing to do, the pending set commands are already executed.
+	}
+	else if (header_matches(header, "*CLS")) {
+		client.errors.clear();
+	}
+	else if (header_matches(header, "SYSTem:ERRor?") ||
+			header_matches(header, "SYSTem:ERRor:NEXT?")) {
+		// Report the set commands that have failed in the meantime.
+		check_pending_sets(client);
+		if (client.errors.empty()) {
+			client.responses.append("0,\"No error\"");
+		}
+		else {
+			client.responses.append(client.errors.front());
+			client.errors.pop_front();
+		}
+	}
+	else if (header_matches(header, "SYSTem:DEVices?")) {
+		QStringList device_ids;
+		for (const auto &device_pair : session_.devices())
+			device_ids.append(quote(QString::fromStdString(device_pair.first)));
+		client.responses.append(device_ids.join(","));
+	}
+	else if (header_matches(header, "SYSTem:SIGNals?")) {
+		const QString device_id = params.isEmpty() ? "" : unquote(params[0]);
+		client.responses.append(list_signals(device_id).join(","));
+	}
+	else if (header_matches(header, "SYSTem:CONFigurables?")) {
+		const QString device_id = params.isEmpty() ? "" : unquote(params[0]);
+		client.responses.append(list_configurables(device_id).join(","));
+	}
+	else if (header_matches(header, "CONFigure:KEYS?")) {
+		if (params.size() < 1) {
+			push_error(client, -109, "Missing parameter");
+			client.responses.append("");
+			return;
+		}
+		auto configurable = find_configurable(unquote(params[0]));
+		if (!configurable) {
+			push_error(client, -241, "Hardware missing");
+			client.responses.append("");
+			return;
+		}
+		QStringList keys;
+		for (const auto &property_pair : configurable->properties()) {
+			keys.append(quote(devices::deviceutil::format_config_key(
+				property_pair.first).remove(' ')));
+		}
+		client.responses.append(keys.join(","));
+	}
+	else if (header_matches(header, "CONFigure:VALue?")) {
+		client.responses.append(query_config(client, params));
+	}
+	else if (header_matches(header, "CONFigure:VALue")) {
+		set_config(client, params);
+	}
+	else if (header_matches(header, "MEASure:VALue?") ||
+			header_matches(header, "MEASure:SAMPle?") ||
+			header_matches(header, "MEASure:STATistics?")) {
+		client.responses.append(query_signal(client, header, params));
+	}
+	else {
+		push_error(client, -113, "Undefined header");
+		// Keep the responses in sync with the queries.
+		if (header.endsWith('?'))
+			client.responses.append("");
+	}
+}
+
+QString ScpiServer::query_signal(Client &client, const QString &header,
+	const QStringList &params)
+{
+	if (params.size() < 1) {
+		push_error(client, -109, "Missing parameter");
+		return QString();
+	}
+	auto signal = find_signal(unquote(params[0]));
+	if (!signal) {
+		push_error(client, -241, "Hardware missing");
+		return QString();
+	}
+	if (signal->sample_count() == 0)
+		return scpi_nan;
+
+	const data::analog_time_sample_t last_sample = signal->get_last_sample(false);
+	if (header_matches(header, "MEASure:VALue?"))
+		return format_number(last_sample.second);
+	if (header_matches(header, "MEASure:SAMPle?")) {
+		return QString("%1,%2").arg(QString::number(last_sample.first, 'f', 6)).
+			arg(format_number(last_sample.second));
+	}
+
+	// Statistics over the last n seconds
+	if (params.size() < 2) {
+		push_error(client, -109, "Missing parameter");
+		return QString();
+	}
+	bool ok;
+	const double time_span = params[1].toDouble(&ok);
+	if (!ok || time_span < 0) {
+		push_error(client, -224, "Illegal parameter value");
+		return QString();
+	}
+
+	// The min and max values come from the min/max tree of the signal, only
+	// the mean is computed here. It is updated incrementally with the samples
+	// that have entered and left the window since the last query.
+	const size_t last = signal->sample_count();
+	const double end_timestamp = signal->get_sample(last - 1, false).first;
+	const double start_timestamp = end_timestamp - time_span;
+	const size_t first =
+		signal->get_index_at_timestamp(start_timestamp, false);
+
+	MeanWindow &window = mean_windows_[unquote(params[0])];
+	if (window.signal.lock() != signal || first < window.first ||
+			first > window.last || last < window.last) {
+		window.signal = signal;
+		window.first = first;
+		window.last = first;
+		window.sum = 0;
+		window.count = 0;
+	}
+	for (; window.first < first; ++window.first) {
+		const double value = signal->get_sample(window.first, false).second;
+		if (std::isfinite(value)) {
+			window.sum -= value;
+			--window.count;
+		}
+	}
+	for (; window.last < last; ++window.last) {
+		const double value = signal->get_sample(window.last, false).second;
+		if (std::isfinite(value)) {
+			window.sum += value;
+			++window.count;
+		}
+	}
+
+	double min;
+	double max;
+	if (window.count == 0 || !signal->get_min_max(
+			start_timestamp, end_timestamp, min, max, false))
+		return QString("%1,%1,%1,0").arg(scpi_nan);
+	return QString("%1,%2,%3,%4").arg(format_number(min)).
+		arg(format_number(max)).
+		arg(format_number(window.sum / window.count)).arg(window.count);
+}
+
+QString ScpiServer::query_config(Client &client, const QStringList &params)
+{
+	auto property = find_property(client, params);
+	if (!property)
+		return QString();
+	if (!property->is_getable()) {
+		push_error(client, -221, "Settings conflict");
+		return QString();
+	}
+
+	// The cached value, the device is not read.
+	const QVariant value = property->value();
+	switch (property->data_type()) {
+	case data::DataType::Bool:
+		return value.toBool() ? "1" : "0";
+	case data::DataType::Double:
+		return format_number(value.toDouble());
+	case data::DataType::Int32:
+	case data::DataType::UInt64:
+		return value.toString();
+	default:
+		return quote(property->to_string());
+	}
+}
+
+void ScpiServer::set_config(Client &client, const QStringList &params)
+{
+	auto property = find_property(client, params);
+	if (!property)
+		return;
+	if (params.size() < 3) {
+		push_error(client, -109, "Missing parameter");
+		return;
+	}
+	if (!property->is_setable()) {
+		push_error(client, -221, "Settings conflict");
+		return;
+	}
+
+	const QString param = params[2];
+	QVariant value;
+	bool ok = true;
+	switch (property->data_type()) {
+	case data::DataType::Bool:
+		if (param.compare("ON", Qt::CaseInsensitive) == 0 || param == "1")
+			value = QVariant(true);
+		else if (param.compare("OFF", Qt::CaseInsensitive) == 0 || param == "0")
+			value = QVariant(false);
+		else
+			ok = false;
+		break;
+	case data::DataType::Double:
+		value = QVariant(param.toDouble(&ok));
+		break;
+	case data::DataType::Int32:
+		value = QVariant(param.toInt(&ok));
+		break;
+	case data::DataType::UInt64:
+		value = QVariant(param.toULongLong(&ok));
+		break;
+	case data::DataType::String:
+		value = QVariant(unquote(param));
+		break;
+	default:
+		ok = false;
+		break;
+	}
+	if (!ok) {
+		push_error(client, -224, "Illegal parameter value");
+		return;
+	}
+
+	// The value is set asynchronously by the command queue of the device.
+	// The future tells when (and if) the value has been set.
+	check_pending_sets(client);
+	client.pending_sets.push_back(property->change_value(value));
+}
+
+void ScpiServer::check_pending_sets(Client &client)
+{
+	for (auto it = client.pending_sets.begin();
+			it != client.pending_sets.end();) {
+		if (!is_ready(*it)) {
+			++it;
+			continue;
+		}
+		bool ok = false;
+		try {
+			ok = it->get();
+		}
+		catch (...) {
+		}
+		if (!ok)
+			push_error(client, -200, "Execution error");
+		it = client.pending_sets.erase(it);
+	}
+}
+
+QStringList ScpiServer::list_signals(const QString &device_id)
+{
+	QStringList paths;
+	for (const auto &device_pair : session_.devices()) {
+		const QString id = QString::fromStdString(device_pair.first);
+		if (!device_id.isEmpty() && id != device_id)
+			continue;
+		for (const auto &channel_pair : device_pair.second->channel_map()) {
+			for (const auto &signal : channel_pair.second->signals()) {
+				paths.append(quote(QString("%1/%2/%3").arg(id).
+					arg(QString::fromStdString(channel_pair.first)).
+					arg(QString::fromStdString(signal->name()))));
+			}
+		}
+	}
+	return paths;
+}
+
+QStringList ScpiServer::list_configurables(const QString &device_id)
+{
+	QStringList paths;
+	for (const auto &device_pair : session_.devices()) {
+		const QString id = QString::fromStdString(device_pair.first);
+		if (!device_id.isEmpty() && id != device_id)
+			continue;
+		for (const auto &conf_pair : device_pair.second->configurable_map()) {
+			paths.append(quote(QString("%1/%2").arg(id).
+				arg(QString::fromStdString(conf_pair.second->name()))));
+		}
+	}
+	return paths;
+}
+
+shared_ptr<data::AnalogTimeSignal> ScpiServer::find_signal(const QString &path)
+{
+	const auto it = signal_cache_.find(path);
+	if (it != signal_cache_.end()) {
+		auto signal = it->second.lock();
+		if (signal)
+			return signal;
+		signal_cache_.erase(it);
+	}
+
+	// The device id may contain '/', so split from the end.
+	const QString signal_name = path.section('/', -1);
+	const QString channel_name = path.section('/', -2, -2);
+	const QString device_id = path.section('/', 0, -3);
+	const auto devices = session_.devices();
+	const auto device_it = devices.find(device_id.toStdString());
+	if (device_it == devices.end())
+		return nullptr;
+	const auto channels = device_it->second->channel_map();
+	const auto channel_it = channels.find(channel_name.toStdString());
+	if (channel_it == channels.end())
+		return nullptr;
+	for (const auto &signal : channel_it->second->signals()) {
+		auto a_signal = dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+		if (a_signal && a_signal->name() == signal_name.toStdString()) {
+			signal_cache_.insert(make_pair(path, a_signal));
+			return a_signal;
+		}
+	}
+	return nullptr;
+}
+
+shared_ptr<devices::Configurable> ScpiServer::find_configurable(
+	const QString &path)
+{
+	const QString configurable_name = path.section('/', -1);
+	const QString device_id = path.section('/', 0, -2);
+	const auto devices = session_.devices();
+	const auto device_it = devices.find(device_id.toStdString());
+	if (device_it == devices.end())
+		return nullptr;
+	for (const auto &conf_pair : device_it->second->configurable_map()) {
+		if (conf_pair.second->name() == configurable_name.toStdString())
+			return conf_pair.second;
+	}
+	return nullptr;
+}
+
+shared_ptr<data::properties::BaseProperty> ScpiServer::find_property(
+	Client &client, const QStringList &params)
+{
+	if (params.size() < 2) {
+		push_error(client, -109, "Missing parameter");
+		return nullptr;
+	}
+	auto configurable = find_configurable(unquote(params[0]));
+	if (!configurable) {
+		push_error(client, -241, "Hardware missing");
+		return nullptr;
+	}
+	const QString key_name = unquote(params[1]);
+	for (const auto &property_pair : configurable->properties()) {
+		const QString name = devices::deviceutil::format_config_key(
+			property_pair.first).remove(' ');
+		if (name.compare(key_name, Qt::CaseInsensitive) == 0)
+			return property_pair.second;
+	}
+	push_error(client, -224, "Illegal parameter value");
+	return nullptr;
+}
+
+void ScpiServer::push_error(Client &client, int code, const QString &message)
+{
+	// SCPI: The last error of a full queue is replaced by "Queue overflow".
+	if (client.errors.size() >= max_error_count) {
+		client.errors.back() = "-350,\"Queue overflow\"";
+		return;
+	}
+	client.errors.push_back(QString("%1,\"%2\"").arg(code).arg(message));
+}
+
+bool ScpiServer::header_matches(const QString &header, const QString &pattern)
+{
+	const bool is_query = header.endsWith('?');
+	if (is_query != pattern.endsWith('?'))
+		return false;
+
+	QString clean_header = is_query ? header.left(header.size() - 1) : header;
+	if (clean_header.startsWith(':'))
+		clean_header.remove(0, 1);
+	const QString clean_pattern =
+		is_query ? pattern.left(pattern.size() - 1) : pattern;
+
+	const QStringList tokens = clean_header.split(':');
+	const QStringList mnemonics = clean_pattern.split(':');
+	if (tokens.size() != mnemonics.size())
+		return false;
+	for (int i = 0; i < tokens.size(); ++i) {
+		if (!mnemonic_matches(tokens[i], mnemonics[i]))
+			return false;
+	}
+	return true;
+}
+
+QStringList ScpiServer::split_unquoted(const QString &str, QChar sep)
+{
+	QStringList parts;
+	QString part;
+	bool in_quotes = false;
+	for (const auto &c : str) {
+		if (c == '"')
+			in_quotes = !in_quotes;
+		if (c == sep && !in_quotes) {
+			parts.append(part);
+			part.clear();
+			continue;
+		}
+		part.append(c);
+	}
+	parts.append(part);
+	return parts;
+}
+
+QString ScpiServer::unquote(const QString &str)
+{
+	const QString trimmed = str.trimmed();
+	if (trimmed.size() >= 2 && trimmed.startsWith('"') && trimmed.endsWith('"'))
+		return trimmed.mid(1, trimmed.size() - 2);
+	return trimmed;
+}
+
+QString ScpiServer::quote(const QString &str)
+{
+	return QString("\"%1\"").arg(str);
+}
+
+QString ScpiServer::format_number(double value)
+{
+	if (!std::isfinite(value))
+		return scpi_nan;
+	return QString::number(value, 'g', 12);
+}
+
+} // namespace server
+} // namespace sv
@@ -0,0 +1,161 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_SCPISERVER_HPP
+#define SERVER_SCPISERVER_HPP
+
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "baseserver.hpp"
+
+using std::deque;
+using std::map;
+using std::shared_future;
+using std::shared_ptr;
+using std::vector;
+using std::weak_ptr;
+
+class QIODevice;
+class QTimer;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+namespace properties {
+class BaseProperty;
+}
+}
+
+namespace devices {
+class Configurable;
+}
+
+namespace server {
+
+/**
+ * The ScpiServer is a gateway for test executives, that speak SCPI. Many
+ * local clients can access the devices of the session, without opening the
+ * instruments themselves.
+ *
+ * Commands are separated by ';' or new lines. All responses to the queries
+ * of one line are sent as one line, separated by ';'. Clients can pipeline
+ * any number of lines; all complete lines are executed in one batch and the
+ * responses are written at once.
+ *
+ * Queries are answered from the cached property values and the samples of
+ * the signals, they never wait for a device. Set commands are queued in the
+ * command queue of the device; *OPC? and *WAI wait (without blocking the
+ * server) until the set commands of the client have been executed.
+ *
+ * Paths are quoted strings: "<device id>/<configurable>" for configurables,
+ * "<device id>/<channel>/<signal>" for signals. Config keys are the key
+ * names without spaces, e.g. "VoltageTarget".
+ */
+class ScpiServer : public BaseServer
+{
+	Q_OBJECT
+
+public:
+	explicit ScpiServer(Session &session);
+	~ScpiServer();
+
+	void close() override;
+	size_t client_count() const;
+
+private:
+	struct Client {
+		/** The commands to execute. An empty command marks an end of line. */
+		deque<QString> commands;
+		/** The responses of the actual line. */
+		QStringList responses;
+		/** The futures of the queued set commands. */
+		vector<shared_future<bool>> pending_sets;
+		/** The SCPI error queue. */
+		deque<QString> errors;
+	};
+
+	/** The window of the last MEASure:STATistics? query of a signal. */
+	struct MeanWindow {
+		weak_ptr<data::AnalogTimeSignal> signal;
+		size_t first;
+		size_t last;
+		double sum;
+		size_t count;
+	};
+
+	void add_client(QIODevice *socket) override;
+	void remove_client(QIODevice *socket);
+	/**
+	 * Execute the commands of the client. Return false, if a command has to
+	 * wait for the pending set commands.
+	 */
+	bool process_client(QIODevice *socket, Client &client);
+	void execute(Client &client, const QString &command);
+
+	QString query_signal(Client &client, const QString &header,
+		const QStringList &params);
+	QString query_config(Client &client, const QStringList &params);
+	void set_config(Client &client, const QStringList &params);
+	/**
+	 * Remove the executed set commands and push an execution error for
+	 * every set command that has failed.
+	 */
+	static void check_pending_sets(Client &client);
+	QStringList list_signals(const QString &device_id);
+	QStringList list_configurables(const QString &device_id);
+
+	shared_ptr<data::AnalogTimeSignal> find_signal(const QString &path);
+	shared_ptr<devices::Configurable> find_configurable(const QString &path);
+	shared_ptr<data::properties::BaseProperty> find_property(
+		Client &client, const QStringList &params);
+
+	static void push_error(Client &client, int code, const QString &message);
+	/** Match a header against a pattern like "MEASure:VALue?". */
+	static bool header_matches(const QString &header, const QString &pattern);
+	/** Split the string at sep, but not inside of quotes. */
+	static QStringList split_unquoted(const QString &str, QChar sep);
+	static QString unquote(const QString &str);
+	static QString quote(const QString &str);
+	static QString format_number(double value);
+
+	map<QIODevice *, Client> clients_;
+	map<QString, weak_ptr<data::AnalogTimeSignal>> signal_cache_;
+	map<QString, MeanWindow> mean_windows_;
+	QTimer *wait_timer_;
+
+private Q_SLOTS:
+	void on_client_ready_read();
+	void on_client_disconnected();
+	void on_wait_timer();
+
+};
+
+} // namespace server
+} // namespace sv
+
+#endif // SERVER_SCPISERVER_HPP
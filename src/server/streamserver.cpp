@@ -0,0 +1,605 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDebug>
+#include <QIODevice>
+#include <QString>
+#include <QTimer>
+
+#include "streamserver.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::lock_guard;
+using std::make_pair;
+using std::make_shared;
+using std::min;
+using std::pair;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace server {
+
+namespace {
+
+/** Max. number of samples buffered per stream between two flushes. */
+const size_t max_pending_samples = 1024 * 1024;
+/** Max. number of samples in one Samples frame. */
+const size_t max_frame_samples = 4096;
+/** Only write to the socket, while less bytes are in the socket buffer. */
+const qint64 socket_write_watermark = 256 * 1024;
+const size_t default_max_queue_size = 4 * 1024 * 1024;
+const qint64 max_command_length = 1024;
+
+QDataStream &write_string(QDataStream &stream, const QString &str)
+{
+	const QByteArray bytes = str.toUtf8();
+	stream << (quint16)bytes.size();
+	stream.writeRawData(bytes.constData(), bytes.size());
+	return stream;
+}
+
+void init_stream(QDataStream &stream)
+{
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+}
+
+StreamServer::StreamServer(Session &session) :
+	BaseServer(session),
+	guard_(make_shared<AcquisitionGuard>()),
+	flush_timer_(new QTimer(this)),
+	max_queue_size_(default_max_queue_size),
+	overflow_policy_(StreamOverflowPolicy::DropOldest),
+	streams_changed_(false)
+{
+	guard_->server = this;
+	flush_timer_->setInterval(20);
+	connect(flush_timer_, SIGNAL(timeout()), this, SLOT(on_flush_timer()));
+	flush_timer_->start();
+
+	for (const auto &device_pair : session_.devices())
+		add_device(device_pair.second);
+	connect(&session_, &Session::device_added,
+		this, &StreamServer::add_device);
+	connect(&session_, &Session::device_removed,
+		this, &StreamServer::remove_device);
+}
+
+StreamServer::~StreamServer()
+{
+	// No more calls from the aquisition threads from here on.
+	{
+		lock_guard<mutex> guard_lock(guard_->mtx);
+		guard_->server = nullptr;
+	}
+
+	close();
+
+	lock_guard<mutex> lock(mutex_);
+	for (auto &stream : streams_) {
+		disconnect(stream.connection);
+		stream.signal.reset();
+	}
+}
+
+void StreamServer::close()
+{
+	vector<QIODevice *> sockets;
+	for (const auto &client_pair : clients_)
+		sockets.push_back(client_pair.first);
+	for (const auto &socket : sockets)
+		remove_client(socket);
+
+	BaseServer::close();
+}
+
+void StreamServer::set_max_queue_size(size_t max_queue_size)
+{
+	max_queue_size_ = max_queue_size;
+}
+
+void StreamServer::set_overflow_policy(StreamOverflowPolicy overflow_policy)
+{
+	overflow_policy_ = overflow_policy;
+}
+
+void StreamServer::set_flush_interval(int flush_interval)
+{
+	flush_timer_->setInterval(flush_interval);
+}
+
+size_t StreamServer::client_count() const
+{
+	return clients_.size();
+}
+
+void StreamServer::add_device(shared_ptr<devices::BaseDevice> device)
+{
+	if (!device)
+		return;
+
+	// The channels (and signals) of hardware devices can be added from the
+	// aquisition thread.
+	const string device_id = device->id();
+	shared_ptr<AcquisitionGuard> guard = guard_;
+	connect(device.get(), &devices::BaseDevice::channel_added,
+		this, [guard, device_id](shared_ptr<channels::BaseChannel> channel) {
+			lock_guard<mutex> guard_lock(guard->mtx);
+			if (guard->server)
+				guard->server->add_channel(device_id, channel);
+		}, Qt::DirectConnection);
+
+	for (const auto &channel_pair : device->channel_map())
+		add_channel(device_id, channel_pair.second);
+}
+
+void StreamServer::remove_device(shared_ptr<devices::BaseDevice> device)
+{
+	if (!device)
+		return;
+
+	disconnect(device.get(), nullptr, this, nullptr);
+	const string prefix = device->id() + "/";
+	lock_guard<mutex> lock(mutex_);
+	for (auto &stream : streams_) {
+		if (!stream.signal || stream.path.compare(0, prefix.size(), prefix) != 0)
+			continue;
+		disconnect(stream.connection);
+		stream.signal.reset();
+		stream.pending.clear();
+	}
+}
+
+void StreamServer::add_channel(const string &device_id,
+	shared_ptr<channels::BaseChannel> channel)
+{
+	const string channel_path = device_id + "/" + channel->name();
+	shared_ptr<AcquisitionGuard> guard = guard_;
+	connect(channel.get(), &channels::BaseChannel::signal_added,
+		this, [guard, channel_path](shared_ptr<data::BaseSignal> signal) {
+			lock_guard<mutex> guard_lock(guard->mtx);
+			if (guard->server)
+				guard->server->add_signal(channel_path, signal);
+		}, Qt::DirectConnection);
+
+	for (const auto &signal : channel->signals())
+		add_signal(channel_path, signal);
+}
+
+void StreamServer::add_signal(const string &channel_path,
+	shared_ptr<data::BaseSignal> signal)
+{
+	auto a_signal = dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+	if (!a_signal)
+		return;
+
+	lock_guard<mutex> lock(mutex_);
+	if (stream_ids_.count(a_signal.get()) > 0)
+		return;
+
+	Stream stream;
+	stream.id = (uint32_t)streams_.size();
+	stream.path = channel_path + "/" + a_signal->name();
+	stream.signal = a_signal;
+	stream.pos = a_signal->sample_count();
+	stream.dropped = 0;
+	stream.subscriber_count = 0;
+	const uint32_t stream_id = stream.id;
+	shared_ptr<AcquisitionGuard> guard = guard_;
+	stream.connection = connect(a_signal.get(),
+		&data::AnalogTimeSignal::sample_appended,
+		this, [guard, stream_id]() {
+			lock_guard<mutex> guard_lock(guard->mtx);
+			if (guard->server)
+				guard->server->on_sample_appended(stream_id);
+		},
+		Qt::DirectConnection);
+	streams_.push_back(stream);
+	stream_ids_.insert(make_pair(a_signal.get(), stream_id));
+	streams_changed_ = true;
+}
+
+void StreamServer::on_sample_appended(uint32_t stream_id)
+{
+	// Called in the aquisition thread: Only copy the new samples, never wait
+	// for the clients.
+	lock_guard<mutex> lock(mutex_);
+	Stream &stream = streams_[stream_id];
+	if (!stream.signal)
+		return;
+
+	const size_t sample_count = stream.signal->sample_count();
+	if (stream.pos > sample_count)
+		stream.pos = 0; // The signal has been cleared.
+	if (stream.subscriber_count == 0) {
+		stream.pos = sample_count;
+		return;
+	}
+
+	for (size_t pos = stream.pos; pos < sample_count; ++pos) {
+		if (stream.pending.size() >= max_pending_samples) {
+			stream.dropped += sample_count - pos;
+			break;
+		}
+		stream.pending.push_back(stream.signal->get_sample(pos, false));
+	}
+	stream.pos = sample_count;
+}
+
+void StreamServer::add_client(QIODevice *socket)
+{
+	Client client;
+	client.queued_bytes = 0;
+	client.dropped_samples = 0;
+	client.reported_dropped_samples = 0;
+	clients_.insert(make_pair(socket, client));
+
+	// QTcpSocket and QLocalSocket have the same signals, but no common base
+	// class that declares disconnected().
+	connect(socket, SIGNAL(readyRead()), this, SLOT(on_client_ready_read()));
+	connect(socket, SIGNAL(bytesWritten(qint64)),
+		this, SLOT(on_client_bytes_written()));
+	connect(socket, SIGNAL(disconnected()),
+		this, SLOT(on_client_disconnected()));
+
+	Q_EMIT client_connected();
+}
+
+void StreamServer::remove_client(QIODevice *socket)
+{
+	if (clients_.erase(socket) == 0)
+		return;
+
+	disconnect(socket, nullptr, this, nullptr);
+	socket->close();
+	socket->deleteLater();
+	update_subscriber_counts();
+
+	Q_EMIT client_disconnected();
+}
+
+void StreamServer::on_client_ready_read()
+{
+	QIODevice *socket = qobject_cast<QIODevice *>(sender());
+	auto it = clients_.find(socket);
+	if (it == clients_.end())
+		return;
+
+	while (socket->canReadLine()) {
+		const QString command = QString::fromUtf8(
+			socket->readLine(max_command_length + 1)).trimmed();
+		handle_command(socket, it->second, command);
+	}
+	if (socket->bytesAvailable() > max_command_length) {
+		qWarning() << "StreamServer: Command too long, disconnecting client";
+		remove_client(socket);
+		return;
+	}
+
+	write_queue(socket, it->second);
+}
+
+void StreamServer::on_client_bytes_written()
+{
+	QIODevice *socket = qobject_cast<QIODevice *>(sender());
+	auto it = clients_.find(socket);
+	if (it != clients_.end())
+		write_queue(socket, it->second);
+}
+
+void StreamServer::on_client_disconnected()
+{
+	remove_client(qobject_cast<QIODevice *>(sender()));
+}
+
+void StreamServer::handle_command(QIODevice *socket, Client &client,
+	const QString &command)
+{
+	const QString name = command.section(' ', 0, 0).toUpper();
+	const string pattern = command.section(' ', 1).trimmed().toStdString();
+
+	vector<Stream> streams;
+	{
+		lock_guard<mutex> lock(mutex_);
+		for (const auto &stream : streams_) {
+			if (!stream.signal)
+				continue;
+			Stream stream_info;
+			stream_info.id = stream.id;
+			stream_info.path = stream.path;
+			stream_info.signal = stream.signal;
+			streams.push_back(stream_info);
+		}
+	}
+
+	if (name == "LIST") {
+		for (const auto &stream : streams)
+			announce_stream(socket, client, stream.id, stream.path, stream.signal);
+	}
+	else if (name == "SUBSCRIBE" && !pattern.empty()) {
+		if (std::find(client.subscriptions.begin(), client.subscriptions.end(),
+				pattern) == client.subscriptions.end())
+			client.subscriptions.push_back(pattern);
+		update_subscriber_counts();
+		// The client needs the stream infos to decode the samples.
+		for (const auto &stream : streams) {
+			if (path_matches(stream.path, pattern) &&
+					client.announced_streams.count(stream.id) == 0)
+				announce_stream(socket, client, stream.id, stream.path,
+					stream.signal);
+		}
+	}
+	else if (name == "UNSUBSCRIBE" && !pattern.empty()) {
+		client.subscriptions.erase(std::remove(client.subscriptions.begin(),
+			client.subscriptions.end(), pattern), client.subscriptions.end());
+		update_subscriber_counts();
+	}
+	else if (!name.isEmpty()) {
+		QByteArray payload;
+		QDataStream stream(&payload, QIODevice::WriteOnly);
+		init_stream(stream);
+		write_string(stream, tr("Unknown command: %1").arg(command));
+		QueuedFrame frame;
+		frame.data = make_frame(StreamFrameType::Error, payload);
+		frame.sample_count = 0;
+		queue_frame(socket, client, frame);
+	}
+}
+
+void StreamServer::update_subscriber_counts()
+{
+	lock_guard<mutex> lock(mutex_);
+	for (auto &stream : streams_) {
+		unsigned int subscriber_count = 0;
+		for (const auto &client_pair : clients_) {
+			for (const auto &pattern : client_pair.second.subscriptions) {
+				if (path_matches(stream.path, pattern)) {
+					++subscriber_count;
+					break;
+				}
+			}
+		}
+		// Start with the samples that are appended from now on.
+		if (stream.subscriber_count == 0 && subscriber_count > 0 && stream.signal)
+			stream.pos = stream.signal->sample_count();
+		stream.subscriber_count = subscriber_count;
+	}
+}
+
+void StreamServer::announce_stream(QIODevice *socket, Client &client,
+	uint32_t stream_id, const string &path,
+	shared_ptr<data::AnalogTimeSignal> signal)
+{
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	init_stream(stream);
+	stream << (quint32)stream_id;
+	write_string(stream, QString::fromStdString(path));
+	write_string(stream, signal->quantity_name());
+	write_string(stream, signal->unit_name());
+
+	QueuedFrame frame;
+	frame.data = make_frame(StreamFrameType::SignalInfo, payload);
+	frame.sample_count = 0;
+	client.announced_streams.insert(stream_id);
+	queue_frame(socket, client, frame);
+}
+
+bool StreamServer::queue_frame(QIODevice *socket, Client &client,
+	QueuedFrame frame)
+{
+	const size_t frame_size = frame.data.size();
+	if (frame.sample_count > 0 &&
+			client.queued_bytes + frame_size > max_queue_size_) {
+		switch (overflow_policy_) {
+		case StreamOverflowPolicy::DropNewest:
+			client.dropped_samples += frame.sample_count;
+			return true;
+		case StreamOverflowPolicy::DropOldest:
+			// Keep the frames without samples, the client needs them.
+			for (auto it = client.queue.begin(); it != client.queue.end() &&
+					client.queued_bytes + frame_size > max_queue_size_;) {
+				if (it->sample_count == 0) {
+					++it;
+					continue;
+				}
+				client.dropped_samples += it->sample_count;
+				client.queued_bytes -= it->data.size();
+				it = client.queue.erase(it);
+			}
+			if (client.queued_bytes + frame_size > max_queue_size_) {
+				client.dropped_samples += frame.sample_count;
+				return true;
+			}
+			break;
+		case StreamOverflowPolicy::Disconnect:
+			qWarning() << "StreamServer: Client is too slow, disconnecting";
+			remove_client(socket);
+			return false;
+		}
+	}
+
+	client.queued_bytes += frame_size;
+	client.queue.push_back(frame);
+	return true;
+}
+
+void StreamServer::write_queue(QIODevice *socket, Client &client)
+{
+	while (!client.queue.empty() &&
+			socket->bytesToWrite() < socket_write_watermark) {
+		const QueuedFrame &frame = client.queue.front();
+		socket->write(frame.data);
+		client.queued_bytes -= frame.data.size();
+		client.queue.pop_front();
+	}
+}
+
+void StreamServer::on_flush_timer()
+{
+	if (streams_changed_.exchange(false))
+		update_subscriber_counts();
+
+	struct Batch {
+		uint32_t id;
+		string path;
+		shared_ptr<data::AnalogTimeSignal> signal;
+		vector<pair<double, double>> samples;
+		vector<QueuedFrame> frames;
+		uint64_t dropped;
+	};
+
+	// Only take the pending samples under the lock, the aquisition threads
+	// must not wait for the encoding.
+	vector<Batch> batches;
+	{
+		lock_guard<mutex> lock(mutex_);
+		for (auto &stream : streams_) {
+			if (!stream.signal || stream.subscriber_count == 0)
+				continue;
+			batches.push_back(Batch());
+			Batch &batch = batches.back();
+			batch.id = stream.id;
+			batch.path = stream.path;
+			batch.signal = stream.signal;
+			batch.dropped = stream.dropped;
+			batch.samples.swap(stream.pending);
+			stream.dropped = 0;
+		}
+	}
+
+	// Encode the samples once for all clients.
+	for (auto &batch : batches) {
+		const vector<pair<double, double>> &samples = batch.samples;
+		for (size_t start = 0; start < samples.size();
+				start += max_frame_samples) {
+			const size_t count = min(max_frame_samples, samples.size() - start);
+			QByteArray payload;
+			QDataStream data_stream(&payload, QIODevice::WriteOnly);
+			init_stream(data_stream);
+			data_stream << (quint32)batch.id << (quint32)count;
+			for (size_t i = start; i < start + count; ++i)
+				data_stream << samples[i].first << samples[i].second;
+
+			QueuedFrame frame;
+			frame.data = make_frame(StreamFrameType::Samples, payload);
+			frame.sample_count = (uint32_t)count;
+			batch.frames.push_back(frame);
+		}
+	}
+
+	vector<QIODevice *> sockets;
+	for (const auto &client_pair : clients_)
+		sockets.push_back(client_pair.first);
+
+	for (const auto &socket : sockets) {
+		auto it = clients_.find(socket);
+		if (it == clients_.end())
+			continue;
+		Client &client = it->second;
+
+		bool connected = true;
+		for (const auto &batch : batches) {
+			bool subscribed = false;
+			for (const auto &pattern : client.subscriptions) {
+				if (path_matches(batch.path, pattern)) {
+					subscribed = true;
+					break;
+				}
+			}
+			if (!subscribed)
+				continue;
+
+			if (client.announced_streams.count(batch.id) == 0)
+				announce_stream(socket, client, batch.id, batch.path,
+					batch.signal);
+			client.dropped_samples += batch.dropped;
+			for (const auto &frame : batch.frames) {
+				if (!(connected = queue_frame(socket, client, frame)))
+					break;
+			}
+			if (!connected)
+				break;
+		}
+		if (!connected)
+			continue;
+
+		if (client.dropped_samples != client.reported_dropped_samples) {
+			QByteArray payload;
+			QDataStream stream(&payload, QIODevice::WriteOnly);
+			init_stream(stream);
+			stream << (quint64)client.dropped_samples;
+			QueuedFrame frame;
+			frame.data = make_frame(StreamFrameType::Dropped, payload);
+			frame.sample_count = 0;
+			queue_frame(socket, client, frame);
+			client.reported_dropped_samples = client.dropped_samples;
+		}
+
+		write_queue(socket, client);
+	}
+}
+
+bool StreamServer::path_matches(const string &path, const string &pattern)
+{
+	if (pattern == "*" || path == pattern)
+		return true;
+	// The pattern is a device or channel path.
+	return path.size() > pattern.size() &&
+		path.compare(0, pattern.size(), pattern) == 0 &&
+		path[pattern.size()] == '/';
+}
+
+QByteArray StreamServer::make_frame(StreamFrameType type,
+	const QByteArray &payload)
+{
+	QByteArray frame;
+	frame.reserve(payload.size() + 5);
+	QDataStream stream(&frame, QIODevice::WriteOnly);
+	init_stream(stream);
+	stream << (quint32)payload.size() << (quint8)type;
+	stream.writeRawData(payload.constData(), payload.size());
+	return frame;
+}
+
+} // namespace server
+} // namespace sv
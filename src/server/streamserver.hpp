@@ -0,0 +1,226 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_STREAMSERVER_HPP
+#define SERVER_STREAMSERVER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <QByteArray>
+#include <QMetaObject>
+#include <QObject>
+
+#include "baseserver.hpp"
+
+using std::deque;
+using std::map;
+using std::mutex;
+using std::pair;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+class QIODevice;
+class QTimer;
+
+namespace sv {
+
+class Session;
+
+namespace channels {
+class BaseChannel;
+}
+
+namespace data {
+class AnalogTimeSignal;
+class BaseSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace server {
+
+/**
+ * What happens when the queue of a client is full, because the client
+ * doesn't read fast enough.
+ */
+enum class StreamOverflowPolicy {
+	/** Drop the new samples. */
+	DropNewest,
+	/** Drop the oldest queued samples. */
+	DropOldest,
+	/** Disconnect the client. */
+	Disconnect,
+};
+
+/**
+ * Frame types of the stream protocol. Every frame starts with the payload
+ * length (uint32) and the frame type (uint8), all values are little endian.
+ */
+enum class StreamFrameType : uint8_t {
+	/** uint32 stream id, string path, string quantity, string unit */
+	SignalInfo = 1,
+	/** uint32 stream id, uint32 count, count * (double ts, double value) */
+	Samples = 2,
+	/** uint64 number of samples dropped for this client so far */
+	Dropped = 3,
+	/** string error message */
+	Error = 4,
+};
+
+/**
+ * The StreamServer publishes the samples of the session signals to local
+ * clients.
+ *
+ * Clients send text commands, one per line:
+ *   LIST                 Send a SignalInfo frame for every signal.
+ *   SUBSCRIBE <path>     Subscribe to all signals under the path.
+ *   UNSUBSCRIBE <path>   Remove a subscription.
+ * A path is "<device id>/<channel name>/<signal name>", where the signal
+ * or channel name can be omitted. "*" subscribes to all signals.
+ *
+ * New samples are copied in the aquisition thread and sent in batches from
+ * the main thread. Every client has a bounded queue, so the aquisition never
+ * waits for a slow client.
+ */
+class StreamServer : public BaseServer
+{
+	Q_OBJECT
+
+public:
+	explicit StreamServer(Session &session);
+	~StreamServer();
+
+	void close() override;
+
+	/** Max. number of bytes queued per client. */
+	void set_max_queue_size(size_t max_queue_size);
+	void set_overflow_policy(StreamOverflowPolicy overflow_policy);
+	/** Interval in ms in which the new samples are sent to the clients. */
+	void set_flush_interval(int flush_interval);
+
+	size_t client_count() const;
+
+private:
+	struct Stream {
+		uint32_t id;
+		string path;
+		shared_ptr<data::AnalogTimeSignal> signal;
+		size_t pos;
+		vector<pair<double, double>> pending;
+		/** Samples dropped, because pending was full. */
+		uint64_t dropped;
+		/** Number of clients that have subscribed to this stream. */
+		unsigned int subscriber_count;
+		QMetaObject::Connection connection;
+	};
+
+	/**
+	 * Shared with the DirectConnection lambdas, that are called from the
+	 * aquisition threads. The destructor resets `server` under the lock, so
+	 * a call that is already waiting for the lock doesn't touch the
+	 * destroyed server.
+	 */
+	struct AcquisitionGuard {
+		mutex mtx;
+		StreamServer *server;
+	};
+
+	struct QueuedFrame {
+		QByteArray data;
+		uint32_t sample_count;
+	};
+
+	struct Client {
+		vector<string> subscriptions;
+		set<uint32_t> announced_streams;
+		deque<QueuedFrame> queue;
+		size_t queued_bytes;
+		uint64_t dropped_samples;
+		uint64_t reported_dropped_samples;
+	};
+
+	void add_device(shared_ptr<devices::BaseDevice> device);
+	void remove_device(shared_ptr<devices::BaseDevice> device);
+	void add_channel(const string &device_id,
+		shared_ptr<channels::BaseChannel> channel);
+	void add_signal(const string &path, shared_ptr<data::BaseSignal> signal);
+	void on_sample_appended(uint32_t stream_id);
+
+	void add_client(QIODevice *socket) override;
+	void handle_command(QIODevice *socket, Client &client,
+		const QString &command);
+	void update_subscriber_counts();
+	void announce_stream(QIODevice *socket, Client &client,
+		uint32_t stream_id, const string &path,
+		shared_ptr<data::AnalogTimeSignal> signal);
+	/**
+	 * Queue a frame, respecting the max. queue size and overflow policy.
+	 * Frames without samples are always queued. Return false, if the client
+	 * has been disconnected.
+	 */
+	bool queue_frame(QIODevice *socket, Client &client, QueuedFrame frame);
+	void write_queue(QIODevice *socket, Client &client);
+	void remove_client(QIODevice *socket);
+
+	static bool path_matches(const string &path, const string &pattern);
+	static QByteArray make_frame(StreamFrameType type,
+		const QByteArray &payload);
+
+	shared_ptr<AcquisitionGuard> guard_;
+	QTimer *flush_timer_;
+	size_t max_queue_size_;
+	StreamOverflowPolicy overflow_policy_;
+
+	/** The streams are accessed from the aquisition threads. */
+	mutable mutex mutex_;
+	vector<Stream> streams_;
+	map<data::BaseSignal *, uint32_t> stream_ids_;
+	std::atomic<bool> streams_changed_;
+
+	map<QIODevice *, Client> clients_;
+
+private Q_SLOTS:
+	void on_client_ready_read();
+	void on_client_bytes_written();
+	void on_client_disconnected();
+	void on_flush_timer();
+
+Q_SIGNALS:
+	void client_connected();
+	void client_disconnected();
+
+};
+
+} // namespace server
+} // namespace sv
+
+#endif // SERVER_STREAMSERVER_HPP
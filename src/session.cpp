@@ -21,6 +21,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,16 +31,29 @@
 #include "session.hpp"
 #include "config.h"
 #include "src/devicemanager.hpp"
+#include "src/eventloopmonitor.hpp"
+#include "src/fileimporter.hpp"
+#include "src/sessionjournal.hpp"
 #include "src/util.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/devices/acquisitionmetrics.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/hardwaredevice.hpp"
+#include "src/devices/replaydevice.hpp"
+#include "src/devices/replayrecording.hpp"
 #include "src/devices/userdevice.hpp"
 #include "src/python/smuscriptrunner.hpp"
+#include "src/server/scpiserver.hpp"
+#include "src/server/streamserver.hpp"
+#include "src/ui/widgets/displayscheduler.hpp"
+#include "src/ui/widgets/plot/plotscheduler.hpp"
 
 using std::list;
 using std::make_pair;
 using std::make_shared;
 using std::map;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -55,17 +69,34 @@ double Session::session_start_timestamp = .0;
 
 Session::Session(DeviceManager &device_manager, MainWindow *main_window) :
 	device_manager_(device_manager),
-	main_window_(main_window)
+	main_window_(main_window),
+	journal_max_size_(0)
 {
 	smu_script_runner_ = make_shared<python::SmuScriptRunner>(*this);
 	connect(smu_script_runner_.get(), &python::SmuScriptRunner::script_error,
 		this, &Session::error_handler);
+	plot_scheduler_ = make_shared<ui::widgets::plot::PlotScheduler>();
+	display_scheduler_ = make_shared<ui::widgets::DisplayScheduler>();
+	// Measure the time from the packet arrival to the screen.
+	connect(plot_scheduler_.get(),
+		&ui::widgets::plot::PlotScheduler::plots_updated,
+		this, &Session::on_displays_updated);
+	connect(display_scheduler_.get(),
+		&ui::widgets::DisplayScheduler::displays_updated,
+		this, &Session::on_displays_updated);
+	event_loop_monitor_ = make_shared<EventLoopMonitor>();
+	journal_ = make_shared<SessionJournal>(
+		SessionJournal::default_journal_path());
 }
 
 Session::~Session()
 {
+	scpi_server_.reset();
+	stream_server_.reset();
 	for (auto &device : devices_)
 		device.second->close();
+	// A clean shutdown, the journal is not needed anymore.
+	journal_->close();
 }
 
 DeviceManager &Session::device_manager()
@@ -83,6 +114,21 @@ shared_ptr<python::SmuScriptRunner> Session::smu_script_runner()
 	return smu_script_runner_;
 }
 
+shared_ptr<ui::widgets::plot::PlotScheduler> Session::plot_scheduler()
+{
+	return plot_scheduler_;
+}
+
+shared_ptr<ui::widgets::DisplayScheduler> Session::display_scheduler()
+{
+	return display_scheduler_;
+}
+
+shared_ptr<EventLoopMonitor> Session::event_loop_monitor()
+{
+	return event_loop_monitor_;
+}
+
 void Session::save_settings(QSettings &settings) const
 {
 	(QSettings)&settings;
@@ -120,7 +166,8 @@ list<shared_ptr<devices::HardwareDevice>>
 	return devices;
 }
 
-void Session::add_device(shared_ptr<devices::BaseDevice> device)
+void Session::add_device(shared_ptr<devices::BaseDevice> device,
+	bool journal)
 {
 	assert(device);
 
@@ -136,6 +183,8 @@ void Session::add_device(shared_ptr<devices::BaseDevice> device)
 		this, &Session::error_handler);
 
 	devices_.insert(make_pair(device->id(), device));
+	if (journal)
+		journal_->add_device(device);
 
 	Q_EMIT device_added(device);
 }
@@ -153,6 +202,31 @@ shared_ptr<devices::UserDevice> Session::add_user_device()
 	return device;
 }
 
+shared_ptr<devices::ReplayDevice> Session::add_replay_device(
+	const string &file_name, const string &format)
+{
+	auto recording = devices::ReplayRecording::load(
+		sr_context, QString::fromStdString(file_name), format);
+
+	auto device = make_shared<devices::ReplayDevice>(sr_context, recording);
+	this->add_device(device);
+
+	return device;
+}
+
+shared_ptr<FileImporter> Session::import_file(
+	const string &file_name, const string &format)
+{
+	auto importer = make_shared<FileImporter>(
+		sr_context, QString::fromStdString(file_name), format);
+	auto device = importer->open();
+
+	// The samples are already in the imported file, no need to journal them.
+	this->add_device(device, false);
+
+	return importer;
+}
+
 void Session::remove_device(shared_ptr<devices::BaseDevice> device)
 {
 	if (device) {
@@ -167,6 +241,100 @@ void Session::remove_device(shared_ptr<devices::BaseDevice> device)
 	}
 }
 
+void Session::set_journal_max_size(uint64_t max_size)
+{
+	journal_max_size_ = max_size;
+}
+
+bool Session::is_journal_enabled() const
+{
+	return journal_max_size_ > 0;
+}
+
+bool Session::has_recoverable_journal() const
+{
+	if (!is_journal_enabled())
+		return false;
+	return journal_->has_recoverable_journal();
+}
+
+list<shared_ptr<devices::BaseDevice>> Session::init_journal(bool recover)
+{
+	list<shared_ptr<devices::BaseDevice>> recovered_devices;
+	if (!is_journal_enabled())
+		return recovered_devices;
+
+	QString old_journal_path;
+	journal_->set_max_size(journal_max_size_);
+	if (!journal_->open(old_journal_path))
+		return recovered_devices;
+	for (const auto &device : devices_)
+		journal_->add_device(device.second);
+
+	if (!old_journal_path.isEmpty()) {
+		if (recover) {
+			// The recovered devices are journaled again, so the old journal
+			// can be removed.
+			recovered_devices = journal_->recover(*this, old_journal_path);
+			SessionJournal::remove(old_journal_path);
+		}
+		else {
+			qWarning() << "Session: The journal of a crashed session was kept in"
+				<< old_journal_path;
+		}
+	}
+
+	return recovered_devices;
+}
+
+bool Session::start_stream_server(const QString &address)
+{
+	if (!stream_server_)
+		stream_server_ = make_shared<server::StreamServer>(*this);
+	if (!stream_server_->listen(address)) {
+		stream_server_.reset();
+		return false;
+	}
+
+	qWarning() << "Session: Stream server is listening on" <<
+		stream_server_->address();
+	return true;
+}
+
+void Session::stop_stream_server()
+{
+	stream_server_.reset();
+}
+
+shared_ptr<server::StreamServer> Session::stream_server() const
+{
+	return stream_server_;
+}
+
+bool Session::start_scpi_server(const QString &address)
+{
+	if (!scpi_server_)
+		scpi_server_ = make_shared<server::ScpiServer>(*this);
+	if (!scpi_server_->listen(address)) {
+		scpi_server_.reset();
+		return false;
+	}
+
+	qWarning() << "Session: SCPI server is listening on" <<
+		scpi_server_->address();
+	return true;
+}
+
+void Session::stop_scpi_server()
+{
+	scpi_server_.reset();
+}
+
+shared_ptr<server::ScpiServer> Session::scpi_server() const
+{
+	return scpi_server_;
+}
+
 MainWindow *Session::main_window() const
 {
 	return main_window_;
@@ -178,4 +346,21 @@ void Session::error_handler(const std::string &sender, const std::string &msg)
 		" error: " << QString::fromStdString(msg);
 }
 
+void Session::on_displays_updated(
+	const set<shared_ptr<data::AnalogTimeSignal>> &signals)
+{
+	// Only the devices, whose samples are on screen now.
+	set<devices::BaseDevice *> displayed_devices;
+	for (const auto &signal : signals) {
+		auto channel = signal->parent_channel();
+		if (channel && channel->parent_device())
+			displayed_devices.insert(channel->parent_device().get());
+	}
+
+	for (const auto &device : devices_) {
+		if (displayed_devices.count(device.second.get()) > 0)
+			device.second->metrics()->mark_displayed();
+	}
+}
+
 } // namespace sv
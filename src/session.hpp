@@ -20,9 +20,11 @@
 #ifndef SESSION_HPP
 #define SESSION_HPP
 
+#include <cstdint>
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 
 #include <QObject>
@@ -30,6 +32,7 @@
 
 using std::list;
 using std::map;
+using std::set;
 using std::shared_ptr;
 using std::string;
 
@@ -40,11 +43,19 @@ class Context;
 namespace sv {
 
 class DeviceManager;
+class EventLoopMonitor;
+class FileImporter;
 class MainWindow;
+class SessionJournal;
+
+namespace data {
+class AnalogTimeSignal;
+}
 
 namespace devices {
 class BaseDevice;
 class HardwareDevice;
+class ReplayDevice;
 class UserDevice;
 }
 
@@ -52,6 +63,20 @@ namespace python {
 class SmuScriptRunner;
 }
 
+namespace server {
+class ScpiServer;
+class StreamServer;
+}
+
+namespace ui {
+namespace widgets {
+class DisplayScheduler;
+namespace plot {
+class PlotScheduler;
+}
+}
+}
+
 class Session : public QObject
 {
 	Q_OBJECT
@@ -68,18 +93,78 @@ public:
 	DeviceManager &device_manager();
 	const DeviceManager &device_manager() const;
 	shared_ptr<python::SmuScriptRunner> smu_script_runner();
+	/** The scheduler that drives the updates of all plots. */
+	shared_ptr<ui::widgets::plot::PlotScheduler> plot_scheduler();
+	/** The scheduler that refreshes the value displays of all panels. */
+	shared_ptr<ui::widgets::DisplayScheduler> display_scheduler();
+	/** The monitor that measures the lag of the GUI event loop. */
+	shared_ptr<EventLoopMonitor> event_loop_monitor();
 
 	void save_settings(QSettings &settings) const;
 	void restore_settings(QSettings &settings);
 
 	map<string, shared_ptr<devices::BaseDevice>> devices() const;
 	list<shared_ptr<devices::HardwareDevice>> connect_device(string conn_string);
-	void add_device(shared_ptr<devices::BaseDevice> device);
+	/**
+	 * Add a device to the session. The device is journaled, unless journal
+	 * is false.
+	 */
+	void add_device(shared_ptr<devices::BaseDevice> device,
+		bool journal = true);
 	shared_ptr<devices::UserDevice> add_user_device();
+	/**
+	 * Load a recorded session and add a replay device for it. The format is
+	 * the name of a libsigrok input format, or empty to detect the format
+	 * from the file extension. Throws a QString on error.
+	 */
+	shared_ptr<devices::ReplayDevice> add_replay_device(
+		const string &file_name, const string &format);
 	void remove_device(shared_ptr<devices::BaseDevice> device);
 
-	void load_init_file(const string &file_name, const string &format);
-
+	/**
+	 * Import a SmuView CSV file or a file in a libsigrok input format into
+	 * a new virtual user device. The device is added to the session, the
+	 * import is started with FileImporter::start(). Throws a QString on
+	 * error.
+	 */
+	shared_ptr<FileImporter> import_file(
+		const string &file_name, const string &format);
+
+	/**
+	 * Enable the session journal and limit its size in bytes. The journal is
+	 * disabled, if max_size is 0 (default). Must be called before
+	 * init_journal().
+	 */
+	void set_journal_max_size(uint64_t max_size);
+	/** Return true, if the session journal is enabled. */
+	bool is_journal_enabled() const;
+	/** Return true, if a journal of a crashed session exists. */
+	bool has_recoverable_journal() const;
+	/**
+	 * Start the session journal, if it is enabled. If recover is true, the devices of a crashed
+	 * session are rebuilt from the old journal as user devices, otherwise the
+	 * old journal is kept aside. Return the recovered devices.
+	 */
+	list<shared_ptr<devices::BaseDevice>> init_journal(bool recover);
+
+	/**
+	 * Start the stream server, that publishes the samples to local clients.
+	 * The address is a TCP port or the name of a local socket.
+	 */
+	bool start_stream_server(const QString &address);
+	void stop_stream_server();
+	/** The stream server. nullptr, when it hasn't been started. */
+	shared_ptr<server::StreamServer> stream_server() const;
+	/**
+	 * Start the SCPI server, that gives local clients access to the devices.
+	 * The address is a TCP port or the name of a local socket.
+	 */
+	bool start_scpi_server(const QString &address);
+	void stop_scpi_server();
+	/** The SCPI server. nullptr, when it hasn't been started. */
+	shared_ptr<server::ScpiServer> scpi_server() const;
+
+	/** The main window. nullptr in headless mode. */
 	MainWindow *main_window() const;
 
 private:
@@ -87,11 +172,20 @@ private:
 	map<string, shared_ptr<devices::BaseDevice>> devices_;
 	MainWindow *main_window_;
 	shared_ptr<python::SmuScriptRunner> smu_script_runner_;
+	shared_ptr<ui::widgets::plot::PlotScheduler> plot_scheduler_;
+	shared_ptr<ui::widgets::DisplayScheduler> display_scheduler_;
+	shared_ptr<EventLoopMonitor> event_loop_monitor_;
+	shared_ptr<SessionJournal> journal_;
+	uint64_t journal_max_size_;
+	shared_ptr<server::StreamServer> stream_server_;
+	shared_ptr<server::ScpiServer> scpi_server_;
 
 	void free_unused_memory();
 
 private Q_SLOTS:
 	void error_handler(const std::string &sender, const std::string &msg);
+	void on_displays_updated(
+		const set<shared_ptr<sv::data::AnalogTimeSignal>> &signals);
 
 Q_SIGNALS:
 	void device_added(shared_ptr<sv::devices::BaseDevice>);
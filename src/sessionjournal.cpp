@@ -0,0 +1,566 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+
+#include "sessionjournal.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/signalrecorder.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::list;
+using std::lock_guard;
+using std::make_pair;
+using std::make_shared;
+using std::map;
+using std::pair;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+
+namespace {
+
+const char structure_file_name[] = "session.journal";
+const char samples_base_name[] = "samples";
+const char binary_magic[] = "SVREC001";
+const size_t record_size = sizeof(uint32_t) + 2 * sizeof(double);
+
+/** Rotate the sample segments at 64 MiB, so a segment can be mapped. */
+const uint64_t segment_size = 64 * 1024 * 1024;
+/** The smallest segment size, for small journal size limits. */
+const uint64_t min_segment_size = 1024 * 1024;
+
+/** The number of journals of crashed sessions, that are kept. */
+const int max_old_journals = 3;
+
+}
+
+SessionJournal::SessionJournal(const QString &journal_path) :
+	journal_path_(journal_path),
+	structure_file_(nullptr),
+	max_size_(0),
+	rotation_size_(segment_size)
+{
+}
+
+SessionJournal::~SessionJournal()
+{
+	// Only a clean close() removes the journal. If the journal is still open
+	// here, keep it, so it can be recovered.
+	if (recorder_)
+		recorder_->stop();
+	if (structure_file_)
+		fclose(structure_file_);
+}
+
+QString SessionJournal::default_journal_path()
+{
+	return QStandardPaths::writableLocation(
+		QStandardPaths::AppDataLocation) + "/journal";
+}
+
+bool SessionJournal::has_recoverable_journal() const
+{
+	lock_guard<mutex> lock(mutex_);
+	if (structure_file_)
+		return false;
+	// The journal of another running instance is not crashed.
+	if (!lock_journal())
+		return false;
+	return QFileInfo::exists(journal_path_ + "/" + structure_file_name);
+}
+
+void SessionJournal::set_max_size(uint64_t max_size)
+{
+	lock_guard<mutex> lock(mutex_);
+	max_size_ = max_size;
+}
+
+bool SessionJournal::open(QString &old_journal_path)
+{
+	lock_guard<mutex> lock(mutex_);
+	if (structure_file_)
+		return true;
+
+	old_journal_path.clear();
+	if (!lock_journal()) {
+		qWarning() << "SessionJournal: The journal is used by another instance,"
+			<< "this session is not journaled";
+		return false;
+	}
+	QDir dir(journal_path_);
+	if (dir.exists()) {
+		// The journal of a crashed session (or an empty left over).
+		if (QFileInfo::exists(journal_path_ + "/" + structure_file_name)) {
+			old_journal_path = QString("%1-%2").arg(journal_path_).
+				arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+			if (!QDir().rename(journal_path_, old_journal_path)) {
+				qWarning() << "SessionJournal: Could not move old journal" <<
+					journal_path_;
+				old_journal_path.clear();
+				return false;
+			}
+			remove_old_journals();
+		}
+		else {
+			dir.removeRecursively();
+		}
+	}
+	if (!QDir().mkpath(journal_path_)) {
+		qWarning() << "SessionJournal: Could not create journal" <<
+			journal_path_;
+		return false;
+	}
+
+	const QString file_name = journal_path_ + "/" + structure_file_name;
+	structure_file_ = fopen(file_name.toLocal8Bit().constData(), "w");
+	if (!structure_file_) {
+		qWarning() << "SessionJournal: Could not open file" << file_name;
+		return false;
+	}
+
+	const string samples_file_name =
+		(journal_path_ + "/" + samples_base_name).toStdString();
+	recorder_ = make_shared<data::SignalRecorder>(
+		samples_file_name, data::RecorderFormat::Binary);
+	// At least a few segments must fit into the size limit, otherwise
+	// deleting the oldest segment deletes most of the journal.
+	rotation_size_ = segment_size;
+	if (max_size_ > 0)
+		rotation_size_ = std::min(rotation_size_,
+			std::max(max_size_ / 4, min_segment_size));
+	recorder_->set_rotation_size(rotation_size_);
+	recorder_->set_sync_interval(1.);
+	{
+		lock_guard<mutex> segments_lock(segments_mutex_);
+		segments_.clear();
+	}
+	// The recorder opens the segments in the writer thread (or in start()).
+	connect(recorder_.get(), &data::SignalRecorder::file_opened,
+		this, [this](const QString &file_name) {
+			on_segment_opened(file_name);
+		}, Qt::DirectConnection);
+
+	return true;
+}
+
+void SessionJournal::close()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		if (!structure_file_)
+			return;
+		fclose(structure_file_);
+		structure_file_ = nullptr;
+		journaled_channels_.clear();
+		signal_indices_.clear();
+	}
+	// Stop the recorder outside the lock, the signal handlers (DirectConnection)
+	// may be waiting for it.
+	if (recorder_) {
+		recorder_->stop();
+		recorder_.reset();
+	}
+
+	remove(journal_path_);
+
+	lock_guard<mutex> lock(mutex_);
+	lock_file_.reset();
+}
+
+bool SessionJournal::is_open() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return structure_file_ != nullptr;
+}
+
+bool SessionJournal::remove(const QString &journal_path)
+{
+	if (journal_path.isEmpty())
+		return true;
+	return QDir(journal_path).removeRecursively();
+}
+
+void SessionJournal::add_device(shared_ptr<devices::BaseDevice> device)
+{
+	if (!device || !is_open())
+		return;
+
+	const string device_id = device->id();
+	QJsonObject entry;
+	entry["entry"] = "device";
+	entry["id"] = QString::fromStdString(device_id);
+	entry["name"] = device->full_name();
+	write_entry(entry);
+
+	// The channels (and signals) of hardware devices can be added from the
+	// aquisition thread.
+	connect(device.get(), &devices::BaseDevice::channel_added,
+		this, [this, device_id](shared_ptr<channels::BaseChannel> channel) {
+			add_channel(device_id, channel);
+		}, Qt::DirectConnection);
+
+	for (const auto &channel_pair : device->channel_map())
+		add_channel(device_id, channel_pair.second);
+}
+
+void SessionJournal::add_channel(const string &device_id,
+	shared_ptr<channels::BaseChannel> channel)
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		// A channel can be added to multiple channel groups.
+		if (!structure_file_ || !journaled_channels_.insert(channel.get()).second)
+			return;
+	}
+
+	const set<string> channel_group_names = channel->channel_group_names();
+	QJsonObject entry;
+	entry["entry"] = "channel";
+	entry["device"] = QString::fromStdString(device_id);
+	entry["channel"] = QString::fromStdString(channel->name());
+	entry["group"] = channel_group_names.empty() ? QString() :
+		QString::fromStdString(*channel_group_names.begin());
+	write_entry(entry);
+
+	const string channel_name = channel->name();
+	connect(channel.get(), &channels::BaseChannel::signal_added,
+		this, [this, device_id, channel_name](shared_ptr<data::BaseSignal> signal) {
+			add_signal(device_id, channel_name, signal);
+		}, Qt::DirectConnection);
+
+	for (const auto &signal : channel->signals())
+		add_signal(device_id, channel_name, signal);
+}
+
+void SessionJournal::add_signal(const string &device_id,
+	const string &channel_name, shared_ptr<data::BaseSignal> signal)
+{
+	auto a_signal = dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+	if (!a_signal)
+		return;
+
+	QJsonArray flags;
+	for (const auto &flag : a_signal->quantity_flags())
+		flags.append((int)flag);
+	QJsonObject entry;
+	entry["entry"] = "signal";
+	entry["device"] = QString::fromStdString(device_id);
+	entry["channel"] = QString::fromStdString(channel_name);
+	entry["quantity"] = (int)a_signal->quantity();
+	entry["flags"] = flags;
+	entry["unit"] = (int)a_signal->unit();
+	entry["digits"] = a_signal->digits();
+	entry["decimal_places"] = a_signal->decimal_places();
+
+	// The index in the journal must be the index the recorder assigns, so
+	// both are done in one critical section.
+	lock_guard<mutex> lock(mutex_);
+	if (!structure_file_ || signal_indices_.count(a_signal.get()) > 0)
+		return;
+	// The recorder numbers the signals in the order they are added.
+	const uint32_t index = (uint32_t)recorder_->signals().size();
+	signal_indices_.insert(make_pair(a_signal.get(), index));
+	entry["index"] = (int)index;
+	// The structure must be on disk before the first sample of the signal.
+	write_entry_locked(entry);
+	recorder_->add_signal(a_signal);
+	if (!recorder_->is_running())
+		recorder_->start();
+}
+
+void SessionJournal::write_entry(const QJsonObject &entry)
+{
+	lock_guard<mutex> lock(mutex_);
+	write_entry_locked(entry);
+}
+
+void SessionJournal::write_entry_locked(const QJsonObject &entry)
+{
+	const QByteArray line =
+		QJsonDocument(entry).toJson(QJsonDocument::Compact) + "\n";
+
+	if (!structure_file_)
+		return;
+	if (fwrite(line.constData(), 1, line.size(), structure_file_) !=
+			(size_t)line.size()) {
+		qWarning() << "SessionJournal: Could not write journal entry";
+		return;
+	}
+	fflush(structure_file_);
+#ifdef _WIN32
+	_commit(_fileno(structure_file_));
+#else
+	fsync(fileno(structure_file_));
+#endif
+}
+
+list<shared_ptr<devices::BaseDevice>> SessionJournal::recover(
+	Session &session, const QString &old_journal_path)
+{
+	list<shared_ptr<devices::BaseDevice>> recovered_devices;
+
+	QFile structure_file(old_journal_path + "/" + structure_file_name);
+	if (!structure_file.open(QIODevice::ReadOnly)) {
+		qWarning() << "SessionJournal: Could not open journal" <<
+			structure_file.fileName();
+		return recovered_devices;
+	}
+
+	struct RecoveredSignal {
+		shared_ptr<data::AnalogTimeSignal> signal;
+		int digits;
+		int decimal_places;
+		/** The samples of the current segment, pushed in one block. */
+		vector<double> timestamps;
+		vector<double> values;
+	};
+
+	map<QString, shared_ptr<devices::UserDevice>> devices;
+	map<pair<QString, QString>, shared_ptr<channels::BaseChannel>> channels;
+	map<uint32_t, RecoveredSignal> signals;
+
+	while (!structure_file.atEnd()) {
+		// The last line may be incomplete, if the session has crashed while
+		// writing it. Broken lines are skipped.
+		const QJsonObject entry =
+			QJsonDocument::fromJson(structure_file.readLine()).object();
+		const QString type = entry["entry"].toString();
+		const QString device_id = entry["device"].toString();
+		const QString channel_name = entry["channel"].toString();
+
+		if (type == "device") {
+			const QString id = entry["id"].toString();
+			if (id.isEmpty() || devices.count(id) > 0)
+				continue;
+			auto device = make_shared<devices::UserDevice>(Session::sr_context,
+				entry["name"].toString().toStdString(), "(recovered)", "");
+			session.add_device(device);
+			devices.insert(make_pair(id, device));
+			recovered_devices.push_back(device);
+		}
+		else if (type == "channel") {
+			if (devices.count(device_id) == 0 ||
+					channels.count(make_pair(device_id, channel_name)) > 0)
+				continue;
+			auto channel = devices[device_id]->add_user_channel(
+				channel_name.toStdString(),
+				entry["group"].toString().toStdString());
+			channels.insert(make_pair(make_pair(device_id, channel_name),
+				channel));
+		}
+		else if (type == "signal") {
+			const auto channel_key = make_pair(device_id, channel_name);
+			const uint32_t index = (uint32_t)entry["index"].toInt(-1);
+			if (channels.count(channel_key) == 0 || signals.count(index) > 0)
+				continue;
+
+			set<data::QuantityFlag> flags;
+			for (const auto &flag : entry["flags"].toArray())
+				flags.insert((data::QuantityFlag)flag.toInt());
+			auto signal = dynamic_pointer_cast<data::AnalogTimeSignal>(
+				channels[channel_key]->add_signal(
+					(data::Quantity)entry["quantity"].toInt(), flags,
+					(data::Unit)entry["unit"].toInt()));
+			if (!signal)
+				continue;
+			RecoveredSignal recovered_signal;
+			recovered_signal.signal = signal;
+			recovered_signal.digits = entry["digits"].toInt();
+			recovered_signal.decimal_places = entry["decimal_places"].toInt();
+			signals.insert(make_pair(index, recovered_signal));
+		}
+	}
+
+	// Read the sample segments in the order they have been written.
+	QStringList segment_names = QDir(old_journal_path).entryList(
+		QStringList() << QString("%1_*.svrec").arg(samples_base_name),
+		QDir::Files, QDir::Name);
+	uint64_t sample_count = 0;
+	for (const auto &segment_name : segment_names) {
+		QFile segment(old_journal_path + "/" + segment_name);
+		if (!segment.open(QIODevice::ReadOnly) || segment.size() == 0)
+			continue;
+		const qint64 size = segment.size();
+		uchar *data = segment.map(0, size);
+		if (!data) {
+			qWarning() << "SessionJournal: Could not map segment" <<
+				segment.fileName();
+			continue;
+		}
+
+		// Skip the header: magic, signal count and the signal names/units.
+		const size_t magic_size = sizeof(binary_magic) - 1;
+		qint64 pos = magic_size + sizeof(uint32_t);
+		if (size < pos || memcmp(data, binary_magic, magic_size) != 0) {
+			qWarning() << "SessionJournal: Invalid segment" << segment.fileName();
+			segment.unmap(data);
+			continue;
+		}
+		uint32_t signal_count;
+		memcpy(&signal_count, data + magic_size, sizeof(signal_count));
+		for (uint32_t i = 0; i < 2 * signal_count && pos >= 0; ++i) {
+			uint32_t length;
+			if (pos + (qint64)sizeof(length) > size) {
+				pos = -1;
+				break;
+			}
+			memcpy(&length, data + pos, sizeof(length));
+			pos += sizeof(length) + length;
+		}
+		if (pos < 0 || pos > size) {
+			segment.unmap(data);
+			continue;
+		}
+
+		// A partly written record at the end is ignored.
+		for (; pos + (qint64)record_size <= size; pos += record_size) {
+			uint32_t index;
+			double timestamp;
+			double value;
+			memcpy(&index, data + pos, sizeof(index));
+			memcpy(&timestamp, data + pos + sizeof(index), sizeof(timestamp));
+			memcpy(&value, data + pos + sizeof(index) + sizeof(timestamp),
+				sizeof(value));
+
+			const auto it = signals.find(index);
+			if (it == signals.end())
+				continue;
+			it->second.timestamps.push_back(timestamp);
+			it->second.values.push_back(value);
+			++sample_count;
+		}
+		segment.unmap(data);
+
+		// Push the samples of the segment in one block per signal, so the
+		// views and the new journal are only notified once.
+		for (auto &signal_pair : signals) {
+			RecoveredSignal &recovered_signal = signal_pair.second;
+			if (recovered_signal.timestamps.empty())
+				continue;
+			recovered_signal.signal->push_samples(
+				recovered_signal.timestamps.data(),
+				recovered_signal.values.data(),
+				recovered_signal.timestamps.size(),
+				recovered_signal.digits, recovered_signal.decimal_places);
+			recovered_signal.timestamps.clear();
+			recovered_signal.values.clear();
+		}
+	}
+
+	qWarning() << "SessionJournal: Recovered" << recovered_devices.size() <<
+		"devices," << signals.size() << "signals and" << sample_count <<
+		"samples from" << old_journal_path;
+
+	return recovered_devices;
+}
+
+void SessionJournal::on_segment_opened(const QString &file_name)
+{
+	lock_guard<mutex> lock(segments_mutex_);
+	segments_.push_back(file_name);
+	if (max_size_ == 0)
+		return;
+
+	// The closed segments have their final size, the new segment can grow
+	// up to the rotation size.
+	uint64_t size = rotation_size_;
+	for (const auto &segment : segments_)
+		size += QFileInfo(segment).size();
+	while (size > max_size_ && segments_.size() > 1) {
+		const QString &segment = segments_.front();
+		size -= std::min<uint64_t>(size, QFileInfo(segment).size());
+		if (!QFile::remove(segment))
+			qWarning() << "SessionJournal: Could not remove segment" << segment;
+		segments_.pop_front();
+	}
+}
+
+bool SessionJournal::lock_journal() const
+{
+	if (lock_file_)
+		return true;
+
+	QDir().mkpath(QFileInfo(journal_path_).absolutePath());
+	unique_ptr<QLockFile> lock_file(new QLockFile(journal_path_ + ".lock"));
+	// The lock is held for the whole session, so it only becomes stale when
+	// the owning process is gone (crashed).
+	lock_file->setStaleLockTime(0);
+	if (!lock_file->tryLock(0))
+		return false;
+	lock_file_ = std::move(lock_file);
+	return true;
+}
+
+void SessionJournal::remove_old_journals() const
+{
+	// The old journals are named <journal path>-yyyyMMdd-hhmmss, so the
+	// oldest journals come first.
+	const QFileInfo journal_info(journal_path_);
+	QDir parent_dir(journal_info.absolutePath());
+	QStringList old_journals = parent_dir.entryList(
+		QStringList() << journal_info.fileName() + "-*",
+		QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+	while (old_journals.size() > max_old_journals) {
+		const QString old_journal = parent_dir.filePath(old_journals.takeFirst());
+		qWarning() << "SessionJournal: Removing old journal" << old_journal;
+		remove(old_journal);
+	}
+}
+
+} // namespace sv
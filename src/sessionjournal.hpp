@@ -0,0 +1,154 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SESSIONJOURNAL_HPP
+#define SESSIONJOURNAL_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <QJsonObject>
+#include <QLockFile>
+#include <QObject>
+#include <QString>
+
+using std::list;
+using std::map;
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+
+namespace sv {
+
+class Session;
+
+namespace channels {
+class BaseChannel;
+}
+
+namespace data {
+class BaseSignal;
+class SignalRecorder;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+/**
+ * The SessionJournal is a write-ahead journal of the session. The structure
+ * (devices, channels and signals) is appended to a line based JSON file and
+ * synced on every change; the samples of all signals are appended to binary
+ * segment files by a SignalRecorder.
+ *
+ * The journal is removed when the session is closed cleanly. A journal that
+ * still exists at startup belongs to a crashed session and can be recovered
+ * into user devices. The journal directory is locked, so only one running
+ * instance uses it; other instances are not journaled.
+ */
+class SessionJournal : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit SessionJournal(const QString &journal_path);
+	~SessionJournal();
+
+	/** The journal directory in the application data location. */
+	static QString default_journal_path();
+
+	/** Return true, if a journal of a crashed session exists. */
+	bool has_recoverable_journal() const;
+
+	/**
+	 * Limit the total size of the sample segments in bytes. When the limit
+	 * is exceeded, the oldest segments are deleted. Must be called before
+	 * open().
+	 */
+	void set_max_size(uint64_t max_size);
+
+	/**
+	 * Start a new journal. An existing journal of a crashed session is moved
+	 * to old_journal_path, so it is never overwritten.
+	 */
+	bool open(QString &old_journal_path);
+	/** Close the journal and remove it (clean shutdown). */
+	void close();
+	bool is_open() const;
+
+	/**
+	 * Rebuild the devices, channels and signals of an old journal as user
+	 * devices in the session and fill them with the journaled samples.
+	 */
+	list<shared_ptr<devices::BaseDevice>> recover(Session &session,
+		const QString &old_journal_path);
+	/** Remove an (old) journal directory. */
+	static bool remove(const QString &journal_path);
+
+	/**
+	 * Journal the device with all its channels and signals. Channels and
+	 * signals that are added later are journaled as well.
+	 */
+	void add_device(shared_ptr<devices::BaseDevice> device);
+
+private:
+	void add_channel(const string &device_id,
+		shared_ptr<channels::BaseChannel> channel);
+	void add_signal(const string &device_id, const string &channel_name,
+		shared_ptr<data::BaseSignal> signal);
+	void write_entry(const QJsonObject &entry);
+	/** Write an entry to the structure file. mutex_ must be held. */
+	void write_entry_locked(const QJsonObject &entry);
+	/** Delete the oldest segments, if the size limit is exceeded. */
+	void on_segment_opened(const QString &file_name);
+	/** Delete the oldest journals of crashed sessions, that were kept. */
+	void remove_old_journals() const;
+	/**
+	 * Lock the journal directory. Return false, if the journal is used by
+	 * another running instance. mutex_ must be held.
+	 */
+	bool lock_journal() const;
+
+	QString journal_path_;
+	mutable mutex mutex_;
+	mutable unique_ptr<QLockFile> lock_file_;
+	FILE *structure_file_;
+	shared_ptr<data::SignalRecorder> recorder_;
+	set<channels::BaseChannel *> journaled_channels_;
+	map<data::BaseSignal *, uint32_t> signal_indices_;
+
+	uint64_t max_size_;
+	uint64_t rotation_size_;
+	/** The segments of the journal, oldest first. */
+	mutex segments_mutex_;
+	list<QString> segments_;
+
+};
+
+} // namespace sv
+
+#endif // SESSIONJOURNAL_HPP
@@ -0,0 +1,254 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "tracer.hpp"
+
+using std::list;
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::ofstream;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+namespace {
+
+struct TraceEvent {
+	const char *category;
+	const char *name;
+	int64_t start_time;
+	int64_t end_time;
+};
+
+struct ThreadBuffer {
+	mutex buffer_mutex;
+	vector<TraceEvent> events;
+	size_t next;
+	bool wrapped;
+	uint32_t thread_id;
+	string thread_name;
+	bool finished;
+};
+
+/** Keep the buffers of at most this many finished threads. */
+const size_t max_finished_buffers = 32;
+
+mutex registry_mutex;
+list<shared_ptr<ThreadBuffer>> buffers;
+std::atomic<size_t> buffer_size(Tracer::default_buffer_size);
+uint32_t next_thread_id = 1;
+
+/** Marks the buffer as finished, when the thread exits. */
+struct ThreadBufferHolder {
+	shared_ptr<ThreadBuffer> buffer;
+
+	~ThreadBufferHolder()
+	{
+		if (!buffer)
+			return;
+		lock_guard<mutex> lock(registry_mutex);
+		buffer->finished = true;
+	}
+};
+
+thread_local ThreadBufferHolder thread_buffer;
+
+void clear_buffer(ThreadBuffer &buffer)
+{
+	// The memory is allocated again with the first new event.
+	lock_guard<mutex> lock(buffer.buffer_mutex);
+	vector<TraceEvent>().swap(buffer.events);
+	buffer.next = 0;
+	buffer.wrapped = false;
+}
+
+ThreadBuffer &get_thread_buffer()
+{
+	if (thread_buffer.buffer)
+		return *thread_buffer.buffer;
+
+	auto buffer = make_shared<ThreadBuffer>();
+	buffer->next = 0;
+	buffer->wrapped = false;
+	buffer->finished = false;
+
+	lock_guard<mutex> lock(registry_mutex);
+	buffer->thread_id = next_thread_id++;
+	buffer->thread_name = "Thread " + std::to_string(buffer->thread_id);
+
+	// Drop the buffers of the oldest finished threads.
+	size_t finished_count = 0;
+	for (const auto &b : buffers) {
+		if (b->finished)
+			++finished_count;
+	}
+	for (auto it = buffers.begin();
+			it != buffers.end() && finished_count >= max_finished_buffers; ) {
+		if ((*it)->finished) {
+			it = buffers.erase(it);
+			--finished_count;
+		}
+		else
+			++it;
+	}
+	buffers.push_back(buffer);
+
+	thread_buffer.buffer = buffer;
+	return *buffer;
+}
+
+string escape_json(const string &str)
+{
+	string escaped;
+	for (const char c : str) {
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		if ((unsigned char)c < 0x20)
+			continue;
+		escaped += c;
+	}
+	return escaped;
+}
+
+} // namespace
+
+const size_t Tracer::default_buffer_size;
+std::atomic<bool> Tracer::enabled_(false);
+
+void Tracer::start(size_t size)
+{
+	buffer_size = size > 0 ? size : default_buffer_size;
+	clear();
+	enabled_ = true;
+}
+
+void Tracer::stop()
+{
+	enabled_ = false;
+}
+
+void Tracer::clear()
+{
+	lock_guard<mutex> lock(registry_mutex);
+	for (const auto &buffer : buffers)
+		clear_buffer(*buffer);
+}
+
+void Tracer::set_thread_name(const string &name)
+{
+	ThreadBuffer &buffer = get_thread_buffer();
+	lock_guard<mutex> lock(registry_mutex);
+	buffer.thread_name = name;
+}
+
+void Tracer::add_event(const char *category, const char *name,
+	int64_t start_time, int64_t end_time)
+{
+	ThreadBuffer &buffer = get_thread_buffer();
+	lock_guard<mutex> lock(buffer.buffer_mutex);
+	if (buffer.events.empty())
+		buffer.events.resize(buffer_size);
+
+	TraceEvent &event = buffer.events[buffer.next];
+	event.category = category;
+	event.name = name;
+	event.start_time = start_time;
+	event.end_time = end_time;
+	if (++buffer.next >= buffer.events.size()) {
+		buffer.next = 0;
+		buffer.wrapped = true;
+	}
+}
+
+bool Tracer::write_json(const string &file_name)
+{
+	ofstream output_file(file_name);
+	if (!output_file.is_open()) {
+		qWarning() << "Tracer::write_json(): Can't open file" <<
+			QString::fromStdString(file_name);
+		return false;
+	}
+
+	list<shared_ptr<ThreadBuffer>> trace_buffers;
+	{
+		lock_guard<mutex> lock(registry_mutex);
+		trace_buffers = buffers;
+	}
+
+	// The timestamps in the Chrome trace event format are in µs.
+	char ts[64];
+	output_file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	for (const auto &buffer : trace_buffers) {
+		vector<TraceEvent> events;
+		string thread_name;
+		{
+			lock_guard<mutex> lock(buffer->buffer_mutex);
+			// Oldest events first.
+			if (buffer->wrapped) {
+				events.insert(events.end(),
+					buffer->events.begin() + buffer->next, buffer->events.end());
+			}
+			events.insert(events.end(), buffer->events.begin(),
+				buffer->events.begin() + buffer->next);
+		}
+		{
+			lock_guard<mutex> lock(registry_mutex);
+			thread_name = buffer->thread_name;
+		}
+
+		if (!first)
+			output_file << ",";
+		first = false;
+		output_file << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1," <<
+			"\"tid\":" << buffer->thread_id << ",\"args\":{\"name\":\"" <<
+			escape_json(thread_name) << "\"}}";
+
+		for (const auto &event : events) {
+			snprintf(ts, sizeof(ts), "\"ts\":%.3f,\"dur\":%.3f",
+				event.start_time / 1000., (event.end_time - event.start_time) / 1000.);
+			output_file << ",\n{\"name\":\"" << escape_json(event.name) <<
+				"\",\"cat\":\"" << escape_json(event.category) <<
+				"\",\"ph\":\"X\"," << ts << ",\"pid\":1,\"tid\":" <<
+				buffer->thread_id << "}";
+		}
+	}
+	output_file << "\n]}\n";
+	output_file.close();
+
+	return !output_file.fail();
+}
+
+} // namespace sv
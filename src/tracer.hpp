@@ -0,0 +1,127 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+using std::string;
+
+namespace sv {
+
+/**
+ * The Tracer records the duration of scopes (trace events) into per thread
+ * ring buffers. Recording an event only locks the (uncontended) mutex of the
+ * buffer of the own thread, when tracing is disabled, a trace scope costs a
+ * single atomic load. The recorded events can be written to a file in the
+ * Chrome trace event format, that can be opened in chrome://tracing or
+ * https://ui.perfetto.dev.
+ *
+ * The category and name of an event must be string literals (or strings
+ * with static storage duration), only the pointers are stored.
+ */
+class Tracer
+{
+
+public:
+	/**
+	 * Clear all recorded events and start tracing. Each thread records
+	 * the last buffer_size events.
+	 */
+	static void start(size_t buffer_size = default_buffer_size);
+	static void stop();
+	static bool is_enabled()
+	{
+		return enabled_.load(std::memory_order_relaxed);
+	}
+	static void clear();
+
+	/** Set the name of the calling thread, shown in the trace viewer. */
+	static void set_thread_name(const string &name);
+
+	/** Write all recorded events to a Chrome trace event JSON file. */
+	static bool write_json(const string &file_name);
+
+	/** Timestamp for trace events in ns. */
+	static int64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/** Record an event of the calling thread. */
+	static void add_event(const char *category, const char *name,
+		int64_t start_time, int64_t end_time);
+
+	static const size_t default_buffer_size = 65536;
+
+private:
+	static std::atomic<bool> enabled_;
+
+};
+
+/**
+ * Records a trace event for the lifetime of the object, if tracing was
+ * enabled at construction.
+ */
+class TraceScope
+{
+
+public:
+	TraceScope(const char *category, const char *name) :
+		category_(category),
+		name_(name),
+		start_time_(Tracer::is_enabled() ? Tracer::now() : -1)
+	{
+	}
+
+	~TraceScope()
+	{
+		if (start_time_ >= 0)
+			Tracer::add_event(category_, name_, start_time_, Tracer::now());
+	}
+
+	TraceScope(const TraceScope &) = delete;
+	TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+	const char *category_;
+	const char *name_;
+	const int64_t start_time_;
+
+};
+
+} // namespace sv
+
+#define SV_TRACE_CONCAT_INNER(a, b) a##b
+#define SV_TRACE_CONCAT(a, b) SV_TRACE_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_TRACING
+/** Trace the enclosing scope. */
+#define SV_TRACE_SCOPE(category, name) \
+	sv::TraceScope SV_TRACE_CONCAT(sv_trace_scope_, __LINE__)(category, name)
+#else
+#define SV_TRACE_SCOPE(category, name) do {} while (0)
+#endif
+
+#endif // TRACER_HPP
@@ -29,6 +29,7 @@
 #include "src/ui/datatypes/doublespinbox.hpp"
 #include "src/ui/datatypes/int32spinbox.hpp"
 #include "src/ui/datatypes/measuredquantitycombobox.hpp"
+#include "src/ui/datatypes/propertytooltipfilter.hpp"
 #include "src/ui/datatypes/rationalcombobox.hpp"
 #include "src/ui/datatypes/stringcombobox.hpp"
 #include "src/ui/datatypes/uint64combobox.hpp"
@@ -43,7 +44,7 @@ namespace ui {
 namespace datatypes {
 namespace datatypehelper {
 
-QWidget *get_widget_for_property(
+static QWidget *create_widget_for_property(
 	shared_ptr<sv::data::properties::BaseProperty> property,
 	bool auto_commit, bool auto_update)
 {
@@ -95,6 +96,17 @@ QWidget *get_widget_for_property(
 	return NULL;
 }
 
+QWidget *get_widget_for_property(
+	shared_ptr<sv::data::properties::BaseProperty> property,
+	bool auto_commit, bool auto_update)
+{
+	QWidget *widget =
+		create_widget_for_property(property, auto_commit, auto_update);
+	if (widget)
+		widget->installEventFilter(new PropertyToolTipFilter(property, widget));
+	return widget;
+}
+
 } // namespace datatypehelper
 } // namespace datatypes
 } // namespace ui
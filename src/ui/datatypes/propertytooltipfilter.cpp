@@ -0,0 +1,71 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <QEvent>
+#include <QHelpEvent>
+#include <QString>
+#include <QToolTip>
+#include <QWidget>
+
+#include "propertytooltipfilter.hpp"
+#include "src/data/properties/baseproperty.hpp"
+
+namespace sv {
+namespace ui {
+namespace datatypes {
+
+PropertyToolTipFilter::PropertyToolTipFilter(
+		shared_ptr<sv::data::properties::BaseProperty> property,
+		QObject *parent) :
+	QObject(parent),
+	property_(property)
+{
+}
+
+bool PropertyToolTipFilter::eventFilter(QObject *object, QEvent *event)
+{
+	if (event->type() != QEvent::ToolTip)
+		return QObject::eventFilter(object, event);
+
+	QString tool_tip = property_->display_name();
+	double cache_age = property_->cache_age();
+	if (cache_age < 0) {
+		tool_tip.append("\n").append(tr("Not read yet"));
+	}
+	else {
+		tool_tip.append(": ").append(property_->to_string());
+		tool_tip.append("\n").append(
+			tr("Updated %1 s ago").arg(cache_age, 0, 'f', 1));
+	}
+	if (property_->poll_interval() > 0) {
+		tool_tip.append("\n").append(
+			tr("Polled every %1 s").arg(property_->poll_interval()));
+	}
+
+	QHelpEvent *help_event = static_cast<QHelpEvent *>(event);
+	QToolTip::showText(help_event->globalPos(), tool_tip,
+		qobject_cast<QWidget *>(object));
+	return true;
+}
+
+} // namespace datatypes
+} // namespace ui
+} // namespace sv
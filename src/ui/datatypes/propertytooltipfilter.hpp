@@ -0,0 +1,66 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_DATATYPES_PROPERTYTOOLTIPFILTER_HPP
+#define UI_DATATYPES_PROPERTYTOOLTIPFILTER_HPP
+
+#include <memory>
+
+#include <QEvent>
+#include <QObject>
+
+using std::shared_ptr;
+
+namespace sv {
+
+namespace data {
+namespace properties {
+class BaseProperty;
+}
+}
+
+namespace ui {
+namespace datatypes {
+
+/**
+ * Event filter that shows the cached value of a property and the age of the
+ * cached value as tool tip of a widget.
+ */
+class PropertyToolTipFilter : public QObject
+{
+	Q_OBJECT
+
+public:
+	PropertyToolTipFilter(
+		shared_ptr<sv::data::properties::BaseProperty> property,
+		QObject *parent);
+
+protected:
+	bool eventFilter(QObject *object, QEvent *event) override;
+
+private:
+	shared_ptr<sv::data::properties::BaseProperty> property_;
+
+};
+
+} // namespace datatypes
+} // namespace ui
+} // namespace sv
+
+#endif // UI_DATATYPES_PROPERTYTOOLTIPFILTER_HPP
@@ -44,6 +44,7 @@
 #include "src/ui/views/plotview.hpp"
 #include "src/ui/views/powerpanelview.hpp"
 #include "src/ui/views/sequenceoutputview.hpp"
+#include "src/ui/views/sweepview.hpp"
 #include "src/ui/views/valuepanelview.hpp"
 #include "src/ui/views/viewhelper.hpp"
 
@@ -87,6 +88,7 @@ void AddViewDialog::setup_ui()
 	this->setup_ui_xy_plot_tab();
 	this->setup_ui_data_table_tab();
 	this->setup_ui_power_panel_tab();
+	this->setup_ui_sweep_tab();
 	tab_widget_->setCurrentIndex(selected_tab_);
 	main_layout->addWidget(tab_widget_);
 
@@ -228,6 +230,20 @@ void AddViewDialog::setup_ui_power_panel_tab()
 	tab_widget_->addTab(pp_widget, title);
 }
 
+void AddViewDialog::setup_ui_sweep_tab()
+{
+	QString title(tr("Sweep"));
+	QWidget *sweep_widget = new QWidget();
+
+	sweep_property_form_ = new ui::devices::SelectPropertyForm(session_);
+	sweep_property_form_->select_device(device_);
+	sweep_property_form_->filter_config_keys(set<sv::data::DataType>{
+		sv::data::DataType::Double});
+	sweep_widget->setLayout(sweep_property_form_);
+
+	tab_widget_->addTab(sweep_widget, title);
+}
+
 vector<ui::views::BaseView *> AddViewDialog::views()
 {
 	return views_;
@@ -314,6 +330,17 @@ void AddViewDialog::accept()
 			}
 		}
 		break;
+	case 7:
+		// Add sweep view for property
+		{
+			auto property = sweep_property_form_->selected_property();
+			if (property != nullptr) {
+				views_.push_back(new ui::views::SweepView(session_,
+					static_pointer_cast<sv::data::properties::DoubleProperty>(
+						property)));
+			}
+		}
+		break;
 	default:
 		break;
 	}
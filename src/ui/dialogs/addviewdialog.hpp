@@ -74,6 +74,7 @@ private:
 	void setup_ui_xy_plot_tab();
 	void setup_ui_data_table_tab();
 	void setup_ui_power_panel_tab();
+	void setup_ui_sweep_tab();
 
 	Session &session_;
 	const shared_ptr<sv::devices::BaseDevice> device_;
@@ -90,6 +91,7 @@ private:
 	ui::devices::devicetree::DeviceTreeView *data_table_signal_tree_;
 	ui::devices::SelectSignalWidget *ppanel_voltage_signal_widget_;
 	ui::devices::SelectSignalWidget *ppanel_current_signal_widget_;
+	ui::devices::SelectPropertyForm *sweep_property_form_;
 	QDialogButtonBox *button_box_;
 
 public Q_SLOTS:
@@ -27,9 +27,11 @@
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
 
+#include <QApplication>
 #include <QDebug>
 #include <QGroupBox>
 #include <QLabel>
+#include <QMessageBox>
 #include <QRadioButton>
 
 #include "connectdialog.hpp"
@@ -300,6 +302,14 @@ void ConnectDialog::on_scan_pressed()
 
 	assert(driver);
 
+	// A timed out scan of the driver may still be running in the background.
+	if (device_manager_.is_driver_scanning(driver)) {
+		QMessageBox::warning(this, tr("Scan for devices"),
+			tr("A previous scan with this driver is still running. Please try "
+				"again later."));
+		return;
+	}
+
 	map<const ConfigKey *, VariantBase> drvopts;
 
 	if (serial_devices_.isEnabled()) {
@@ -335,9 +345,26 @@ void ConnectDialog::on_scan_pressed()
 			conn.toUtf8().constData());
 	}
 
-	const list<shared_ptr<HardwareDevice>> devices =
-		device_manager_.driver_scan(driver, drvopts);
+	// Scan in a worker thread and keep the dialog responsive. The scan is
+	// abandoned when the dialog is closed or the scan times out.
+	scan_button_.setEnabled(false);
+	device_manager_.parallel_driver_scan(
+		{ sv::driver_scan_request_t(driver, drvopts) },
+		[this](size_t, size_t, shared_ptr<Driver> driver,
+				list<shared_ptr<HardwareDevice>> devices) {
+			if (driver)
+				add_devices(devices);
+			QApplication::processEvents();
+			return isVisible();
+		});
+	scan_button_.setEnabled(true);
 
+	device_list_.setCurrentRow(0);
+	button_box_.button(QDialogButtonBox::Ok)->setDisabled(device_list_.count() == 0);
+}
+
+void ConnectDialog::add_devices(list<shared_ptr<HardwareDevice>> devices)
+{
 	for (const auto &device : devices) {
 		assert(device);
 
@@ -350,9 +377,6 @@ void ConnectDialog::on_scan_pressed()
 		item->setData(Qt::UserRole, qVariantFromValue(device));
 		device_list_.addItem(item);
 	}
-
-	device_list_.setCurrentRow(0);
-	button_box_.button(QDialogButtonBox::Ok)->setDisabled(device_list_.count() == 0);
 }
 
 void ConnectDialog::on_driver_selected(int index)
@@ -21,6 +21,7 @@
 #ifndef UI_DIALOGS_CONNECTDIALOG_HPP
 #define UI_DIALOGS_CONNECTDIALOG_HPP
 
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -42,6 +43,7 @@
 
 #include "src/devices/hardwaredevice.hpp"
 
+using std::list;
 using std::shared_ptr;
 
 namespace sigrok {
@@ -78,6 +80,7 @@ private:
 	void populate_serials_thread_proc(shared_ptr<sigrok::Driver> driver);
 	void check_available_libs();
 	void unset_connection();
+	void add_devices(list<shared_ptr<sv::devices::HardwareDevice>> devices);
 
 private Q_SLOTS:
 	void on_driver_selected(int index);
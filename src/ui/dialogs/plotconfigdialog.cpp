@@ -19,6 +19,7 @@
 
 #include <map>
 
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDebug>
 #include <QDialog>
@@ -26,6 +27,7 @@
 #include <QFormLayout>
 #include <QIcon>
 #include <QLineEdit>
+#include <QSpinBox>
 #include <QString>
 #include <QTabWidget>
 #include <QVariant>
@@ -34,9 +36,12 @@
 
 #include "plotconfigdialog.hpp"
 #include "src/ui/views/plotview.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
 #include "src/ui/widgets/plot/plot.hpp"
+#include "src/ui/widgets/plot/sweeptrigger.hpp"
 
 Q_DECLARE_METATYPE(sv::ui::widgets::plot::PlotUpdateMode)
+Q_DECLARE_METATYPE(sv::ui::widgets::plot::TriggerEdge)
 
 namespace sv {
 namespace ui {
@@ -113,6 +118,48 @@ void PlotConfigDialog::setup_ui_plot_mode_tab()
 	add_time_edit_->setText(QString("%1").arg(plot_->add_time(), 0, 'f'));
 	layout->addRow(tr("Add time"), add_time_edit_);
 
+	trigger_curve_combobox_ = new QComboBox();
+	int curve_index = 0;
+	for (const auto &curve_data : plot_->curve_datas()) {
+		if (curve_data->curve_type() != widgets::plot::CurveType::TimeCurve) {
+			++curve_index;
+			continue;
+		}
+		trigger_curve_combobox_->addItem(curve_data->name(), curve_index);
+		if (curve_data == plot_->trigger_curve())
+			trigger_curve_combobox_->setCurrentIndex(
+				trigger_curve_combobox_->count() - 1);
+		++curve_index;
+	}
+	layout->addRow(tr("Trigger signal"), trigger_curve_combobox_);
+
+	trigger_level_edit_ = new QLineEdit();
+	trigger_level_edit_->setValidator(new QDoubleValidator);
+	trigger_level_edit_->setText(
+		QString("%1").arg(plot_->trigger_level(), 0, 'f'));
+	layout->addRow(tr("Trigger level"), trigger_level_edit_);
+
+	trigger_edge_combobox_ = new QComboBox();
+	for (const auto &edge_pair : widgets::plot::trigger_edge_name_map) {
+		trigger_edge_combobox_->addItem(
+			edge_pair.second, QVariant::fromValue(edge_pair.first));
+		if (plot_->trigger_edge() == edge_pair.first)
+			trigger_edge_combobox_->setCurrentIndex(
+				trigger_edge_combobox_->count() - 1);
+	}
+	layout->addRow(tr("Trigger edge"), trigger_edge_combobox_);
+
+	pre_trigger_spinbox_ = new QSpinBox();
+	pre_trigger_spinbox_->setRange(0, 100);
+	pre_trigger_spinbox_->setSuffix(" %");
+	pre_trigger_spinbox_->setValue((int)(plot_->pre_trigger() * 100 + .5));
+	layout->addRow(tr("Pre trigger"), pre_trigger_spinbox_);
+
+	clear_persistence_checkbox_ = new QCheckBox();
+	clear_persistence_checkbox_->setText(tr("(%1 sweeps)").
+		arg(plot_->sweep_count()));
+	layout->addRow(tr("Clear persistence"), clear_persistence_checkbox_);
+
 	switch (plot_->update_mode()) {
 	case widgets::plot::PlotUpdateMode::Additive:
 		setup_ui_additive();
@@ -123,6 +170,9 @@ void PlotConfigDialog::setup_ui_plot_mode_tab()
 	case widgets::plot::PlotUpdateMode::Oscilloscope:
 		setup_ui_oscilloscope();
 		break;
+	case widgets::plot::PlotUpdateMode::Triggered:
+		setup_ui_triggered();
+		break;
 	}
 
 	widget->setLayout(layout);
@@ -184,18 +234,37 @@ void PlotConfigDialog::setup_ui_additive()
 {
 	time_span_edit_->setDisabled(true);
 	add_time_edit_->setDisabled(false);
+	set_trigger_ui_enabled(false);
 }
 
 void PlotConfigDialog::setup_ui_rolling()
 {
 	time_span_edit_->setDisabled(false);
 	add_time_edit_->setDisabled(false);
+	set_trigger_ui_enabled(false);
 }
 
 void PlotConfigDialog::setup_ui_oscilloscope()
 {
 	time_span_edit_->setDisabled(false);
 	add_time_edit_->setDisabled(true);
+	set_trigger_ui_enabled(false);
+}
+
+void PlotConfigDialog::setup_ui_triggered()
+{
+	time_span_edit_->setDisabled(false);
+	add_time_edit_->setDisabled(true);
+	set_trigger_ui_enabled(true);
+}
+
+void PlotConfigDialog::set_trigger_ui_enabled(bool enabled)
+{
+	trigger_curve_combobox_->setEnabled(enabled);
+	trigger_level_edit_->setEnabled(enabled);
+	trigger_edge_combobox_->setEnabled(enabled);
+	pre_trigger_spinbox_->setEnabled(enabled);
+	clear_persistence_checkbox_->setEnabled(enabled);
 }
 
 void PlotConfigDialog::on_update_mode_changed()
@@ -211,6 +280,9 @@ void PlotConfigDialog::on_update_mode_changed()
 	case widgets::plot::PlotUpdateMode::Oscilloscope:
 		setup_ui_oscilloscope();
 		break;
+	case widgets::plot::PlotUpdateMode::Triggered:
+		setup_ui_triggered();
+		break;
 	}
 }
 
@@ -221,12 +293,26 @@ void PlotConfigDialog::accept()
 		sv::ui::widgets::plot::PlotUpdateMode update_mode =
 			update_mode_var.value<sv::ui::widgets::plot::PlotUpdateMode>();
 		plot_->set_update_mode(update_mode);
+		if (update_mode == widgets::plot::PlotUpdateMode::Triggered) {
+			int curve_index = trigger_curve_combobox_->currentData().toInt();
+			if (trigger_curve_combobox_->currentIndex() >= 0)
+				plot_->set_trigger_curve(plot_->curve_datas()[curve_index]);
+			plot_->set_trigger_level(trigger_level_edit_->text().toDouble());
+			plot_->set_trigger_edge(trigger_edge_combobox_->currentData().
+				value<sv::ui::widgets::plot::TriggerEdge>());
+			plot_->set_pre_trigger(pre_trigger_spinbox_->value() / 100.);
+		}
 		if (update_mode == widgets::plot::PlotUpdateMode::Rolling ||
-				update_mode == widgets::plot::PlotUpdateMode::Oscilloscope)
+				update_mode == widgets::plot::PlotUpdateMode::Oscilloscope ||
+				(update_mode == widgets::plot::PlotUpdateMode::Triggered &&
+				time_span_edit_->text().toDouble() != plot_->time_span()))
 			plot_->set_time_span(time_span_edit_->text().toDouble());
 		if (update_mode == widgets::plot::PlotUpdateMode::Additive ||
 				update_mode == widgets::plot::PlotUpdateMode::Rolling)
 			plot_->set_add_time(add_time_edit_->text().toDouble());
+		if (update_mode == widgets::plot::PlotUpdateMode::Triggered &&
+				clear_persistence_checkbox_->isChecked())
+			plot_->clear_persistence();
 	}
 
 	plot_->set_markers_label_alignment(
@@ -22,10 +22,12 @@
 
 #include <map>
 
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QLineEdit>
+#include <QSpinBox>
 #include <QString>
 #include <QTabWidget>
 #include <QWidget>
@@ -53,6 +55,8 @@ private:
 	void setup_ui_additive();
 	void setup_ui_rolling();
 	void setup_ui_oscilloscope();
+	void setup_ui_triggered();
+	void set_trigger_ui_enabled(bool enabled);
 
 	widgets::plot::Plot *plot_;
 	views::PlotType plot_type_;
@@ -60,6 +64,11 @@ private:
 	QComboBox *plot_update_mode_combobox_;
 	QLineEdit *time_span_edit_;
 	QLineEdit *add_time_edit_;
+	QComboBox *trigger_curve_combobox_;
+	QLineEdit *trigger_level_edit_;
+	QComboBox *trigger_edge_combobox_;
+	QSpinBox *pre_trigger_spinbox_;
+	QCheckBox *clear_persistence_checkbox_;
 	QComboBox *markers_box_pos_combobox_;
 	QDialogButtonBox *button_box_;
 
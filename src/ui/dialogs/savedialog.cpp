@@ -100,7 +100,9 @@ void SaveDialog::setup_ui()
 	this->setLayout(main_layout);
 }
 
-void SaveDialog::save(QString file_name)
+void SaveDialog::save(
+	const vector<shared_ptr<sv::data::BaseSignal>> &signals,
+	const QString &file_name, bool relative_time, const string &sep)
 {
 	ofstream output_file;
 	string str_file_name = file_name.toStdString();
@@ -108,9 +110,6 @@ void SaveDialog::save(QString file_name)
 
 	output_file.open(str_file_name);
 
-	auto signals = device_tree_->checked_signals();
-	bool relative_time = !time_absolut_->isChecked();
-	string sep = separator_edit_->text().toStdString();
 	size_t max_sample_count = 0;
 
 	// Header
@@ -209,7 +208,9 @@ void SaveDialog::save(QString file_name)
 	output_file.close();
 }
 
-void SaveDialog::save_combined(QString file_name)
+void SaveDialog::save_combined(
+	const vector<shared_ptr<sv::data::BaseSignal>> &signals,
+	const QString &file_name, bool relative_time, const string &sep)
 {
 	ofstream output_file;
 	string str_file_name = file_name.toStdString();
@@ -218,10 +219,6 @@ void SaveDialog::save_combined(QString file_name)
 
 	output_file.open(str_file_name);
 
-	auto signals = device_tree_->checked_signals();
-	bool relative_time = !time_absolut_->isChecked();
-	string sep = separator_edit_->text().toStdString();
-
 	// Header
 	string device_header_line("Time"); // Time
 	string chg_name_header_line("Time"); // Time
@@ -327,10 +324,13 @@ void SaveDialog::accept()
 		tr("Save CSV-File"), QDir::homePath(), tr("CSV Files (*.csv)"));
 
 	if (file_name.length() > 0) {
+		auto signals = device_tree_->checked_signals();
+		bool relative_time = !time_absolut_->isChecked();
+		string sep = separator_edit_->text().toStdString();
 		if (timestamps_combined_->isChecked())
-			save_combined(file_name);
+			save_combined(signals, file_name, relative_time, sep);
 		else
-			save(file_name);
+			save(signals, file_name, relative_time, sep);
 
 		QDialog::accept();
 	}
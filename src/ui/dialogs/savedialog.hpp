@@ -21,6 +21,7 @@
 #define UI_DIALOGS_SAVEDIALOG_HPP
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <QCheckBox>
@@ -33,10 +34,15 @@
 #include "src/session.hpp"
 
 using std::shared_ptr;
+using std::string;
 using std::vector;
 
 namespace sv {
 
+namespace data {
+class BaseSignal;
+}
+
 namespace devices {
 class BaseDevice;
 }
@@ -60,10 +66,21 @@ public:
 		const shared_ptr<sv::devices::BaseDevice> selected_device,
 		QWidget *parent = nullptr);
 
+	/**
+	 * Save the analog signals to a CSV file, each signal with its own
+	 * time column.
+	 */
+	static void save(const vector<shared_ptr<sv::data::BaseSignal>> &signals,
+		const QString &file_name, bool relative_time, const string &sep);
+	/**
+	 * Save the analog signals to a CSV file with one combined time column.
+	 */
+	static void save_combined(
+		const vector<shared_ptr<sv::data::BaseSignal>> &signals,
+		const QString &file_name, bool relative_time, const string &sep);
+
 private:
 	void setup_ui();
-	void save(QString file_name);
-	void save_combined(QString file_name);
 
 	const Session &session_;
 	const shared_ptr<sv::devices::BaseDevice> selected_device_;
@@ -0,0 +1,76 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QWidget>
+
+#include "replaytab.hpp"
+#include "src/session.hpp"
+#include "src/devices/replaydevice.hpp"
+#include "src/ui/tabs/devicetab.hpp"
+#include "src/ui/views/baseview.hpp"
+#include "src/ui/views/plotview.hpp"
+#include "src/ui/views/replaycontrolview.hpp"
+#include "src/ui/views/valuepanelview.hpp"
+
+namespace sv {
+namespace ui {
+namespace tabs {
+
+ReplayTab::ReplayTab(Session &session,
+		shared_ptr<sv::devices::ReplayDevice> device, QWidget *parent) :
+	DeviceTab(session, device, parent),
+	replay_device_(device)
+{
+	setup_ui();
+}
+
+void ReplayTab::setup_ui()
+{
+	// Replay controls
+	add_view(new views::ReplayControlView(session_, replay_device_),
+		Qt::TopDockWidgetArea);
+
+	views::BaseView *first_panel_view = nullptr;
+	for (const auto &ch_pair : replay_device_->channel_map()) {
+		auto channel = ch_pair.second;
+
+		// Value panel(s)
+		views::BaseView *value_panel_view =
+			new views::ValuePanelView(session_, channel);
+		if (!first_panel_view) {
+			first_panel_view = value_panel_view;
+			add_view(value_panel_view, Qt::TopDockWidgetArea);
+		}
+		else
+			add_view_ontop(value_panel_view, first_panel_view);
+
+		// Value plot(s)
+		views::BaseView *value_plot_view =
+			new views::PlotView(session_, channel);
+		add_view(value_plot_view, Qt::BottomDockWidgetArea);
+	}
+	if (first_panel_view) {
+		first_panel_view->show();
+		first_panel_view->raise();
+	}
+}
+
+} // namespace tabs
+} // namespace ui
+} // namespace sv
@@ -26,10 +26,12 @@
 #include "src/devices/basedevice.hpp"
 #include "src/devices/deviceutil.hpp"
 #include "src/devices/measurementdevice.hpp"
+#include "src/devices/replaydevice.hpp"
 #include "src/devices/sourcesinkdevice.hpp"
 #include "src/devices/userdevice.hpp"
 #include "src/ui/tabs/basetab.hpp"
 #include "src/ui/tabs/measurementtab.hpp"
+#include "src/ui/tabs/replaytab.hpp"
 #include "src/ui/tabs/sourcesinktab.hpp"
 #include "src/ui/tabs/usertab.hpp"
 
@@ -78,6 +80,12 @@ BaseTab *get_tab_for_device(Session &session,
 			static_pointer_cast<devices::UserDevice>(device), parent);
 	}
 
+	// Replay device tab
+	if (device->type() == DeviceType::ReplayDevice) {
+		return new ReplayTab(session,
+			static_pointer_cast<devices::ReplayDevice>(device), parent);
+	}
+
 	return nullptr;
 }
 
@@ -31,6 +31,7 @@
 
 #include "dataview.hpp"
 #include "src/session.hpp"
+#include "src/tracer.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/ui/dialogs/selectsignaldialog.hpp"
@@ -121,6 +122,8 @@ void DataView::add_signal(shared_ptr<sv::data::AnalogTimeSignal> signal)
 
 void DataView::populate_table()
 {
+	SV_TRACE_SCOPE("view", "populate_table");
+
 	std::unique_lock<std::mutex> lock(populate_mutex_, std::try_to_lock);
 	if (!lock.owns_lock())
 		return;
@@ -21,6 +21,8 @@
 
 #include <QAction>
 #include <QDebug>
+#include <QDir>
+#include <QFileDialog>
 #include <QMessageBox>
 #include <QToolBar>
 #include <QVBoxLayout>
@@ -33,6 +35,7 @@
 #include "src/data/basesignal.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/hardwaredevice.hpp"
+#include "src/devices/replaydevice.hpp"
 #include "src/devices/userdevice.hpp"
 #include "src/ui/devices/devicetree/devicetreemodel.hpp"
 #include "src/ui/devices/devicetree/devicetreeview.hpp"
@@ -56,6 +59,8 @@ DevicesView::DevicesView(Session &session,
 	BaseView(session, parent),
 	action_add_device_(new QAction(this)),
 	action_add_userdevice_(new QAction(this)),
+	action_add_replaydevice_(new QAction(this)),
+	action_import_file_(new QAction(this)),
 	action_disconnect_device_(new QAction(this))
 {
 	setup_ui();
@@ -95,6 +100,20 @@ void DevicesView::setup_toolbar()
 	connect(action_add_userdevice_, SIGNAL(triggered(bool)),
 		this, SLOT(on_action_add_userdevice_triggered()));
 
+	action_add_replaydevice_->setText(tr("Replay recording"));
+	action_add_replaydevice_->setIcon(
+		QIcon::fromTheme("document-open",
+		QIcon(":/icons/document-open.png")));
+	connect(action_add_replaydevice_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_add_replaydevice_triggered()));
+
+	action_import_file_->setText(tr("Import file"));
+	action_import_file_->setIcon(
+		QIcon::fromTheme("document-open-folder",
+		QIcon(":/icons/document-open-folder.png")));
+	connect(action_import_file_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_import_file_triggered()));
+
 	action_disconnect_device_->setText(tr("Disconnect device"));
 	action_disconnect_device_->setIcon(
 		QIcon::fromTheme("edit-delete",
@@ -105,6 +124,8 @@ void DevicesView::setup_toolbar()
 	toolbar_ = new QToolBar("Device Tree Toolbar");
 	toolbar_->addAction(action_add_device_);
 	toolbar_->addAction(action_add_userdevice_);
+	toolbar_->addAction(action_add_replaydevice_);
+	toolbar_->addAction(action_import_file_);
 	toolbar_->addSeparator();
 	toolbar_->addAction(action_disconnect_device_);
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
@@ -134,6 +155,38 @@ void DevicesView::on_action_add_userdevice_triggered()
 	session().main_window()->add_device_tab(device);
 }
 
+void DevicesView::on_action_add_replaydevice_triggered()
+{
+	QString file_name = QFileDialog::getOpenFileName(this,
+		tr("Open Recording"), QDir::homePath(),
+		tr("SmuView CSV Files (*.csv);;All Files (*)"));
+	if (file_name.length() <= 0)
+		return;
+
+	// NOTE: add_replay_device() must be called, before the device tab
+	//       tries to access the device (device is not opend yet).
+	shared_ptr<sv::devices::ReplayDevice> device;
+	try {
+		device = session().add_replay_device(file_name.toStdString(), "");
+	}
+	catch (const QString &e) {
+		QMessageBox::warning(this, tr("Replay recording"), e);
+		return;
+	}
+	session().main_window()->add_device_tab(device);
+}
+
+void DevicesView::on_action_import_file_triggered()
+{
+	QString file_name = QFileDialog::getOpenFileName(this,
+		tr("Import File"), QDir::homePath(),
+		tr("SmuView CSV Files (*.csv);;All Files (*)"));
+	if (file_name.length() <= 0)
+		return;
+
+	session().main_window()->import_file(file_name.toStdString(), "");
+}
+
 void DevicesView::on_action_disconnect_device_triggered()
 {
 	TreeItem *item = device_tree_->selected_item();
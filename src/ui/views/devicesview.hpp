@@ -55,6 +55,8 @@ public:
 private:
 	QAction *const action_add_device_;
 	QAction *const action_add_userdevice_;
+	QAction *const action_add_replaydevice_;
+	QAction *const action_import_file_;
 	QAction *const action_disconnect_device_;
 	QToolBar *toolbar_;
 	devices::devicetree::DeviceTreeView  *device_tree_;
@@ -66,6 +68,8 @@ private:
 private Q_SLOTS:
 	void on_action_add_device_triggered();
 	void on_action_add_userdevice_triggered();
+	void on_action_add_replaydevice_triggered();
+	void on_action_import_file_triggered();
 	void on_action_disconnect_device_triggered();
 
 };
@@ -0,0 +1,301 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <QAction>
+#include <QDir>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QLabel>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QToolBar>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+#include <QVBoxLayout>
+
+#include "diagnosticsview.hpp"
+#include "src/eventloopmonitor.hpp"
+#include "src/session.hpp"
+#include "src/tracer.hpp"
+#include "src/util.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/devices/acquisitionmetrics.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::set;
+using std::string;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+namespace {
+
+enum Column {
+	NameColumn = 0,
+	PacketRateColumn,
+	SampleRateColumn,
+	IngestLatencyColumn,
+	DisplayLatencyColumn,
+	MemoryColumn
+};
+
+QString format_latency(double us)
+{
+	return util::format_time_si(
+		util::Timestamp(us / 1000000.), util::SIPrefix::unspecified, 1,
+		"s", false);
+}
+
+/** Format the median, 99th percentile and max. latency. */
+QString format_latency_stats(const devices::LatencyStats &stats)
+{
+	if (stats.count == 0)
+		return "-";
+	return QString("%1 / %2 / %3").arg(format_latency(stats.p50)).
+		arg(format_latency(stats.p99)).arg(format_latency(stats.max));
+}
+
+QString format_memory(size_t bytes)
+{
+	if (bytes >= 1024 * 1024)
+		return QString("%1 MiB").arg(bytes / (1024. * 1024.), 0, 'f', 1);
+	if (bytes >= 1024)
+		return QString("%1 KiB").arg(bytes / 1024., 0, 'f', 1);
+	return QString("%1 B").arg(bytes);
+}
+
+} // namespace
+
+DiagnosticsView::DiagnosticsView(Session &session, QWidget *parent) :
+	BaseView(session, parent),
+	action_reset_(new QAction(this)),
+	action_trace_(new QAction(this)),
+	action_save_trace_(new QAction(this))
+{
+	id_ = "diagnostics";
+
+	setup_ui();
+	setup_toolbar();
+
+	connect(&refresh_timer_, SIGNAL(timeout()), this, SLOT(refresh()));
+	refresh_timer_.start(1000);
+}
+
+QString DiagnosticsView::title() const
+{
+	return tr("Diagnostics");
+}
+
+void DiagnosticsView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	metrics_tree_ = new QTreeWidget();
+	metrics_tree_->setColumnCount(6);
+	metrics_tree_->setHeaderLabels(QStringList()
+		<< tr("Device / Signal") << tr("Packets/s") << tr("Samples/s")
+		<< tr("Ingest latency") << tr("Display latency") << tr("Memory"));
+	metrics_tree_->headerItem()->setToolTip(IngestLatencyColumn,
+		tr("Median / 99th percentile / max. time to process a packet"));
+	metrics_tree_->headerItem()->setToolTip(DisplayLatencyColumn,
+		tr("Median / 99th percentile / max. time from the packet arrival "
+			"until it is on screen"));
+	metrics_tree_->header()->setSectionResizeMode(
+		QHeaderView::ResizeToContents);
+	metrics_tree_->setAlternatingRowColors(true);
+	layout->addWidget(metrics_tree_);
+
+	event_loop_label_ = new QLabel();
+	event_loop_label_->setToolTip(
+		tr("Time until a posted event is delivered by the GUI event loop"));
+	layout->addWidget(event_loop_label_);
+
+	layout->setContentsMargins(2, 2, 2, 2);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void DiagnosticsView::setup_toolbar()
+{
+	action_reset_->setText(tr("Reset"));
+	action_reset_->setIconText(tr("Reset"));
+	action_reset_->setIcon(
+		QIcon::fromTheme("view-refresh",
+		QIcon(":/icons/view-refresh.png")));
+	connect(action_reset_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_reset_triggered()));
+
+	update_trace_action();
+	action_trace_->setCheckable(true);
+	connect(action_trace_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_trace_triggered()));
+
+	action_save_trace_->setText(tr("Save trace"));
+	action_save_trace_->setIconText(tr("Save trace"));
+	action_save_trace_->setIcon(
+		QIcon::fromTheme("document-save-as",
+		QIcon(":/icons/document-save-as.png")));
+	connect(action_save_trace_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_save_trace_triggered()));
+
+	toolbar_ = new QToolBar("Diagnostics Toolbar");
+	toolbar_->addAction(action_reset_);
+	toolbar_->addSeparator();
+	toolbar_->addAction(action_trace_);
+	toolbar_->addAction(action_save_trace_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void DiagnosticsView::update_trace_action()
+{
+	if (Tracer::is_enabled()) {
+		action_trace_->setText(tr("Stop tracing"));
+		action_trace_->setIconText(tr("Stop tracing"));
+		action_trace_->setIcon(
+			QIcon::fromTheme("media-playback-stop",
+			QIcon(":/icons/media-playback-stop.png")));
+	}
+	else {
+		action_trace_->setText(tr("Start tracing"));
+		action_trace_->setIconText(tr("Start tracing"));
+		action_trace_->setIcon(
+			QIcon::fromTheme("media-record",
+			QIcon(":/icons/media-playback-start.png")));
+	}
+	action_trace_->setChecked(Tracer::is_enabled());
+}
+
+void DiagnosticsView::refresh()
+{
+	if (!isVisible())
+		return;
+
+	// Tracing may also be started from the command line or a script.
+	update_trace_action();
+
+	set<string> device_ids;
+	set<string> signal_ids;
+	for (const auto &device_pair : session_.devices()) {
+		const auto &device = device_pair.second;
+		device_ids.insert(device->id());
+
+		QTreeWidgetItem *device_item = device_items_[device->id()];
+		if (!device_item) {
+			device_item = new QTreeWidgetItem(metrics_tree_);
+			device_item->setText(NameColumn, device->short_name());
+			device_item->setExpanded(true);
+			device_items_[device->id()] = device_item;
+		}
+
+		devices::AcquisitionStats stats = device->metrics()->stats();
+		device_item->setText(PacketRateColumn,
+			QString::number(stats.packet_rate, 'f', 1));
+		device_item->setText(SampleRateColumn,
+			QString::number(stats.sample_rate, 'f', 1));
+		device_item->setText(IngestLatencyColumn,
+			format_latency_stats(stats.ingest_latency));
+		device_item->setText(DisplayLatencyColumn,
+			format_latency_stats(stats.display_latency));
+
+		size_t device_memory = 0;
+		for (const auto &signal : device->signals()) {
+			auto a_signal = dynamic_pointer_cast<data::AnalogTimeSignal>(signal);
+			if (!a_signal)
+				continue;
+
+			string signal_id = device->id() + "/" + signal->name();
+			signal_ids.insert(signal_id);
+			QTreeWidgetItem *signal_item = signal_items_[signal_id];
+			if (!signal_item) {
+				signal_item = new QTreeWidgetItem(device_item);
+				signal_item->setText(NameColumn, signal->display_name());
+				signal_items_[signal_id] = signal_item;
+			}
+
+			size_t memory = a_signal->memory_size();
+			device_memory += memory;
+			signal_item->setText(MemoryColumn, format_memory(memory));
+			signal_item->setToolTip(MemoryColumn, tr("%1 samples").
+				arg(a_signal->sample_count()));
+		}
+		device_item->setText(MemoryColumn, format_memory(device_memory));
+	}
+
+	// Remove the items of removed devices and signals. The signal items are
+	// removed first, they may be children of a removed device item.
+	for (auto it = signal_items_.begin(); it != signal_items_.end(); ) {
+		if (signal_ids.count(it->first) == 0) {
+			delete it->second;
+			it = signal_items_.erase(it);
+		}
+		else
+			++it;
+	}
+	for (auto it = device_items_.begin(); it != device_items_.end(); ) {
+		if (device_ids.count(it->first) == 0) {
+			delete it->second;
+			it = device_items_.erase(it);
+		}
+		else
+			++it;
+	}
+
+	auto monitor = session_.event_loop_monitor();
+	event_loop_label_->setText(tr("Event loop lag: %1 (max. %2)").
+		arg(format_latency(monitor->lag() * 1000.)).
+		arg(format_latency(monitor->max_lag() * 1000.)));
+}
+
+void DiagnosticsView::on_action_reset_triggered()
+{
+	for (const auto &device_pair : session_.devices())
+		device_pair.second->metrics()->reset();
+	session_.event_loop_monitor()->reset();
+	refresh();
+}
+
+void DiagnosticsView::on_action_trace_triggered()
+{
+	if (action_trace_->isChecked())
+		Tracer::start();
+	else
+		Tracer::stop();
+	update_trace_action();
+}
+
+void DiagnosticsView::on_action_save_trace_triggered()
+{
+	QString file_name = QFileDialog::getSaveFileName(this,
+		tr("Save Trace"), QDir::homePath(), tr("JSON Files (*.json)"));
+	if (file_name.length() > 0)
+		Tracer::write_json(file_name.toStdString());
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,88 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_DIAGNOSTICSVIEW_HPP
+#define UI_VIEWS_DIAGNOSTICSVIEW_HPP
+
+#include <map>
+#include <string>
+
+#include <QAction>
+#include <QLabel>
+#include <QTimer>
+#include <QToolBar>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+
+#include "src/ui/views/baseview.hpp"
+
+using std::map;
+using std::string;
+
+namespace sv {
+
+class Session;
+
+namespace ui {
+namespace views {
+
+/**
+ * The DiagnosticsView shows the acquisition metrics of all devices (packet
+ * and sample rates, ingest and display latencies), the memory of all signals
+ * and the lag of the GUI event loop. It is refreshed once per second, as
+ * long as it is visible.
+ */
+class DiagnosticsView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	DiagnosticsView(Session& session, QWidget* parent = nullptr);
+
+	QString title() const override;
+
+private:
+	QAction *const action_reset_;
+	QAction *const action_trace_;
+	QAction *const action_save_trace_;
+	QToolBar *toolbar_;
+	QTreeWidget *metrics_tree_;
+	QLabel *event_loop_label_;
+	QTimer refresh_timer_;
+	/** The tree items of the devices and signals by their id. */
+	map<string, QTreeWidgetItem *> device_items_;
+	map<string, QTreeWidgetItem *> signal_items_;
+
+	void setup_ui();
+	void setup_toolbar();
+	void update_trace_action();
+
+private Q_SLOTS:
+	void refresh();
+	void on_action_reset_triggered();
+	void on_action_trace_triggered();
+	void on_action_save_trace_triggered();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_DIAGNOSTICSVIEW_HPP
@@ -212,7 +212,7 @@ void PlotView::setup_ui()
 {
 	QVBoxLayout *layout = new QVBoxLayout();
 
-	plot_ = new widgets::plot::Plot();
+	plot_ = new widgets::plot::Plot(session_.plot_scheduler());
 	plot_->set_update_mode(widgets::plot::PlotUpdateMode::Additive);
 	plot_->set_plot_interval(200); // 200ms
 
@@ -19,9 +19,9 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QApplication>
-#include <QDateTime>
 #include <QVBoxLayout>
 
 #include "powerpanelview.hpp"
@@ -29,9 +29,14 @@
 #include "src/util.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/energyaccumulator.hpp"
+#include "src/ui/widgets/displayscheduler.hpp"
 #include "src/ui/widgets/monofontdisplay.hpp"
+#include "src/ui/widgets/refreshintervalbutton.hpp"
 
+using std::make_shared;
 using std::set;
+using std::vector;
 using sv::data::QuantityFlag;
 
 namespace sv {
@@ -45,27 +50,28 @@ PowerPanelView::PowerPanelView(Session &session,
 	BaseView(session, parent),
 	voltage_signal_(voltage_signal),
 	current_signal_(current_signal),
+	energy_accumulator_(make_shared<sv::data::EnergyAccumulator>(
+		voltage_signal, current_signal)),
+	refresh_interval_(250),
 	voltage_min_(std::numeric_limits<double>::max()),
 	voltage_max_(std::numeric_limits<double>::lowest()),
 	current_min_(std::numeric_limits<double>::max()),
 	current_max_(std::numeric_limits<double>::lowest()),
 	resistance_min_(std::numeric_limits<double>::max()),
 	resistance_max_(std::numeric_limits<double>::lowest()),
-	power_min_(std::numeric_limits<double>::max()),
-	power_max_(std::numeric_limits<double>::lowest()),
-	actual_amp_hours_(0),
-	actual_watt_hours_(0),
 	action_reset_displays_(new QAction(this))
 {
 	id_ = "powerpanel:" + voltage_signal_->name() +
 		":" + current_signal_->name();
 
+	// Can't be called in the ctor of the accumulator (shared_from_this()).
+	energy_accumulator_->init();
+
 	setup_ui();
 	setup_toolbar();
 	connect_signals();
 	reset_displays();
 
-	timer_ = new QTimer(this);
 	init_timer();
 }
 
@@ -225,8 +231,14 @@ void PowerPanelView::setup_toolbar()
 	connect(action_reset_displays_, SIGNAL(triggered(bool)),
 		this, SLOT(on_action_reset_displays_triggered()));
 
+	refresh_interval_button_ =
+		new widgets::RefreshIntervalButton(refresh_interval_);
+	connect(refresh_interval_button_, SIGNAL(interval_changed(int)),
+		this, SLOT(on_refresh_interval_changed(int)));
+
 	toolbar_ = new QToolBar("Power Panel Toolbar");
 	toolbar_->addAction(action_reset_displays_);
+	toolbar_->addWidget(refresh_interval_button_);
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
 }
 
@@ -282,44 +294,49 @@ void PowerPanelView::init_timer()
 	if (!voltage_signal_ && !current_signal_)
 		return;
 
-	start_time_ = QDateTime::currentMSecsSinceEpoch();
-	last_time_ = start_time_;
-
 	voltage_min_ = std::numeric_limits<double>::max();
 	voltage_max_ = std::numeric_limits<double>::lowest();
 	current_min_ = std::numeric_limits<double>::max();
 	current_max_ = std::numeric_limits<double>::lowest();
 	resistance_min_ = std::numeric_limits<double>::max();
 	resistance_max_ = std::numeric_limits<double>::lowest();
-	power_min_ = std::numeric_limits<double>::max();
-	power_max_ = std::numeric_limits<double>::lowest();
-	actual_amp_hours_ = 0;
-	actual_watt_hours_ = 0;
-
-	connect(timer_, SIGNAL(timeout()), this, SLOT(on_update()));
-	timer_->start(250);
+	energy_accumulator_->reset();
+
+	session_.display_scheduler()->add_display(
+		this, refresh_interval_, [this]() { on_update(); },
+		[this]() {
+			return vector<shared_ptr<sv::data::AnalogTimeSignal>>{
+				voltage_signal_, current_signal_ };
+		});
 }
 
 void PowerPanelView::stop_timer()
 {
-	if (!timer_->isActive())
+	if (!session_.display_scheduler()->has_display(this))
 		return;
 
-	timer_->stop();
-	disconnect(timer_, SIGNAL(timeout()), this, SLOT(on_update()));
+	session_.display_scheduler()->remove_display(this);
 
 	reset_displays();
 }
 
+void PowerPanelView::set_refresh_interval(int refresh_interval)
+{
+	refresh_interval_ = refresh_interval;
+	refresh_interval_button_->set_interval(refresh_interval_);
+	session_.display_scheduler()->set_interval(this, refresh_interval_);
+}
+
+int PowerPanelView::refresh_interval() const
+{
+	return refresh_interval_;
+}
+
 void PowerPanelView::on_update()
 {
 	if (voltage_signal_->sample_count() == 0)
 		return;
 
-	qint64 now = QDateTime::currentMSecsSinceEpoch();
-	double elapsed_time = (now - last_time_) / (double)3600000; // 1000 * 60 * 60 = 1h
-	last_time_ = now;
-
 	double voltage = 0.;
 	if (voltage_signal_) {
 		voltage = voltage_signal_->last_value();
@@ -346,13 +363,10 @@ void PowerPanelView::on_update()
 		resistance_max_ = resistance;
 
 	double power = voltage * current;
-	if (power_min_ > power)
-		power_min_ = power;
-	if (power_max_ < power)
-		power_max_ = power;
 
-	actual_amp_hours_ = actual_amp_hours_ + (current * elapsed_time);
-	actual_watt_hours_ = actual_watt_hours_ + (power * elapsed_time);
+	// Ah, Wh and min/max power are accumulated sample by sample over the
+	// sample timestamps, independent of the refresh interval.
+	sv::data::EnergyValues energy = energy_accumulator_->values();
 
 	voltage_display_->set_value(voltage);
 	voltage_min_display_->set_value(voltage_min_);
@@ -367,11 +381,13 @@ void PowerPanelView::on_update()
 	resistance_max_display_->set_value(resistance_max_);
 
 	power_display_->set_value(power);
-	power_min_display_->set_value(power_min_);
-	power_max_display_->set_value(power_max_);
+	if (energy.sample_count > 0) {
+		power_min_display_->set_value(energy.power_min);
+		power_max_display_->set_value(energy.power_max);
+	}
 
-	amp_hour_display_->set_value(actual_amp_hours_);
-	watt_hour_display_->set_value(actual_watt_hours_);
+	amp_hour_display_->set_value(energy.amp_hours);
+	watt_hour_display_->set_value(energy.watt_hours);
 }
 
 void PowerPanelView::on_action_reset_displays_triggered()
@@ -380,6 +396,11 @@ void PowerPanelView::on_action_reset_displays_triggered()
 	init_timer();
 }
 
+void PowerPanelView::on_refresh_interval_changed(int interval)
+{
+	set_refresh_interval(interval);
+}
+
 void PowerPanelView::on_digits_changed()
 {
 	// Use the smaller digits count to save space.
@@ -23,7 +23,6 @@
 #include <memory>
 
 #include <QAction>
-#include <QTimer>
 #include <QToolBar>
 
 #include "src/ui/views/baseview.hpp"
@@ -36,11 +35,13 @@ class Session;
 
 namespace data {
 class AnalogTimeSignal;
+class EnergyAccumulator;
 }
 
 namespace ui {
 
 namespace widgets {
+class RefreshIntervalButton;
 class ValueDisplay;
 }
 
@@ -59,13 +60,18 @@ public:
 
 	QString title() const override;
 
+	/** Set the refresh interval of the displays in ms. */
+	void set_refresh_interval(int refresh_interval);
+	int refresh_interval() const;
+
 private:
 	shared_ptr<sv::data::AnalogTimeSignal> voltage_signal_;
 	shared_ptr<sv::data::AnalogTimeSignal> current_signal_;
 
-	QTimer *timer_;
-	qint64 start_time_;
-	qint64 last_time_;
+	/** Sample accurate Ah/Wh and min/max power. */
+	shared_ptr<sv::data::EnergyAccumulator> energy_accumulator_;
+
+	int refresh_interval_;
 
 	// Min/max/actual values are stored here, so they can be reseted
 	double voltage_min_;
@@ -74,13 +80,10 @@ private:
 	double current_max_;
 	double resistance_min_;
 	double resistance_max_;
-	double power_min_;
-	double power_max_;
-	double actual_amp_hours_;
-	double actual_watt_hours_;
 
 	QAction *const action_reset_displays_;
 	QToolBar *toolbar_;
+	widgets::RefreshIntervalButton *refresh_interval_button_;
 	widgets::ValueDisplay *voltage_display_;
 	widgets::ValueDisplay *voltage_min_display_;
 	widgets::ValueDisplay *voltage_max_display_;
@@ -106,6 +109,7 @@ private:
 private Q_SLOTS:
 	void on_update();
 	void on_action_reset_displays_triggered();
+	void on_refresh_interval_changed(int interval);
 	void on_digits_changed();
 
 };
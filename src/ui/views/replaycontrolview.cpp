@@ -0,0 +1,126 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDebug>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QVariant>
+
+#include "replaycontrolview.hpp"
+#include "src/session.hpp"
+#include "src/devices/replaydevice.hpp"
+#include "src/devices/replayrecording.hpp"
+
+namespace sv {
+namespace ui {
+namespace views {
+
+ReplayControlView::ReplayControlView(Session &session,
+		shared_ptr<sv::devices::ReplayDevice> device, QWidget *parent) :
+	BaseView(session, parent),
+	device_(device)
+{
+	id_ = "replay:" + device_->id();
+
+	setup_ui();
+	connect_signals();
+	update_position();
+}
+
+QString ReplayControlView::title() const
+{
+	return tr("Replay") + " " + device_->recording()->name();
+}
+
+void ReplayControlView::setup_ui()
+{
+	QFormLayout *layout = new QFormLayout();
+
+	speed_box_ = new QComboBox();
+	for (const double speed : { 0.1, 0.5, 1., 2., 5., 10., 100. })
+		speed_box_->addItem(QString("%1x").arg(speed), QVariant(speed));
+	speed_box_->addItem(tr("Max"), QVariant(0.));
+	int index = speed_box_->findData(QVariant(device_->speed()));
+	speed_box_->setCurrentIndex(index >= 0 ? index : 2);
+	layout->addRow(tr("Speed"), speed_box_);
+
+	QHBoxLayout *loop_layout = new QHBoxLayout();
+	loop_box_ = new QCheckBox(tr("Loop"));
+	loop_box_->setChecked(device_->loop());
+	loop_layout->addWidget(loop_box_);
+	restart_button_ = new QPushButton(tr("Restart"));
+	loop_layout->addWidget(restart_button_);
+	loop_layout->addStretch(1);
+	layout->addRow(loop_layout);
+
+	position_label_ = new QLabel();
+	layout->addRow(tr("Position"), position_label_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void ReplayControlView::connect_signals()
+{
+	// Control elements -> Device
+	connect(speed_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_speed_changed()));
+	connect(loop_box_, SIGNAL(toggled(bool)),
+		this, SLOT(on_loop_changed()));
+	connect(restart_button_, SIGNAL(clicked(bool)),
+		this, SLOT(on_restart()));
+
+	// Device -> control elements
+	connect(&refresh_timer_, SIGNAL(timeout()), this, SLOT(update_position()));
+	refresh_timer_.start(250);
+}
+
+void ReplayControlView::on_speed_changed()
+{
+	device_->set_speed(speed_box_->currentData().toDouble());
+}
+
+void ReplayControlView::on_loop_changed()
+{
+	device_->set_loop(loop_box_->isChecked());
+}
+
+void ReplayControlView::on_restart()
+{
+	device_->restart();
+}
+
+void ReplayControlView::update_position()
+{
+	QString text = QString("%1 s / %2 s").
+		arg(device_->position(), 0, 'f', 1).
+		arg(device_->recording()->duration(), 0, 'f', 1);
+	if (device_->is_finished())
+		text.append(" ").append(tr("(finished)"));
+	position_label_->setText(text);
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
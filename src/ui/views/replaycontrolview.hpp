@@ -0,0 +1,86 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_REPLAYCONTROLVIEW_HPP
+#define UI_VIEWS_REPLAYCONTROLVIEW_HPP
+
+#include <memory>
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QString>
+#include <QTimer>
+
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+
+namespace sv {
+
+class Session;
+
+namespace devices {
+class ReplayDevice;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * The ReplayControlView controls the playback speed of a replay device and
+ * shows the position of the playback.
+ */
+class ReplayControlView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	ReplayControlView(Session& session,
+		shared_ptr<sv::devices::ReplayDevice> device,
+		QWidget* parent = nullptr);
+
+	QString title() const override;
+
+private:
+	shared_ptr<sv::devices::ReplayDevice> device_;
+
+	QComboBox *speed_box_;
+	QCheckBox *loop_box_;
+	QPushButton *restart_button_;
+	QLabel *position_label_;
+	QTimer refresh_timer_;
+
+	void setup_ui();
+	void connect_signals();
+
+private Q_SLOTS:
+	void on_speed_changed();
+	void on_loop_changed();
+	void on_restart();
+	void update_position();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_REPLAYCONTROLVIEW_HPP
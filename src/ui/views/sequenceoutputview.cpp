@@ -24,6 +24,7 @@
 
 #include <QAction>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QDebug>
 #include <QDoubleSpinBox>
 #include <QFile>
@@ -40,17 +41,22 @@
 #include <QTableWidget>
 #include <QTableWidgetItem>
 #include <QTextStream>
-#include <QTimer>
 #include <QToolBar>
 #include <QVBoxLayout>
 
 #include "sequenceoutputview.hpp"
 #include "src/session.hpp"
 #include "src/util.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/datautil.hpp"
 #include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/sequencer.hpp"
+#include "src/devices/userdevice.hpp"
 #include "src/ui/datatypes/doublespinbox.hpp"
 #include "src/ui/dialogs/generatewaveformdialog.hpp"
 
+using std::make_shared;
+using std::set;
 using std::shared_ptr;
 using std::string;
 using std::vector;
@@ -124,13 +130,16 @@ SequenceOutputView::SequenceOutputView(Session &session,
 	action_delete_row_(new QAction(this)),
 	action_delete_all_(new QAction(this)),
 	action_load_from_file_(new QAction(this)),
-	action_generate_waveform_(new QAction(this)),
-	sequence_pos_(0)
+	action_generate_waveform_(new QAction(this))
 {
 	assert(property_);
 	id_ = "sequence:" + property_->name();
 
-	timer_ = new QTimer(this);
+	sequencer_ = make_shared<sv::devices::Sequencer>(property_);
+	connect(sequencer_.get(), &sv::devices::Sequencer::step_executed,
+		this, &SequenceOutputView::on_step_executed);
+	connect(sequencer_.get(), &sv::devices::Sequencer::sequence_finished,
+		this, &SequenceOutputView::on_sequence_finished);
 
 	setup_ui();
 	setup_toolbar();
@@ -138,7 +147,8 @@ SequenceOutputView::SequenceOutputView(Session &session,
 
 SequenceOutputView::~SequenceOutputView()
 {
-	stop_timer();
+	sequencer_->stop();
+	sequencer_->wait();
 }
 
 QString SequenceOutputView::title() const
@@ -166,6 +176,14 @@ void SequenceOutputView::setup_ui()
 	repeat_count_box_->setSuffix(tr(" cycle(s)"));
 	repeat_count_box_->setDisabled(true);
 	repeat_layout->addWidget(repeat_count_box_);
+	repeat_layout->addSpacing(8);
+	repeat_layout->addWidget(new QLabel(tr("Late steps")));
+	catch_up_box_ = new QComboBox();
+	catch_up_box_->addItem(tr("Skip"),
+		QVariant::fromValue((int)sv::devices::SequencerCatchUp::Skip));
+	catch_up_box_->addItem(tr("Catch up"),
+		QVariant::fromValue((int)sv::devices::SequencerCatchUp::Burst));
+	repeat_layout->addWidget(catch_up_box_);
 	repeat_layout->addStretch(1);
 	layout->addItem(repeat_layout);
 
@@ -191,6 +209,9 @@ void SequenceOutputView::setup_ui()
 	//sequence_table_->setRowCount(1);
 	layout->addWidget(sequence_table_);
 
+	timing_label_ = new QLabel();
+	layout->addWidget(timing_label_);
+
 	this->central_widget_->setLayout(layout);
 }
 
@@ -252,43 +273,80 @@ void SequenceOutputView::setup_toolbar()
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
 }
 
-void SequenceOutputView::start_timer()
+void SequenceOutputView::init_result_channels()
 {
-	if (timer_->isActive()) {
-		timer_->stop();
-		disconnect(timer_, SIGNAL(timeout()), this, SLOT(on_timer_update()));
-	}
+	if (!result_device_)
+		result_device_ = session_.add_user_device();
+	if (actual_channel_)
+		return;
 
-	sequence_pos_ = 0;
-	sequence_reperat_count_ = 0;
-	if (sequence_table_->rowCount() == 0)
+	const string name = "Sequence " + property_->name();
+	actual_channel_ = result_device_->add_user_channel(name, "Sequence");
+	planned_channel_ = result_device_->add_user_channel(
+		name + " planned", "Sequence");
+	timing_error_channel_ = result_device_->add_user_channel(
+		name + " timing error", "Sequence");
+}
+
+void SequenceOutputView::start_sequence()
+{
+	sequencer_->stop();
+	sequencer_->wait();
+
+	// Take a snapshot of the table, the sequencer thread must not access the
+	// widgets. Rows without a delay are skipped like before.
+	vector<double> values;
+	vector<double> delays;
+	sequence_rows_.clear();
+	for (int row = 0; row < sequence_table_->rowCount(); ++row) {
+		QTableWidgetItem *value_item = sequence_table_->item(row, 0);
+		QTableWidgetItem *delay_item = sequence_table_->item(row, 1);
+		if (!value_item || !delay_item)
+			continue;
+		double delay = delay_item->data(0).toDouble();
+		if (delay <= 0)
+			continue;
+		values.push_back(value_item->data(0).toDouble());
+		delays.push_back(delay);
+		sequence_rows_.push_back(row);
+	}
+	if (values.empty()) {
+		update_run_action(false);
 		return;
+	}
 
-	connect(timer_, SIGNAL(timeout()), this, SLOT(on_timer_update()));
-	timer_->start();
+	init_result_channels();
+	sequencer_->set_sequence(values, delays);
+	sequencer_->set_repeat_count(repeat_infinite_box_->isChecked() ?
+		0 : repeat_count_box_->value());
+	sequencer_->set_catch_up_policy((sv::devices::SequencerCatchUp)
+		catch_up_box_->currentData().toInt());
+	sequencer_->start();
 
-	action_run_->setText(tr("Stop"));
-	action_run_->setIcon(
-		QIcon::fromTheme("media-playback-stop",
-		QIcon(":/icons/media-playback-stop.png")));
-	action_run_->setChecked(true);
+	update_run_action(true);
 }
 
-void SequenceOutputView::stop_timer()
+void SequenceOutputView::stop_sequence()
 {
-	action_run_->setText(tr("Run"));
-	action_run_->setIcon(
-		QIcon::fromTheme("media-playback-start",
-		QIcon(":/icons/media-playback-start.png")));
-	action_run_->setChecked(false);
-
-	if (!timer_->isActive())
-		return;
+	sequencer_->stop();
+	update_run_action(false);
+}
 
-	timer_->stop();
-	disconnect(timer_, SIGNAL(timeout()), this, SLOT(on_timer_update()));
-	sequence_pos_ = 0;
-	sequence_reperat_count_ = 0;
+void SequenceOutputView::update_run_action(bool running)
+{
+	if (running) {
+		action_run_->setText(tr("Stop"));
+		action_run_->setIcon(
+			QIcon::fromTheme("media-playback-stop",
+			QIcon(":/icons/media-playback-stop.png")));
+	}
+	else {
+		action_run_->setText(tr("Run"));
+		action_run_->setIcon(
+			QIcon::fromTheme("media-playback-start",
+			QIcon(":/icons/media-playback-start.png")));
+	}
+	action_run_->setChecked(running);
 }
 
 void SequenceOutputView::insert_row(int row, double value, double delay)
@@ -302,47 +360,34 @@ void SequenceOutputView::insert_row(int row, double value, double delay)
 	sequence_table_->setItem(row, 1, delay_item);
 }
 
-void SequenceOutputView::on_timer_update()
+void SequenceOutputView::on_step_executed(unsigned int step, double value,
+	double planned_timestamp, double actual_timestamp, double timing_error)
 {
-	bool found_value = sequence_pos_ > 0 ? true : false;
-	double value = .0;
-	double delay_ms = .0;
-	// Cycle through the row until a duration is found.
-	do {
-		if (sequence_table_->rowCount() == 0) {
-			stop_timer();
-			return;
-		}
-		if (sequence_pos_ >= sequence_table_->rowCount()) {
-			// Jump up to the first row
-			sequence_pos_ = 0;
-			if (!found_value) {
-				stop_timer();
-				return;
-			}
-			if (!repeat_infinite_box_->isChecked()) {
-				sequence_reperat_count_++;
-				if (sequence_reperat_count_ >= repeat_count_box_->value()) {
-					stop_timer();
-					return;
-				}
-			}
-		}
-
-		QTableWidgetItem *value_item = sequence_table_->item(sequence_pos_, 0);
-		if (value_item)
-			value = value_item->data(0).toDouble();
-		QTableWidgetItem *delay_item = sequence_table_->item(sequence_pos_, 1);
-		if (delay_item)
-			delay_ms = delay_item->data(0).toDouble() * 1000;
-
-		sequence_table_->selectRow(sequence_pos_);
-		sequence_pos_++;
-	}
-	while (delay_ms <= 0);
+	const data::Quantity quantity =
+		data::datautil::get_quantity_from_unit(property_->unit());
+	actual_channel_->push_sample(value, actual_timestamp, quantity,
+		set<data::QuantityFlag>(), property_->unit(), property_->digits(),
+		property_->decimal_places());
+	planned_channel_->push_sample(value, planned_timestamp, quantity,
+		set<data::QuantityFlag>(), property_->unit(), property_->digits(),
+		property_->decimal_places());
+	// The timing error is in ms, the channel is in s.
+	timing_error_channel_->push_sample(timing_error / 1000.,
+		actual_timestamp, data::Quantity::Time, set<data::QuantityFlag>(),
+		data::Unit::Second, 7, 6);
+
+	if (step < sequence_rows_.size())
+		sequence_table_->selectRow(sequence_rows_[step]);
+	timing_label_->setText(tr("Timing error: %1 ms (max. %2 ms)").
+		arg(timing_error, 0, 'f', 3).
+		arg(sequencer_->max_timing_error(), 0, 'f', 3));
+}
 
-	property_->change_value(value);
-	timer_->setInterval(delay_ms);
+void SequenceOutputView::on_sequence_finished()
+{
+	// A finish signal of a previous run may arrive after a restart.
+	if (!sequencer_->is_running())
+		update_run_action(false);
 }
 
 void SequenceOutputView::on_repeat_infinite_changed()
@@ -356,9 +401,9 @@ void SequenceOutputView::on_repeat_infinite_changed()
 void SequenceOutputView::on_action_run_triggered()
 {
 	if (action_run_->isChecked())
-		start_timer();
+		start_sequence();
 	else
-		stop_timer();
+		stop_sequence();
 }
 
 void SequenceOutputView::on_action_add_row()
@@ -21,33 +21,45 @@
 #define UI_VIEWS_SEQUENCEOUTPUTVIEW_HPP
 
 #include <memory>
+#include <vector>
 
 #include <QAction>
 #include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
 #include <QLocale>
 #include <QSpinBox>
 #include <QString>
 #include <QStringList>
 #include <QStyledItemDelegate>
 #include <QTableWidget>
-#include <QTimer>
 #include <QToolBar>
 #include <QVariant>
 
 #include "src/ui/views/baseview.hpp"
 
 using std::shared_ptr;
+using std::vector;
 
 namespace sv {
 
 class Session;
 
+namespace channels {
+class UserChannel;
+}
+
 namespace data {
 namespace properties {
 class DoubleProperty;
 }
 }
 
+namespace devices {
+class Sequencer;
+class UserDevice;
+}
+
 namespace ui {
 namespace views {
 
@@ -99,22 +111,37 @@ private:
 	QAction *const action_load_from_file_;
 	QAction *const action_generate_waveform_;
 	QToolBar *toolbar_;
-	QTimer *timer_;
 	QCheckBox *repeat_infinite_box_;
 	QSpinBox *repeat_count_box_;
+	QComboBox *catch_up_box_;
 	QTableWidget *sequence_table_;
-	int sequence_pos_;
-	int sequence_reperat_count_;
+	QLabel *timing_label_;
+	shared_ptr<sv::devices::Sequencer> sequencer_;
+	/** Maps the sequencer steps to the rows of the sequence table. */
+	vector<int> sequence_rows_;
+	/**
+	 * The executed steps are recorded into user channels, so the timing
+	 * can be plotted and saved: The set values at the actual and at the
+	 * planned timestamps and the timing error of each step.
+	 */
+	shared_ptr<sv::devices::UserDevice> result_device_;
+	shared_ptr<sv::channels::UserChannel> actual_channel_;
+	shared_ptr<sv::channels::UserChannel> planned_channel_;
+	shared_ptr<sv::channels::UserChannel> timing_error_channel_;
 
 	void setup_ui();
 	void setup_toolbar();
-	void start_timer();
-	void stop_timer();
+	void init_result_channels();
+	void start_sequence();
+	void stop_sequence();
+	void update_run_action(bool running);
 	void insert_row(int row, double value, double delay);
 	QStringList parse_csv_line(QString line);
 
 private Q_SLOTS:
-	void on_timer_update();
+	void on_step_executed(unsigned int step, double value,
+		double planned_timestamp, double actual_timestamp, double timing_error);
+	void on_sequence_finished();
 	void on_repeat_infinite_changed();
 	void on_action_run_triggered();
 	void on_action_add_row();
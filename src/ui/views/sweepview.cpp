@@ -0,0 +1,276 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+
+#include <QAction>
+#include <QDebug>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QListWidget>
+#include <QListWidgetItem>
+#include <QString>
+#include <QToolBar>
+#include <QVBoxLayout>
+
+#include "sweepview.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/sweepengine.hpp"
+#include "src/devices/userdevice.hpp"
+#include "src/ui/dialogs/selectsignaldialog.hpp"
+
+using std::dynamic_pointer_cast;
+using std::make_shared;
+using std::shared_ptr;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+SweepView::SweepView(Session &session,
+		shared_ptr<sv::data::properties::DoubleProperty> property,
+		QWidget *parent) :
+	BaseView(session, parent),
+	property_(property),
+	action_run_(new QAction(this)),
+	action_add_signal_(new QAction(this)),
+	action_remove_signal_(new QAction(this))
+{
+	assert(property_);
+	id_ = "sweep:" + property_->name();
+
+	setup_ui();
+	setup_toolbar();
+}
+
+SweepView::~SweepView()
+{
+	if (sweep_engine_)
+		sweep_engine_->stop();
+}
+
+QString SweepView::title() const
+{
+	return tr("Sweep") + " " + property_->display_name();
+}
+
+void SweepView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	QFormLayout *form_layout = new QFormLayout();
+	start_box_ = new QDoubleSpinBox();
+	start_box_->setRange(property_->min(), property_->max());
+	start_box_->setSingleStep(property_->step());
+	start_box_->setDecimals(property_->decimal_places());
+	start_box_->setValue(property_->min());
+	form_layout->addRow(tr("Start"), start_box_);
+	stop_box_ = new QDoubleSpinBox();
+	stop_box_->setRange(property_->min(), property_->max());
+	stop_box_->setSingleStep(property_->step());
+	stop_box_->setDecimals(property_->decimal_places());
+	stop_box_->setValue(property_->max());
+	form_layout->addRow(tr("Stop"), stop_box_);
+	step_box_ = new QDoubleSpinBox();
+	step_box_->setRange(property_->step(), property_->max() - property_->min());
+	step_box_->setSingleStep(property_->step());
+	step_box_->setDecimals(property_->decimal_places());
+	step_box_->setValue(property_->step());
+	form_layout->addRow(tr("Step"), step_box_);
+
+	abs_tolerance_box_ = new QDoubleSpinBox();
+	abs_tolerance_box_->setRange(0, 1000000);
+	abs_tolerance_box_->setDecimals(6);
+	abs_tolerance_box_->setSingleStep(0.001);
+	abs_tolerance_box_->setValue(0.001);
+	form_layout->addRow(tr("Abs. tolerance"), abs_tolerance_box_);
+	rel_tolerance_box_ = new QDoubleSpinBox();
+	rel_tolerance_box_->setRange(0, 100);
+	rel_tolerance_box_->setDecimals(3);
+	rel_tolerance_box_->setSingleStep(0.01);
+	rel_tolerance_box_->setValue(0.1);
+	rel_tolerance_box_->setSuffix(" %");
+	form_layout->addRow(tr("Rel. tolerance"), rel_tolerance_box_);
+	window_box_ = new QDoubleSpinBox();
+	window_box_->setRange(0, 3600);
+	window_box_->setDecimals(3);
+	window_box_->setSingleStep(0.1);
+	window_box_->setValue(0.5);
+	window_box_->setSuffix(" s");
+	form_layout->addRow(tr("Settling window"), window_box_);
+	timeout_box_ = new QDoubleSpinBox();
+	timeout_box_->setRange(0, 3600);
+	timeout_box_->setDecimals(1);
+	timeout_box_->setValue(10);
+	timeout_box_->setSuffix(" s");
+	form_layout->addRow(tr("Timeout"), timeout_box_);
+	layout->addLayout(form_layout);
+
+	layout->addWidget(new QLabel(tr("Signals")));
+	signal_list_ = new QListWidget();
+	layout->addWidget(signal_list_);
+
+	status_label_ = new QLabel();
+	layout->addWidget(status_label_);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void SweepView::setup_toolbar()
+{
+	update_run_action(false);
+	action_run_->setCheckable(true);
+	connect(action_run_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_run_triggered()));
+
+	action_add_signal_->setText(tr("Add signal"));
+	action_add_signal_->setIcon(
+		QIcon::fromTheme("office-chart-line-stacked",
+		QIcon(":/icons/office-chart-line-stacked.png")));
+	connect(action_add_signal_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_add_signal_triggered()));
+
+	action_remove_signal_->setText(tr("Remove signal"));
+	action_remove_signal_->setIcon(
+		QIcon::fromTheme("edit-delete",
+		QIcon(":/icons/edit-delete.png")));
+	connect(action_remove_signal_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_remove_signal_triggered()));
+
+	toolbar_ = new QToolBar("Sweep Toolbar");
+	toolbar_->addAction(action_run_);
+	toolbar_->addSeparator();
+	toolbar_->addAction(action_add_signal_);
+	toolbar_->addAction(action_remove_signal_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void SweepView::start_sweep()
+{
+	if (!result_device_)
+		result_device_ = session_.add_user_device();
+
+	// A new engine is needed, when the signals have changed, because the
+	// result channels depend on the signals.
+	if (!sweep_engine_ || sweep_engine_->signals() != signals_) {
+		sweep_engine_ = make_shared<sv::devices::SweepEngine>(
+			property_, result_device_);
+		for (const auto &signal : signals_)
+			sweep_engine_->add_signal(signal);
+		connect(sweep_engine_.get(), &sv::devices::SweepEngine::step_finished,
+			this, &SweepView::on_step_finished);
+		connect(sweep_engine_.get(), &sv::devices::SweepEngine::sweep_finished,
+			this, &SweepView::on_sweep_finished);
+	}
+
+	sweep_engine_->set_range(
+		start_box_->value(), stop_box_->value(), step_box_->value());
+	sweep_engine_->set_settling(abs_tolerance_box_->value(),
+		rel_tolerance_box_->value() / 100., window_box_->value(),
+		timeout_box_->value());
+	sweep_engine_->start();
+
+	status_label_->setText(tr("Running..."));
+	update_run_action(true);
+}
+
+void SweepView::stop_sweep()
+{
+	if (sweep_engine_)
+		sweep_engine_->stop();
+	update_run_action(false);
+}
+
+void SweepView::update_run_action(bool running)
+{
+	if (running) {
+		action_run_->setText(tr("Stop"));
+		action_run_->setIcon(
+			QIcon::fromTheme("media-playback-stop",
+			QIcon(":/icons/media-playback-stop.png")));
+	}
+	else {
+		action_run_->setText(tr("Run sweep"));
+		action_run_->setIcon(
+			QIcon::fromTheme("media-playback-start",
+			QIcon(":/icons/media-playback-start.png")));
+	}
+	action_run_->setChecked(running);
+	action_add_signal_->setDisabled(running);
+	action_remove_signal_->setDisabled(running);
+}
+
+void SweepView::on_action_run_triggered()
+{
+	if (action_run_->isChecked())
+		start_sweep();
+	else
+		stop_sweep();
+}
+
+void SweepView::on_action_add_signal_triggered()
+{
+	ui::dialogs::SelectSignalDialog dlg(session(), nullptr);
+	if (!dlg.exec())
+		return;
+
+	for (const auto &signal : dlg.signals()) {
+		auto a_signal = dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
+		if (!a_signal || std::find(signals_.begin(), signals_.end(),
+				a_signal) != signals_.end())
+			continue;
+		signals_.push_back(a_signal);
+		signal_list_->addItem(a_signal->display_name());
+	}
+}
+
+void SweepView::on_action_remove_signal_triggered()
+{
+	int row = signal_list_->currentRow();
+	if (row < 0 || row >= (int)signals_.size())
+		return;
+	signals_.erase(signals_.begin() + row);
+	delete signal_list_->takeItem(row);
+}
+
+void SweepView::on_step_finished(unsigned int step, double setpoint,
+	bool settled)
+{
+	QString status = tr("Step %1: %2").arg(step + 1).
+		arg(property_->to_string(setpoint));
+	if (!settled)
+		status.append(" ").append(tr("(not settled)"));
+	status_label_->setText(status);
+}
+
+void SweepView::on_sweep_finished()
+{
+	status_label_->setText(status_label_->text() + " - " + tr("finished"));
+	update_run_action(false);
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
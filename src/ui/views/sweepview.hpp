@@ -0,0 +1,106 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_SWEEPVIEW_HPP
+#define UI_VIEWS_SWEEPVIEW_HPP
+
+#include <memory>
+#include <vector>
+
+#include <QAction>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QListWidget>
+#include <QToolBar>
+
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+namespace properties {
+class DoubleProperty;
+}
+}
+
+namespace devices {
+class SweepEngine;
+class UserDevice;
+}
+
+namespace ui {
+namespace views {
+
+class SweepView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	SweepView(Session& session,
+		shared_ptr<sv::data::properties::DoubleProperty> property,
+		QWidget* parent = nullptr);
+	~SweepView();
+
+	QString title() const override;
+
+private:
+	shared_ptr<sv::data::properties::DoubleProperty> property_;
+	shared_ptr<sv::devices::UserDevice> result_device_;
+	shared_ptr<sv::devices::SweepEngine> sweep_engine_;
+	vector<shared_ptr<sv::data::AnalogTimeSignal>> signals_;
+	QAction *const action_run_;
+	QAction *const action_add_signal_;
+	QAction *const action_remove_signal_;
+	QToolBar *toolbar_;
+	QDoubleSpinBox *start_box_;
+	QDoubleSpinBox *stop_box_;
+	QDoubleSpinBox *step_box_;
+	QDoubleSpinBox *abs_tolerance_box_;
+	QDoubleSpinBox *rel_tolerance_box_;
+	QDoubleSpinBox *window_box_;
+	QDoubleSpinBox *timeout_box_;
+	QListWidget *signal_list_;
+	QLabel *status_label_;
+
+	void setup_ui();
+	void setup_toolbar();
+	void start_sweep();
+	void stop_sweep();
+	void update_run_action(bool running);
+
+private Q_SLOTS:
+	void on_action_run_triggered();
+	void on_action_add_signal_triggered();
+	void on_action_remove_signal_triggered();
+	void on_step_finished(unsigned int step, double setpoint, bool settled);
+	void on_sweep_finished();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_SWEEPVIEW_HPP
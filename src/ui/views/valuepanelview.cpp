@@ -21,6 +21,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QApplication>
 #include <QDateTime>
@@ -33,10 +34,13 @@
 #include "src/channels/basechannel.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/ui/widgets/displayscheduler.hpp"
 #include "src/ui/widgets/monofontdisplay.hpp"
+#include "src/ui/widgets/refreshintervalbutton.hpp"
 
 using std::dynamic_pointer_cast;
 using std::set;
+using std::vector;
 
 namespace sv {
 namespace ui {
@@ -49,6 +53,8 @@ ValuePanelView::ValuePanelView(Session &session,
 	channel_(channel),
 	unit_(""),
 	unit_suffix_(""),
+	refresh_interval_(250),
+	last_sample_count_(0),
 	value_min_(std::numeric_limits<double>::max()),
 	value_max_(std::numeric_limits<double>::lowest()),
 	action_reset_display_(new QAction(this))
@@ -81,7 +87,6 @@ ValuePanelView::ValuePanelView(Session &session,
 	connect(channel_.get(), SIGNAL(signal_changed(shared_ptr<sv::data::BaseSignal>)),
 		this, SLOT(on_signal_changed()));
 
-	timer_ = new QTimer(this);
 	init_timer();
 }
 
@@ -93,6 +98,8 @@ ValuePanelView::ValuePanelView(Session& session,
 	signal_(signal),
 	unit_(""),
 	unit_suffix_(""),
+	refresh_interval_(250),
+	last_sample_count_(0),
 	value_min_(std::numeric_limits<double>::max()),
 	value_max_(std::numeric_limits<double>::lowest()),
 	action_reset_display_(new QAction(this))
@@ -110,7 +117,6 @@ ValuePanelView::ValuePanelView(Session& session,
 	connect_signals_displays();
 	reset_display();
 
-	timer_ = new QTimer(this);
 	init_timer();
 }
 
@@ -197,8 +203,14 @@ void ValuePanelView::setup_toolbar()
 	connect(action_reset_display_, SIGNAL(triggered(bool)),
 		this, SLOT(on_action_reset_display_triggered()));
 
+	refresh_interval_button_ =
+		new widgets::RefreshIntervalButton(refresh_interval_);
+	connect(refresh_interval_button_, SIGNAL(interval_changed(int)),
+		this, SLOT(on_refresh_interval_changed(int)));
+
 	toolbar_ = new QToolBar("Panel Toolbar");
 	toolbar_->addAction(action_reset_display_);
+	toolbar_->addWidget(refresh_interval_button_);
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
 }
 
@@ -239,26 +251,45 @@ void ValuePanelView::init_timer()
 {
 	value_min_ = std::numeric_limits<double>::max();
 	value_max_ = std::numeric_limits<double>::lowest();
+	last_sample_count_ = 0;
 
-	connect(timer_, SIGNAL(timeout()), this, SLOT(on_update()));
-	timer_->start(250);
+	session_.display_scheduler()->add_display(
+		this, refresh_interval_, [this]() { on_update(); },
+		[this]() {
+			return vector<shared_ptr<sv::data::AnalogTimeSignal>>{ signal_ };
+		});
 }
 
 void ValuePanelView::stop_timer()
 {
-	if (!timer_->isActive())
+	if (!session_.display_scheduler()->has_display(this))
 		return;
 
-	timer_->stop();
-	disconnect(timer_, SIGNAL(timeout()), this, SLOT(on_update()));
+	session_.display_scheduler()->remove_display(this);
 
 	reset_display();
 }
 
+void ValuePanelView::set_refresh_interval(int refresh_interval)
+{
+	refresh_interval_ = refresh_interval;
+	refresh_interval_button_->set_interval(refresh_interval_);
+	session_.display_scheduler()->set_interval(this, refresh_interval_);
+}
+
+int ValuePanelView::refresh_interval() const
+{
+	return refresh_interval_;
+}
+
 void ValuePanelView::on_update()
 {
 	if (!signal_ || signal_->sample_count() == 0)
 		return;
+	// Nothing to do, when there is no new sample.
+	if (signal_->sample_count() == last_sample_count_)
+		return;
+	last_sample_count_ = signal_->sample_count();
 
 	double value = 0;
 	if (signal_) {
@@ -290,6 +321,7 @@ void ValuePanelView::on_signal_changed()
 	setup_unit();
 	digits_ = signal_->digits();
 	decimal_places_ = signal_->decimal_places();
+	last_sample_count_ = 0;
 
 	value_display_->set_unit(unit_);
 	value_display_->set_unit_suffix(unit_suffix_);
@@ -320,6 +352,11 @@ void ValuePanelView::on_action_reset_display_triggered()
 	init_timer();
 }
 
+void ValuePanelView::on_refresh_interval_changed(int interval)
+{
+	set_refresh_interval(interval);
+}
+
 } // namespace views
 } // namespace ui
 } // namespace sv
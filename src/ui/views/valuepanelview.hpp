@@ -25,7 +25,6 @@
 
 #include <QAction>
 #include <QString>
-#include <QTimer>
 #include <QToolBar>
 
 #include "src/data/datautil.hpp"
@@ -48,6 +47,7 @@ class AnalogTimeSignal;
 namespace ui {
 
 namespace widgets {
+class RefreshIntervalButton;
 class ValueDisplay;
 }
 
@@ -70,6 +70,10 @@ public:
 
 	QString title() const override;
 
+	/** Set the refresh interval of the displays in ms. */
+	void set_refresh_interval(int refresh_interval);
+	int refresh_interval() const;
+
 private:
 	shared_ptr<channels::BaseChannel> channel_;
 	shared_ptr<sv::data::AnalogTimeSignal> signal_;
@@ -81,7 +85,8 @@ private:
 	int digits_;
 	int decimal_places_;
 
-	QTimer *timer_;
+	int refresh_interval_;
+	size_t last_sample_count_;
 
 	// Min/max/actual values are stored here, so they can be reseted
 	double value_min_;
@@ -89,6 +94,7 @@ private:
 
 	QAction *const action_reset_display_;
 	QToolBar *toolbar_;
+	widgets::RefreshIntervalButton *refresh_interval_button_;
 	widgets::ValueDisplay *value_display_;
 	widgets::ValueDisplay *value_min_display_;
 	widgets::ValueDisplay *value_max_display_;
@@ -106,6 +112,7 @@ private Q_SLOTS:
 	void on_update();
 	void on_signal_changed();
 	void on_action_reset_display_triggered();
+	void on_refresh_interval_changed(int interval);
 
 };
 
@@ -0,0 +1,179 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimerEvent>
+#include <QWidget>
+
+#include "displayscheduler.hpp"
+
+using std::function;
+using std::set;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+
+namespace {
+// Lower limit for the tick interval in ms.
+const int min_tick_interval = 20;
+}
+
+DisplayScheduler::DisplayScheduler(QObject *parent) :
+	QObject(parent),
+	tick_interval_(0),
+	timer_id_(-1)
+{
+	clock_.start();
+}
+
+void DisplayScheduler::add_display(QWidget *widget, int interval,
+	function<void()> update,
+	function<vector<shared_ptr<sv::data::AnalogTimeSignal>>()>
+		displayed_signals)
+{
+	auto it = find_display(widget);
+	if (it != displays_.end())
+		displays_.erase(it);
+
+	Display display;
+	display.widget = widget;
+	display.interval = std::max(interval, min_tick_interval);
+	display.next_update = clock_.elapsed() + display.interval;
+	display.update = update;
+	display.displayed_signals = displayed_signals;
+	displays_.push_back(display);
+	restart_timer();
+}
+
+void DisplayScheduler::remove_display(QWidget *widget)
+{
+	auto it = find_display(widget);
+	if (it == displays_.end())
+		return;
+
+	displays_.erase(it);
+	restart_timer();
+}
+
+bool DisplayScheduler::has_display(QWidget *widget) const
+{
+	for (const auto &display : displays_) {
+		if (display.widget == widget)
+			return true;
+	}
+	return false;
+}
+
+void DisplayScheduler::set_interval(QWidget *widget, int interval)
+{
+	auto it = find_display(widget);
+	if (it == displays_.end())
+		return;
+
+	it->interval = std::max(interval, min_tick_interval);
+	it->next_update = clock_.elapsed() + it->interval;
+	restart_timer();
+}
+
+vector<DisplayScheduler::Display>::iterator DisplayScheduler::find_display(
+	const QWidget *widget)
+{
+	return std::find_if(displays_.begin(), displays_.end(),
+		[widget](const Display &display) { return display.widget == widget; });
+}
+
+void DisplayScheduler::restart_timer()
+{
+	// The timer ticks with the shortest refresh interval of all displays.
+	int tick_interval = 0;
+	for (const auto &display : displays_) {
+		if (tick_interval == 0 || display.interval < tick_interval)
+			tick_interval = display.interval;
+	}
+	if (tick_interval == tick_interval_ && (timer_id_ >= 0) == !displays_.empty())
+		return;
+
+	if (timer_id_ >= 0) {
+		killTimer(timer_id_);
+		timer_id_ = -1;
+	}
+	tick_interval_ = tick_interval;
+	// Don't wake up when there is nothing to do.
+	if (!displays_.empty())
+		timer_id_ = startTimer(tick_interval_);
+}
+
+bool DisplayScheduler::is_visible_on_screen(const QWidget *widget)
+{
+	return widget->isVisible() && !widget->window()->isMinimized() &&
+		!widget->visibleRegion().isEmpty();
+}
+
+void DisplayScheduler::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() != timer_id_) {
+		QObject::timerEvent(event);
+		return;
+	}
+
+	// Displays that are due within half a tick are refreshed now, so
+	// displays with the same interval stay in the same tick.
+	const qint64 now = clock_.elapsed();
+	const qint64 due_time = now + tick_interval_ / 2;
+
+	// An update can't remove a display, but be defensive anyway.
+	const vector<Display> displays = displays_;
+	set<shared_ptr<sv::data::AnalogTimeSignal>> updated_signals;
+	for (const auto &display : displays) {
+		if (display.next_update > due_time)
+			continue;
+
+		auto it = find_display(display.widget);
+		if (it == displays_.end())
+			continue;
+		it->next_update += it->interval;
+		if (it->next_update <= now)
+			it->next_update = now + it->interval;
+
+		if (is_visible_on_screen(display.widget)) {
+			display.update();
+			for (const auto &signal : display.displayed_signals()) {
+				if (signal)
+					updated_signals.insert(signal);
+			}
+		}
+	}
+
+	if (!updated_signals.empty())
+		Q_EMIT displays_updated(updated_signals);
+}
+
+} // namespace widgets
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,109 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_DISPLAYSCHEDULER_HPP
+#define UI_WIDGETS_DISPLAYSCHEDULER_HPP
+
+#include <functional>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimerEvent>
+#include <QWidget>
+
+using std::function;
+using std::set;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace ui {
+namespace widgets {
+
+/**
+ * The DisplayScheduler refreshes the value displays of all panels with a
+ * single timer. All panels that are due are refreshed in the same tick, so
+ * Qt can paint them together. Panels that aren't visible on screen are
+ * skipped.
+ */
+class DisplayScheduler : public QObject
+{
+	Q_OBJECT
+
+public:
+	DisplayScheduler(QObject *parent = nullptr);
+
+	/**
+	 * Register a display widget. The update function is called every
+	 * interval ms, as long as the widget is visible. displayed_signals
+	 * returns the signals, that are shown by the widget.
+	 */
+	void add_display(QWidget *widget, int interval, function<void()> update,
+		function<vector<shared_ptr<sv::data::AnalogTimeSignal>>()>
+			displayed_signals);
+	void remove_display(QWidget *widget);
+	bool has_display(QWidget *widget) const;
+	/** Set the refresh interval in ms of a registered display widget. */
+	void set_interval(QWidget *widget, int interval);
+
+protected:
+	void timerEvent(QTimerEvent *event) override;
+
+private:
+	struct Display {
+		QWidget *widget;
+		int interval;
+		qint64 next_update;
+		function<void()> update;
+		function<vector<shared_ptr<sv::data::AnalogTimeSignal>>()>
+			displayed_signals;
+	};
+
+	static bool is_visible_on_screen(const QWidget *widget);
+	vector<Display>::iterator find_display(const QWidget *widget);
+	void restart_timer();
+
+	vector<Display> displays_;
+	QElapsedTimer clock_;
+	int tick_interval_;
+	int timer_id_;
+
+Q_SIGNALS:
+	/**
+	 * Is emitted after a tick, that has refreshed at least one display,
+	 * with the signals of the refreshed displays.
+	 */
+	void displays_updated(
+		const set<shared_ptr<sv::data::AnalogTimeSignal>> &signals);
+
+};
+
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_DISPLAYSCHEDULER_HPP
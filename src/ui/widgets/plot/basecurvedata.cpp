@@ -98,6 +98,26 @@ QColor BaseCurveData::color() const
 	*/
 }
 
+bool BaseCurveData::visible_range(double x_min, double x_max,
+	size_t &first, size_t &last) const
+{
+	(void)x_min;
+	(void)x_max;
+	(void)first;
+	(void)last;
+	return false;
+}
+
+bool BaseCurveData::y_range(double x_min, double x_max,
+	double &y_min, double &y_max) const
+{
+	(void)x_min;
+	(void)x_max;
+	(void)y_min;
+	(void)y_max;
+	return false;
+}
+
 void BaseCurveData::set_relative_time(bool is_relative_time)
 {
 	relative_time_ = is_relative_time;
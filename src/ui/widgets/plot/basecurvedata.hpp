@@ -20,7 +20,9 @@
 #ifndef UI_WIDGETS_PLOT_BASECURVEDATA_HPP
 #define UI_WIDGETS_PLOT_BASECURVEDATA_HPP
 
+#include <memory>
 #include <set>
+#include <vector>
 
 #include <QColor>
 #include <QPointF>
@@ -31,8 +33,15 @@
 #include "src/data/datautil.hpp"
 
 using std::set;
+using std::shared_ptr;
+using std::vector;
 
 namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
 namespace ui {
 namespace widgets {
 namespace plot {
@@ -60,6 +69,21 @@ public:
 	virtual size_t size() const = 0;
 	virtual QRectF boundingRect() const = 0;
 
+	/**
+	 * Get the range of sample indices that is needed to draw the curve
+	 * between x_min and x_max, including the adjacent samples outside of
+	 * this interval. Returns false if the range can't be determined
+	 * (e.g. the x values are not ordered) and all samples must be drawn.
+	 */
+	virtual bool visible_range(double x_min, double x_max,
+		size_t &first, size_t &last) const;
+	/**
+	 * Get the min and max y value of the samples between x_min and x_max.
+	 * Returns false if there are no samples or this is not supported.
+	 */
+	virtual bool y_range(double x_min, double x_max,
+		double &y_min, double &y_max) const;
+
 	virtual QPointF closest_point(const QPointF &pos, double *dist) const = 0;
 	virtual QString name() const = 0;
 	virtual sv::data::Quantity x_quantity() const = 0;
@@ -72,6 +96,9 @@ public:
 	virtual sv::data::Unit y_unit() const = 0;
 	virtual QString y_unit_str() const = 0;
 	virtual QString y_title() const = 0;
+	/** The signals the curve is drawn from. */
+	virtual vector<shared_ptr<sv::data::AnalogTimeSignal>> curve_signals()
+		const = 0;
 
 protected:
 	const CurveType curve_type_;
@@ -0,0 +1,293 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#include <QImage>
+#include <QPainter>
+#include <QPen>
+#include <QPointF>
+#include <QPolygonF>
+#include <QRectF>
+#include <QRunnable>
+#include <QSize>
+#include <QThreadPool>
+#include <QVector>
+#include <qwt_scale_map.h>
+#include <qwt_series_data.h>
+
+#include "curverenderer.hpp"
+
+using std::lock_guard;
+using std::unique_lock;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+bool CurveLayerKey::operator==(const CurveLayerKey &other) const
+{
+	return x_s1 == other.x_s1 && x_s2 == other.x_s2 &&
+		x_p1 == other.x_p1 && x_p2 == other.x_p2 &&
+		y_s1 == other.y_s1 && y_s2 == other.y_s2 &&
+		y_p1 == other.y_p1 && y_p2 == other.y_p2 &&
+		is_linear == other.is_linear && origin == other.origin &&
+		size == other.size;
+}
+
+bool CurveLayerKey::operator!=(const CurveLayerKey &other) const
+{
+	return !(*this == other);
+}
+
+class CurveRenderer::RenderTask : public QRunnable
+{
+public:
+	RenderTask(CurveRenderer *renderer, const Job &job) :
+		renderer_(renderer),
+		job_(job)
+	{
+	}
+
+	void run() override
+	{
+		renderer_->run_job(job_);
+	}
+
+private:
+	CurveRenderer *renderer_;
+	const Job job_;
+};
+
+CurveRenderer::CurveRenderer(const QwtSeriesData<QPointF> *series_data) :
+	series_data_(series_data),
+	is_running_(false),
+	has_pending_job_(false),
+	cancel_(false),
+	has_layer_(false),
+	layer_last_(0)
+{
+}
+
+CurveRenderer::~CurveRenderer()
+{
+	cancel_ = true;
+	unique_lock<mutex> lock(mutex_);
+	has_pending_job_ = false;
+	finished_cv_.wait(lock, [this] { return !is_running_; });
+}
+
+CurveLayerKey CurveRenderer::create_key(const QwtScaleMap &x_map,
+	const QwtScaleMap &y_map, const QRectF &canvas_rect)
+{
+	CurveLayerKey key;
+	key.x_s1 = x_map.s1();
+	key.x_s2 = x_map.s2();
+	key.x_p1 = x_map.p1();
+	key.x_p2 = x_map.p2();
+	key.y_s1 = y_map.s1();
+	key.y_s2 = y_map.s2();
+	key.y_p1 = y_map.p1();
+	key.y_p2 = y_map.p2();
+	key.is_linear = !x_map.transformation() && !y_map.transformation();
+	key.origin = canvas_rect.topLeft();
+	key.size = canvas_rect.size().toSize();
+	return key;
+}
+
+bool CurveRenderer::remap_layer(const CurveLayerKey &key,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map, QRectF &rect)
+{
+	if (!key.is_linear || x_map.transformation() || y_map.transformation())
+		return false;
+
+	double left = key.origin.x();
+	double right = key.origin.x() + key.size.width();
+	double top = key.origin.y();
+	double bottom = key.origin.y() + key.size.height();
+	if (!remap_interval(key.x_s1, key.x_s2, key.x_p1, key.x_p2, x_map,
+			left, right) ||
+			!remap_interval(key.y_s1, key.y_s2, key.y_p1, key.y_p2, y_map,
+			top, bottom))
+		return false;
+
+	rect = QRectF(QPointF(left, top), QPointF(right, bottom));
+	return true;
+}
+
+bool CurveRenderer::remap_interval(double s1, double s2, double p1, double p2,
+	const QwtScaleMap &map, double &pos1, double &pos2)
+{
+	if (p1 == p2 || s1 == s2)
+		return false;
+
+	// Paint position -> scale value with the old linear map -> paint position
+	// with the current map.
+	const double factor = (s2 - s1) / (p2 - p1);
+	pos1 = map.transform(s1 + (pos1 - p1) * factor);
+	pos2 = map.transform(s1 + (pos2 - p1) * factor);
+	return true;
+}
+
+void CurveRenderer::request(const CurveLayerKey &key,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+	size_t first, size_t last, const QPen &pen, bool antialiasing)
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		// Don't queue the same job twice.
+		if (is_running_ && running_job_.key == key &&
+				running_job_.last >= last) {
+			has_pending_job_ = false;
+			return;
+		}
+	}
+
+	const size_t size = series_data_->size();
+	if (size == 0)
+		return;
+	last = std::min(last, size - 1);
+
+	Job job;
+	job.key = key;
+	job.x_map = x_map;
+	job.y_map = y_map;
+	// The series data is appended to by the acquisition while the worker
+	// is rendering, so the worker only gets a copy of the samples.
+	if (first <= last) {
+		job.samples.reserve((int)(last - first + 1));
+		for (size_t i = first; i <= last; ++i)
+			job.samples.append(series_data_->sample(i));
+	}
+	job.last = last;
+	job.pen = pen;
+	job.antialiasing = antialiasing;
+
+	lock_guard<mutex> lock(mutex_);
+	if (is_running_) {
+		pending_job_ = job;
+		has_pending_job_ = true;
+		return;
+	}
+	start_job(job);
+}
+
+bool CurveRenderer::layer(CurveLayerKey &key, QImage &image,
+	size_t &last) const
+{
+	lock_guard<mutex> lock(mutex_);
+	if (!has_layer_)
+		return false;
+
+	key = layer_key_;
+	image = layer_image_;
+	last = layer_last_;
+	return true;
+}
+
+void CurveRenderer::start_job(const Job &job)
+{
+	// The mutex must be locked by the caller.
+	is_running_ = true;
+	running_job_ = job;
+	QThreadPool::globalInstance()->start(new RenderTask(this, job));
+}
+
+void CurveRenderer::run_job(const Job &job)
+{
+	QImage image = render(job);
+
+	lock_guard<mutex> lock(mutex_);
+	if (!cancel_) {
+		layer_key_ = job.key;
+		layer_image_ = image;
+		layer_last_ = job.last;
+		has_layer_ = true;
+		Q_EMIT layer_ready();
+	}
+	if (has_pending_job_ && !cancel_) {
+		has_pending_job_ = false;
+		start_job(pending_job_);
+		return;
+	}
+	is_running_ = false;
+	finished_cv_.notify_all();
+}
+
+QImage CurveRenderer::render(const Job &job) const
+{
+	QImage image(job.key.size, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+
+	QPolygonF polyline;
+	int column = std::numeric_limits<int>::min();
+	double first_y = 0.;
+	double min_y = 0.;
+	double max_y = 0.;
+	double last_y = 0.;
+	auto add_column = [&]() {
+		polyline << QPointF(column, first_y);
+		if (min_y < max_y)
+			polyline << QPointF(column, min_y) << QPointF(column, max_y);
+		polyline << QPointF(column, last_y);
+	};
+
+	const int size = job.samples.size();
+	for (int i = 0; i < size; ++i) {
+		if ((i & 0xfff) == 0 && cancel_)
+			return QImage();
+
+		const QPointF &sample = job.samples.at(i);
+		const double x =
+			job.x_map.transform(sample.x()) - job.key.origin.x();
+		const double y =
+			job.y_map.transform(sample.y()) - job.key.origin.y();
+		const int x_column = (int)std::floor(x);
+		if (x_column != column) {
+			if (column != std::numeric_limits<int>::min())
+				add_column();
+			column = x_column;
+			first_y = min_y = max_y = last_y = y;
+		}
+		else {
+			min_y = std::min(min_y, y);
+			max_y = std::max(max_y, y);
+			last_y = y;
+		}
+	}
+	if (column != std::numeric_limits<int>::min())
+		add_column();
+
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing, job.antialiasing);
+	painter.setPen(job.pen);
+	painter.drawPolyline(polyline);
+	painter.end();
+
+	return image;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
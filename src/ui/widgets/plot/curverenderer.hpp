@@ -0,0 +1,149 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_CURVERENDERER_HPP
+#define UI_WIDGETS_PLOT_CURVERENDERER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include <QImage>
+#include <QObject>
+#include <QPen>
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <QVector>
+#include <qwt_scale_map.h>
+#include <qwt_series_data.h>
+
+using std::mutex;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+/**
+ * The geometry a curve layer has been rendered for.
+ */
+struct CurveLayerKey
+{
+	double x_s1, x_s2, x_p1, x_p2;
+	double y_s1, y_s2, y_p1, y_p2;
+	/** True if both maps have no (e.g. logarithmic) transformation. */
+	bool is_linear;
+	QPointF origin;
+	QSize size;
+
+	bool operator==(const CurveLayerKey &other) const;
+	bool operator!=(const CurveLayerKey &other) const;
+};
+
+/**
+ * The CurveRenderer renders a curve with ordered x values into a QImage
+ * layer in the global QThreadPool. The samples are decimated to min/max
+ * values per pixel column, so the layer costs O(columns) to draw, no matter
+ * how many samples are in the visible range. The layer_ready() signal is
+ * emitted when a new layer is available.
+ *
+ * The worker thread never touches the series data, the samples are copied
+ * in request(), which must be called from the GUI thread.
+ */
+class CurveRenderer : public QObject
+{
+	Q_OBJECT
+
+public:
+	CurveRenderer(const QwtSeriesData<QPointF> *series_data);
+	/** Cancels a running render job and waits for it. */
+	~CurveRenderer();
+
+	/**
+	 * Request a layer for the samples first to last. A pending request
+	 * is replaced, a running render job is finished first.
+	 */
+	void request(const CurveLayerKey &key,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		size_t first, size_t last, const QPen &pen, bool antialiasing);
+
+	/**
+	 * Get the last rendered layer. Returns false if there is no layer at
+	 * all. `last` is the index of the last sample in the layer.
+	 */
+	bool layer(CurveLayerKey &key, QImage &image, size_t &last) const;
+
+	static CurveLayerKey create_key(const QwtScaleMap &x_map,
+		const QwtScaleMap &y_map, const QRectF &canvas_rect);
+
+	/**
+	 * Get the rect, a layer rendered for `key` has to be drawn into, to
+	 * match the current maps. Returns false if the layer can't be remapped,
+	 * e.g. for logarithmic scales.
+	 */
+	static bool remap_layer(const CurveLayerKey &key,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map, QRectF &rect);
+
+private:
+	struct Job {
+		CurveLayerKey key;
+		QwtScaleMap x_map;
+		QwtScaleMap y_map;
+		/** The snapshot of the samples first to last. */
+		QVector<QPointF> samples;
+		size_t last;
+		QPen pen;
+		bool antialiasing;
+	};
+
+	class RenderTask;
+
+	void start_job(const Job &job);
+	void run_job(const Job &job);
+	QImage render(const Job &job) const;
+	static bool remap_interval(double s1, double s2, double p1, double p2,
+		const QwtScaleMap &map, double &pos1, double &pos2);
+
+	const QwtSeriesData<QPointF> *series_data_;
+
+	mutable mutex mutex_;
+	std::condition_variable finished_cv_;
+	bool is_running_;
+	Job running_job_;
+	bool has_pending_job_;
+	Job pending_job_;
+	std::atomic<bool> cancel_;
+
+	bool has_layer_;
+	CurveLayerKey layer_key_;
+	QImage layer_image_;
+	size_t layer_last_;
+
+Q_SIGNALS:
+	void layer_ready();
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_CURVERENDERER_HPP
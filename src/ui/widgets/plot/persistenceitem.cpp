@@ -0,0 +1,228 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <qwt_plot_item.h>
+#include <qwt_scale_map.h>
+#include <qwt_text.h>
+
+#include "persistenceitem.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+PersistenceItem::PersistenceItem(const QString &title, const QColor &color) :
+	QwtPlotItem(QwtText(title)),
+	color_(color),
+	width_(0),
+	height_(0),
+	max_hits_(0),
+	sweep_count_(0),
+	image_dirty_(false)
+{
+	setItemAttribute(QwtPlotItem::AutoScale, false);
+	setItemAttribute(QwtPlotItem::Legend, false);
+}
+
+int PersistenceItem::rtti() const
+{
+	return QwtPlotItem::Rtti_PlotUserItem;
+}
+
+QRectF PersistenceItem::boundingRect() const
+{
+	return rect_;
+}
+
+void PersistenceItem::reset(const QRectF &rect, int width, int height)
+{
+	rect_ = rect;
+	width_ = std::max(width, 1);
+	height_ = std::max(height, 1);
+	hits_.assign((size_t)width_ * height_, 0);
+	max_hits_ = 0;
+	sweep_count_ = 0;
+	image_ = QImage();
+	image_dirty_ = true;
+}
+
+void PersistenceItem::add_sweep(const BaseCurveData *curve_data,
+	double trigger_time)
+{
+	if (hits_.empty() || rect_.width() <= 0 || rect_.height() <= 0)
+		return;
+
+	size_t first;
+	size_t last;
+	if (!curve_data->visible_range(trigger_time + rect_.left(),
+			trigger_time + rect_.right(), first, last))
+		return;
+
+	const double x_scale = width_ / rect_.width();
+	const double y_scale = height_ / rect_.height();
+	// The last incremented cell, so the cell at the joint of two segments
+	// is only counted once per sweep.
+	size_t last_cell = std::numeric_limits<size_t>::max();
+	bool has_prev = false;
+	double prev_x = 0.;
+	double prev_y = 0.;
+	for (size_t i = first; i <= last; ++i) {
+		const QPointF sample = curve_data->sample(i);
+		if (!std::isfinite(sample.y())) {
+			has_prev = false;
+			continue;
+		}
+		// Buffer coordinates, row 0 is the top of the buffer.
+		const double x = (sample.x() - trigger_time - rect_.left()) * x_scale;
+		const double y = (rect_.bottom() - sample.y()) * y_scale;
+		if (has_prev)
+			add_line(prev_x, prev_y, x, y, last_cell);
+		prev_x = x;
+		prev_y = y;
+		has_prev = true;
+	}
+
+	++sweep_count_;
+	image_dirty_ = true;
+}
+
+void PersistenceItem::add_line(double x0, double y0, double x1, double y1,
+	size_t &last_cell)
+{
+	// Clip the segment to the buffer (Liang-Barsky), so segments far
+	// outside of the buffer don't produce lots of steps.
+	const double dx = x1 - x0;
+	const double dy = y1 - y0;
+	double t0 = 0.;
+	double t1 = 1.;
+	const double p[4] = { -dx, dx, -dy, dy };
+	const double q[4] = { x0, width_ - x0, y0, height_ - y0 };
+	for (int i = 0; i < 4; ++i) {
+		if (p[i] == 0.) {
+			if (q[i] < 0.)
+				return;
+			continue;
+		}
+		const double r = q[i] / p[i];
+		if (p[i] < 0.)
+			t0 = std::max(t0, r);
+		else
+			t1 = std::min(t1, r);
+		if (t0 > t1)
+			return;
+	}
+
+	const double cx0 = x0 + t0 * dx;
+	const double cy0 = y0 + t0 * dy;
+	const double cdx = (t1 - t0) * dx;
+	const double cdy = (t1 - t0) * dy;
+	const size_t steps =
+		(size_t)std::ceil(std::max(std::fabs(cdx), std::fabs(cdy))) + 1;
+	for (size_t s = 0; s <= steps; ++s) {
+		const double f = (double)s / steps;
+		const int col = std::min((int)(cx0 + f * cdx), width_ - 1);
+		const int row = std::min((int)(cy0 + f * cdy), height_ - 1);
+		if (col < 0 || row < 0)
+			continue;
+		const size_t cell = (size_t)row * width_ + col;
+		if (cell == last_cell)
+			continue;
+		last_cell = cell;
+		uint32_t &hits = hits_[cell];
+		if (hits < std::numeric_limits<uint32_t>::max())
+			++hits;
+		if (hits > max_hits_)
+			max_hits_ = hits;
+	}
+}
+
+void PersistenceItem::update_image() const
+{
+	if (!image_dirty_)
+		return;
+	image_dirty_ = false;
+
+	if (image_.width() != width_ || image_.height() != height_)
+		image_ = QImage(width_, height_, QImage::Format_ARGB32_Premultiplied);
+	image_.fill(0);
+	if (max_hits_ == 0)
+		return;
+
+	// Logarithmic intensity, so rare outliers are still visible. The color
+	// goes from the (transparent) curve color to white for the most hits.
+	const double log_max = std::log1p((double)max_hits_);
+	const int r = color_.red();
+	const int g = color_.green();
+	const int b = color_.blue();
+	for (int row = 0; row < height_; ++row) {
+		QRgb *line = reinterpret_cast<QRgb *>(image_.scanLine(row));
+		const uint32_t *hits_line = &hits_[(size_t)row * width_];
+		for (int col = 0; col < width_; ++col) {
+			if (hits_line[col] == 0)
+				continue;
+			const double intensity = std::log1p((double)hits_line[col]) / log_max;
+			const double white = intensity * intensity;
+			const int alpha = 64 + (int)(191 * intensity);
+			// Premultiplied alpha
+			line[col] = qRgba(
+				(int)((r + (255 - r) * white) * alpha / 255),
+				(int)((g + (255 - g) * white) * alpha / 255),
+				(int)((b + (255 - b) * white) * alpha / 255),
+				alpha);
+		}
+	}
+}
+
+void PersistenceItem::draw(QPainter *painter,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+	const QRectF &canvas_rect) const
+{
+	(void)canvas_rect;
+
+	if (hits_.empty())
+		return;
+	update_image();
+
+	const double left = x_map.transform(rect_.left());
+	const double right = x_map.transform(rect_.right());
+	const double top = y_map.transform(rect_.bottom());
+	const double bottom = y_map.transform(rect_.top());
+	painter->drawImage(QRectF(left, top, right - left, bottom - top), image_);
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
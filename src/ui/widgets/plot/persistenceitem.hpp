@@ -0,0 +1,95 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_PERSISTENCEITEM_HPP
+#define UI_WIDGETS_PLOT_PERSISTENCEITEM_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QRectF>
+#include <QString>
+#include <qwt_plot_item.h>
+#include <qwt_scale_map.h>
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class BaseCurveData;
+
+/**
+ * Persistence display for the triggered sweep mode: Every sweep of a curve
+ * is rasterized into a buffer of hit counts, that is drawn as an intensity
+ * map. Only new sweeps are added to the buffer, so the costs of an update
+ * don't depend on the number of accumulated sweeps.
+ *
+ * The x values of the buffer are relative to the trigger time.
+ */
+class PersistenceItem : public QwtPlotItem
+{
+
+public:
+	PersistenceItem(const QString &title, const QColor &color);
+
+	int rtti() const override;
+	QRectF boundingRect() const override;
+	void draw(QPainter *painter,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		const QRectF &canvas_rect) const override;
+
+	/**
+	 * Clear the buffer and set its value rect and resolution. The rect
+	 * should match the current axis intervals and the resolution the size
+	 * of the canvas.
+	 */
+	void reset(const QRectF &rect, int width, int height);
+	/** Rasterize the samples of the sweep triggered at trigger_time. */
+	void add_sweep(const BaseCurveData *curve_data, double trigger_time);
+	size_t sweep_count() const { return sweep_count_; }
+
+private:
+	void add_line(double x0, double y0, double x1, double y1,
+		size_t &last_cell);
+	void update_image() const;
+
+	const QColor color_;
+	QRectF rect_;
+	int width_;
+	int height_;
+	vector<uint32_t> hits_;
+	uint32_t max_hits_;
+	size_t sweep_count_;
+	mutable QImage image_;
+	mutable bool image_dirty_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_PERSISTENCEITEM_HPP
@@ -18,18 +18,24 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <map>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include <QBoxLayout>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QHBoxLayout>
 #include <QPen>
 #include <QPoint>
 #include <QPointF>
 #include <QPushButton>
+#include <QRect>
 #include <QRectF>
 #include <QSize>
 #include <QVBoxLayout>
@@ -48,14 +54,19 @@
 #include <qwt_plot_panner.h>
 #include <qwt_plot_picker.h>
 #include <qwt_scale_draw.h>
+#include <qwt_scale_engine.h>
 #include <qwt_scale_widget.h>
 #include <qwt_symbol.h>
 
 #include "plot.hpp"
+#include "src/tracer.hpp"
 #include "src/ui/dialogs/plotcurveconfigdialog.hpp"
 #include "src/ui/widgets/plot/axislocklabel.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/persistenceitem.hpp"
+#include "src/ui/widgets/plot/plotcurve.hpp"
 #include "src/ui/widgets/plot/plotmagnifier.hpp"
+#include "src/ui/widgets/plot/plotscheduler.hpp"
 #include "src/ui/widgets/plot/plotscalepicker.hpp"
 
 using std::make_pair;
@@ -123,11 +134,16 @@ private:
 	}
 };
 
-Plot::Plot(QWidget *parent) : QwtPlot(parent),
+Plot::Plot(shared_ptr<PlotScheduler> plot_scheduler, QWidget *parent) :
+	QwtPlot(parent),
+	plot_scheduler_(plot_scheduler),
+	needs_replot_(false),
 	plot_interval_(200),
-	timer_id_(-1),
+	update_mode_(PlotUpdateMode::Additive),
 	time_span_(120.),
 	add_time_(30.),
+	trigger_curve_data_(nullptr),
+	sweep_count_(0),
 	active_marker_(nullptr),
 	markers_label_(nullptr),
 	markers_label_alignment_(Qt::AlignBottom | Qt::AlignHCenter),
@@ -190,19 +206,70 @@ Plot::~Plot()
 
 void Plot::start()
 {
-	timer_id_ = startTimer(plot_interval_);
+	last_update_timer_.invalidate();
+	plot_scheduler_->add_plot(this);
 }
 
 void Plot::stop()
 {
 	//qWarning() << "Plot::stop() for " << curve_data_->name();
-	killTimer(timer_id_);
+	plot_scheduler_->remove_plot(this);
+}
+
+bool Plot::needs_update() const
+{
+	if (last_update_timer_.isValid() &&
+			last_update_timer_.elapsed() < plot_interval_)
+		return false;
+
+	return is_visible_on_screen() && (needs_replot_ || has_new_data());
+}
+
+void Plot::update_plot()
+{
+	if (update_mode_ == PlotUpdateMode::Triggered) {
+		update_sweeps();
+	}
+	else {
+		update_intervals();
+		update_curves();
+	}
+
+	for (const auto &curve_data : curve_datas_) {
+		updated_points_map_[curve_data] = curve_data->size();
+	}
+	// The plot may have been replotted already by update_intervals().
+	if (needs_replot_)
+		replot();
+	last_update_timer_.start();
+}
+
+bool Plot::is_visible_on_screen() const
+{
+	// Hidden plots (e.g. in a background tab of a dock area) and plots in a
+	// minimized window don't have to be painted. The plot is replotted
+	// anyway, when it is shown again.
+	return isVisible() && !window()->isMinimized() &&
+		!visibleRegion().isEmpty();
+}
+
+bool Plot::has_new_data() const
+{
+	for (const auto &curve_data : curve_datas_) {
+		auto it = updated_points_map_.find(curve_data);
+		if (it == updated_points_map_.end() ||
+				it->second != curve_data->size())
+			return true;
+	}
+	return false;
 }
 
 void Plot::replot()
 {
 	//qWarning() << "Plot::replot()";
+	SV_TRACE_SCOPE("plot", "replot");
 
+	needs_replot_ = false;
 	for (const auto &curve_data : curve_datas_) {
 		painted_points_map_[curve_data] = 0;
 	}
@@ -241,7 +308,7 @@ bool Plot::add_curve(widgets::plot::BaseCurveData *curve_data)
 	// Set empty symbol, used in the PlotCurveConfigDialog.
 	QwtSymbol *symbol = new QwtSymbol(QwtSymbol::NoSymbol);
 
-	QwtPlotCurve *plot_curve = new QwtPlotCurve(curve_data->name());
+	QwtPlotCurve *plot_curve = new PlotCurve(curve_data->name());
 	plot_curve->setYAxis(y_axis_id);
 	plot_curve->setXAxis(x_axis_id);
 	plot_curve->setStyle(QwtPlotCurve::Lines);
@@ -256,6 +323,11 @@ bool Plot::add_curve(widgets::plot::BaseCurveData *curve_data)
 	plot_curve->attach(this);
 	plot_curve_map_.insert(make_pair(curve_data, plot_curve));
 
+	if (update_mode_ == PlotUpdateMode::Triggered) {
+		plot_curve->setVisible(false);
+		add_persistence_item(curve_data);
+	}
+
 	QwtPlotDirectPainter *direct_painter = new QwtPlotDirectPainter();
 	plot_direct_painter_map_.insert(make_pair(curve_data, direct_painter));
 
@@ -461,6 +533,15 @@ void Plot::set_time_span(double time_span)
 {
 	time_span_ = time_span;
 
+	if (update_mode_ == PlotUpdateMode::Triggered) {
+		// The x axis shows the sweep relative to the trigger time.
+		sweep_trigger_.set_sweep_length(time_span_);
+		this->setAxisScale(QwtPlot::xBottom,
+			sweep_trigger_.sweep_start(), sweep_trigger_.sweep_end());
+		restart_sweeps();
+		return;
+	}
+
 	// time_span_ is used in rolling mode and oscilloscope mode. Find the
 	// last/highest x value/timestamp and use it to calculate the new
 	// x axis interval.
@@ -477,6 +558,173 @@ void Plot::set_time_span(double time_span)
 	this->replot();
 }
 
+void Plot::set_update_mode(PlotUpdateMode update_mode)
+{
+	if (update_mode == update_mode_)
+		return;
+
+	const bool was_triggered = update_mode_ == PlotUpdateMode::Triggered;
+	update_mode_ = update_mode;
+	if (update_mode_ == PlotUpdateMode::Triggered)
+		start_triggered_mode();
+	else if (was_triggered)
+		stop_triggered_mode();
+}
+
+void Plot::start_triggered_mode()
+{
+	for (const auto &curve_data : curve_datas_) {
+		plot_curve_map_[curve_data]->setVisible(false);
+		add_persistence_item(curve_data);
+	}
+
+	// The x values of the sweeps are relative to the trigger, so absolute
+	// timestamps can't be shown as dates.
+	if (!curve_datas_.empty() &&
+			curve_datas_[0]->curve_type() == CurveType::TimeCurve &&
+			!curve_datas_[0]->is_relative_time())
+		this->setAxisScaleEngine(QwtPlot::xBottom, new QwtLinearScaleEngine());
+
+	set_time_span(time_span_);
+}
+
+void Plot::stop_triggered_mode()
+{
+	for (const auto &item_pair : persistence_item_map_) {
+		item_pair.second->detach();
+		delete item_pair.second;
+	}
+	persistence_item_map_.clear();
+	sweep_count_ = 0;
+
+	for (const auto &curve_data : curve_datas_)
+		plot_curve_map_[curve_data]->setVisible(true);
+
+	if (!curve_datas_.empty() &&
+			curve_datas_[0]->curve_type() == CurveType::TimeCurve &&
+			!curve_datas_[0]->is_relative_time())
+		this->setAxisScaleEngine(QwtPlot::xBottom, new QwtDateScaleEngine());
+
+	set_time_span(time_span_);
+}
+
+void Plot::add_persistence_item(plot::BaseCurveData *curve_data)
+{
+	// Only time curves can be triggered.
+	if (curve_data->curve_type() != CurveType::TimeCurve)
+		return;
+
+	QwtPlotCurve *plot_curve = plot_curve_map_[curve_data];
+	PersistenceItem *item =
+		new PersistenceItem(curve_data->name(), curve_data->color());
+	item->setXAxis(plot_curve->xAxis());
+	item->setYAxis(plot_curve->yAxis());
+	// Same z order as the curves, everything else will be painted ontop.
+	item->setZ(1);
+	item->attach(this);
+	persistence_item_map_.insert(make_pair(curve_data, item));
+
+	if (!trigger_curve_data_)
+		trigger_curve_data_ = curve_data;
+	restart_sweeps();
+}
+
+void Plot::set_trigger_curve(plot::BaseCurveData *curve_data)
+{
+	if (curve_data == trigger_curve_data_ || !curve_data ||
+			curve_data->curve_type() != CurveType::TimeCurve ||
+			std::find(curve_datas_.begin(), curve_datas_.end(), curve_data) ==
+				curve_datas_.end())
+		return;
+
+	trigger_curve_data_ = curve_data;
+	restart_sweeps();
+}
+
+void Plot::set_trigger_level(double level)
+{
+	if (level == sweep_trigger_.level())
+		return;
+
+	sweep_trigger_.set_level(level);
+	restart_sweeps();
+}
+
+void Plot::set_trigger_edge(TriggerEdge edge)
+{
+	if (edge == sweep_trigger_.edge())
+		return;
+
+	sweep_trigger_.set_edge(edge);
+	restart_sweeps();
+}
+
+void Plot::set_pre_trigger(double pre_trigger)
+{
+	if (pre_trigger == sweep_trigger_.pre_trigger())
+		return;
+
+	sweep_trigger_.set_pre_trigger(pre_trigger);
+	if (update_mode_ == PlotUpdateMode::Triggered)
+		this->setAxisScale(QwtPlot::xBottom,
+			sweep_trigger_.sweep_start(), sweep_trigger_.sweep_end());
+	restart_sweeps();
+}
+
+void Plot::restart_sweeps()
+{
+	// Don't trigger on the history, only on new samples.
+	sweep_trigger_.reset(trigger_curve_data_ ? trigger_curve_data_->size() : 0);
+	clear_persistence();
+}
+
+void Plot::clear_persistence()
+{
+	sweep_count_ = 0;
+	if (persistence_item_map_.empty())
+		return;
+
+	// The buffers have the resolution of the canvas and cover the current
+	// y intervals. Zooming just scales the buffers.
+	this->updateAxes();
+	const QRect canvas_rect = this->canvas()->contentsRect();
+	for (const auto &item_pair : persistence_item_map_) {
+		PersistenceItem *item = item_pair.second;
+		QwtInterval y_interval = this->axisInterval(item->yAxis());
+		QRectF rect(sweep_trigger_.sweep_start(), y_interval.minValue(),
+			sweep_trigger_.sweep_end() - sweep_trigger_.sweep_start(),
+			y_interval.width());
+		item->reset(rect, canvas_rect.width(), canvas_rect.height());
+	}
+	replot();
+}
+
+void Plot::update_sweeps()
+{
+	// The y axis of the buffers can only be changed by starting over.
+	bool intervals_changed = false;
+	for (const auto &item_pair : persistence_item_map_) {
+		if (update_y_interval(item_pair.first))
+			intervals_changed = true;
+	}
+	if (intervals_changed)
+		clear_persistence();
+
+	if (!trigger_curve_data_)
+		return;
+
+	vector<double> triggers = sweep_trigger_.process(trigger_curve_data_);
+	if (triggers.empty())
+		return;
+
+	for (const double trigger_time : triggers) {
+		for (const auto &item_pair : persistence_item_map_)
+			item_pair.second->add_sweep(item_pair.first, trigger_time);
+		++sweep_count_;
+	}
+	replot();
+}
+
 void Plot::add_marker(plot::BaseCurveData *curve_data)
 {
 	assert(curve_data);
@@ -654,6 +902,8 @@ void Plot::on_legend_clicked(const QVariant &item_info, int index)
 
 void Plot::update_curves()
 {
+	SV_TRACE_SCOPE("plot", "update_curves");
+
 	for (const auto &curve_data : curve_datas_) {
 		const size_t painted_points = painted_points_map_[curve_data];
 		const size_t num_points = curve_data->size();
@@ -700,7 +950,19 @@ void Plot::update_intervals()
 	for (const auto &curve_data : curve_datas_) {
 		if (update_x_interval(curve_data))
 			intervals_changed = true;
-		if (update_y_interval(curve_data))
+	}
+
+	if (update_mode_ == PlotUpdateMode::Additive) {
+		for (const auto &curve_data : curve_datas_) {
+			if (update_y_interval(curve_data))
+				intervals_changed = true;
+		}
+	}
+	else {
+		// The y intervals depend on the new x interval.
+		if (intervals_changed)
+			updateAxes();
+		if (update_visible_y_intervals())
 			intervals_changed = true;
 	}
 
@@ -708,6 +970,83 @@ void Plot::update_intervals()
 		replot();
 }
 
+bool Plot::update_visible_y_intervals()
+{
+	bool intervals_changed = false;
+	QwtInterval x_interval = this->axisInterval(QwtPlot::xBottom);
+
+	// Min/max of all curves on an y axis in the visible time window
+	map<int, pair<double, double>> y_ranges;
+	for (const auto &curve_data : curve_datas_) {
+		if (curve_data->curve_type() != CurveType::TimeCurve) {
+			if (update_y_interval(curve_data))
+				intervals_changed = true;
+			continue;
+		}
+
+		double y_min;
+		double y_max;
+		if (!curve_data->y_range(x_interval.minValue(), x_interval.maxValue(),
+				y_min, y_max))
+			continue;
+
+		int y_axis_id = y_axis_id_map_[curve_data];
+		auto it = y_ranges.find(y_axis_id);
+		if (it == y_ranges.end()) {
+			y_ranges.insert(make_pair(y_axis_id, make_pair(y_min, y_max)));
+		}
+		else {
+			it->second.first = std::min(it->second.first, y_min);
+			it->second.second = std::max(it->second.second, y_max);
+		}
+	}
+
+	for (const auto &y_range : y_ranges) {
+		const int y_axis_id = y_range.first;
+		const bool lower_locked =
+			axis_lock_map_[y_axis_id][AxisBoundary::LowerBoundary];
+		const bool upper_locked =
+			axis_lock_map_[y_axis_id][AxisBoundary::UpperBoundary];
+		if (lower_locked && upper_locked)
+			continue;
+
+		// Visible values -/+ 10%
+		double new_min = y_range.second.first -
+			(std::fabs(y_range.second.first) * 0.1);
+		double new_max = y_range.second.second +
+			(std::fabs(y_range.second.second) * 0.1);
+		if (new_max <= new_min) {
+			const double margin = new_min == 0. ? 1. : std::fabs(new_min) * 0.1;
+			new_min -= margin;
+			new_max += margin;
+		}
+
+		QwtInterval y_interval = this->axisInterval(y_axis_id);
+		double min = y_interval.minValue();
+		double max = y_interval.maxValue();
+
+		// Expand immediately, but only shrink when the visible values use
+		// less than half of the axis, so the axis doesn't jitter.
+		const bool expand = (!lower_locked && new_min < min) ||
+			(!upper_locked && new_max > max);
+		const bool shrink = (new_max - new_min) < 0.5 * (max - min);
+		if (!expand && !shrink)
+			continue;
+
+		if (!lower_locked)
+			min = new_min;
+		if (!upper_locked)
+			max = new_max;
+		if (min >= max)
+			continue;
+
+		setAxisScale(y_axis_id, min, max);
+		intervals_changed = true;
+	}
+
+	return intervals_changed;
+}
+
 bool Plot::update_x_interval(plot::BaseCurveData *curve_data)
 {
 	if (axis_lock_map_[QwtPlot::xBottom][AxisBoundary::LowerBoundary] == true &&
@@ -920,17 +1259,6 @@ void Plot::update_markers_label()
 	markers_label_->setText(text);
 }
 
-void Plot::timerEvent(QTimerEvent *event)
-{
-	if (event->timerId() == timer_id_) {
-		update_intervals();
-		update_curves();
-		return;
-	}
-
-	QwtPlot::timerEvent(event);
-}
-
 void Plot::resizeEvent(QResizeEvent *event)
 {
 	for (auto &direct_painter_pair : plot_direct_painter_map_) {
@@ -22,8 +22,10 @@
 #define UI_WIDGETS_PLOT_PLOT_HPP
 
 #include <map>
+#include <memory>
 #include <vector>
 
+#include <QElapsedTimer>
 #include <QVariant>
 
 #include <qwt_interval.h>
@@ -37,8 +39,11 @@
 #include <qwt_system_clock.h>
 #include <qwt_text.h>
 
+#include "src/ui/widgets/plot/sweeptrigger.hpp"
+
 using std::map;
 using std::pair;
+using std::shared_ptr;
 using std::vector;
 
 namespace sv {
@@ -47,7 +52,9 @@ namespace widgets {
 namespace plot {
 
 class BaseCurveData;
+class PersistenceItem;
 class PlotMagnifier;
+class PlotScheduler;
 
 enum class AxisBoundary {
 	LowerBoundary,
@@ -57,7 +64,8 @@ enum class AxisBoundary {
 enum class PlotUpdateMode {
 	Additive = 0,
 	Rolling,
-	Oscilloscope
+	Oscilloscope,
+	Triggered
 };
 
 // TODO: Use tr(), QCoreApplication::translate(), QT_TR_NOOP() or
@@ -68,6 +76,7 @@ static plot_update_mode_name_map_t plot_update_mode_name_map = {
 	{ sv::ui::widgets::plot::PlotUpdateMode::Additive, QString("Additive") },
 	{ sv::ui::widgets::plot::PlotUpdateMode::Rolling, QString("Rolling") },
 	{ sv::ui::widgets::plot::PlotUpdateMode::Oscilloscope, QString("Oscilloscope") },
+	{ sv::ui::widgets::plot::PlotUpdateMode::Triggered, QString("Triggered") },
 };
 
 class Plot : public QwtPlot
@@ -75,7 +84,7 @@ class Plot : public QwtPlot
 	Q_OBJECT
 
 public:
-	Plot(QWidget *parent = nullptr);
+	Plot(shared_ptr<PlotScheduler> plot_scheduler, QWidget *parent = nullptr);
 	virtual ~Plot();
 
 	virtual void replot() override;
@@ -86,12 +95,41 @@ public:
 	void set_axis_locked(int axis_id, AxisBoundary axis_boundary, bool locked);
 	void set_all_axis_locked(bool locked);
 	void set_plot_interval(int plot_interval) { plot_interval_ = plot_interval; }
-	void set_update_mode(PlotUpdateMode update_mode) { update_mode_ = update_mode; }
+	/**
+	 * Return true, if the plot is visible on screen, has new curve data and
+	 * the plot interval since the last update has elapsed.
+	 */
+	bool needs_update() const;
+	/** Update the axis intervals and paint the new curve data. */
+	void update_plot();
+	/**
+	 * Replot the whole plot in the next update, even if there is no new
+	 * curve data. Use PlotScheduler::mark_dirty() instead of calling this
+	 * directly.
+	 */
+	void set_needs_replot() { needs_replot_ = true; }
+	shared_ptr<PlotScheduler> plot_scheduler() const { return plot_scheduler_; }
+	void set_update_mode(PlotUpdateMode update_mode);
 	PlotUpdateMode update_mode() const { return update_mode_; };
 	void set_time_span(double time_span);
 	double time_span() { return time_span_; }
 	void set_add_time(double add_time) { add_time_ = add_time; }
 	double add_time() { return add_time_; }
+	/**
+	 * Set the curve, that triggers the sweeps in the triggered mode. Must be
+	 * a time curve of this plot.
+	 */
+	void set_trigger_curve(plot::BaseCurveData *curve_data);
+	plot::BaseCurveData *trigger_curve() const { return trigger_curve_data_; }
+	void set_trigger_level(double level);
+	double trigger_level() const { return sweep_trigger_.level(); }
+	void set_trigger_edge(TriggerEdge edge);
+	TriggerEdge trigger_edge() const { return sweep_trigger_.edge(); }
+	/** Set the part of the sweep before the trigger (0.0 - 1.0). */
+	void set_pre_trigger(double pre_trigger);
+	double pre_trigger() const { return sweep_trigger_.pre_trigger(); }
+	/** Number of sweeps in the persistence buffers. */
+	size_t sweep_count() const { return sweep_count_; }
 	map<QwtPlotMarker *, plot::BaseCurveData *> markers() { return marker_map_; }
 	void set_markers_label_alignment(int alignment);
 	int markers_label_alignment() { return markers_label_alignment_; }
@@ -110,6 +148,8 @@ public Q_SLOTS:
 	void on_marker_selected(const QPointF mouse_pos);
 	void on_marker_moved(const QPointF mouse_pos);
 	void on_legend_clicked(const QVariant &item_info, int index);
+	/** Clear the persistence buffers of the triggered mode. */
+	void clear_persistence();
 
 Q_SIGNALS:
 	void axis_lock_changed(int axis_id, AxisBoundary axis_boundary, bool locked);
@@ -117,28 +157,45 @@ Q_SIGNALS:
 protected:
 	virtual void showEvent(QShowEvent *) override;
 	virtual void resizeEvent(QResizeEvent *) override;
-	virtual void timerEvent(QTimerEvent *) override;
 
 private:
+	bool is_visible_on_screen() const;
+	bool has_new_data() const;
 	void update_curves();
 	void update_intervals();
 	bool update_x_interval(plot::BaseCurveData *curve_data);
 	bool update_y_interval(plot::BaseCurveData *curve_data);
+	bool update_visible_y_intervals();
 	void update_markers_label();
+	void start_triggered_mode();
+	void stop_triggered_mode();
+	void add_persistence_item(plot::BaseCurveData *curve_data);
+	/** Restart the trigger and clear the persistence buffers. */
+	void restart_sweeps();
+	/** Add all new complete sweeps to the persistence buffers. */
+	void update_sweeps();
 
 	vector<plot::BaseCurveData *> curve_datas_;
 	map<plot::BaseCurveData *, QwtPlotCurve *> plot_curve_map_;
 	map<plot::BaseCurveData *, QwtPlotDirectPainter *> plot_direct_painter_map_;
 	map<plot::BaseCurveData *, int> y_axis_id_map_;
 	map<plot::BaseCurveData *, size_t> painted_points_map_;
+	map<plot::BaseCurveData *, size_t> updated_points_map_;
 
 	map<int, map<AxisBoundary, bool>> axis_lock_map_; // map<axis_id, map<AxisBoundary, locked>>
+	shared_ptr<PlotScheduler> plot_scheduler_;
+	bool needs_replot_;
 	int plot_interval_;
-	int timer_id_;
+	QElapsedTimer last_update_timer_;
 	PlotUpdateMode update_mode_;
 	double time_span_;
 	double add_time_;
 
+	SweepTrigger sweep_trigger_;
+	plot::BaseCurveData *trigger_curve_data_;
+	map<plot::BaseCurveData *, PersistenceItem *> persistence_item_map_;
+	size_t sweep_count_;
+
 	QwtPlotPanner *plot_panner_;
 	PlotMagnifier *plot_magnifier_;
 
@@ -0,0 +1,177 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <QImage>
+#include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <qwt_plot.h>
+#include <qwt_plot_curve.h>
+#include <qwt_scale_map.h>
+#include <qwt_series_data.h>
+#include <qwt_symbol.h>
+
+#include "plotcurve.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/curverenderer.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+#include "src/ui/widgets/plot/plotscheduler.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+PlotCurve::PlotCurve(const QString &title) :
+	QwtPlotCurve(title),
+	async_threshold_(100000),
+	renderer_(nullptr),
+	renderer_data_(nullptr)
+{
+}
+
+PlotCurve::~PlotCurve()
+{
+	// Must be deleted before the series data, the renderer may still use it.
+	delete renderer_;
+}
+
+void PlotCurve::set_async_threshold(size_t async_threshold)
+{
+	async_threshold_ = async_threshold;
+}
+
+size_t PlotCurve::async_threshold() const
+{
+	return async_threshold_;
+}
+
+void PlotCurve::drawSeries(QPainter *painter,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+	const QRectF &canvas_rect, int from, int to) const
+{
+	if (to < 0)
+		to = (int)dataSize() - 1;
+	if (from < 0)
+		from = 0;
+
+	const BaseCurveData *curve_data =
+		dynamic_cast<const BaseCurveData *>(data());
+	size_t first;
+	size_t last;
+	const bool is_full_redraw = from == 0;
+	if (curve_data && curve_data->visible_range(
+			std::min(x_map.s1(), x_map.s2()), std::max(x_map.s1(), x_map.s2()),
+			first, last)) {
+		from = std::max(from, (int)first);
+		to = std::min(to, (int)last);
+		if (from > to)
+			return;
+
+		// Only full redraws of ordered curves are rendered asynchronously,
+		// the small incremental updates of the direct painter are not.
+		if (is_full_redraw && async_threshold_ > 0 &&
+				(size_t)(to - from + 1) >= async_threshold_ &&
+				draw_layer(painter, x_map, y_map, canvas_rect, from, to))
+			return;
+	}
+	if (from > to)
+		return;
+
+	QwtPlotCurve::drawSeries(painter, x_map, y_map, canvas_rect, from, to);
+}
+
+bool PlotCurve::draw_layer(QPainter *painter,
+	const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+	const QRectF &canvas_rect, size_t first, size_t last) const
+{
+	// The renderer only draws plain lines.
+	if (style() != QwtPlotCurve::Lines ||
+			(symbol() && symbol()->style() != QwtSymbol::NoSymbol))
+		return false;
+
+	if (!renderer_ || renderer_data_ != data()) {
+		delete renderer_;
+		renderer_data_ = data();
+		renderer_ = new CurveRenderer(renderer_data_);
+		// The layer_ready() signal is emitted from a worker thread, the
+		// slot is queued to the GUI thread by Qt. The plot is replotted by
+		// the PlotScheduler in its next frame.
+		const PlotCurve *curve = this;
+		QObject::connect(renderer_, &CurveRenderer::layer_ready,
+			renderer_, [curve]() {
+				Plot *plot = dynamic_cast<Plot *>(curve->plot());
+				if (plot)
+					plot->plot_scheduler()->mark_dirty(plot);
+				else if (curve->plot())
+					curve->plot()->replot();
+			});
+	}
+
+	const CurveLayerKey key =
+		CurveRenderer::create_key(x_map, y_map, canvas_rect);
+	CurveLayerKey layer_key;
+	QImage layer_image;
+	size_t layer_last;
+	const bool has_layer =
+		renderer_->layer(layer_key, layer_image, layer_last);
+
+	if (!has_layer) {
+		renderer_->request(key, x_map, y_map, first, last, pen(),
+			testRenderHint(QwtPlotItem::RenderAntialiased));
+		return true;
+	}
+
+	if (layer_key != key) {
+		// The maps have changed (e.g. the x interval in the rolling mode),
+		// the outdated layer is scaled to the current maps until the new
+		// layer is ready. If that isn't possible, the curve is drawn
+		// synchronously.
+		QRectF layer_rect;
+		if (!CurveRenderer::remap_layer(layer_key, x_map, y_map, layer_rect))
+			return false;
+		renderer_->request(key, x_map, y_map, first, last, pen(),
+			testRenderHint(QwtPlotItem::RenderAntialiased));
+		painter->drawImage(layer_rect, layer_image);
+	}
+	else {
+		painter->drawImage(canvas_rect.topLeft(), layer_image);
+		// Render the samples, that arrived after the layer has been
+		// rendered, into a new layer when there are too many of them.
+		if (layer_last < last && last - layer_last >= async_threshold_) {
+			renderer_->request(key, x_map, y_map, first, last, pen(),
+				testRenderHint(QwtPlotItem::RenderAntialiased));
+		}
+	}
+
+	// Samples that arrived after the layer has been rendered.
+	if (layer_last < last) {
+		QwtPlotCurve::drawSeries(painter, x_map, y_map, canvas_rect,
+			(int)std::max(layer_last, first), (int)last);
+	}
+	return true;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,81 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_PLOTCURVE_HPP
+#define UI_WIDGETS_PLOT_PLOTCURVE_HPP
+
+#include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <qwt_plot_curve.h>
+#include <qwt_scale_map.h>
+#include <qwt_series_data.h>
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class CurveRenderer;
+
+/**
+ * A QwtPlotCurve for BaseCurveData, that only draws the samples within the
+ * visible x interval, so the painting costs don't grow with the history of
+ * the curve.
+ *
+ * When a full redraw contains more samples than the async threshold, the
+ * curve is rendered by a CurveRenderer in a worker thread. Until the layer
+ * is ready, the last layer is drawn, so the GUI thread never blocks.
+ */
+class PlotCurve : public QwtPlotCurve
+{
+
+public:
+	PlotCurve(const QString &title);
+	~PlotCurve();
+
+	void drawSeries(QPainter *painter,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		const QRectF &canvas_rect, int from, int to) const override;
+
+	/**
+	 * Set the number of visible samples from which on the curve is rendered
+	 * asynchronously. 0 disables the async rendering.
+	 */
+	void set_async_threshold(size_t async_threshold);
+	size_t async_threshold() const;
+
+private:
+	bool draw_layer(QPainter *painter,
+		const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		const QRectF &canvas_rect, size_t first, size_t last) const;
+
+	size_t async_threshold_;
+	mutable CurveRenderer *renderer_;
+	mutable const QwtSeriesData<QPointF> *renderer_data_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_PLOTCURVE_HPP
@@ -0,0 +1,160 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimerEvent>
+
+#include "plotscheduler.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+PlotScheduler::PlotScheduler(QObject *parent) :
+	QObject(parent),
+	next_plot_(0),
+	frame_budget_(40),
+	min_interval_(50),
+	max_interval_(1000),
+	interval_(50),
+	timer_id_(-1)
+{
+}
+
+void PlotScheduler::add_plot(Plot *plot)
+{
+	if (std::find(plots_.begin(), plots_.end(), plot) != plots_.end())
+		return;
+
+	plots_.push_back(plot);
+	if (timer_id_ < 0)
+		restart_timer();
+}
+
+void PlotScheduler::remove_plot(Plot *plot)
+{
+	auto it = std::find(plots_.begin(), plots_.end(), plot);
+	if (it == plots_.end())
+		return;
+
+	plots_.erase(it);
+	if (next_plot_ >= plots_.size())
+		next_plot_ = 0;
+
+	// Don't wake up when there is nothing to do.
+	if (plots_.empty() && timer_id_ >= 0) {
+		killTimer(timer_id_);
+		timer_id_ = -1;
+	}
+}
+
+void PlotScheduler::mark_dirty(Plot *plot)
+{
+	if (std::find(plots_.begin(), plots_.end(), plot) == plots_.end()) {
+		plot->replot();
+		return;
+	}
+	plot->set_needs_replot();
+}
+
+void PlotScheduler::set_interval_range(int min_interval, int max_interval)
+{
+	min_interval_ = min_interval;
+	max_interval_ = std::max(min_interval, max_interval);
+	interval_ = std::min(std::max(interval_, min_interval_), max_interval_);
+	if (timer_id_ >= 0)
+		restart_timer();
+}
+
+void PlotScheduler::restart_timer()
+{
+	if (timer_id_ >= 0)
+		killTimer(timer_id_);
+	timer_id_ = startTimer(interval_);
+}
+
+void PlotScheduler::adapt_interval(qint64 frame_time, bool budget_exceeded)
+{
+	int interval = interval_;
+	if (budget_exceeded || frame_time > frame_budget_)
+		interval = std::min(interval_ * 2, max_interval_);
+	else if (frame_time < frame_budget_ / 4)
+		interval = std::max(interval_ * 3 / 4, min_interval_);
+
+	if (interval != interval_) {
+		interval_ = interval;
+		restart_timer();
+	}
+}
+
+void PlotScheduler::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() != timer_id_) {
+		QObject::timerEvent(event);
+		return;
+	}
+
+	QElapsedTimer frame_timer;
+	frame_timer.start();
+
+	// A plot update can't remove a plot, but be defensive anyway.
+	const vector<Plot *> plots = plots_;
+	const size_t count = plots.size();
+	bool budget_exceeded = false;
+	set<shared_ptr<sv::data::AnalogTimeSignal>> updated_signals;
+	for (size_t i = 0; i < count; ++i) {
+		const size_t pos = (next_plot_ + i) % count;
+		Plot *plot = plots[pos];
+		if (!plot->needs_update())
+			continue;
+		if (frame_timer.elapsed() >= frame_budget_) {
+			// Start with this plot in the next frame.
+			next_plot_ = pos;
+			budget_exceeded = true;
+			break;
+		}
+		plot->update_plot();
+		for (const auto &curve_data : plot->curve_datas()) {
+			for (const auto &signal : curve_data->curve_signals())
+				updated_signals.insert(signal);
+		}
+	}
+
+	adapt_interval(frame_timer.elapsed(), budget_exceeded);
+	if (!updated_signals.empty())
+		Q_EMIT plots_updated(updated_signals);
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
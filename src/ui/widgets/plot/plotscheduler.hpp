@@ -0,0 +1,106 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_PLOTSCHEDULER_HPP
+#define UI_WIDGETS_PLOT_PLOTSCHEDULER_HPP
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <QObject>
+#include <QTimerEvent>
+
+using std::set;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class Plot;
+
+/**
+ * The PlotScheduler drives the updates of all plots with a single timer.
+ * Only plots that are visible and have new data are updated. The time spent
+ * per frame is limited, remaining plots are updated in the next frame
+ * (round robin). When the budget is exceeded, the frame interval is
+ * increased and slowly decreased again when the load goes down.
+ */
+class PlotScheduler : public QObject
+{
+	Q_OBJECT
+
+public:
+	PlotScheduler(QObject *parent = nullptr);
+
+	void add_plot(Plot *plot);
+	void remove_plot(Plot *plot);
+	/**
+	 * Replot the plot in the next frame. Plots that aren't scheduled are
+	 * replotted at once.
+	 */
+	void mark_dirty(Plot *plot);
+
+	/** Set the max. time in ms that is spent updating plots per frame. */
+	void set_frame_budget(int frame_budget) { frame_budget_ = frame_budget; }
+	int frame_budget() const { return frame_budget_; }
+	/** Set the range in ms, the frame interval is adapted in. */
+	void set_interval_range(int min_interval, int max_interval);
+	/** The current frame interval in ms. */
+	int interval() const { return interval_; }
+
+protected:
+	void timerEvent(QTimerEvent *event) override;
+
+private:
+	void restart_timer();
+	void adapt_interval(qint64 frame_time, bool budget_exceeded);
+
+	vector<Plot *> plots_;
+	size_t next_plot_;
+	int frame_budget_;
+	int min_interval_;
+	int max_interval_;
+	int interval_;
+	int timer_id_;
+
+Q_SIGNALS:
+	/**
+	 * Is emitted after a frame, that has updated at least one plot, with
+	 * the signals of the updated plots.
+	 */
+	void plots_updated(
+		const set<shared_ptr<sv::data::AnalogTimeSignal>> &signals);
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_PLOTSCHEDULER_HPP
@@ -0,0 +1,221 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "pointgridindex.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+namespace {
+
+/** Mean number of points per cell the cell size is chosen for. */
+const double points_per_cell = 4.;
+/** Number of points, before the cell size is adapted the first time. */
+const size_t min_rebuild_count = 64;
+
+}
+
+PointGridIndex::PointGridIndex(point_getter_t point_getter) :
+	point_getter_(point_getter)
+{
+	clear();
+}
+
+void PointGridIndex::clear()
+{
+	indexed_count_ = 0;
+	rebuild_count_ = min_rebuild_count;
+	cell_size_ = 0.;
+	cells_.clear();
+	min_cell_x_ = std::numeric_limits<int>::max();
+	max_cell_x_ = std::numeric_limits<int>::min();
+	min_cell_y_ = std::numeric_limits<int>::max();
+	max_cell_y_ = std::numeric_limits<int>::min();
+}
+
+void PointGridIndex::update(size_t count)
+{
+	if (count < indexed_count_)
+		clear();
+	if (count >= rebuild_count_ || cell_size_ <= 0.) {
+		indexed_count_ = count;
+		rebuild();
+		return;
+	}
+
+	for (size_t i = indexed_count_; i < count; ++i)
+		insert(i);
+	indexed_count_ = count;
+}
+
+void PointGridIndex::rebuild()
+{
+	cells_.clear();
+	min_cell_x_ = std::numeric_limits<int>::max();
+	max_cell_x_ = std::numeric_limits<int>::min();
+	min_cell_y_ = std::numeric_limits<int>::max();
+	max_cell_y_ = std::numeric_limits<int>::min();
+
+	double min_x = std::numeric_limits<double>::max();
+	double max_x = std::numeric_limits<double>::lowest();
+	double min_y = std::numeric_limits<double>::max();
+	double max_y = std::numeric_limits<double>::lowest();
+	size_t valid_count = 0;
+	for (size_t i = 0; i < indexed_count_; ++i) {
+		double x;
+		double y;
+		if (!point_getter_(i, x, y) || !std::isfinite(x) || !std::isfinite(y))
+			continue;
+		min_x = std::min(min_x, x);
+		max_x = std::max(max_x, x);
+		min_y = std::min(min_y, y);
+		max_y = std::max(max_y, y);
+		++valid_count;
+	}
+
+	// Square cells, because the distance is euclidean in data units.
+	cell_size_ = 1.;
+	if (valid_count > 0) {
+		const double width = max_x - min_x;
+		const double height = max_y - min_y;
+		const double cell_count =
+			std::max(1., (double)valid_count / points_per_cell);
+		if (width > 0. && height > 0.)
+			cell_size_ = std::sqrt(width * height / cell_count);
+		else if (width > 0. || height > 0.)
+			cell_size_ = std::max(width, height) / cell_count;
+	}
+	rebuild_count_ = std::max(2 * indexed_count_, min_rebuild_count);
+
+	for (size_t i = 0; i < indexed_count_; ++i)
+		insert(i);
+}
+
+void PointGridIndex::insert(size_t index)
+{
+	double x;
+	double y;
+	if (!point_getter_(index, x, y) || !std::isfinite(x) || !std::isfinite(y))
+		return;
+
+	const int cell_x = to_cell(x);
+	const int cell_y = to_cell(y);
+	cells_[to_key(cell_x, cell_y)].push_back(index);
+	min_cell_x_ = std::min(min_cell_x_, cell_x);
+	max_cell_x_ = std::max(max_cell_x_, cell_x);
+	min_cell_y_ = std::min(min_cell_y_, cell_y);
+	max_cell_y_ = std::max(max_cell_y_, cell_y);
+}
+
+bool PointGridIndex::closest_point(double x, double y,
+	size_t &index, double &dist) const
+{
+	if (cells_.empty())
+		return false;
+
+	// Start at the occupied cell closest to the query point.
+	const int cell_x = std::min(std::max(to_cell(x), min_cell_x_), max_cell_x_);
+	const int cell_y = std::min(std::max(to_cell(y), min_cell_y_), max_cell_y_);
+	const int max_ring = std::max(
+		std::max(cell_x - min_cell_x_, max_cell_x_ - cell_x),
+		std::max(cell_y - min_cell_y_, max_cell_y_ - cell_y));
+
+	double min_dist_sq = std::numeric_limits<double>::max();
+	bool found = false;
+	auto check_cell = [&](int cx, int cy) {
+		if (cx < min_cell_x_ || cx > max_cell_x_ ||
+				cy < min_cell_y_ || cy > max_cell_y_)
+			return;
+		auto it = cells_.find(to_key(cx, cy));
+		if (it == cells_.end())
+			return;
+		for (const size_t i : it->second) {
+			double point_x;
+			double point_y;
+			if (!point_getter_(i, point_x, point_y))
+				continue;
+			const double dx = point_x - x;
+			const double dy = point_y - y;
+			const double dist_sq = dx * dx + dy * dy;
+			if (dist_sq < min_dist_sq) {
+				min_dist_sq = dist_sq;
+				index = i;
+				found = true;
+			}
+		}
+	};
+
+	// Search in rings around the start cell. All points outside of ring r
+	// are at least r + 0.5 cells away from the center of the start cell (in
+	// one axis), so the search can stop when the best point is closer.
+	const double center_dist = std::max(
+		std::abs(x - (cell_x + .5) * cell_size_),
+		std::abs(y - (cell_y + .5) * cell_size_));
+	for (int r = 0; r <= max_ring; ++r) {
+		if (r == 0) {
+			check_cell(cell_x, cell_y);
+		}
+		else {
+			for (int i = -r; i <= r; ++i) {
+				check_cell(cell_x + i, cell_y - r);
+				check_cell(cell_x + i, cell_y + r);
+			}
+			for (int i = -r + 1; i <= r - 1; ++i) {
+				check_cell(cell_x - r, cell_y + i);
+				check_cell(cell_x + r, cell_y + i);
+			}
+		}
+
+		const double bound = (r + .5) * cell_size_ - center_dist;
+		if (found && bound > 0. && min_dist_sq <= bound * bound)
+			break;
+	}
+
+	if (found)
+		dist = std::sqrt(min_dist_sq);
+	return found;
+}
+
+int PointGridIndex::to_cell(double value) const
+{
+	const double cell = std::floor(value / cell_size_);
+	// Clamp, so extreme outliers don't overflow the cell coordinates.
+	const double limit = std::numeric_limits<int>::max() / 2;
+	return (int)std::min(std::max(cell, -limit), limit);
+}
+
+PointGridIndex::cell_key_t PointGridIndex::to_key(int cell_x, int cell_y)
+{
+	return ((cell_key_t)cell_x << 32) ^ (cell_key_t)(uint32_t)cell_y;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
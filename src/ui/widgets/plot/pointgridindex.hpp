@@ -0,0 +1,97 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_POINTGRIDINDEX_HPP
+#define UI_WIDGETS_PLOT_POINTGRIDINDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+using std::function;
+using std::unordered_map;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+/**
+ * Incremental uniform grid over 2D points for nearest neighbour queries.
+ * The points are referenced by their index and read with a getter, so the
+ * point data isn't copied. Points must only be appended. The cell size is adapted every time the number of points has
+ * doubled, so appending is amortized O(1) and a query only looks at the
+ * cells around the query point.
+ */
+class PointGridIndex
+{
+
+public:
+	/**
+	 * The getter returns the point for an index, or false if the point is
+	 * not available.
+	 */
+	typedef function<bool(size_t, double &, double &)> point_getter_t;
+
+	PointGridIndex(point_getter_t point_getter);
+
+	/** Index the points up to count. A smaller count resets the index. */
+	void update(size_t count);
+	/** Remove all points, e.g. when the data has been cleared. */
+	void clear();
+
+	/**
+	 * Find the index of the point closest to (x, y). Returns false if the
+	 * index is empty.
+	 */
+	bool closest_point(double x, double y, size_t &index, double &dist) const;
+
+	/** Number of indexed points. */
+	size_t size() const { return indexed_count_; }
+
+private:
+	typedef int64_t cell_key_t;
+
+	void rebuild();
+	void insert(size_t index);
+	int to_cell(double value) const;
+	static cell_key_t to_key(int cell_x, int cell_y);
+
+	point_getter_t point_getter_;
+	size_t indexed_count_;
+	size_t rebuild_count_;
+
+	double cell_size_;
+	unordered_map<cell_key_t, vector<size_t>> cells_;
+	int min_cell_x_;
+	int max_cell_x_;
+	int min_cell_y_;
+	int max_cell_y_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_POINTGRIDINDEX_HPP
@@ -0,0 +1,119 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <QPointF>
+
+#include "sweeptrigger.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+SweepTrigger::SweepTrigger() :
+	level_(0.),
+	edge_(TriggerEdge::Rising),
+	sweep_length_(1.),
+	pre_trigger_(.1),
+	scan_pos_(0),
+	holdoff_until_(0.),
+	has_holdoff_(false)
+{
+}
+
+void SweepTrigger::set_pre_trigger(double pre_trigger)
+{
+	pre_trigger_ = std::min(1., std::max(0., pre_trigger));
+}
+
+void SweepTrigger::reset(size_t scan_pos)
+{
+	scan_pos_ = scan_pos;
+	has_holdoff_ = false;
+	pending_triggers_.clear();
+}
+
+vector<double> SweepTrigger::process(const BaseCurveData *curve_data)
+{
+	vector<double> complete_triggers;
+	const size_t sample_count = curve_data->size();
+	if (sample_count == 0)
+		return complete_triggers;
+	if (scan_pos_ == 0)
+		scan_pos_ = 1;
+
+	// Only the samples that have been added since the last call are scanned.
+	QPointF p0 = curve_data->sample(scan_pos_ - 1);
+	for (; scan_pos_ < sample_count; ++scan_pos_) {
+		const QPointF p1 = curve_data->sample(scan_pos_);
+		if (is_triggered(p0.y(), p1.y())) {
+			// Interpolate the time of the level crossing between the samples.
+			double t = p1.x();
+			if (p1.y() != p0.y())
+				t = p0.x() + (level_ - p0.y()) *
+					(p1.x() - p0.x()) / (p1.y() - p0.y());
+			if (!has_holdoff_ || t >= holdoff_until_) {
+				pending_triggers_.push_back(t);
+				holdoff_until_ = t + sweep_end();
+				has_holdoff_ = true;
+			}
+		}
+		p0 = p1;
+	}
+
+	// A sweep is complete, when the curve has reached the end of the sweep.
+	const double last_x = curve_data->sample(sample_count - 1).x();
+	while (!pending_triggers_.empty() &&
+			pending_triggers_.front() + sweep_end() <= last_x) {
+		complete_triggers.push_back(pending_triggers_.front());
+		pending_triggers_.pop_front();
+	}
+
+	return complete_triggers;
+}
+
+bool SweepTrigger::is_triggered(double y0, double y1) const
+{
+	if (!std::isfinite(y0) || !std::isfinite(y1))
+		return false;
+
+	const bool rising = y0 < level_ && y1 >= level_;
+	const bool falling = y0 > level_ && y1 <= level_;
+	switch (edge_) {
+	case TriggerEdge::Rising:
+		return rising;
+	case TriggerEdge::Falling:
+		return falling;
+	case TriggerEdge::Both:
+		return rising || falling;
+	}
+	return false;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_SWEEPTRIGGER_HPP
+#define UI_WIDGETS_PLOT_SWEEPTRIGGER_HPP
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <QString>
+
+using std::deque;
+using std::map;
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class BaseCurveData;
+
+enum class TriggerEdge {
+	Rising = 0,
+	Falling,
+	Both
+};
+
+typedef map<TriggerEdge, QString> trigger_edge_name_map_t;
+static trigger_edge_name_map_t trigger_edge_name_map = {
+	{ sv::ui::widgets::plot::TriggerEdge::Rising, QString("Rising") },
+	{ sv::ui::widgets::plot::TriggerEdge::Falling, QString("Falling") },
+	{ sv::ui::widgets::plot::TriggerEdge::Both, QString("Both") },
+};
+
+/**
+ * Level/edge trigger for the triggered sweep mode of the plot. The samples
+ * of the trigger curve are scanned incrementally for level crossings, each
+ * trigger starts a sweep of the given length. The pre trigger part of the
+ * sweep is taken from the history of the curve. A new sweep can't be
+ * triggered before the last sweep has ended (holdoff).
+ */
+class SweepTrigger
+{
+
+public:
+	SweepTrigger();
+
+	void set_level(double level) { level_ = level; }
+	double level() const { return level_; }
+	void set_edge(TriggerEdge edge) { edge_ = edge; }
+	TriggerEdge edge() const { return edge_; }
+	/** Set the sweep length in x units (seconds). */
+	void set_sweep_length(double sweep_length) { sweep_length_ = sweep_length; }
+	double sweep_length() const { return sweep_length_; }
+	/** Set the part of the sweep before the trigger (0.0 - 1.0). */
+	void set_pre_trigger(double pre_trigger);
+	double pre_trigger() const { return pre_trigger_; }
+
+	/** Start of the sweep relative to the trigger time. */
+	double sweep_start() const { return -sweep_length_ * pre_trigger_; }
+	/** End of the sweep relative to the trigger time. */
+	double sweep_end() const { return sweep_length_ * (1. - pre_trigger_); }
+
+	/**
+	 * Drop all pending sweeps and continue scanning at sample index
+	 * scan_pos, so the history before is not triggered on.
+	 */
+	void reset(size_t scan_pos);
+
+	/**
+	 * Scan the new samples of the curve for triggers and return the trigger
+	 * times of all sweeps that are complete (the curve has samples beyond
+	 * the end of the sweep). Each sweep is returned only once.
+	 */
+	vector<double> process(const BaseCurveData *curve_data);
+
+private:
+	bool is_triggered(double y0, double y1) const;
+
+	double level_;
+	TriggerEdge edge_;
+	double sweep_length_;
+	double pre_trigger_;
+
+	size_t scan_pos_;
+	double holdoff_until_;
+	bool has_holdoff_;
+	deque<double> pending_triggers_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_SWEEPTRIGGER_HPP
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <set>
+#include <vector>
 
 #include <QPointF>
 #include <QRectF>
@@ -31,6 +32,7 @@
 
 using std::set;
 using std::shared_ptr;
+using std::vector;
 
 namespace sv {
 namespace ui {
@@ -91,6 +93,31 @@ QRectF TimeCurveData::boundingRect() const
 		QPointF(signal_->last_timestamp(relative_time_), signal_->min_value()));
 }
 
+bool TimeCurveData::visible_range(double x_min, double x_max,
+	size_t &first, size_t &last) const
+{
+	const size_t sample_count = size();
+	if (sample_count == 0)
+		return false;
+
+	// Include the samples right before x_min and after x_max, so the line
+	// segments reaching into the visible area are drawn too.
+	first = signal_->get_index_at_timestamp(x_min, relative_time_);
+	if (first > 0)
+		--first;
+	last = signal_->get_index_at_timestamp(x_max, relative_time_);
+	if (last >= sample_count)
+		last = sample_count - 1;
+
+	return true;
+}
+
+bool TimeCurveData::y_range(double x_min, double x_max,
+	double &y_min, double &y_max) const
+{
+	return signal_->get_min_max(x_min, x_max, y_min, y_max, relative_time_);
+}
+
 QPointF TimeCurveData::closest_point(const QPointF &pos, double *dist) const
 {
 	(void)dist;
@@ -184,6 +211,12 @@ QString TimeCurveData::y_title() const
 		arg(y_unit_str());
 }
 
+vector<shared_ptr<sv::data::AnalogTimeSignal>>
+	TimeCurveData::curve_signals() const
+{
+	return { signal_ };
+}
+
 shared_ptr<sv::data::AnalogTimeSignal> TimeCurveData::signal() const
 {
 	return signal_;
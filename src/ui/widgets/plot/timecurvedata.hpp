@@ -22,6 +22,7 @@
 
 #include <memory>
 #include <set>
+#include <vector>
 
 #include <QPointF>
 #include <QRectF>
@@ -32,6 +33,7 @@
 
 using std::set;
 using std::shared_ptr;
+using std::vector;
 
 namespace sv {
 
@@ -54,6 +56,10 @@ public:
 	QPointF sample(size_t i) const override;
 	size_t size() const override;
 	QRectF boundingRect() const override;
+	bool visible_range(double x_min, double x_max,
+		size_t &first, size_t &last) const override;
+	bool y_range(double x_min, double x_max,
+		double &y_min, double &y_max) const override;
 
 	QPointF closest_point(const QPointF &pos, double *dist) const override;
 	QString name() const override;
@@ -67,6 +73,8 @@ public:
 	sv::data::Unit y_unit() const override;
 	QString y_unit_str() const override;
 	QString y_title() const override;
+	vector<shared_ptr<sv::data::AnalogTimeSignal>> curve_signals()
+		const override;
 
 	shared_ptr<sv::data::AnalogTimeSignal> signal() const;
 
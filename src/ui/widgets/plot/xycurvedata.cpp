@@ -27,15 +27,18 @@
 #include <QString>
 
 #include "xycurvedata.hpp"
+#include "src/data/alignedsignalpair.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/datautil.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/pointgridindex.hpp"
 
 using std::lock_guard;
 using std::make_shared;
 using std::mutex;
 using std::set;
 using std::shared_ptr;
+using std::vector;
 
 namespace sv {
 namespace ui {
@@ -46,14 +49,17 @@ XYCurveData::XYCurveData(shared_ptr<sv::data::AnalogTimeSignal> x_t_signal,
 		shared_ptr<sv::data::AnalogTimeSignal> y_t_signal) :
 	BaseCurveData(CurveType::XYCurve),
 	x_t_signal_(x_t_signal),
-	y_t_signal_(y_t_signal),
-	x_t_signal_pos_(0),
-	y_t_signal_pos_(0)
+	y_t_signal_(y_t_signal)
 {
-	x_data_ = make_shared<vector<double>>();
-	y_data_ = make_shared<vector<double>>();
+	signal_pair_ = sv::data::AlignedSignalPair::get(x_t_signal_, y_t_signal_);
+	auto signal_pair = signal_pair_;
+	point_index_ = make_shared<PointGridIndex>(
+		[signal_pair](size_t i, double &x, double &y) {
+			double time;
+			return signal_pair->get_sample(i, time, x, y);
+		});
 
-	// Prefill data vectors
+	// Align the already existing samples
 	this->on_sample_appended();
 
 	connect(x_t_signal_.get(), SIGNAL(sample_appended()),
@@ -76,13 +82,17 @@ bool XYCurveData::is_equal(const BaseCurveData *other) const
 
 QPointF XYCurveData::sample(size_t i) const
 {
-	QPointF sample_point(x_data_->at(i), y_data_->at(i));
-	return sample_point;
+	double time;
+	double x;
+	double y;
+	if (!signal_pair_->get_sample(i, time, x, y))
+		return QPointF(0, 0);
+	return QPointF(x, y);
 }
 
 size_t XYCurveData::size() const
 {
-	return x_data_->size();
+	return signal_pair_->size();
 }
 
 QRectF XYCurveData::boundingRect() const
@@ -95,25 +105,15 @@ QRectF XYCurveData::boundingRect() const
 
 QPointF XYCurveData::closest_point(const QPointF &pos, double *dist) const
 {
-	const size_t num_samples = size();
-	if (num_samples <= 0)
+	lock_guard<mutex> lock(sample_append_mutex_);
+
+	size_t index;
+	double dmin;
+	if (!point_index_->closest_point(pos.x(), pos.y(), index, dmin))
 		return QPointF(0, 0); // TODO
 
-	size_t index = -1;
-	double dmin = 1.0e10;
-
-	for (size_t i=0; i < num_samples; i++) {
-		const QPointF s = sample(i);
-		const double cx = s.x() - pos.x();
-		const double cy = s.y() - pos.y();
-		const double d = qwtSqr(cx) + qwtSqr(cy);
-		if (d < dmin) {
-			index = i;
-			dmin = d;
-		}
-	}
 	if (dist)
-		*dist = qSqrt(dmin);
+		*dist = dmin;
 
 	return sample(index);
 }
@@ -181,6 +181,12 @@ QString XYCurveData::y_title() const
 		arg(y_unit_str());
 }
 
+vector<shared_ptr<sv::data::AnalogTimeSignal>>
+	XYCurveData::curve_signals() const
+{
+	return { x_t_signal_, y_t_signal_ };
+}
+
 shared_ptr<sv::data::AnalogTimeSignal> XYCurveData::x_t_signal() const
 {
 	return x_t_signal_;
@@ -195,11 +201,9 @@ void XYCurveData::on_sample_appended()
 {
 	lock_guard<mutex> lock(sample_append_mutex_);
 
-	shared_ptr<vector<double>> time = make_shared<vector<double>>();
-	sv::data::AnalogTimeSignal::combine_signals(
-		x_t_signal_, x_t_signal_pos_,
-		y_t_signal_, y_t_signal_pos_,
-		time, x_data_, y_data_);
+	// The pair may be shared, but aligning is only done once per sample.
+	signal_pair_->update();
+	point_index_->update(signal_pair_->size());
 }
 
 } // namespace plot
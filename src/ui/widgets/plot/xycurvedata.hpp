@@ -31,6 +31,7 @@
 
 #include "src/data/datautil.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/pointgridindex.hpp"
 
 using std::mutex;
 using std::set;
@@ -40,6 +41,7 @@ using std::vector;
 namespace sv {
 
 namespace data {
+class AlignedSignalPair;
 class AnalogTimeSignal;
 }
 
@@ -77,6 +79,8 @@ public:
 	sv::data::Unit y_unit() const override;
 	QString y_unit_str() const override;
 	QString y_title() const override;
+	vector<shared_ptr<sv::data::AnalogTimeSignal>> curve_signals()
+		const override;
 
 	shared_ptr<sv::data::AnalogTimeSignal> x_t_signal() const;
 	shared_ptr<sv::data::AnalogTimeSignal> y_t_signal() const;
@@ -84,12 +88,11 @@ public:
 private:
 	shared_ptr<sv::data::AnalogTimeSignal> x_t_signal_;
 	shared_ptr<sv::data::AnalogTimeSignal> y_t_signal_;
-	size_t x_t_signal_pos_;
-	size_t y_t_signal_pos_;
-	// TODO: use some sort of AnalogSignal instead of 2 vectors?
-	shared_ptr<vector<double>> x_data_;
-	shared_ptr<vector<double>> y_data_;
-	mutex sample_append_mutex_;
+	/** Aligned view on the x/y signals, shared with other consumers. */
+	shared_ptr<sv::data::AlignedSignalPair> signal_pair_;
+	/** Spatial index for closest_point(), updated with every new sample. */
+	shared_ptr<PointGridIndex> point_index_;
+	mutable mutex sample_append_mutex_;
 
 private Q_SLOTS:
 	void on_sample_appended();
@@ -0,0 +1,72 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QAction>
+#include <QActionGroup>
+#include <QIcon>
+#include <QMenu>
+#include <QToolButton>
+#include <QWidget>
+
+#include "refreshintervalbutton.hpp"
+
+namespace sv {
+namespace ui {
+namespace widgets {
+
+RefreshIntervalButton::RefreshIntervalButton(int interval, QWidget *parent) :
+	QToolButton(parent)
+{
+	menu_ = new QMenu(this);
+	action_group_ = new QActionGroup(this);
+	const int intervals[] = { 100, 250, 500, 1000, 2000 };
+	for (const int i : intervals) {
+		QAction *action = new QAction(tr("%1 ms").arg(i), this);
+		action->setCheckable(true);
+		action->setData(i);
+		action_group_->addAction(action);
+		menu_->addAction(action);
+	}
+	set_interval(interval);
+	connect(action_group_, SIGNAL(triggered(QAction *)),
+		this, SLOT(on_action_triggered(QAction *)));
+
+	this->setText(tr("Refresh interval"));
+	this->setIcon(
+		QIcon::fromTheme("chronometer",
+		QIcon(":/icons/chronometer.png")));
+	this->setMenu(menu_);
+	this->setPopupMode(QToolButton::InstantPopup);
+}
+
+void RefreshIntervalButton::set_interval(int interval)
+{
+	for (const auto &action : action_group_->actions())
+		action->setChecked(action->data().toInt() == interval);
+}
+
+void RefreshIntervalButton::on_action_triggered(QAction *action)
+{
+	Q_EMIT interval_changed(action->data().toInt());
+}
+
+} // namespace widgets
+} // namespace ui
+} // namespace sv
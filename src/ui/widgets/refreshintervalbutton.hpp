@@ -0,0 +1,65 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UI_WIDGETS_REFRESHINTERVALBUTTON_HPP
+#define UI_WIDGETS_REFRESHINTERVALBUTTON_HPP
+
+#include <QAction>
+#include <QActionGroup>
+#include <QMenu>
+#include <QToolButton>
+#include <QWidget>
+
+namespace sv {
+namespace ui {
+namespace widgets {
+
+/**
+ * Tool bar button with a menu to choose the refresh interval of a panel,
+ * that is registered with the DisplayScheduler.
+ */
+class RefreshIntervalButton : public QToolButton
+{
+	Q_OBJECT
+
+public:
+	RefreshIntervalButton(int interval, QWidget *parent = nullptr);
+
+	/** Check the menu entry of the refresh interval in ms. */
+	void set_interval(int interval);
+
+private:
+	QMenu *menu_;
+	QActionGroup *action_group_;
+
+private Q_SLOTS:
+	void on_action_triggered(QAction *action);
+
+Q_SIGNALS:
+	/** Is emitted when a refresh interval in ms is chosen from the menu. */
+	void interval_changed(int interval);
+
+};
+
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_REFRESHINTERVALBUTTON_HPP
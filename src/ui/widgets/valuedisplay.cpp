@@ -45,7 +45,8 @@ ValueDisplay::ValueDisplay(
 	unit_suffix_(unit_suffix),
 	unit_changed_(true),
 	small_(small),
-	value_(.0)
+	value_(.0),
+	value_shown_(false)
 {
 }
 
@@ -56,12 +57,19 @@ double ValueDisplay::value() const
 
 void ValueDisplay::set_value(const double value)
 {
+	// Formatting the value is expensive, skip it for unchanged values.
+	if (value_shown_ && value == value_)
+		return;
+
 	value_ = value;
 	update_display();
 }
 
 void ValueDisplay::set_extra_text(const QString extra_text)
 {
+	if (extra_text == extra_text_)
+		return;
+
 	extra_text_ = extra_text;
 	extra_text_changed_ = true;
 	update_display();
@@ -69,6 +77,9 @@ void ValueDisplay::set_extra_text(const QString extra_text)
 
 void ValueDisplay::set_unit(const QString unit)
 {
+	if (unit == unit_)
+		return;
+
 	unit_ = unit;
 	unit_changed_ = true;
 	update_display();
@@ -76,6 +87,9 @@ void ValueDisplay::set_unit(const QString unit)
 
 void ValueDisplay::set_unit_suffix(const QString unit_suffix)
 {
+	if (unit_suffix == unit_suffix_)
+		return;
+
 	unit_suffix_ = unit_suffix;
 	unit_changed_ = true;
 	update_display();
@@ -83,6 +97,10 @@ void ValueDisplay::set_unit_suffix(const QString unit_suffix)
 
 void ValueDisplay::set_digits(const int digits, const int decimal_places)
 {
+	// The widget dimensions only must be recalculated for new digits.
+	if (digits == digits_ && decimal_places == decimal_places_)
+		return;
+
 	digits_ = digits;
 	decimal_places_ = decimal_places;
 	digits_changed_ = true;
@@ -95,6 +113,8 @@ void ValueDisplay::reset_value()
 	for (int i=0; i<digits_; i++)
 		init_value.append("-");
 	show_value(init_value);
+	value_str_ = init_value;
+	value_shown_ = false;
 }
 
 void ValueDisplay::update_display()
@@ -120,7 +140,11 @@ void ValueDisplay::update_display()
 		util::format_value_si(
 			value_, digits_, decimal_places_, value_str, si_prefix);
 	}
-	show_value(value_str);
+	if (value_str != value_str_) {
+		value_str_ = value_str;
+		show_value(value_str_);
+	}
+	value_shown_ = true;
 
 	if (digits_changed_) {
 		digits_changed_ = false;
@@ -52,6 +52,10 @@ protected:
 	bool unit_changed_;
 	const bool small_;
 	double value_;
+	/** The last shown value string, to skip unchanged updates of the widget. */
+	QString value_str_;
+	/** True, when value_ is shown (and not reset). */
+	bool value_shown_;
 
 	virtual void setup_ui() = 0;
 	virtual void update_value_widget_dimensions() = 0;